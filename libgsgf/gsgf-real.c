@@ -54,6 +54,7 @@ static gboolean gsgf_real_write_stream (const GSGFValue *self,
                                         GError **error);
 
 static GRegex *double_pattern = NULL;
+static volatile gsize double_pattern_init = 0;
 
 static void
 gsgf_real_init(GSGFReal *self)
@@ -79,8 +80,6 @@ gsgf_real_class_init(GSGFRealClass *klass)
 
         value_class->write_stream = gsgf_real_write_stream;
 
-        double_pattern = g_regex_new("^[+-]?[0-9]+(?:\\.[0-9]+)?$", 0, 0, NULL);
-
         g_type_class_add_private(klass, sizeof(GSGFRealPrivate));
 
         object_class->finalize = gsgf_real_finalize;
@@ -114,8 +113,10 @@ _gsgf_real_new(const gchar *string, GError **error)
 
         gsgf_return_val_if_fail (string != NULL, NULL, error);
 
-        if (!double_pattern)
+        if (g_once_init_enter(&double_pattern_init)) {
                 double_pattern = g_regex_new("^[+-]?[0-9]+(?:\\.[0-9]+)?$", 0, 0, NULL);
+                g_once_init_leave(&double_pattern_init, 1);
+        }
 
         if (!g_regex_match(double_pattern, string, 0, NULL)) {
                 g_set_error(error, GSGF_ERROR, GSGF_ERROR_INVALID_NUMBER,
@@ -34,6 +34,38 @@ typedef struct svg_cairo_pt {
     double y;
 } svg_cairo_pt_t;
 
+typedef struct svg_cairo_compiled_path {
+    cairo_matrix_t matrix;
+    cairo_path_t *path;
+} svg_cairo_compiled_path_t;
+
+/* Font faces that have already been looked up.  */
+typedef struct svg_cairo_font_face {
+    char *family;
+    cairo_font_slant_t slant;
+    cairo_font_weight_t weight;
+    cairo_font_face_t *font_face;
+
+    struct svg_cairo_font_face *next;
+} svg_cairo_font_face_t;
+
+/* Texts converted to glyphs, with their origin at 0/0.  */
+typedef struct svg_cairo_glyph_run {
+    char *utf8;
+    cairo_font_face_t *font_face;
+    double font_size;
+    cairo_matrix_t matrix;
+
+    cairo_glyph_t *glyphs;
+    int num_glyphs;
+    cairo_text_extents_t extents;
+
+    struct svg_cairo_glyph_run *next;
+} svg_cairo_glyph_run_t;
+
+/* Maximum number of cached glyph runs per document.  */
+#define SVG_CAIRO_GLYPH_RUN_CACHE_SIZE 32
+
 typedef enum svg_cairo_render_type {
     SVG_CAIRO_RENDER_TYPE_FILL,
     SVG_CAIRO_RENDER_TYPE_STROKE
@@ -81,6 +113,10 @@ struct svg_cairo {
 
     unsigned int viewport_width;
     unsigned int viewport_height;
+
+    svg_cairo_font_face_t *font_faces;
+    svg_cairo_glyph_run_t *glyph_runs;
+    int num_glyph_runs;
 };
 
 /* svg_cairo_sprintf_alloc.c */
@@ -91,6 +127,20 @@ _svg_cairo_sprintf_alloc (char **str, const char *fmt, ...);
 int
 _svg_cairo_vsprintf_alloc (char **str, const char *fmt, va_list ap);
 
+/* svg_cairo_text_cache.c */
+
+cairo_font_face_t *
+_svg_cairo_font_face_cache_lookup (svg_cairo_t		*svg_cairo,
+				   const char		*family,
+				   cairo_font_slant_t	slant,
+				   cairo_font_weight_t	weight);
+
+svg_cairo_glyph_run_t *
+_svg_cairo_glyph_run_cache_lookup (svg_cairo_t *svg_cairo, const char *utf8);
+
+void
+_svg_cairo_text_cache_destroy (svg_cairo_t *svg_cairo);
+
 /* svg_cairo_state.c */
 
 svg_cairo_status_t
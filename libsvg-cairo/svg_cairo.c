@@ -89,6 +89,11 @@ _svg_cairo_set_fill_rule (void *closure, svg_fill_rule_t fill_rule);
 static svg_status_t
 _svg_cairo_select_font (svg_cairo_t *svg_cairo);
 
+static void
+_svg_cairo_show_glyph_run (svg_cairo_t *svg_cairo,
+			   svg_cairo_glyph_run_t *run,
+			   int path);
+
 static svg_status_t
 _svg_cairo_set_font_family (void *closure, const char *family);
 
@@ -191,6 +196,19 @@ _svg_cairo_render_image (void		*closure,
 			 svg_length_t	*width,
 			 svg_length_t	*height);
 
+static svg_status_t
+_svg_cairo_compile_path (void *closure,
+			 void **compiled,
+			 void (**destroy) (void *compiled));
+
+static svg_status_t
+_svg_cairo_append_compiled_path (void *closure,
+				 void *compiled,
+				 int  *appended);
+
+static void
+_svg_cairo_destroy_compiled_path (void *compiled);
+
 static svg_status_t
 _cairo_status_to_svg_status (cairo_status_t xr_status);
 
@@ -247,7 +265,10 @@ static svg_render_engine_t SVG_CAIRO_RENDER_ENGINE = {
     _svg_cairo_render_ellipse,
     _svg_cairo_render_rect,
     _svg_cairo_render_text,
-    _svg_cairo_render_image
+    _svg_cairo_render_image,
+    /* compiled paths */
+    _svg_cairo_compile_path,
+    _svg_cairo_append_compiled_path
 };
 
 svg_cairo_status_t
@@ -266,6 +287,10 @@ svg_cairo_create (svg_cairo_t **svg_cairo)
      * handling should be reworked. */
     (*svg_cairo)->viewport_width = 490;
     (*svg_cairo)->viewport_height = 380;
+
+    (*svg_cairo)->font_faces = NULL;
+    (*svg_cairo)->glyph_runs = NULL;
+    (*svg_cairo)->num_glyph_runs = 0;
  
     status = svg_create (&(*svg_cairo)->svg);
     if (status)
@@ -283,6 +308,8 @@ svg_cairo_destroy (svg_cairo_t *svg_cairo)
 
     _svg_cairo_pop_state (svg_cairo);
 
+    _svg_cairo_text_cache_destroy (svg_cairo);
+
     status = svg_destroy (svg_cairo->svg);
 
     free (svg_cairo);
@@ -775,6 +802,7 @@ _svg_cairo_select_font (svg_cairo_t *svg_cairo)
     cairo_font_weight_t weight;
     svg_font_style_t font_style = svg_cairo->state->font_style;
     cairo_font_slant_t slant;
+    cairo_font_face_t *font_face;
 
     if (! svg_cairo->state->font_dirty)
 	return SVG_STATUS_SUCCESS;
@@ -796,7 +824,12 @@ _svg_cairo_select_font (svg_cairo_t *svg_cairo)
 	break;
     }
 
-    cairo_select_font_face (svg_cairo->cr, family, slant, weight);
+    font_face = _svg_cairo_font_face_cache_lookup (svg_cairo, family,
+						   slant, weight);
+    if (font_face)
+	cairo_set_font_face (svg_cairo->cr, font_face);
+    else
+	cairo_select_font_face (svg_cairo->cr, family, slant, weight);
     cairo_set_font_size (svg_cairo->cr, svg_cairo->state->font_size);
     svg_cairo->state->font_dirty = 0;
 
@@ -1081,6 +1114,73 @@ _svg_cairo_render_path (void *closure)
     return _cairo_status_to_svg_status (cairo_status (svg_cairo->cr));
 }
 
+static svg_status_t
+_svg_cairo_compile_path (void *closure,
+			 void **compiled,
+			 void (**destroy) (void *compiled))
+{
+    svg_cairo_t *svg_cairo = closure;
+    svg_cairo_compiled_path_t *compiled_path;
+
+    compiled_path = malloc (sizeof (svg_cairo_compiled_path_t));
+    if (compiled_path == NULL)
+	return SVG_STATUS_NO_MEMORY;
+
+    /* The current path only holds the path being rendered because
+       _svg_cairo_render_path always starts a new path when done.  */
+    cairo_get_matrix (svg_cairo->cr, &compiled_path->matrix);
+    compiled_path->path = cairo_copy_path (svg_cairo->cr);
+    if (compiled_path->path->status) {
+	_svg_cairo_destroy_compiled_path (compiled_path);
+	return SVG_STATUS_SUCCESS;
+    }
+
+    *compiled = compiled_path;
+    *destroy = _svg_cairo_destroy_compiled_path;
+
+    return SVG_STATUS_SUCCESS;
+}
+
+static svg_status_t
+_svg_cairo_append_compiled_path (void *closure,
+				 void *compiled,
+				 int  *appended)
+{
+    svg_cairo_t *svg_cairo = closure;
+    svg_cairo_compiled_path_t *compiled_path = compiled;
+    cairo_matrix_t matrix;
+
+    /* The copy is in user space, but cairo rounds every point to fixed
+       point in device space, and the copy was converted back from these
+       rounded values.  Under the scale and rotation it was made with the
+       points round to the same device coordinates again, up to one fixed
+       point unit after a translation.  Under any other matrix the
+       rounding errors would be scaled up, so the element is rendered
+       from scratch.  */
+    cairo_get_matrix (svg_cairo->cr, &matrix);
+    if (matrix.xx != compiled_path->matrix.xx
+	|| matrix.yx != compiled_path->matrix.yx
+	|| matrix.xy != compiled_path->matrix.xy
+	|| matrix.yy != compiled_path->matrix.yy) {
+	*appended = 0;
+	return SVG_STATUS_SUCCESS;
+    }
+
+    cairo_append_path (svg_cairo->cr, compiled_path->path);
+    *appended = 1;
+
+    return _cairo_status_to_svg_status (cairo_status (svg_cairo->cr));
+}
+
+static void
+_svg_cairo_destroy_compiled_path (void *compiled)
+{
+    svg_cairo_compiled_path_t *compiled_path = compiled;
+
+    cairo_path_destroy (compiled_path->path);
+    free (compiled_path);
+}
+
 static svg_status_t
 _svg_cairo_render_ellipse (void *closure,
 		      svg_length_t *cx_len,
@@ -1164,6 +1264,29 @@ _svg_cairo_render_rect (void *closure,
     return _cairo_status_to_svg_status (cairo_status (svg_cairo->cr));
 }
 
+/* Like cairo_show_text, or cairo_text_path if PATH is true, for a
+   cached glyph run.  Both advance the current point, so this does too.  */
+static void
+_svg_cairo_show_glyph_run (svg_cairo_t *svg_cairo,
+			   svg_cairo_glyph_run_t *run,
+			   int path)
+{
+    double x, y;
+
+    cairo_get_current_point (svg_cairo->cr, &x, &y);
+
+    cairo_save (svg_cairo->cr);
+    cairo_translate (svg_cairo->cr, x, y);
+    if (path)
+	cairo_glyph_path (svg_cairo->cr, run->glyphs, run->num_glyphs);
+    else
+	cairo_show_glyphs (svg_cairo->cr, run->glyphs, run->num_glyphs);
+    cairo_restore (svg_cairo->cr);
+
+    cairo_move_to (svg_cairo->cr,
+		   x + run->extents.x_advance, y + run->extents.y_advance);
+}
+
 static svg_status_t
 _svg_cairo_render_text (void *closure,
 			svg_length_t *x_len,
@@ -1174,6 +1297,8 @@ _svg_cairo_render_text (void *closure,
     double x, y;
     svg_status_t status;
     svg_paint_t *fill_paint, *stroke_paint;
+    svg_cairo_glyph_run_t *run;
+    cairo_text_extents_t extents;
 
     fill_paint = &svg_cairo->state->fill_paint;
     stroke_paint = &svg_cairo->state->stroke_paint;
@@ -1187,10 +1312,14 @@ _svg_cairo_render_text (void *closure,
     if (status)
 	return status;
 
-    if (svg_cairo->state->text_anchor != SVG_TEXT_ANCHOR_START) {
-	cairo_text_extents_t extents;
+    run = _svg_cairo_glyph_run_cache_lookup (svg_cairo, utf8);
+    if (run)
+	extents = run->extents;
+    else if (svg_cairo->state->text_anchor != SVG_TEXT_ANCHOR_START
+	     || svg_cairo->state->dominant_baseline != SVG_DOMINANT_BASELINE_AUTO)
 	cairo_text_extents (svg_cairo->cr, utf8, &extents);
 
+    if (svg_cairo->state->text_anchor != SVG_TEXT_ANCHOR_START) {
 	if (svg_cairo->state->text_anchor == SVG_TEXT_ANCHOR_END)
 	    cairo_rel_move_to (svg_cairo->cr, -extents.x_advance, -extents.y_advance);
 	else if (svg_cairo->state->text_anchor == SVG_TEXT_ANCHOR_MIDDLE)
@@ -1198,9 +1327,6 @@ _svg_cairo_render_text (void *closure,
     }
 
     if (svg_cairo->state->dominant_baseline != SVG_DOMINANT_BASELINE_AUTO) {
-        cairo_text_extents_t extents;
-        cairo_text_extents (svg_cairo->cr, utf8, &extents);
-
         if (svg_cairo->state->dominant_baseline == SVG_DOMINANT_BASELINE_CENTRAL) {
             cairo_rel_move_to (svg_cairo->cr, 0, extents.height / 2.0);
         } else if (svg_cairo->state->dominant_baseline == SVG_DOMINANT_BASELINE_MIDDLE)
@@ -1215,7 +1341,10 @@ _svg_cairo_render_text (void *closure,
 	_svg_cairo_set_paint_and_opacity (svg_cairo, fill_paint,
 					  svg_cairo->state->fill_opacity,
 					  SVG_CAIRO_RENDER_TYPE_FILL);
-	cairo_show_text (svg_cairo->cr, utf8);
+	if (run)
+	    _svg_cairo_show_glyph_run (svg_cairo, run, 0);
+	else
+	    cairo_show_text (svg_cairo->cr, utf8);
 	if (stroke_paint->type)
 	    cairo_restore (svg_cairo->cr);
     }
@@ -1224,7 +1353,10 @@ _svg_cairo_render_text (void *closure,
 	_svg_cairo_set_paint_and_opacity (svg_cairo, stroke_paint,
 					  svg_cairo->state->stroke_opacity,
 					  SVG_CAIRO_RENDER_TYPE_STROKE);
-	cairo_text_path (svg_cairo->cr, utf8);
+	if (run)
+	    _svg_cairo_show_glyph_run (svg_cairo, run, 1);
+	else
+	    cairo_text_path (svg_cairo->cr, utf8);
 	cairo_stroke (svg_cairo->cr);
     }
 
@@ -0,0 +1,195 @@
+/* libsvg-cairo - Render SVG documents using the cairo library
+ *
+ * Copyright (C) 2009-2012 Guido Flohr
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GCinema; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Rendering the same texts over and over again should neither look up
+   the font nor convert the text into glyphs each time.  Both results
+   are therefore cached per document.  Glyph runs are keyed by their
+   text, so a text element that changes simply misses the cache.  */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "svg-cairo-internal.h"
+
+static void
+_svg_cairo_glyph_run_destroy (svg_cairo_glyph_run_t *run);
+
+cairo_font_face_t *
+_svg_cairo_font_face_cache_lookup (svg_cairo_t		*svg_cairo,
+				   const char		*family,
+				   cairo_font_slant_t	slant,
+				   cairo_font_weight_t	weight)
+{
+    svg_cairo_font_face_t *face;
+    cairo_font_face_t *font_face;
+
+    for (face = svg_cairo->font_faces; face; face = face->next)
+	if (face->slant == slant && face->weight == weight
+	    && strcmp (face->family, family) == 0)
+	    return face->font_face;
+
+    /* Let cairo resolve the family name once.  */
+    cairo_save (svg_cairo->cr);
+    cairo_select_font_face (svg_cairo->cr, family, slant, weight);
+    font_face = cairo_font_face_reference (cairo_get_font_face (svg_cairo->cr));
+    cairo_restore (svg_cairo->cr);
+
+    if (cairo_font_face_status (font_face)) {
+	cairo_font_face_destroy (font_face);
+	return NULL;
+    }
+
+    face = malloc (sizeof (svg_cairo_font_face_t));
+    if (face == NULL) {
+	cairo_font_face_destroy (font_face);
+	return NULL;
+    }
+
+    face->family = strdup (family);
+    if (face->family == NULL) {
+	cairo_font_face_destroy (font_face);
+	free (face);
+	return NULL;
+    }
+    face->slant = slant;
+    face->weight = weight;
+    face->font_face = font_face;
+
+    face->next = svg_cairo->font_faces;
+    svg_cairo->font_faces = face;
+
+    return font_face;
+}
+
+/* The glyphs depend on the font that is currently selected, and their
+   positions also on the scale and rotation of the current
+   transformation because of hinting.  Returns NULL if the text cannot
+   be converted, the caller should then fall back to cairo_show_text.  */
+svg_cairo_glyph_run_t *
+_svg_cairo_glyph_run_cache_lookup (svg_cairo_t *svg_cairo, const char *utf8)
+{
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE (1, 8, 0)
+    cairo_t *cr = svg_cairo->cr;
+    cairo_font_face_t *font_face = cairo_get_font_face (cr);
+    double font_size = svg_cairo->state->font_size;
+    cairo_scaled_font_t *scaled_font;
+    cairo_matrix_t matrix;
+    svg_cairo_glyph_run_t *run, *prev = NULL;
+    cairo_status_t status;
+    int i;
+
+    cairo_get_matrix (cr, &matrix);
+
+    for (run = svg_cairo->glyph_runs; run; prev = run, run = run->next) {
+	if (run->font_face != font_face
+	    || run->font_size != font_size
+	    || run->matrix.xx != matrix.xx
+	    || run->matrix.yx != matrix.yx
+	    || run->matrix.xy != matrix.xy
+	    || run->matrix.yy != matrix.yy
+	    || strcmp (run->utf8, utf8))
+	    continue;
+
+	/* Keep the list ordered by the time of last use.  */
+	if (prev) {
+	    prev->next = run->next;
+	    run->next = svg_cairo->glyph_runs;
+	    svg_cairo->glyph_runs = run;
+	}
+
+	return run;
+    }
+
+    run = malloc (sizeof (svg_cairo_glyph_run_t));
+    if (run == NULL)
+	return NULL;
+
+    run->utf8 = strdup (utf8);
+    if (run->utf8 == NULL) {
+	free (run);
+	return NULL;
+    }
+
+    run->glyphs = NULL;
+    run->num_glyphs = 0;
+    scaled_font = cairo_get_scaled_font (cr);
+    status = cairo_scaled_font_text_to_glyphs (scaled_font, 0, 0, utf8, -1,
+					       &run->glyphs, &run->num_glyphs,
+					       NULL, NULL, NULL);
+    if (status) {
+	free (run->utf8);
+	free (run);
+	return NULL;
+    }
+    cairo_scaled_font_glyph_extents (scaled_font, run->glyphs,
+				     run->num_glyphs, &run->extents);
+
+    run->font_face = cairo_font_face_reference (font_face);
+    run->font_size = font_size;
+    run->matrix = matrix;
+
+    run->next = svg_cairo->glyph_runs;
+    svg_cairo->glyph_runs = run;
+
+    if (++svg_cairo->num_glyph_runs > SVG_CAIRO_GLYPH_RUN_CACHE_SIZE) {
+	prev = svg_cairo->glyph_runs;
+	for (i = 2; i < svg_cairo->num_glyph_runs; i++)
+	    prev = prev->next;
+	_svg_cairo_glyph_run_destroy (prev->next);
+	prev->next = NULL;
+	svg_cairo->num_glyph_runs--;
+    }
+
+    return run;
+#else
+    return NULL;
+#endif
+}
+
+void
+_svg_cairo_text_cache_destroy (svg_cairo_t *svg_cairo)
+{
+    svg_cairo_font_face_t *face;
+    svg_cairo_glyph_run_t *run;
+
+    while (svg_cairo->font_faces) {
+	face = svg_cairo->font_faces;
+	svg_cairo->font_faces = face->next;
+	cairo_font_face_destroy (face->font_face);
+	free (face->family);
+	free (face);
+    }
+
+    while (svg_cairo->glyph_runs) {
+	run = svg_cairo->glyph_runs;
+	svg_cairo->glyph_runs = run->next;
+	_svg_cairo_glyph_run_destroy (run);
+    }
+    svg_cairo->num_glyph_runs = 0;
+}
+
+static void
+_svg_cairo_glyph_run_destroy (svg_cairo_glyph_run_t *run)
+{
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE (1, 8, 0)
+    cairo_glyph_free (run->glyphs);
+#endif
+    cairo_font_face_destroy (run->font_face);
+    free (run->utf8);
+    free (run);
+}
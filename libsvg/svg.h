@@ -323,6 +323,13 @@ typedef struct svg_render_engine {
 				   svg_length_t	 *y,
 				   svg_length_t	 *width,
 				   svg_length_t	 *height);
+    /* compiled paths (optional) */
+    svg_status_t (* compile_path) (void *closure,
+				   void **compiled,
+				   void (**destroy) (void *compiled));
+    svg_status_t (* append_compiled_path) (void *closure,
+					   void *compiled,
+					   int  *appended);
 } svg_render_engine_t;
 
 svg_status_t
@@ -103,6 +103,9 @@ _svg_path_arg_buf_destroy (svg_path_arg_buf_t *arg_buf);
 static svg_status_t
 _svg_path_arg_buf_add (svg_path_arg_buf_t *arg_buf, double val);
 
+static void
+_svg_path_discard_compiled (svg_path_t *path);
+
 svg_status_t
 _svg_path_create (svg_path_t **path)
 {
@@ -135,6 +138,10 @@ _svg_path_init (svg_path_t *path)
     path->arg_head = NULL;
     path->arg_tail = NULL;
 
+    path->compiled_engine = NULL;
+    path->compiled = NULL;
+    path->compiled_destroy = NULL;
+
     return SVG_STATUS_SUCCESS;
 }
 
@@ -251,6 +258,8 @@ _svg_path_deinit (svg_path_t *path)
     svg_path_op_buf_t *op;
     svg_path_arg_buf_t *arg;
 
+    _svg_path_discard_compiled (path);
+
     while (path->op_head) {
 	op = path->op_head;
 	path->op_head = op->next;
@@ -292,6 +301,21 @@ _svg_path_render (svg_path_t		*path,
     svg_path_op_t op;
     svg_path_arg_buf_t *arg_buf = path->arg_head;
     int buf_i = 0;
+    int appended = 0;
+
+    /* Engines that can compile a path are asked to do so after the
+       first replay of the operators.  As long as the path does not
+       change, the compiled path is handed back to the engine, which
+       may still decide to replay the path, for example, because the
+       transformation has changed.  */
+    if (path->compiled && path->compiled_engine == engine) {
+	status = (engine->append_compiled_path) (closure, path->compiled,
+						 &appended);
+	if (status)
+	    return status;
+	if (appended)
+	    return (engine->render_path) (closure);
+    }
 
     for (op_buf = path->op_head; op_buf; op_buf = op_buf->next) {
 	for (i=0; i < op_buf->num_ops; i++) {
@@ -339,6 +363,16 @@ _svg_path_render (svg_path_t		*path,
 	}
     }
 
+    if (engine->compile_path && engine->append_compiled_path) {
+	_svg_path_discard_compiled (path);
+	status = (engine->compile_path) (closure, &path->compiled,
+					 &path->compiled_destroy);
+	if (status)
+	    return status;
+	if (path->compiled)
+	    path->compiled_engine = engine;
+    }
+
     status = (engine->render_path) (closure);
     if (status)
 	return status;
@@ -507,12 +541,25 @@ _svg_path_add_from_str (svg_path_t *path, const char *path_str)
     return SVG_STATUS_SUCCESS;
 }
 
+static void
+_svg_path_discard_compiled (svg_path_t *path)
+{
+    if (path->compiled && path->compiled_destroy)
+	(path->compiled_destroy) (path->compiled);
+
+    path->compiled_engine = NULL;
+    path->compiled = NULL;
+    path->compiled_destroy = NULL;
+}
+
 static svg_status_t
 _svg_path_add (svg_path_t *path, svg_path_op_t op, ...)
 {
     va_list va;
     svg_status_t status;
 
+    _svg_path_discard_compiled (path);
+
     va_start (va, op);
     status = _svg_path_add_va (path, op, va);
     va_end (va);
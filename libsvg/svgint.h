@@ -138,6 +138,12 @@ typedef struct svg_path {
 
     svg_path_arg_buf_t *arg_head;
     svg_path_arg_buf_t *arg_tail;
+
+    /* The path in the representation of the render engine that
+       compiled it, see _svg_path_render.  */
+    const struct svg_render_engine *compiled_engine;
+    void *compiled;
+    void (*compiled_destroy) (void *compiled);
 } svg_path_t;
 
 #define SVG_STYLE_FLAG_NONE				0x00000000000ULL
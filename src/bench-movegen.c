@@ -0,0 +1,465 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark for the hot paths of the move code.
+ *
+ * Usage: bench_movegen [POSITIONS [SEED [MATCH_FILE...]]]
+ *
+ * The corpus consists of POSITIONS positions from random games and all
+ * moves found in the archived matches (by default the 7point.gmd from
+ * the source directory).  For every function the number of positions
+ * per second, the number of allocations per call and latency percentiles
+ * are written to standard output, one JSON object per line.
+ *
+ * Allocations are counted with a memory vtable.  If the GLib version
+ * in use ignores g_mem_set_vtable() they are reported as null.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "gibbon-position.h"
+#include "gibbon-move.h"
+#include "gibbon-game.h"
+#include "gibbon-match.h"
+#include "gibbon-gmd-reader.h"
+
+#define BENCH_REPEAT 16
+
+typedef struct _BenchEntry BenchEntry;
+struct _BenchEntry {
+        GibbonPosition *before;
+        GibbonPosition *after;
+        GibbonPositionSide side;
+
+        /* In absolute coordinates, see add_entry().  */
+        GibbonMove *move;
+};
+
+typedef void (*BenchFunc) (const BenchEntry *entry);
+
+static guint64 allocations = 0;
+static gboolean count_allocations = FALSE;
+static GArray *plays = NULL;
+
+static gpointer bench_malloc (gsize n_bytes);
+static gpointer bench_realloc (gpointer mem, gsize n_bytes);
+static gpointer bench_calloc (gsize n_blocks, gsize n_block_bytes);
+
+static void add_entry (GPtrArray *entries, const GibbonPosition *before,
+                       const GibbonPosition *after, GibbonPositionSide side);
+static guint add_random_entries (GPtrArray *entries, guint64 count);
+static guint add_archived_entries (GPtrArray *entries, const gchar *filename);
+static void free_entry (BenchEntry *entry);
+
+static void bench_check_move (const BenchEntry *entry);
+static void bench_apply_move (const BenchEntry *entry);
+static void bench_format_move (const BenchEntry *entry);
+static void bench_generate_moves (const BenchEntry *entry);
+static void bench_run (const gchar *name, BenchFunc func,
+                       const GPtrArray *entries);
+static gint compare_doubles (gconstpointer a, gconstpointer b);
+
+static GMemVTable bench_vtable = {
+        bench_malloc,
+        bench_realloc,
+        free,
+        bench_calloc,
+        NULL,
+        NULL
+};
+
+int
+main (int argc, char *argv[])
+{
+        guint64 num_random = 10000;
+        long long random_seed = time (NULL);
+        GPtrArray *entries;
+        guint num_archived = 0;
+        gchar *filename;
+        gpointer probe;
+        gint i;
+
+        /* Must happen before anything else is allocated.  */
+        g_mem_set_vtable (&bench_vtable);
+        g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+        probe = g_malloc (1);
+        count_allocations = allocations != 0;
+        g_free (probe);
+
+        g_type_init ();
+
+        if (argc > 1) {
+                errno = 0;
+                num_random = g_ascii_strtoull (argv[1], NULL, 10);
+                if (errno) {
+                        g_printerr ("Invalid number of positions `%s': %s!\n",
+                                    argv[1], strerror (errno));
+                        return -1;
+                }
+        }
+
+        if (argc > 2) {
+                errno = 0;
+                random_seed = g_ascii_strtoull (argv[2], NULL, 10);
+                if (errno) {
+                        g_printerr ("Invalid random seed `%s': %s!\n",
+                                    argv[2], strerror (errno));
+                        return -1;
+                }
+        }
+        srandom (random_seed);
+
+        entries = g_ptr_array_new_with_free_func ((GDestroyNotify) free_entry);
+
+        if (argc > 3) {
+                for (i = 3; i < argc; ++i)
+                        num_archived += add_archived_entries (entries, argv[i]);
+        } else {
+                filename = g_build_filename (ABS_SRCDIR, "7point.gmd", NULL);
+                num_archived = add_archived_entries (entries, filename);
+                g_free (filename);
+        }
+
+        num_random = add_random_entries (entries, num_random);
+
+        g_print ("{\"corpus\":{\"random\":%llu,\"archived\":%u,"
+                 "\"seed\":%lld,\"repeat\":%u}}\n",
+                 (unsigned long long) num_random, num_archived,
+                 random_seed, BENCH_REPEAT);
+
+        if (!entries->len) {
+                g_printerr ("Empty corpus!\n");
+                return -1;
+        }
+
+        plays = g_array_sized_new (FALSE, FALSE, sizeof (GibbonPositionPlay),
+                                   1024);
+
+        bench_run ("check_move", bench_check_move, entries);
+        bench_run ("apply_move", bench_apply_move, entries);
+        bench_run ("format_move", bench_format_move, entries);
+        bench_run ("generate_moves", bench_generate_moves, entries);
+
+        g_array_free (plays, TRUE);
+        g_ptr_array_free (entries, TRUE);
+
+        return 0;
+}
+
+static gpointer
+bench_malloc (gsize n_bytes)
+{
+        ++allocations;
+
+        return malloc (n_bytes);
+}
+
+static gpointer
+bench_realloc (gpointer mem, gsize n_bytes)
+{
+        ++allocations;
+
+        return realloc (mem, n_bytes);
+}
+
+static gpointer
+bench_calloc (gsize n_blocks, gsize n_block_bytes)
+{
+        ++allocations;
+
+        return calloc (n_blocks, n_block_bytes);
+}
+
+/*
+ * The move returned by gibbon_position_check_move() is relative to the
+ * side on move.  It is converted to absolute coordinates here, so that
+ * gibbon_position_apply_move() does not modify it, and can be called
+ * repeatedly.
+ */
+static void
+add_entry (GPtrArray *entries, const GibbonPosition *before,
+           const GibbonPosition *after, GibbonPositionSide side)
+{
+        BenchEntry *entry;
+        GibbonMove *move;
+        GibbonPosition work;
+        gsize i;
+
+        if (before->dice[0] < 1 || before->dice[0] > 6
+            || before->dice[1] < 1 || before->dice[1] > 6)
+                return;
+
+        move = gibbon_position_check_move (before, after, side);
+        if (move->status != GIBBON_MOVE_LEGAL) {
+                g_object_unref (move);
+                return;
+        }
+
+        if (side < 0) {
+                for (i = 0; i < move->number; ++i) {
+                        move->movements[i].from = 25 - move->movements[i].from;
+                        move->movements[i].to = 25 - move->movements[i].to;
+                }
+        }
+
+        work = *before;
+        if (!gibbon_position_apply_move (&work, move, side, FALSE)
+            || memcmp (work.points, after->points, sizeof work.points)
+            || memcmp (work.bar, after->bar, sizeof work.bar)) {
+                g_object_unref (move);
+                return;
+        }
+
+        entry = g_malloc (sizeof *entry);
+        entry->before = gibbon_position_copy (before);
+        entry->after = gibbon_position_copy (after);
+        entry->side = side;
+        entry->move = move;
+
+        g_ptr_array_add (entries, entry);
+}
+
+static guint
+add_random_entries (GPtrArray *entries, guint64 count)
+{
+        GibbonPosition *before = NULL;
+        GibbonPosition *after;
+        GibbonPositionSide side = GIBBON_POSITION_SIDE_NONE;
+        GArray *candidates;
+        const GibbonPositionPlay *play;
+        guint64 done = 0;
+        guint old_len = entries->len;
+        gint i;
+
+        candidates = g_array_new (FALSE, FALSE, sizeof (GibbonPositionPlay));
+
+        while (done < count) {
+                if (!before || gibbon_position_game_over (before)) {
+                        gibbon_position_free (before);
+                        before = gibbon_position_new ();
+                        side = random () % 2 ? GIBBON_POSITION_SIDE_WHITE
+                                             : GIBBON_POSITION_SIDE_BLACK;
+                }
+
+                before->turn = side;
+                before->dice[0] = 1 + random () % 6;
+                before->dice[1] = 1 + random () % 6;
+
+                (void) gibbon_position_generate_moves (before, side,
+                                                       before->dice[0],
+                                                       before->dice[1],
+                                                       candidates);
+                play = &g_array_index (candidates, GibbonPositionPlay,
+                                       random () % candidates->len);
+
+                after = gibbon_position_copy (before);
+                if (side > 0) {
+                        after->bar[1] = play->board[0];
+                        for (i = 0; i < 24; ++i)
+                                after->points[i] = play->board[i + 1];
+                        after->bar[0] = play->board[25];
+                } else {
+                        after->bar[0] = play->board[0];
+                        for (i = 0; i < 24; ++i)
+                                after->points[23 - i] = -play->board[i + 1];
+                        after->bar[1] = play->board[25];
+                }
+                after->dice[0] = after->dice[1] = 0;
+
+                add_entry (entries, before, after, side);
+                ++done;
+
+                gibbon_position_free (before);
+                before = after;
+                side = -side;
+        }
+
+        gibbon_position_free (before);
+        g_array_free (candidates, TRUE);
+
+        return entries->len - old_len;
+}
+
+static guint
+add_archived_entries (GPtrArray *entries, const gchar *filename)
+{
+        GibbonMatchReader *reader;
+        GibbonMatch *match;
+        GibbonGame *game;
+        const GibbonGameAction *action;
+        const GibbonPosition *before;
+        const GibbonPosition *after;
+        GibbonPositionSide side;
+        gsize i, num_games;
+        gsize j, num_actions;
+        guint old_len = entries->len;
+
+        reader = GIBBON_MATCH_READER (gibbon_gmd_reader_new (NULL, NULL));
+        match = gibbon_match_reader_parse (reader, filename);
+        g_object_unref (reader);
+        if (!match) {
+                g_printerr ("Cannot read `%s'.\n", filename);
+                return 0;
+        }
+
+        num_games = gibbon_match_get_number_of_games (match);
+        for (i = 0; i < num_games; ++i) {
+                game = gibbon_match_get_nth_game (match, i);
+                num_actions = gibbon_game_get_num_actions (game);
+                for (j = 0; j < num_actions; ++j) {
+                        action = gibbon_game_get_nth_action (game, j, &side);
+                        if (!GIBBON_IS_MOVE (action) || !side)
+                                continue;
+                        if (j)
+                                before = gibbon_game_get_nth_position (game,
+                                                                       j - 1);
+                        else
+                                before = gibbon_game_get_initial_position (
+                                                game);
+                        after = gibbon_game_get_nth_position (game, j);
+                        add_entry (entries, before, after, side);
+                }
+        }
+
+        g_object_unref (match);
+
+        return entries->len - old_len;
+}
+
+static void
+free_entry (BenchEntry *entry)
+{
+        gibbon_position_free (entry->before);
+        gibbon_position_free (entry->after);
+        g_object_unref (entry->move);
+        g_free (entry);
+}
+
+static void
+bench_check_move (const BenchEntry *entry)
+{
+        GibbonMove *move;
+
+        move = gibbon_position_check_move (entry->before, entry->after,
+                                           entry->side);
+        g_object_unref (move);
+}
+
+static void
+bench_apply_move (const BenchEntry *entry)
+{
+        GibbonPosition work = *entry->before;
+
+        (void) gibbon_position_apply_move (&work, entry->move, entry->side,
+                                           FALSE);
+}
+
+static void
+bench_format_move (const BenchEntry *entry)
+{
+        g_free (gibbon_position_format_move (entry->before, entry->move,
+                                             entry->side, FALSE));
+}
+
+static void
+bench_generate_moves (const BenchEntry *entry)
+{
+        (void) gibbon_position_generate_moves (entry->before, entry->side,
+                                               entry->before->dice[0],
+                                               entry->before->dice[1],
+                                               plays);
+}
+
+static void
+bench_run (const gchar *name, BenchFunc func, const GPtrArray *entries)
+{
+        gdouble *latencies;
+        GTimer *timer;
+        gdouble elapsed, total = 0;
+        guint64 allocations_before;
+        guint64 allocated;
+        guint64 calls = (guint64) entries->len * BENCH_REPEAT;
+        const BenchEntry *entry;
+        guint i, r, n = entries->len;
+
+        latencies = g_new (gdouble, n);
+        timer = g_timer_new ();
+
+        /* Warm up caches and lazily initialized data.  */
+        for (i = 0; i < n; ++i)
+                func (g_ptr_array_index (entries, i));
+
+        allocations_before = allocations;
+        for (i = 0; i < n; ++i) {
+                entry = g_ptr_array_index (entries, i);
+                g_timer_start (timer);
+                for (r = 0; r < BENCH_REPEAT; ++r)
+                        func (entry);
+                g_timer_stop (timer);
+                elapsed = g_timer_elapsed (timer, NULL);
+                latencies[i] = 1e9 * elapsed / BENCH_REPEAT;
+                total += elapsed;
+        }
+        allocated = allocations - allocations_before;
+
+        qsort (latencies, n, sizeof *latencies, compare_doubles);
+
+        g_print ("{\"benchmark\":\"%s\",\"calls\":%llu,"
+                 "\"positions_per_second\":%.0f,",
+                 name, (unsigned long long) calls,
+                 total > 0 ? calls / total : 0.0);
+        if (count_allocations)
+                g_print ("\"allocations_per_call\":%.2f,",
+                         (gdouble) allocated / calls);
+        else
+                g_print ("\"allocations_per_call\":null,");
+        g_print ("\"latency_ns\":{\"p50\":%.0f,\"p90\":%.0f,\"p99\":%.0f,"
+                 "\"max\":%.0f}}\n",
+                 latencies[n / 2], latencies[n * 9 / 10],
+                 latencies[n * 99 / 100], latencies[n - 1]);
+
+        g_timer_destroy (timer);
+        g_free (latencies);
+}
+
+static gint
+compare_doubles (gconstpointer a, gconstpointer b)
+{
+        gdouble d1 = *((const gdouble *) a);
+        gdouble d2 = *((const gdouble *) b);
+
+        if (d1 < d2)
+                return -1;
+        else if (d1 > d2)
+                return +1;
+        else
+                return 0;
+}
@@ -60,6 +60,7 @@
 #include "gibbon-game.h"
 #include "gibbon-analysis-view.h"
 #include "gibbon-met.h"
+#include "gibbon-bearoff.h"
 #include "gibbon-java-fibs-importer.h"
 
 enum gibbon_app_list_signal {
@@ -108,6 +109,8 @@ struct _GibbonAppPrivate {
         GibbonAnalysisView *analysis_view;
 
         GibbonMET *met;
+        GibbonBearoff *bearoff;
+        guint verify_bearoff_id;
 };
 
 #define GIBBON_APP_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
@@ -120,6 +123,8 @@ static GibbonCairoboard *gibbon_app_init_board (GibbonApp *self,
                                                 const gchar *board_filename);
 static gboolean gibbon_app_init_match_list (GibbonApp *self,
                                             const gchar *filename);
+static GibbonBearoff *gibbon_app_load_bearoff (const gchar *builder_path);
+static gboolean gibbon_app_verify_bearoff (GibbonApp *self);
 
 static void gibbon_app_connect_signals (const GibbonApp *self);
 static void gibbon_app_set_icon (const GibbonApp *self, const gchar *directory);
@@ -197,6 +202,9 @@ static void gibbon_app_init(GibbonApp *self)
         self->priv->game_list_view = NULL;
         self->priv->move_list_view = NULL;
         self->priv->analysis_view = NULL;
+
+        self->priv->bearoff = NULL;
+        self->priv->verify_bearoff_id = 0;
 }
 
 static void gibbon_app_finalize(GObject *object)
@@ -238,6 +246,10 @@ static void gibbon_app_finalize(GObject *object)
         if (self->priv->match_list)
                 g_object_unref (self->priv->match_list);
 
+        if (self->priv->verify_bearoff_id)
+                g_source_remove (self->priv->verify_bearoff_id);
+        gibbon_bearoff_free (self->priv->bearoff);
+
         if (self->priv->window)
                 gtk_widget_destroy (self->priv->window);
 
@@ -297,6 +309,17 @@ gibbon_app_new(const gchar *builder_path, const gchar *pixmaps_directory,
         app = self = g_object_new (GIBBON_TYPE_APP, NULL);
 
         self->priv->met = gibbon_met_new ();
+        /*
+         * The checksum of the bearoff database is verified, once the
+         * application is idle, because that reads the whole file.
+         */
+        self->priv->bearoff = gibbon_app_load_bearoff (builder_path);
+        if (self->priv->bearoff)
+                self->priv->verify_bearoff_id =
+                        g_idle_add_full (G_PRIORITY_LOW,
+                                         (GSourceFunc)
+                                         gibbon_app_verify_bearoff,
+                                         self, NULL);
 
         self->priv->builder = gibbon_app_get_builder(self, builder_path);
         if (!self->priv->builder) {
@@ -2034,6 +2057,61 @@ gibbon_app_get_met (const GibbonApp *self)
         return self->priv->met;
 }
 
+const struct _GibbonBearoff *
+gibbon_app_get_bearoff (const GibbonApp *self)
+{
+        g_return_val_if_fail (GIBBON_IS_APP (self), NULL);
+
+        return self->priv->bearoff;
+}
+
+/*
+ * The bearoff database is installed next to the builder file.  If it is
+ * missing, for example when running from the source tree, the exact race
+ * figures are simply not displayed.  Calculating the database takes far
+ * too long for doing it at startup.
+ */
+static GibbonBearoff *
+gibbon_app_load_bearoff (const gchar *builder_path)
+{
+        GibbonBearoff *bearoff;
+        gchar *directory;
+        gchar *path;
+        GError *error = NULL;
+
+        directory = g_path_get_dirname (builder_path);
+        path = g_build_filename (directory, GIBBON_BEAROFF_FILENAME, NULL);
+        g_free (directory);
+
+        bearoff = gibbon_bearoff_load (path, &error);
+        g_free (path);
+        if (bearoff)
+                return bearoff;
+
+        if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+                g_warning ("%s", error->message);
+        g_error_free (error);
+
+        return NULL;
+}
+
+static gboolean
+gibbon_app_verify_bearoff (GibbonApp *self)
+{
+        GError *error = NULL;
+
+        self->priv->verify_bearoff_id = 0;
+
+        if (!gibbon_bearoff_verify (self->priv->bearoff, &error)) {
+                g_warning ("%s", error->message);
+                g_error_free (error);
+                gibbon_bearoff_free (self->priv->bearoff);
+                self->priv->bearoff = NULL;
+        }
+
+        return FALSE;
+}
+
 static void
 gibbon_app_on_java_fibs_import (GibbonApp *self)
 {
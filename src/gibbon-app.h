@@ -117,6 +117,7 @@ struct _GibbonInviterList *gibbon_app_get_inviter_list (const GibbonApp *self);
 struct _GibbonMatchList *gibbon_app_get_match_list (const GibbonApp *self);
 struct _GibbonClientIcons *gibbon_app_get_client_icons (const GibbonApp *self);
 const struct _GibbonMET *gibbon_app_get_met (const GibbonApp *self);
+const struct _GibbonBearoff *gibbon_app_get_bearoff (const GibbonApp *self);
 
 void gibbon_app_start_chat (GibbonApp *self, const gchar *peer);
 void gibbon_app_close_chat (GibbonApp *self, const gchar *peer);
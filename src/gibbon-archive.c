@@ -73,6 +73,7 @@
 
 #include "gibbon-archive.h"
 #include "gibbon-database.h"
+#include "gibbon-geo-ip-snapshot.h"
 #include "gibbon-util.h"
 #include "gibbon-country.h"
 #include "gibbon-match.h"
@@ -95,7 +96,7 @@ GRegex *gibbon_archive_re_ip = NULL;
 typedef struct _GibbonArchiveLookupInfo {
         gchar *hostname;
         GibbonGeoIPCallback callback;
-        GibbonDatabase *database;
+        const GibbonArchive *archive;
         gpointer data;
 } GibbonArchiveLookupInfo;
 
@@ -108,6 +109,16 @@ struct _GibbonArchivePrivate {
         GibbonDatabase *db;
 
         GHashTable *droppers;
+
+        /*
+         * Compiled copy of the ip2country table, sorted by start address.
+         * It is either the result of the last online update or the one
+         * installed with the program.
+         */
+        GibbonGeoIPSnapshot *geo_ip;
+        gchar *geo_ip_path;
+        gboolean geo_ip_installed;
+        guint verify_geo_ip_id;
 };
 
 #define GIBBON_ARCHIVE_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
@@ -126,6 +137,9 @@ static void gibbon_archive_on_resolve (GObject *resolver, GAsyncResult *result,
 static void gibbon_archive_on_resolve_ip (GObject *resolver,
                                           GAsyncResult *result,
                                           gpointer data);
+static void gibbon_archive_load_ip_ranges (GibbonArchive *self);
+static void gibbon_archive_map_installed_geo_ip (GibbonArchive *self);
+static gboolean gibbon_archive_verify_geo_ip (GibbonArchive *self);
 
 static void 
 gibbon_archive_init (GibbonArchive *self)
@@ -138,6 +152,10 @@ gibbon_archive_init (GibbonArchive *self)
         self->priv->session_directory = NULL;
         self->priv->db = NULL;
         self->priv->droppers = NULL;
+        self->priv->geo_ip = NULL;
+        self->priv->geo_ip_path = NULL;
+        self->priv->geo_ip_installed = FALSE;
+        self->priv->verify_geo_ip_id = 0;
 }
 
 static void
@@ -152,8 +170,18 @@ gibbon_archive_finalize (GObject *object)
         if (self->priv->droppers)
                 g_hash_table_destroy (self->priv->droppers);
 
-        if (self->priv->db)
+        if (self->priv->db) {
+                g_signal_handlers_disconnect_by_func (
+                                self->priv->db,
+                                (gpointer) gibbon_archive_load_ip_ranges,
+                                self);
                 g_object_unref (self->priv->db);
+        }
+
+        if (self->priv->verify_geo_ip_id)
+                g_source_remove (self->priv->verify_geo_ip_id);
+        gibbon_geo_ip_snapshot_free (self->priv->geo_ip);
+        g_free (self->priv->geo_ip_path);
 
         G_OBJECT_CLASS (gibbon_archive_parent_class)->finalize(object);
 }
@@ -235,6 +263,30 @@ gibbon_archive_new (GError **error)
         self->priv->droppers = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                       g_free, NULL);
 
+        /*
+         * Map the GeoIP snapshot of the last online update if there is a
+         * valid one.  Otherwise, it is rebuilt from the database, or the
+         * snapshot installed with the program is used.  The checksum
+         * is verified, once the application is idle, because that reads
+         * the whole file.
+         */
+        self->priv->geo_ip_path = g_build_filename (documents_servers_directory,
+                                                    PACKAGE, "ip2country.bin",
+                                                    NULL);
+        self->priv->geo_ip = gibbon_geo_ip_snapshot_load (
+                        self->priv->geo_ip_path, NULL);
+        if (!self->priv->geo_ip)
+                gibbon_archive_load_ip_ranges (self);
+        else
+                self->priv->verify_geo_ip_id =
+                        g_idle_add_full (G_PRIORITY_LOW,
+                                         (GSourceFunc)
+                                         gibbon_archive_verify_geo_ip,
+                                         self, NULL);
+        g_signal_connect_swapped (self->priv->db, "geo-ip-updated",
+                                  G_CALLBACK (gibbon_archive_load_ip_ranges),
+                                  self);
+
         return self;
 }
 
@@ -297,7 +349,7 @@ void
 gibbon_archive_update_user (GibbonArchive *self,
                             const gchar *hostname, guint port,
                             const gchar *user, gdouble rating,
-                            gint experience)
+                            guint64 experience)
 {
         g_return_if_fail (GIBBON_IS_ARCHIVE (self));
         g_return_if_fail (hostname != NULL);
@@ -308,11 +360,26 @@ gibbon_archive_update_user (GibbonArchive *self,
                                           rating, experience, NULL);
 }
 
+gboolean
+gibbon_archive_update_users (GibbonArchive *self,
+                             const gchar *hostname, guint port,
+                             GibbonDatabaseUser *users, gsize num_users,
+                             GError **error)
+{
+        gibbon_return_val_if_fail (GIBBON_IS_ARCHIVE (self), FALSE, error);
+        gibbon_return_val_if_fail (hostname != NULL, FALSE, error);
+        gibbon_return_val_if_fail (port != 0, FALSE, error);
+        gibbon_return_val_if_fail (port <= 65536, FALSE, error);
+
+        return gibbon_database_update_users (self->priv->db, hostname, port,
+                                             users, num_users, error);
+}
+
 gboolean
 gibbon_archive_update_rank (GibbonArchive *self,
                             const gchar *hostname, guint port,
                             const gchar *user, gdouble rating,
-                            gint experience, GDateTime *dt,
+                            guint64 experience, GDateTime *dt,
                             GError **error)
 {
         gchar *path;
@@ -640,7 +707,7 @@ gibbon_archive_get_country (const GibbonArchive *self,
                 info = g_malloc (sizeof *info);
                 info->hostname = hostname;
                 info->callback = callback;
-                info->database = self->priv->db;
+                info->archive = self;
                 info->data = data;
 
                 resolver = g_resolver_get_default ();
@@ -677,7 +744,7 @@ gibbon_archive_on_resolve (GObject *oresolver, GAsyncResult *result,
         gsize i;
         const guint8 *octets;
         guint32 key;
-        gchar *alpha2;
+        gchar alpha2[3];
         GibbonCountry *country;
         GMatchInfo *match_info;
         gchar *xoctets[4];
@@ -755,7 +822,10 @@ gibbon_archive_on_resolve (GObject *oresolver, GAsyncResult *result,
         }
         g_resolver_free_addresses (ips);
 
-        alpha2 = gibbon_database_get_country (info.database, key);
+        if (!info.archive->priv->geo_ip
+            || !gibbon_geo_ip_snapshot_lookup (info.archive->priv->geo_ip,
+                                               key, alpha2))
+                alpha2[0] = 0;
 
         country = gibbon_country_new (alpha2);
         g_hash_table_insert (gibbon_archive_countries,
@@ -778,7 +848,7 @@ gibbon_archive_on_resolve_ip (GObject *resolver, GAsyncResult *result,
         GInetAddress *address;
         gint i;
         const guint8 *octets;
-        gchar *alpha2;
+        gchar alpha2[3];
         GibbonCountry *country;
 
         /*
@@ -825,7 +895,10 @@ gibbon_archive_on_resolve_ip (GObject *resolver, GAsyncResult *result,
                 key += octets[i];
         }
 
-        alpha2 = gibbon_database_get_country (info.database, key);
+        if (!info.archive->priv->geo_ip
+            || !gibbon_geo_ip_snapshot_lookup (info.archive->priv->geo_ip,
+                                               key, alpha2))
+                alpha2[0] = 0;
 
         country = gibbon_country_new (alpha2);
         g_hash_table_insert (gibbon_archive_countries,
@@ -835,6 +908,101 @@ gibbon_archive_on_resolve_ip (GObject *resolver, GAsyncResult *result,
         info.callback (info.data, info.hostname, country);
 }
 
+static void
+gibbon_archive_load_ip_ranges (GibbonArchive *self)
+{
+        GibbonDatabaseIPRange *ranges;
+        GibbonGeoIPSnapshot *old;
+        gsize num_ranges;
+        GError *error = NULL;
+
+        ranges = gibbon_database_get_ip_ranges (self->priv->db, &num_ranges);
+
+        /*
+         * An empty table means that there was no online update yet.  The
+         * snapshot installed with the program is used instead.
+         */
+        if (!num_ranges) {
+                g_free (ranges);
+                if (!self->priv->geo_ip)
+                        gibbon_archive_map_installed_geo_ip (self);
+                return;
+        }
+
+        /*
+         * Swap the new table in before freeing the old one so that a lookup
+         * never sees a half-built index.
+         */
+        old = self->priv->geo_ip;
+        self->priv->geo_ip = gibbon_geo_ip_snapshot_new (ranges, num_ranges);
+        self->priv->geo_ip_installed = FALSE;
+        gibbon_geo_ip_snapshot_free (old);
+
+        if (!gibbon_geo_ip_snapshot_save (self->priv->geo_ip,
+                                          self->priv->geo_ip_path, &error)) {
+                g_warning ("%s", error->message);
+                g_error_free (error);
+        }
+}
+
+static void
+gibbon_archive_map_installed_geo_ip (GibbonArchive *self)
+{
+        gchar *path;
+        GError *error = NULL;
+#ifdef G_OS_WIN32
+        gchar *win32_dir;
+
+        win32_dir =
+            g_win32_get_package_installation_directory_of_module (NULL);
+        path = g_build_filename (win32_dir, "share", PACKAGE,
+                                 "ip2country.bin", NULL);
+        g_free (win32_dir);
+#else
+        path = g_build_filename (GIBBON_DATADIR, PACKAGE,
+                                 "ip2country.bin", NULL);
+#endif
+
+        self->priv->geo_ip = gibbon_geo_ip_snapshot_load (path, &error);
+        if (!self->priv->geo_ip) {
+                if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+                        g_warning ("%s", error->message);
+                g_error_free (error);
+                g_free (path);
+                return;
+        }
+        g_free (path);
+
+        self->priv->geo_ip_installed = TRUE;
+        if (!self->priv->verify_geo_ip_id)
+                self->priv->verify_geo_ip_id =
+                        g_idle_add_full (G_PRIORITY_LOW,
+                                         (GSourceFunc)
+                                         gibbon_archive_verify_geo_ip,
+                                         self, NULL);
+}
+
+static gboolean
+gibbon_archive_verify_geo_ip (GibbonArchive *self)
+{
+        GError *error = NULL;
+
+        self->priv->verify_geo_ip_id = 0;
+
+        if (!gibbon_geo_ip_snapshot_verify (self->priv->geo_ip, &error)) {
+                g_warning ("%s", error->message);
+                g_error_free (error);
+                gibbon_geo_ip_snapshot_free (self->priv->geo_ip);
+                self->priv->geo_ip = NULL;
+
+                /* A broken installation cannot be repaired here.  */
+                if (!self->priv->geo_ip_installed)
+                        gibbon_archive_load_ip_ranges (self);
+        }
+
+        return FALSE;
+}
+
 GSList *
 gibbon_archive_get_accounts (const GibbonArchive *self,
                              const gchar *hostname, guint port)
@@ -24,6 +24,7 @@
 #include <glib-object.h>
 
 #include "gibbon-country.h"
+#include "gibbon-database.h"
 #include "gibbon-match.h"
 
 #define GIBBON_TYPE_ARCHIVE \
@@ -87,11 +88,16 @@ gboolean gibbon_archive_login (GibbonArchive *self,
 void gibbon_archive_update_user (GibbonArchive *self,
                                  const gchar *hostname, guint port,
                                  const gchar *user, gdouble rating,
-                                 gint experience);
+                                 guint64 experience);
+gboolean gibbon_archive_update_users (GibbonArchive *self,
+                                      const gchar *hostname, guint port,
+                                      GibbonDatabaseUser *users,
+                                      gsize num_users,
+                                      GError **error);
 gboolean gibbon_archive_update_rank (GibbonArchive *self,
                                      const gchar *hostname, guint port,
                                      const gchar *user, gdouble rating,
-                                     gint experience, GDateTime *dt,
+                                     guint64 experience, GDateTime *dt,
                                      GError **error);
 gboolean gibbon_archive_get_rank (GibbonArchive *self,
                                   const gchar *hostname, guint port,
@@ -0,0 +1,682 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gibbon-bearoff
+ * @short_description: One-sided bearoff database.
+ *
+ * Since: 0.2.0
+ *
+ * For every distribution of up to 15 checkers on the six home board points
+ * the database holds the probabilities to bear off all checkers in
+ * exactly 0, 1, 2, ... rolls, when the checkers are always played so that
+ * the expected number of rolls is minimal.  That allows exact race figures
+ * in bearoff positions without an evaluation engine.
+ *
+ * Positions are indexed with the combinatorial number system.  The
+ * checker counts on the points 1 to 6 are written as a bit string with
+ * as many zeros as there are checkers on the point, followed by a one.
+ * The rank of the resulting combination of six out of 21 bits is the
+ * index of the position.  The empty board has index 0.
+ *
+ * The compiled file starts with a #GibbonBearoffHeader, followed by
+ * %GIBBON_BEAROFF_MAX_ROLLS unsigned 16 bit numbers for each position,
+ * the probabilities scaled to 65535.  The file is installed into the
+ * architecture independent data directory, and all numbers are therefore
+ * stored in little-endian byte order.  The file is normally created at
+ * build time by gibbon-make-bearoff and memory-mapped at runtime.  On
+ * big-endian machines the data is converted into memory instead.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "gibbon-bearoff.h"
+#include "gibbon-util.h"
+
+#define GIBBON_BEAROFF_MAGIC "GibbonBO"
+#define GIBBON_BEAROFF_VERSION 3
+
+/* Six out of 21, see above.  */
+#define GIBBON_BEAROFF_NUM_POSITIONS 54264
+
+typedef struct _GibbonBearoffHeader GibbonBearoffHeader;
+struct _GibbonBearoffHeader {
+        GibbonFileHeader file;
+        guint32 points;
+        guint32 checkers;
+        guint32 num_positions;
+        guint32 max_rolls;
+};
+
+struct _GibbonBearoff {
+        GMappedFile *mapped;
+
+        /* Points into the mapped file or is owned if not mapped.  */
+        const guint16 *data;
+        gsize num_positions;
+};
+
+/* Binomial coefficients n over k for n < 21 and k < 7.  */
+static const guint32 gibbon_bearoff_binomials[21][7] = {
+        { 1, 0, 0, 0, 0, 0, 0 },
+        { 1, 1, 0, 0, 0, 0, 0 },
+        { 1, 2, 1, 0, 0, 0, 0 },
+        { 1, 3, 3, 1, 0, 0, 0 },
+        { 1, 4, 6, 4, 1, 0, 0 },
+        { 1, 5, 10, 10, 5, 1, 0 },
+        { 1, 6, 15, 20, 15, 6, 1 },
+        { 1, 7, 21, 35, 35, 21, 7 },
+        { 1, 8, 28, 56, 70, 56, 28 },
+        { 1, 9, 36, 84, 126, 126, 84 },
+        { 1, 10, 45, 120, 210, 252, 210 },
+        { 1, 11, 55, 165, 330, 462, 462 },
+        { 1, 12, 66, 220, 495, 792, 924 },
+        { 1, 13, 78, 286, 715, 1287, 1716 },
+        { 1, 14, 91, 364, 1001, 2002, 3003 },
+        { 1, 15, 105, 455, 1365, 3003, 5005 },
+        { 1, 16, 120, 560, 1820, 4368, 8008 },
+        { 1, 17, 136, 680, 2380, 6188, 12376 },
+        { 1, 18, 153, 816, 3060, 8568, 18564 },
+        { 1, 19, 171, 969, 3876, 11628, 27132 },
+        { 1, 20, 190, 1140, 4845, 15504, 38760 }
+};
+
+static gsize gibbon_bearoff_rank (const guint8 *board);
+static gboolean gibbon_bearoff_extract (const GibbonPosition *pos,
+                                        GibbonPositionSide side,
+                                        guint8 *board);
+static void gibbon_bearoff_generate (guint16 *data);
+static void gibbon_bearoff_play (const gdouble *expected, guint8 *board,
+                                 const guint *dice, guint num_dice,
+                                 guint max_from,
+                                 gsize *best, gdouble *best_expected);
+
+/**
+ * gibbon_bearoff_new:
+ *
+ * Creates a new #GibbonBearoff by calculating all positions in memory.
+ * This takes a noticeable amount of time.  Use gibbon_bearoff_load() for
+ * a precompiled database instead.
+ *
+ * Returns: The new #GibbonBearoff, free with gibbon_bearoff_free().
+ */
+GibbonBearoff *
+gibbon_bearoff_new (void)
+{
+        GibbonBearoff *self = g_malloc (sizeof *self);
+        guint16 *data;
+
+        data = g_malloc (GIBBON_BEAROFF_NUM_POSITIONS
+                         * GIBBON_BEAROFF_MAX_ROLLS * sizeof *data);
+        gibbon_bearoff_generate (data);
+
+        self->mapped = NULL;
+        self->data = data;
+        self->num_positions = GIBBON_BEAROFF_NUM_POSITIONS;
+
+        return self;
+}
+
+/**
+ * gibbon_bearoff_load:
+ * @path: The database file.
+ * @error: Location to store errors or %NULL.
+ *
+ * Memory-maps a database file written by gibbon_bearoff_save().  Only the
+ * header and the size of the file are checked, use gibbon_bearoff_verify()
+ * for a complete check.  On big-endian machines the data has to be
+ * converted anyway, and the checksum is then verified immediately.
+ *
+ * Returns: The new #GibbonBearoff or %NULL in case of failure.
+ */
+GibbonBearoff *
+gibbon_bearoff_load (const gchar *path, GError **error)
+{
+        GibbonBearoff *self;
+        GMappedFile *mapped;
+        const GibbonBearoffHeader *header;
+        const guint16 *data;
+        gsize length;
+        gsize num_positions;
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+        guint16 *converted;
+        gsize i;
+#endif
+
+        gibbon_return_val_if_fail (path != NULL, NULL, error);
+
+        mapped = gibbon_map_checked_file (path, GIBBON_BEAROFF_MAGIC,
+                                          GIBBON_BEAROFF_VERSION,
+                                          sizeof *header,
+                                          G_BYTE_ORDER == G_BIG_ENDIAN,
+                                          error);
+        if (!mapped)
+                return NULL;
+
+        length = g_mapped_file_get_length (mapped);
+        header = (const GibbonBearoffHeader *)
+                        g_mapped_file_get_contents (mapped);
+
+        if (GUINT32_FROM_LE (header->points) != GIBBON_BEAROFF_POINTS
+            || GUINT32_FROM_LE (header->checkers) != GIBBON_BEAROFF_CHECKERS
+            || (GUINT32_FROM_LE (header->num_positions)
+                != GIBBON_BEAROFF_NUM_POSITIONS)
+            || (GUINT32_FROM_LE (header->max_rolls)
+                != GIBBON_BEAROFF_MAX_ROLLS)) {
+                g_set_error (error, GIBBON_ERROR, -1,
+                             _("`%s' is not a bearoff database!"), path);
+                g_mapped_file_unref (mapped);
+                return NULL;
+        }
+
+        num_positions = GUINT32_FROM_LE (header->num_positions);
+        data = (const guint16 *) (header + 1);
+        length -= sizeof *header;
+        if (length != num_positions * GIBBON_BEAROFF_MAX_ROLLS
+                      * sizeof *data) {
+                g_set_error (error, GIBBON_ERROR, -1,
+                             _("Bearoff database `%s' is corrupted!"),
+                             path);
+                g_mapped_file_unref (mapped);
+                return NULL;
+        }
+
+        self = g_malloc (sizeof *self);
+        self->num_positions = num_positions;
+
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+        converted = g_malloc (length);
+        for (i = 0; i < num_positions * GIBBON_BEAROFF_MAX_ROLLS; ++i)
+                converted[i] = GUINT16_FROM_LE (data[i]);
+        g_mapped_file_unref (mapped);
+        self->mapped = NULL;
+        self->data = converted;
+#else
+        self->mapped = mapped;
+        self->data = data;
+#endif
+
+        return self;
+}
+
+/**
+ * gibbon_bearoff_verify:
+ * @self: The #GibbonBearoff.
+ * @error: Location to store errors or %NULL.
+ *
+ * Compares the checksum stored in the database file with the mapped
+ * data.  This reads the complete file.  Databases calculated in memory
+ * or converted while loading are always valid.
+ *
+ * Returns: %TRUE if the data is intact, %FALSE otherwise.
+ */
+gboolean
+gibbon_bearoff_verify (const GibbonBearoff *self, GError **error)
+{
+        gibbon_return_val_if_fail (self != NULL, FALSE, error);
+
+        if (!self->mapped)
+                return TRUE;
+
+        if (!gibbon_verify_checked_file (self->mapped)) {
+                g_set_error_literal (error, GIBBON_ERROR, -1,
+                                     _("Bearoff database is corrupted!"));
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+void
+gibbon_bearoff_free (GibbonBearoff *self)
+{
+        if (!self)
+                return;
+
+        if (self->mapped)
+                g_mapped_file_unref (self->mapped);
+        else
+                g_free ((gpointer) self->data);
+
+        g_free (self);
+}
+
+/**
+ * gibbon_bearoff_save:
+ * @self: The #GibbonBearoff.
+ * @path: The output file.
+ * @error: Location to store errors or %NULL.
+ *
+ * Writes the database into @path.  The file is replaced atomically.
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_bearoff_save (const GibbonBearoff *self, const gchar *path,
+                     GError **error)
+{
+        GibbonBearoffHeader *header;
+        gsize data_size;
+        gchar *buffer;
+        guint16 *data;
+        gsize i;
+        gboolean retval;
+
+        gibbon_return_val_if_fail (self != NULL, FALSE, error);
+        gibbon_return_val_if_fail (path != NULL, FALSE, error);
+
+        data_size = self->num_positions * GIBBON_BEAROFF_MAX_ROLLS
+                    * sizeof *self->data;
+        buffer = g_malloc0 (sizeof *header + data_size);
+        header = (GibbonBearoffHeader *) buffer;
+
+        header->points = GUINT32_TO_LE (GIBBON_BEAROFF_POINTS);
+        header->checkers = GUINT32_TO_LE (GIBBON_BEAROFF_CHECKERS);
+        header->num_positions = GUINT32_TO_LE (self->num_positions);
+        header->max_rolls = GUINT32_TO_LE (GIBBON_BEAROFF_MAX_ROLLS);
+
+        data = (guint16 *) (header + 1);
+        for (i = 0; i < self->num_positions * GIBBON_BEAROFF_MAX_ROLLS; ++i)
+                data[i] = GUINT16_TO_LE (self->data[i]);
+
+        retval = gibbon_save_checked_file (path, GIBBON_BEAROFF_MAGIC,
+                                           GIBBON_BEAROFF_VERSION,
+                                           buffer, sizeof *header + data_size,
+                                           error);
+        g_free (buffer);
+
+        return retval;
+}
+
+gsize
+gibbon_bearoff_get_num_positions (const GibbonBearoff *self)
+{
+        g_return_val_if_fail (self != NULL, 0);
+
+        return self->num_positions;
+}
+
+/**
+ * gibbon_bearoff_get_distribution:
+ * @self: The #GibbonBearoff.
+ * @pos: The #GibbonPosition.
+ * @side: The side to look up.
+ * @dist: Buffer for the result.
+ *
+ * Looks up the probabilities that @side bears off all checkers in exactly
+ * @dist[n] rolls.
+ *
+ * Returns: %TRUE for success, %FALSE if @side is not in a bearoff position.
+ */
+gboolean
+gibbon_bearoff_get_distribution (const GibbonBearoff *self,
+                                 const GibbonPosition *pos,
+                                 GibbonPositionSide side,
+                                 gdouble dist[GIBBON_BEAROFF_MAX_ROLLS])
+{
+        guint8 board[GIBBON_BEAROFF_POINTS];
+        const guint16 *raw;
+        guint total = 0;
+        gsize i;
+
+        g_return_val_if_fail (self != NULL, FALSE);
+        g_return_val_if_fail (pos != NULL, FALSE);
+        g_return_val_if_fail (side != GIBBON_POSITION_SIDE_NONE, FALSE);
+
+        if (!gibbon_bearoff_extract (pos, side, board))
+                return FALSE;
+
+        raw = self->data + gibbon_bearoff_rank (board)
+                           * GIBBON_BEAROFF_MAX_ROLLS;
+        for (i = 0; i < GIBBON_BEAROFF_MAX_ROLLS; ++i)
+                total += raw[i];
+
+        /* Compensate for rounding errors.  */
+        for (i = 0; i < GIBBON_BEAROFF_MAX_ROLLS; ++i)
+                dist[i] = (gdouble) raw[i] / total;
+
+        return TRUE;
+}
+
+/**
+ * gibbon_bearoff_get_expected_rolls:
+ * @self: The #GibbonBearoff.
+ * @pos: The #GibbonPosition.
+ * @side: The side to look up.
+ *
+ * Returns: The expected number of rolls that @side needs to bear off all
+ *          checkers or a negative number if @side is not in a bearoff
+ *          position.
+ */
+gdouble
+gibbon_bearoff_get_expected_rolls (const GibbonBearoff *self,
+                                   const GibbonPosition *pos,
+                                   GibbonPositionSide side)
+{
+        gdouble dist[GIBBON_BEAROFF_MAX_ROLLS];
+        gdouble expected = 0.0;
+        gsize i;
+
+        if (!gibbon_bearoff_get_distribution (self, pos, side, dist))
+                return -1.0;
+
+        for (i = 1; i < GIBBON_BEAROFF_MAX_ROLLS; ++i)
+                expected += i * dist[i];
+
+        return expected;
+}
+
+/**
+ * gibbon_bearoff_get_win_probability:
+ * @self: The #GibbonBearoff.
+ * @pos: The #GibbonPosition.
+ * @probability: Location to store the result.
+ *
+ * Calculates the probability that the side on turn wins the race, when it
+ * is about to roll.  The dice in @pos are ignored.  Both sides must be in
+ * a bearoff position.
+ *
+ * Returns: %TRUE for success, %FALSE if the race cannot be looked up.
+ */
+gboolean
+gibbon_bearoff_get_win_probability (const GibbonBearoff *self,
+                                    const GibbonPosition *pos,
+                                    gdouble *probability)
+{
+        gdouble mine[GIBBON_BEAROFF_MAX_ROLLS];
+        gdouble theirs[GIBBON_BEAROFF_MAX_ROLLS];
+        gdouble remaining = 1.0;
+        gdouble p = 0.0;
+        gsize i;
+
+        g_return_val_if_fail (self != NULL, FALSE);
+        g_return_val_if_fail (pos != NULL, FALSE);
+        g_return_val_if_fail (probability != NULL, FALSE);
+
+        if (pos->turn == GIBBON_POSITION_SIDE_NONE)
+                return FALSE;
+
+        if (!gibbon_bearoff_get_distribution (self, pos, pos->turn, mine))
+                return FALSE;
+        if (!gibbon_bearoff_get_distribution (self, pos, -pos->turn, theirs))
+                return FALSE;
+
+        /*
+         * The side on turn wins in n rolls, if the opponent needs at least
+         * n rolls as well.  The variable remaining is the probability for
+         * the latter.
+         */
+        for (i = 0; i < GIBBON_BEAROFF_MAX_ROLLS; ++i) {
+                p += mine[i] * remaining;
+                remaining -= theirs[i];
+        }
+
+        *probability = CLAMP (p, 0.0, 1.0);
+
+        return TRUE;
+}
+
+static gsize
+gibbon_bearoff_rank (const guint8 *board)
+{
+        gsize rank = 0;
+        guint bit = 0;
+        guint i;
+
+        for (i = 0; i < GIBBON_BEAROFF_POINTS; ++i) {
+                bit += board[i];
+                rank += gibbon_bearoff_binomials[bit][i + 1];
+                ++bit;
+        }
+
+        return rank;
+}
+
+static gboolean
+gibbon_bearoff_extract (const GibbonPosition *pos, GibbonPositionSide side,
+                        guint8 *board)
+{
+        guint total = 0;
+        gint i;
+
+        if (side == GIBBON_POSITION_SIDE_WHITE) {
+                if (pos->bar[0])
+                        return FALSE;
+                for (i = GIBBON_BEAROFF_POINTS; i < 24; ++i)
+                        if (pos->points[i] > 0)
+                                return FALSE;
+                for (i = 0; i < GIBBON_BEAROFF_POINTS; ++i) {
+                        board[i] = pos->points[i] > 0 ? pos->points[i] : 0;
+                        total += board[i];
+                }
+        } else {
+                if (pos->bar[1])
+                        return FALSE;
+                for (i = 0; i < 24 - GIBBON_BEAROFF_POINTS; ++i)
+                        if (pos->points[i] < 0)
+                                return FALSE;
+                for (i = 0; i < GIBBON_BEAROFF_POINTS; ++i) {
+                        board[i] = pos->points[23 - i] < 0
+                                        ? -pos->points[23 - i] : 0;
+                        total += board[i];
+                }
+        }
+
+        return total <= GIBBON_BEAROFF_CHECKERS;
+}
+
+static void
+gibbon_bearoff_generate (guint16 *data)
+{
+        guint8 *boards;
+        guint8 board[GIBBON_BEAROFF_POINTS];
+        guint *pips;
+        gdouble *expected;
+        gdouble *dists;
+        gdouble *dist;
+        const gdouble *successor;
+        guint dice[4];
+        guint die1, die2, num_dice;
+        guint pip_count, max_pips;
+        gsize rank, best, n, i;
+        guint sum = 0;
+        gdouble weight, best_expected;
+
+        boards = g_malloc0 (GIBBON_BEAROFF_NUM_POSITIONS
+                            * GIBBON_BEAROFF_POINTS);
+        pips = g_malloc (GIBBON_BEAROFF_NUM_POSITIONS * sizeof *pips);
+        expected = g_malloc (GIBBON_BEAROFF_NUM_POSITIONS * sizeof *expected);
+        dists = g_malloc0 (GIBBON_BEAROFF_NUM_POSITIONS
+                           * GIBBON_BEAROFF_MAX_ROLLS * sizeof *dists);
+
+        /* Enumerate all positions like an odometer.  */
+        memset (board, 0, sizeof board);
+        n = 0;
+        do {
+                rank = gibbon_bearoff_rank (board);
+                memcpy (boards + rank * GIBBON_BEAROFF_POINTS, board,
+                        sizeof board);
+                pips[rank] = 0;
+                for (i = 0; i < GIBBON_BEAROFF_POINTS; ++i)
+                        pips[rank] += (i + 1) * board[i];
+                ++n;
+
+                for (i = 0; i < GIBBON_BEAROFF_POINTS; ++i) {
+                        if (sum < GIBBON_BEAROFF_CHECKERS) {
+                                ++board[i];
+                                ++sum;
+                                break;
+                        }
+                        sum -= board[i];
+                        board[i] = 0;
+                }
+        } while (i < GIBBON_BEAROFF_POINTS);
+        g_assert (n == GIBBON_BEAROFF_NUM_POSITIONS);
+
+        /*
+         * Every move reduces the pip count.  Processing the positions in
+         * ascending order of their pip count therefore guarantees that all
+         * possible successors of a position are already known.
+         */
+        max_pips = GIBBON_BEAROFF_POINTS * GIBBON_BEAROFF_CHECKERS;
+        for (pip_count = 0; pip_count <= max_pips; ++pip_count) {
+                for (rank = 0; rank < GIBBON_BEAROFF_NUM_POSITIONS; ++rank) {
+                        if (pips[rank] != pip_count)
+                                continue;
+
+                        dist = dists + rank * GIBBON_BEAROFF_MAX_ROLLS;
+                        if (!pip_count) {
+                                dist[0] = 1.0;
+                                expected[rank] = 0.0;
+                                continue;
+                        }
+
+                        expected[rank] = 1.0;
+                        for (die1 = 1; die1 <= 6; ++die1) {
+                                for (die2 = die1; die2 <= 6; ++die2) {
+                                        memcpy (board,
+                                                boards + rank
+                                                * GIBBON_BEAROFF_POINTS,
+                                                sizeof board);
+                                        best = 0;
+                                        best_expected = G_MAXDOUBLE;
+                                        if (die1 == die2) {
+                                                weight = 1.0 / 36.0;
+                                                dice[0] = dice[1] = dice[2]
+                                                        = dice[3] = die1;
+                                                num_dice = 4;
+                                                gibbon_bearoff_play (
+                                                        expected, board,
+                                                        dice, num_dice,
+                                                        GIBBON_BEAROFF_POINTS,
+                                                        &best,
+                                                        &best_expected);
+                                        } else {
+                                                weight = 2.0 / 36.0;
+                                                num_dice = 2;
+                                                dice[0] = die1;
+                                                dice[1] = die2;
+                                                gibbon_bearoff_play (
+                                                        expected, board,
+                                                        dice, num_dice,
+                                                        GIBBON_BEAROFF_POINTS,
+                                                        &best,
+                                                        &best_expected);
+                                                dice[0] = die2;
+                                                dice[1] = die1;
+                                                gibbon_bearoff_play (
+                                                        expected, board,
+                                                        dice, num_dice,
+                                                        GIBBON_BEAROFF_POINTS,
+                                                        &best,
+                                                        &best_expected);
+                                        }
+
+                                        expected[rank] += weight
+                                                          * best_expected;
+                                        successor = dists + best
+                                                * GIBBON_BEAROFF_MAX_ROLLS;
+                                        for (n = 0;
+                                             n < GIBBON_BEAROFF_MAX_ROLLS - 1;
+                                             ++n)
+                                                dist[n + 1] += weight
+                                                               * successor[n];
+                                        /*
+                                         * Practically impossible, but keep
+                                         * the distribution normalized.
+                                         */
+                                        dist[GIBBON_BEAROFF_MAX_ROLLS - 1] +=
+                                                weight * successor[
+                                                GIBBON_BEAROFF_MAX_ROLLS - 1];
+                                }
+                        }
+                }
+        }
+
+        for (i = 0; i < GIBBON_BEAROFF_NUM_POSITIONS * GIBBON_BEAROFF_MAX_ROLLS;
+             ++i)
+                data[i] = (guint16) (dists[i] * 65535.0 + 0.5);
+
+        g_free (dists);
+        g_free (expected);
+        g_free (pips);
+        g_free (boards);
+}
+
+/*
+ * Play the dice in the given order on a board and record the resulting
+ * position with the lowest expected number of rolls.  Equal dice are
+ * played from non-increasing points so that the permutations of the same
+ * checker play are not generated over and over.
+ */
+static void
+gibbon_bearoff_play (const gdouble *expected, guint8 *board,
+                     const guint *dice, guint num_dice, guint max_from,
+                     gsize *best, gdouble *best_expected)
+{
+        guint from, highest, die, next_max;
+        gboolean moved = FALSE;
+        gsize rank;
+
+        if (num_dice) {
+                die = dice[0];
+                for (highest = GIBBON_BEAROFF_POINTS; highest > 0; --highest)
+                        if (board[highest - 1])
+                                break;
+
+                for (from = MIN (max_from, highest); from > 0; --from) {
+                        if (!board[from - 1])
+                                continue;
+                        /* Bearing off with a higher die?  */
+                        if (from < die && from != highest)
+                                continue;
+
+                        --board[from - 1];
+                        if (from > die)
+                                ++board[from - die - 1];
+
+                        next_max = (num_dice > 1 && dice[1] == die)
+                                   ? from : GIBBON_BEAROFF_POINTS;
+                        gibbon_bearoff_play (expected, board,
+                                             dice + 1, num_dice - 1,
+                                             next_max, best, best_expected);
+
+                        if (from > die)
+                                --board[from - die - 1];
+                        ++board[from - 1];
+                        moved = TRUE;
+                }
+
+                /*
+                 * Dice can only be unplayable when all checkers are off
+                 * or when the order of equal dice is restricted.
+                 */
+                if (moved || highest)
+                        return;
+        }
+
+        rank = gibbon_bearoff_rank (board);
+        if (expected[rank] < *best_expected) {
+                *best_expected = expected[rank];
+                *best = rank;
+        }
+}
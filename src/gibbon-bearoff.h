@@ -0,0 +1,75 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GIBBON_BEAROFF_H
+# define _GIBBON_BEAROFF_H
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "gibbon-position.h"
+
+G_BEGIN_DECLS
+
+#define GIBBON_BEAROFF_POINTS 6
+#define GIBBON_BEAROFF_CHECKERS 15
+#define GIBBON_BEAROFF_MAX_ROLLS 32
+
+/**
+ * GIBBON_BEAROFF_FILENAME:
+ *
+ * Name of the compiled database file in the data directory.
+ */
+#define GIBBON_BEAROFF_FILENAME "gibbon-os.bd"
+
+/**
+ * GibbonBearoff:
+ *
+ * A one-sided bearoff database for up to %GIBBON_BEAROFF_CHECKERS checkers
+ * on the %GIBBON_BEAROFF_POINTS home board points.  For every position it
+ * holds the probabilities to bear off all checkers in exactly n rolls.
+ * All members are private.
+ */
+typedef struct _GibbonBearoff GibbonBearoff;
+
+GibbonBearoff *gibbon_bearoff_new (void);
+GibbonBearoff *gibbon_bearoff_load (const gchar *path, GError **error);
+gboolean gibbon_bearoff_verify (const GibbonBearoff *self, GError **error);
+void gibbon_bearoff_free (GibbonBearoff *self);
+gboolean gibbon_bearoff_save (const GibbonBearoff *self, const gchar *path,
+                              GError **error);
+gsize gibbon_bearoff_get_num_positions (const GibbonBearoff *self);
+gboolean gibbon_bearoff_get_distribution (const GibbonBearoff *self,
+                                          const GibbonPosition *pos,
+                                          GibbonPositionSide side,
+                                          gdouble
+                                          dist[GIBBON_BEAROFF_MAX_ROLLS]);
+gdouble gibbon_bearoff_get_expected_rolls (const GibbonBearoff *self,
+                                           const GibbonPosition *pos,
+                                           GibbonPositionSide side);
+gboolean gibbon_bearoff_get_win_probability (const GibbonBearoff *self,
+                                             const GibbonPosition *pos,
+                                             gdouble *probability);
+
+G_END_DECLS
+
+#endif
@@ -18,6 +18,7 @@
  */
 
 #include <stdlib.h>
+#include <math.h>
 
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
@@ -27,6 +28,8 @@
 #include "gibbon-cairoboard.h"
 #include "svg-util.h"
 #include "gibbon-board.h"
+#include "gibbon-bearoff.h"
+#include "gibbon-sprite-cache.h"
 
 enum {
         GIBBON_CAIROBOARD_DICE_PICKED_UP,
@@ -89,6 +92,22 @@ struct _GibbonCairoboardPrivate {
 
         gdouble translate_x, translate_y, scale;
 
+        /*
+         * The board is composed of layers that are only re-rendered when
+         * necessary.  The background holds the board graphics including
+         * all texts, the stage additionally all checkers, dice, the cube
+         * and so on that are not currently animated.  Both have the size
+         * of the allocation.  During an animation, only the floating
+         * checker has to be painted on top of the stage.
+         *
+         * The components themselves are painted from pre-rasterized
+         * sprites.
+         */
+        cairo_surface_t *background;
+        cairo_surface_t *stage;
+        gint layer_width, layer_height;
+        GibbonSpriteCache *sprites;
+
         GHashTable *ids;
 
         struct svg_component *board;
@@ -113,6 +132,9 @@ struct _GibbonCairoboardPrivate {
 #define ANIMATION_TIMEOUT 25
 #define DICE_FADE_OUT_TIMEOUT 750
 
+/* Maximum size of all sprites in bytes.  */
+#define SPRITE_CACHE_SIZE (4 << 20)
+
 #define GIBBON_CAIROBOARD_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), \
                                       GIBBON_TYPE_CAIROBOARD,           \
                                       GibbonCairoboardPrivate))
@@ -132,6 +154,7 @@ static void gibbon_cairoboard_animate_move (GibbonBoard *self,
                                             GibbonPosition *target_position);
 static void gibbon_cairoboard_fade_out_dice (GibbonBoard *self);
 static void gibbon_cairoboard_cancel_animation (GibbonCairoboard *self);
+static gboolean gibbon_cairoboard_finish_animation (GibbonCairoboard *self);
 static gboolean gibbon_cairoboard_do_animation (GibbonCairoboard *self);
 static gboolean gibbon_cairoboard_hide_dice (GibbonCairoboard *self);
 
@@ -156,6 +179,25 @@ static void gibbon_draw_flag (GibbonCairoboard *board, cairo_t *cr);
 static void gibbon_draw_cup (GibbonCairoboard *board, cairo_t *cr);
 static void gibbon_draw_dice (GibbonCairoboard *board, cairo_t *cr);
 static void gibbon_draw_animation (GibbonCairoboard *board, cairo_t *cr);
+static cairo_surface_t *gibbon_cairoboard_render_background (GibbonCairoboard
+                                                             *self,
+                                                             cairo_t *cr);
+static cairo_surface_t *gibbon_cairoboard_render_stage (GibbonCairoboard *self,
+                                                        cairo_t *cr);
+static gboolean gibbon_cairoboard_get_floating_position (GibbonCairoboard
+                                                         *self,
+                                                         gdouble *x,
+                                                         gdouble *y);
+static void gibbon_cairoboard_queue_draw_box (GibbonCairoboard *self,
+                                              gdouble x, gdouble y,
+                                              gdouble width, gdouble height);
+static void gibbon_cairoboard_queue_floating (GibbonCairoboard *self);
+static void gibbon_cairoboard_queue_field (GibbonCairoboard *self, gint field,
+                                           GibbonPositionSide side);
+static void gibbon_cairoboard_queue_dice (GibbonCairoboard *self);
+static void gibbon_cairoboard_invalidate (GibbonCairoboard *self,
+                                          gboolean info);
+static void gibbon_cairoboard_free_layers (GibbonCairoboard *self);
 
 static void gibbon_cairoboard_draw_svg_component (GibbonCairoboard *board, 
                                                   cairo_t *cr,
@@ -213,6 +255,11 @@ gibbon_cairoboard_init (GibbonCairoboard *self)
         self->priv->translate_x = self->priv->translate_y = 0;
         self->priv->scale = 1;
 
+        self->priv->background = NULL;
+        self->priv->stage = NULL;
+        self->priv->layer_width = self->priv->layer_height = 0;
+        self->priv->sprites = gibbon_sprite_cache_new (SPRITE_CACHE_SIZE);
+
         self->priv->board = NULL;
         self->priv->point12 = NULL;
         self->priv->point24 = NULL;
@@ -267,6 +314,10 @@ gibbon_cairoboard_finalize (GObject *object)
         if (self->priv->move)
                 g_object_unref (self->priv->move);
 
+        gibbon_cairoboard_free_layers (self);
+        gibbon_sprite_cache_free (self->priv->sprites);
+        self->priv->sprites = NULL;
+
         if (self->priv->ids)
                 g_hash_table_destroy (self->priv->ids);
                 
@@ -581,12 +632,9 @@ gibbon_cairoboard_draw (GibbonCairoboard *self, cairo_t *cr)
         gdouble aspect_ratio;
         gdouble width;
         gdouble height;
-        gint i;
 
         g_return_if_fail (GIBBON_IS_CAIROBOARD (self));
 
-        gibbon_cairoboard_set_info (self);
-
         width = self->priv->board->width;
         height = self->priv->board->height;
 
@@ -618,30 +666,128 @@ gibbon_cairoboard_draw (GibbonCairoboard *self, cairo_t *cr)
         self->priv->translate_y = translate_y;
         self->priv->scale = scale;
 
+        if (allocation.width != self->priv->layer_width
+            || allocation.height != self->priv->layer_height) {
+                gibbon_cairoboard_free_layers (self);
+                self->priv->layer_width = allocation.width;
+                self->priv->layer_height = allocation.height;
+        }
+
+        if (!self->priv->background)
+                self->priv->background =
+                        gibbon_cairoboard_render_background (self, cr);
+        if (!self->priv->stage)
+                self->priv->stage = gibbon_cairoboard_render_stage (self, cr);
+
+        cairo_set_source_surface (cr, self->priv->stage, 0, 0);
+        cairo_paint (cr);
+
         cairo_translate (cr, translate_x, translate_y);
         cairo_scale (cr, scale, scale);
 
+        gibbon_draw_animation (self, cr);
+}
+
+static cairo_surface_t *
+gibbon_cairoboard_render_background (GibbonCairoboard *self, cairo_t *cr)
+{
+        cairo_surface_t *surface;
+        cairo_t *layer;
+
+        gibbon_cairoboard_set_info (self);
+
+        /*
+         * A surface similar to the target lives on the X server and can
+         * therefore be blitted to the window without a round-trip.
+         */
+        surface = cairo_surface_create_similar (cairo_get_target (cr),
+                                                CAIRO_CONTENT_COLOR_ALPHA,
+                                                self->priv->layer_width,
+                                                self->priv->layer_height);
+        layer = cairo_create (surface);
+
+        cairo_translate (layer, self->priv->translate_x,
+                         self->priv->translate_y);
+        cairo_scale (layer, self->priv->scale, self->priv->scale);
+
         svg_cairo_set_viewport_dimension (self->priv->board->scr,
-                                          allocation.width,
-                                          allocation.height);
-        svg_cairo_render (self->priv->board->scr, cr);
+                                          self->priv->layer_width,
+                                          self->priv->layer_height);
+        svg_cairo_render (self->priv->board->scr, layer);
+
+        cairo_destroy (layer);
+
+        return surface;
+}
+
+static cairo_surface_t *
+gibbon_cairoboard_render_stage (GibbonCairoboard *self, cairo_t *cr)
+{
+        cairo_surface_t *surface;
+        cairo_t *layer;
+        gint i;
+
+        surface = cairo_surface_create_similar (cairo_get_target (cr),
+                                                CAIRO_CONTENT_COLOR_ALPHA,
+                                                self->priv->layer_width,
+                                                self->priv->layer_height);
+        layer = cairo_create (surface);
 
-        gibbon_draw_dice (self, cr);
-        gibbon_draw_cube (self, cr);
-        gibbon_draw_flag (self, cr);
-        gibbon_draw_cup (self, cr);
+        cairo_set_source_surface (layer, self->priv->background, 0, 0);
+        cairo_paint (layer);
 
-        gibbon_cairoboard_draw_bar (self, cr, GIBBON_POSITION_SIDE_WHITE);
-        gibbon_cairoboard_draw_bar (self, cr, GIBBON_POSITION_SIDE_BLACK);
+        cairo_translate (layer, self->priv->translate_x,
+                         self->priv->translate_y);
+        cairo_scale (layer, self->priv->scale, self->priv->scale);
 
-        gibbon_draw_home (self, cr, GIBBON_POSITION_SIDE_WHITE);
-        gibbon_draw_home (self, cr, GIBBON_POSITION_SIDE_BLACK);
+        gibbon_draw_dice (self, layer);
+        gibbon_draw_cube (self, layer);
+        gibbon_draw_flag (self, layer);
+        gibbon_draw_cup (self, layer);
+
+        gibbon_cairoboard_draw_bar (self, layer, GIBBON_POSITION_SIDE_WHITE);
+        gibbon_cairoboard_draw_bar (self, layer, GIBBON_POSITION_SIDE_BLACK);
+
+        gibbon_draw_home (self, layer, GIBBON_POSITION_SIDE_WHITE);
+        gibbon_draw_home (self, layer, GIBBON_POSITION_SIDE_BLACK);
 
         for (i = 0; i < 24; ++i)
                 if (self->priv->pos->points[i])
-                        gibbon_cairoboard_draw_point (self, cr, i);
+                        gibbon_cairoboard_draw_point (self, layer, i);
 
-        gibbon_draw_animation (self, cr);
+        cairo_destroy (layer);
+
+        return surface;
+}
+
+/*
+ * Discard the stage, and if INFO is TRUE also the background with the
+ * texts.  They are rendered again with the next expose event.
+ */
+static void
+gibbon_cairoboard_invalidate (GibbonCairoboard *self, gboolean info)
+{
+        if (info && self->priv->background) {
+                cairo_surface_destroy (self->priv->background);
+                self->priv->background = NULL;
+        }
+
+        if (self->priv->stage) {
+                cairo_surface_destroy (self->priv->stage);
+                self->priv->stage = NULL;
+        }
+}
+
+static void
+gibbon_cairoboard_free_layers (GibbonCairoboard *self)
+{
+        gibbon_cairoboard_invalidate (self, TRUE);
+
+        /* Sprites for the old size would only waste memory.  */
+        if (self->priv->sprites)
+                gibbon_sprite_cache_clear (self->priv->sprites);
+
+        self->priv->layer_width = self->priv->layer_height = 0;
 }
 
 static void
@@ -826,12 +972,22 @@ gibbon_draw_cube (GibbonCairoboard *self, cairo_t *cr)
                 scale = 2.0 / (gdouble) strlen (cube_label);
         else
                 scale = 1.0;
+        /* The text only has to be replaced for rendering a new sprite.  */
+        if (gibbon_sprite_cache_contains (self->priv->sprites, cr,
+                                          self->priv->cube, cube_label)) {
+                gibbon_sprite_cache_draw (self->priv->sprites, cr,
+                                          self->priv->cube, cube_label, x, y);
+                g_free (cube_label);
+                return;
+        }
+
         g_return_if_fail (svg_util_steal_text_params (self->priv->cube,
                                                       "cube-value",
                                                       cube_label, scale, 0,
                                                       &saved_size));
 
-        gibbon_cairoboard_draw_svg_component (self, cr, self->priv->cube, x, y);
+        gibbon_sprite_cache_draw (self->priv->sprites, cr,
+                                  self->priv->cube, cube_label, x, y);
         g_free (cube_label);
 
         g_return_if_fail (svg_util_steal_text_params (self->priv->cube,
@@ -873,11 +1029,20 @@ gibbon_draw_flag (GibbonCairoboard *self, cairo_t *cr)
 
         flag_value = abs (self->priv->pos->resigned / self->priv->pos->cube);
         flag_label = g_strdup_printf ("%d", flag_value);
+        if (gibbon_sprite_cache_contains (self->priv->sprites, cr,
+                                          self->priv->flag, flag_label)) {
+                gibbon_sprite_cache_draw (self->priv->sprites, cr,
+                                          self->priv->flag, flag_label, x, y);
+                g_free (flag_label);
+                return;
+        }
+
         g_return_if_fail (svg_util_steal_text_params (self->priv->flag,
                                                       "flag-value",
                                                       flag_label, 1.0, 0,
                                                       &saved_size));
-        gibbon_cairoboard_draw_svg_component (self, cr, self->priv->flag, x, y);
+        gibbon_sprite_cache_draw (self->priv->sprites, cr,
+                                  self->priv->flag, flag_label, x, y);
         g_free (flag_label);
 
         g_return_if_fail (svg_util_steal_text_params (self->priv->flag,
@@ -986,21 +1151,33 @@ gibbon_cairoboard_draw_die (GibbonCairoboard *self, cairo_t *cr,
 
 static void
 gibbon_draw_animation (GibbonCairoboard *self, cairo_t *cr)
+{
+        gdouble x, y;
+
+        g_return_if_fail (GIBBON_IS_CAIROBOARD (self));
+
+        if (!gibbon_cairoboard_get_floating_position (self, &x, &y))
+                return;
+
+        gibbon_cairoboard_draw_flat_checker (self, cr, x, y,
+                                             self->priv->animation_floating);
+}
+
+static gboolean
+gibbon_cairoboard_get_floating_position (GibbonCairoboard *self,
+                                         gdouble *x, gdouble *y)
 {
         gdouble from_x, from_y;
         gdouble to_x, to_y;
-        gdouble x, y;
         gint from, to;
         GibbonPositionSide side;
         guint num_checkers;
         struct svg_component *checker;
         GibbonPosition *pos;
 
-        g_return_if_fail (GIBBON_IS_CAIROBOARD (self));
-
         side = self->priv->animation_floating;
         if (!side)
-                return;
+                return FALSE;
 
         pos = self->priv->pos;
 
@@ -1086,10 +1263,117 @@ gibbon_draw_animation (GibbonCairoboard *self, cairo_t *cr)
                                                              + 1);
         }
 
-        x = from_x + self->priv->animation_promille * ((to_x - from_x) / 1000);
-        y = from_y + self->priv->animation_promille * ((to_y - from_y) / 1000);
+        *x = from_x + self->priv->animation_promille * ((to_x - from_x) / 1000);
+        *y = from_y + self->priv->animation_promille * ((to_y - from_y) / 1000);
 
-        gibbon_cairoboard_draw_flat_checker (self, cr, x, y, side);
+        return TRUE;
+}
+
+/*
+ * Queue a redraw of a rectangle in board coordinates.  The margin covers
+ * antialiasing and the rounding of sprites to the pixel grid.
+ */
+static void
+gibbon_cairoboard_queue_draw_box (GibbonCairoboard *self,
+                                  gdouble x, gdouble y,
+                                  gdouble width, gdouble height)
+{
+        gdouble scale = self->priv->scale;
+        gint left, top, right, bottom;
+
+        left = floor (self->priv->translate_x + x * scale) - 2;
+        top = floor (self->priv->translate_y + y * scale) - 2;
+        right = ceil (self->priv->translate_x + (x + width) * scale) + 2;
+        bottom = ceil (self->priv->translate_y + (y + height) * scale) + 2;
+
+        gtk_widget_queue_draw_area (GTK_WIDGET (self), left, top,
+                                    right - left, bottom - top);
+}
+
+static void
+gibbon_cairoboard_queue_floating (GibbonCairoboard *self)
+{
+        gdouble x, y;
+        struct svg_component *checker;
+
+        if (!gibbon_cairoboard_get_floating_position (self, &x, &y))
+                return;
+
+        if (self->priv->animation_floating == GIBBON_POSITION_SIDE_WHITE)
+                checker = self->priv->checker_w_flat;
+        else
+                checker = self->priv->checker_b_flat;
+
+        gibbon_cairoboard_queue_draw_box (self,
+                                          x - 0.5 * checker->width,
+                                          y - 0.5 * checker->height,
+                                          checker->width, checker->height);
+}
+
+/*
+ * Queue a redraw of the complete column of a point, the bar or a home,
+ * where FIELD is interpreted like the starting and end points of a
+ * movement of SIDE.
+ */
+static void
+gibbon_cairoboard_queue_field (GibbonCairoboard *self, gint field,
+                               GibbonPositionSide side)
+{
+        gdouble x, width;
+        struct svg_component *board = self->priv->board;
+
+        if ((field == 0 && side == GIBBON_POSITION_SIDE_WHITE)
+            || (field == 25 && side == GIBBON_POSITION_SIDE_BLACK)) {
+                x = gibbon_cairoboard_get_home_x (self, side);
+                width = self->priv->checker_w_home->width;
+        } else if (field == 0 || field == 25) {
+                x = gibbon_cairoboard_get_bar_x (self);
+                width = self->priv->checker_w_flat->width;
+        } else {
+                x = gibbon_cairoboard_get_flat_checker_x (self, field - 1);
+                width = self->priv->point12->width;
+        }
+
+        gibbon_cairoboard_queue_draw_box (self, x - 0.5 * width, board->y,
+                                          width, board->height);
+}
+
+/* Queue a redraw of both dice areas and the cup.  */
+static void
+gibbon_cairoboard_queue_dice (GibbonCairoboard *self)
+{
+        struct svg_component *die = self->priv->white_dice[0];
+        struct svg_component *cup = self->priv->cup;
+        gdouble top, bottom;
+        gdouble left, right;
+        gdouble width, y;
+
+        /* See gibbon_cairoboard_draw_die().  */
+        top = self->priv->point24->y;
+        bottom = self->priv->point12->y + self->priv->point12->height;
+        y = 0.5 * (top + bottom) - 0.5 * die->height;
+        width = 2.5 * die->width;
+
+        left = self->priv->point12->x;
+        right = left + 6 * self->priv->point12->width;
+        gibbon_cairoboard_queue_draw_box (self,
+                                          0.5 * (left + right - width), y,
+                                          width, die->height);
+
+        right = self->priv->point24->x + self->priv->point24->width;
+        left = right - 6 * self->priv->point24->width;
+        gibbon_cairoboard_queue_draw_box (self,
+                                          0.5 * (left + right - width), y,
+                                          width, die->height);
+
+        /* See gibbon_draw_cup().  */
+        top = self->priv->checker_w_home->y;
+        bottom = self->priv->checker_b_home->y
+                 + self->priv->checker_b_home->height;
+        gibbon_cairoboard_queue_draw_box (self,
+                                          0.5 * (left + right - cup->width),
+                                          0.5 * (top + bottom - cup->height),
+                                          cup->width, cup->height);
 }
 
 static void
@@ -1109,6 +1393,7 @@ gibbon_cairoboard_set_position (GibbonBoard *_self,
                 gibbon_position_free (self->priv->pos);
         self->priv->pos = gibbon_position_copy (pos);
 
+        gibbon_cairoboard_invalidate (self, TRUE);
         gtk_widget_queue_draw (GTK_WIDGET (self));
 }
 
@@ -1181,14 +1466,7 @@ gibbon_cairoboard_draw_svg_component (GibbonCairoboard *board, cairo_t *cr,
                                       struct svg_component *svg,
                                       gdouble x, gdouble y)
 {
-        gdouble cx, cy;
-
-        cx = svg->x + svg->width / 2;
-        cy = svg->y + svg->height / 2;
-
-        cairo_translate (cr, x - cx, y - cy);
-        svg_cairo_render (svg->scr, cr);
-        cairo_translate (cr, cx - x, cy - y);
+        gibbon_sprite_cache_draw (board->priv->sprites, cr, svg, NULL, x, y);
 }
 
 static gdouble
@@ -1297,6 +1575,9 @@ gibbon_cairoboard_set_info (GibbonCairoboard *self)
         GibbonPosition *pos = self->priv->pos;
         guint64 away[2];
         guint pip_count[2];
+        const GibbonBearoff *bearoff;
+        gdouble rolls[2];
+        gdouble wins[2];
 
         text = pos->players[0] ? pos->players[0] : "";
         svg_util_steal_text_params (self->priv->board, "player1", text,
@@ -1374,16 +1655,66 @@ gibbon_cairoboard_set_info (GibbonCairoboard *self)
                                                     GIBBON_POSITION_SIDE_WHITE);
         pip_count[1] = gibbon_position_get_pip_count (pos,
                                                     GIBBON_POSITION_SIDE_BLACK);
-        text = g_strdup_printf (_("Pips: %u (%+d)"),
-                                  pip_count[0], pip_count[0] - pip_count[1]);
-        svg_util_steal_text_params (self->priv->board, "pip1", text,
-                                    1.0, 0, NULL);
-        g_free (text);
-        text = g_strdup_printf (_("Pips: %u (%+d)"),
-                                  pip_count[1], pip_count[1] - pip_count[0]);
-        svg_util_steal_text_params (self->priv->board, "pip2", text,
-                                    1.0, 0, NULL);
-        g_free (text);
+
+        /* In bearoff positions, show the exact race figures.  */
+        bearoff = gibbon_app_get_bearoff (self->priv->app);
+        rolls[0] = rolls[1] = -1.0;
+        if (running && bearoff) {
+                rolls[0] = gibbon_bearoff_get_expected_rolls (bearoff, pos,
+                                                   GIBBON_POSITION_SIDE_WHITE);
+                rolls[1] = gibbon_bearoff_get_expected_rolls (bearoff, pos,
+                                                   GIBBON_POSITION_SIDE_BLACK);
+        }
+        if (rolls[0] < 0.0 || rolls[1] < 0.0) {
+                text = g_strdup_printf (_("Pips: %u (%+d)"),
+                                        pip_count[0],
+                                        pip_count[0] - pip_count[1]);
+                svg_util_steal_text_params (self->priv->board, "pip1", text,
+                                            1.0, 0, NULL);
+                g_free (text);
+                text = g_strdup_printf (_("Pips: %u (%+d)"),
+                                        pip_count[1],
+                                        pip_count[1] - pip_count[0]);
+                svg_util_steal_text_params (self->priv->board, "pip2", text,
+                                            1.0, 0, NULL);
+                g_free (text);
+        } else if (gibbon_bearoff_get_win_probability (bearoff, pos,
+                                                       &wins[0])) {
+                if (pos->turn == GIBBON_POSITION_SIDE_BLACK)
+                        wins[0] = 1.0 - wins[0];
+                wins[1] = 1.0 - wins[0];
+                text = g_strdup_printf (_("Pips: %u (%+d), %.2f rolls"
+                                          " (%.1f %%)"),
+                                        pip_count[0],
+                                        pip_count[0] - pip_count[1],
+                                        rolls[0], 100.0 * wins[0]);
+                svg_util_steal_text_params (self->priv->board, "pip1", text,
+                                            1.0, 0, NULL);
+                g_free (text);
+                text = g_strdup_printf (_("Pips: %u (%+d), %.2f rolls"
+                                          " (%.1f %%)"),
+                                        pip_count[1],
+                                        pip_count[1] - pip_count[0],
+                                        rolls[1], 100.0 * wins[1]);
+                svg_util_steal_text_params (self->priv->board, "pip2", text,
+                                            1.0, 0, NULL);
+                g_free (text);
+        } else {
+                text = g_strdup_printf (_("Pips: %u (%+d), %.2f rolls"),
+                                        pip_count[0],
+                                        pip_count[0] - pip_count[1],
+                                        rolls[0]);
+                svg_util_steal_text_params (self->priv->board, "pip1", text,
+                                            1.0, 0, NULL);
+                g_free (text);
+                text = g_strdup_printf (_("Pips: %u (%+d), %.2f rolls"),
+                                        pip_count[1],
+                                        pip_count[1] - pip_count[0],
+                                        rolls[1]);
+                svg_util_steal_text_params (self->priv->board, "pip2", text,
+                                            1.0, 0, NULL);
+                g_free (text);
+        }
 }
 
 static void
@@ -1440,9 +1771,23 @@ gibbon_cairoboard_fade_out_dice (GibbonBoard *_self)
 static void
 gibbon_cairoboard_cancel_animation (GibbonCairoboard *self)
 {
-        if (!self->priv->target)
+        if (!gibbon_cairoboard_finish_animation (self))
                 return;
 
+        gibbon_cairoboard_invalidate (self, TRUE);
+        gtk_widget_queue_draw (GTK_WIDGET (self));
+}
+
+/*
+ * Jump to the target position of a running animation without redrawing.
+ * Returns FALSE if there was no animation.
+ */
+static gboolean
+gibbon_cairoboard_finish_animation (GibbonCairoboard *self)
+{
+        if (!self->priv->target)
+                return FALSE;
+
         gibbon_position_free (self->priv->pos);
         self->priv->pos = self->priv->target;
         self->priv->target = NULL;
@@ -1457,7 +1802,7 @@ gibbon_cairoboard_cancel_animation (GibbonCairoboard *self)
 
         self->priv->animation_floating = GIBBON_POSITION_SIDE_NONE;
 
-        gtk_widget_queue_draw (GTK_WIDGET (self));
+        return TRUE;
 }
 
 static gboolean
@@ -1478,6 +1823,9 @@ gibbon_cairoboard_do_animation (GibbonCairoboard *self)
         if (!move || move_number >= move->number || !side)
                 stop_animation (self);
 
+        /* The floating checker leaves its old place.  */
+        gibbon_cairoboard_queue_floating (self);
+
         from = move->movements[move_number].from;
         to = move->movements[move_number].to;
 
@@ -1510,6 +1858,13 @@ gibbon_cairoboard_do_animation (GibbonCairoboard *self)
                 self->priv->animation_from = from;
                 self->priv->animation_to = to;
                 self->priv->animation_promille = 0;
+
+                /*
+                 * Only the stage has to be rendered again.  The texts are
+                 * updated when the animation has finished.
+                 */
+                gibbon_cairoboard_invalidate (self, FALSE);
+                gibbon_cairoboard_queue_field (self, from, side);
         }
 
         if (self->priv->animation_step == 1) {
@@ -1557,6 +1912,8 @@ gibbon_cairoboard_do_animation (GibbonCairoboard *self)
                                          GIBBON_POSITION_SIDE_NONE;
                         }
                 }
+                gibbon_cairoboard_invalidate (self, FALSE);
+                gibbon_cairoboard_queue_field (self, to, side);
         }
 
         if (self->priv->animation_step == 3) {
@@ -1567,6 +1924,10 @@ gibbon_cairoboard_do_animation (GibbonCairoboard *self)
                                 ++pos->bar[1];
                         else
                                 ++pos->bar[0];
+                        gibbon_cairoboard_invalidate (self, FALSE);
+                        gibbon_cairoboard_queue_field (self,
+                                                       self->priv->animation_to,
+                                                       -side);
                         self->priv->animation_promille = 0;
                         self->priv->animation_floating =
                             GIBBON_POSITION_SIDE_NONE;
@@ -1586,7 +1947,7 @@ gibbon_cairoboard_do_animation (GibbonCairoboard *self)
                 }
         }
 
-        gtk_widget_queue_draw (GTK_WIDGET (self));
+        gibbon_cairoboard_queue_floating (self);
 
         return TRUE;
 }
@@ -1595,7 +1956,12 @@ static gboolean
 gibbon_cairoboard_hide_dice (GibbonCairoboard *self)
 {
         self->priv->animation_id = 0;
-        gibbon_cairoboard_cancel_animation (self);
+
+        /* Only the dice vanish and the cup may appear.  */
+        if (gibbon_cairoboard_finish_animation (self)) {
+                gibbon_cairoboard_invalidate (self, FALSE);
+                gibbon_cairoboard_queue_dice (self);
+        }
 
         return FALSE;
 }
@@ -1821,5 +2187,6 @@ gibbon_cairoboard_on_2button_press (GibbonCairoboard *self,
 static void
 gibbon_cairoboard_redraw (const GibbonBoard *self)
 {
+        gibbon_cairoboard_invalidate (GIBBON_CAIROBOARD (self), TRUE);
         gtk_widget_queue_draw (GTK_WIDGET (self));
 }
@@ -6138,22 +6138,16 @@ case 16:
 YY_RULE_SETUP
 #line 289 "gibbon-clip-lexer.l"
 {
-		gchar **tokens = g_strsplit (yytext + 6, ":", -1);
-		gboolean success = gibbon_clip_reader_set_board (reader, 
-		                                                 tokens);
-		
-		g_strfreev (tokens);
-
-		if (success)
-			return 1;
-		else
+		if (!gibbon_clip_reader_set_board (reader, yytext + 6))
 			return -1;
+
+		return 1;
 	}
 	YY_BREAK
 case 17:
 /* rule 17 can match eol */
 YY_RULE_SETUP
-#line 301 "gibbon-clip-lexer.l"
+#line 295 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 5,
 		                                    " \t",
@@ -6170,7 +6164,7 @@ YY_RULE_SETUP
 case 18:
 /* rule 18 can match eol */
 YY_RULE_SETUP
-#line 313 "gibbon-clip-lexer.l"
+#line 307 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 10,
 		                                    "- \t",
@@ -6194,7 +6188,7 @@ YY_RULE_SETUP
 case 19:
 /* rule 19 can match eol */
 YY_RULE_SETUP
-#line 332 "gibbon-clip-lexer.l"
+#line 326 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 8,
 		                                    "- \t",
@@ -6217,7 +6211,7 @@ YY_RULE_SETUP
 case 20:
 /* rule 20 can match eol */
 YY_RULE_SETUP
-#line 350 "gibbon-clip-lexer.l"
+#line 344 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 6,
 		                                    "- \t",
@@ -6238,7 +6232,7 @@ YY_RULE_SETUP
 case 21:
 /* rule 21 can match eol */
 YY_RULE_SETUP
-#line 366 "gibbon-clip-lexer.l"
+#line 360 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 4,
 		                                    "- \t",
@@ -6257,7 +6251,7 @@ YY_RULE_SETUP
 case 22:
 /* rule 22 can match eol */
 YY_RULE_SETUP
-#line 380 "gibbon-clip-lexer.l"
+#line 374 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 6,
 		                                    " \t",
@@ -6272,7 +6266,7 @@ YY_RULE_SETUP
 case 23:
 /* rule 23 can match eol */
 YY_RULE_SETUP
-#line 390 "gibbon-clip-lexer.l"
+#line 384 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 9,
 		                                    " \t",
@@ -6287,7 +6281,7 @@ YY_RULE_SETUP
 case 24:
 /* rule 24 can match eol */
 YY_RULE_SETUP
-#line 400 "gibbon-clip-lexer.l"
+#line 394 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 10,
 		                                    " \t",
@@ -6302,7 +6296,7 @@ YY_RULE_SETUP
 case 25:
 /* rule 25 can match eol */
 YY_RULE_SETUP
-#line 410 "gibbon-clip-lexer.l"
+#line 404 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 7,
 		                                    " \t",
@@ -6317,7 +6311,7 @@ YY_RULE_SETUP
 case 26:
 /* rule 26 can match eol */
 YY_RULE_SETUP
-#line 420 "gibbon-clip-lexer.l"
+#line 414 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 7,
 		                                    " \t",
@@ -6332,7 +6326,7 @@ YY_RULE_SETUP
 case 27:
 /* rule 27 can match eol */
 YY_RULE_SETUP
-#line 430 "gibbon-clip-lexer.l"
+#line 424 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 9,
 		                                    " \t",
@@ -6347,7 +6341,7 @@ YY_RULE_SETUP
 case 28:
 /* rule 28 can match eol */
 YY_RULE_SETUP
-#line 440 "gibbon-clip-lexer.l"
+#line 434 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 3,
 		                                    " \t",
@@ -6362,7 +6356,7 @@ YY_RULE_SETUP
 case 29:
 /* rule 29 can match eol */
 YY_RULE_SETUP
-#line 450 "gibbon-clip-lexer.l"
+#line 444 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 10,
 		                                    " \t",
@@ -6377,7 +6371,7 @@ YY_RULE_SETUP
 case 30:
 /* rule 30 can match eol */
 YY_RULE_SETUP
-#line 460 "gibbon-clip-lexer.l"
+#line 454 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 6,
 		                                    " \t",
@@ -6392,7 +6386,7 @@ YY_RULE_SETUP
 case 31:
 /* rule 31 can match eol */
 YY_RULE_SETUP
-#line 470 "gibbon-clip-lexer.l"
+#line 464 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 9,
 		                                    " \t",
@@ -6408,7 +6402,7 @@ YY_RULE_SETUP
 case 32:
 /* rule 32 can match eol */
 YY_RULE_SETUP
-#line 481 "gibbon-clip-lexer.l"
+#line 475 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 10,
 		                                    " \t",
@@ -6424,7 +6418,7 @@ YY_RULE_SETUP
 case 33:
 /* rule 33 can match eol */
 YY_RULE_SETUP
-#line 492 "gibbon-clip-lexer.l"
+#line 486 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 9,
 		                                    " \t",
@@ -6440,7 +6434,7 @@ YY_RULE_SETUP
 case 34:
 /* rule 34 can match eol */
 YY_RULE_SETUP
-#line 503 "gibbon-clip-lexer.l"
+#line 497 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 9,
 		                                    " \t",
@@ -6456,7 +6450,7 @@ YY_RULE_SETUP
 case 35:
 /* rule 35 can match eol */
 YY_RULE_SETUP
-#line 514 "gibbon-clip-lexer.l"
+#line 508 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 5,
 		                                    "' \t",
@@ -6471,7 +6465,7 @@ YY_RULE_SETUP
 case 36:
 /* rule 36 can match eol */
 YY_RULE_SETUP
-#line 524 "gibbon-clip-lexer.l"
+#line 518 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 4,
 		                                    " \t",
@@ -6486,7 +6480,7 @@ YY_RULE_SETUP
 case 37:
 /* rule 37 can match eol */
 YY_RULE_SETUP
-#line 534 "gibbon-clip-lexer.l"
+#line 528 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 11,
 		                                    " \t",
@@ -6502,7 +6496,7 @@ YY_RULE_SETUP
 case 38:
 /* rule 38 can match eol */
 YY_RULE_SETUP
-#line 545 "gibbon-clip-lexer.l"
+#line 539 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 10,
 		                                    " \t",
@@ -6518,7 +6512,7 @@ YY_RULE_SETUP
 case 39:
 /* rule 39 can match eol */
 YY_RULE_SETUP
-#line 556 "gibbon-clip-lexer.l"
+#line 550 "gibbon-clip-lexer.l"
 {
 		gchar *ptr = yytext + 3;
 		gchar *user;
@@ -6549,7 +6543,7 @@ YY_RULE_SETUP
 case 40:
 /* rule 40 can match eol */
 YY_RULE_SETUP
-#line 582 "gibbon-clip-lexer.l"
+#line 576 "gibbon-clip-lexer.l"
 {
 		gchar *ptr = 6 + strstr (yytext + 3, "Error:");
 		gchar *user;
@@ -6581,7 +6575,7 @@ YY_RULE_SETUP
 case 41:
 /* rule 41 can match eol */
 YY_RULE_SETUP
-#line 609 "gibbon-clip-lexer.l"
+#line 603 "gibbon-clip-lexer.l"
 {
 		gchar *ptr = yytext + 3;
 		gchar *user;
@@ -6613,7 +6607,7 @@ YY_RULE_SETUP
 case 42:
 /* rule 42 can match eol */
 YY_RULE_SETUP
-#line 636 "gibbon-clip-lexer.l"
+#line 630 "gibbon-clip-lexer.l"
 {
 		gchar *ptr = 6 + strstr (yytext + 21, "player");
 		gchar *user;
@@ -6643,7 +6637,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 43:
 YY_RULE_SETUP
-#line 662 "gibbon-clip-lexer.l"
+#line 656 "gibbon-clip-lexer.l"
 {
 		gibbon_clip_reader_set_error (reader,
    	                                      GIBBON_CLIP_ERROR_NO_TWO_MATCHES,
@@ -6657,7 +6651,7 @@ YY_RULE_SETUP
 case 44:
 /* rule 44 can match eol */
 YY_RULE_SETUP
-#line 671 "gibbon-clip-lexer.l"
+#line 665 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 9,
 		                                    " \t",
@@ -6673,7 +6667,7 @@ YY_RULE_SETUP
 case 45:
 /* rule 45 can match eol */
 YY_RULE_SETUP
-#line 682 "gibbon-clip-lexer.l"
+#line 676 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 9,
 		                                    " \t",
@@ -6688,7 +6682,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 46:
 YY_RULE_SETUP
-#line 693 "gibbon-clip-lexer.l"
+#line 687 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 0,
 		                                    "', \t",
@@ -6702,7 +6696,7 @@ YY_RULE_SETUP
 case 47:
 /* rule 47 can match eol */
 YY_RULE_SETUP
-#line 702 "gibbon-clip-lexer.l"
+#line 696 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 8,
 		                                    " \t",
@@ -6718,7 +6712,7 @@ YY_RULE_SETUP
 case 48:
 /* rule 48 can match eol */
 YY_RULE_SETUP
-#line 713 "gibbon-clip-lexer.l"
+#line 707 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 7,
 		                                    ". \t",
@@ -6734,7 +6728,7 @@ YY_RULE_SETUP
 case 49:
 /* rule 49 can match eol */
 YY_RULE_SETUP
-#line 724 "gibbon-clip-lexer.l"
+#line 718 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 5,
 		                                    " \t",
@@ -6750,7 +6744,7 @@ YY_RULE_SETUP
 case 50:
 /* rule 50 can match eol */
 YY_RULE_SETUP
-#line 735 "gibbon-clip-lexer.l"
+#line 729 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 9,
 		                                    "- \t",
@@ -6769,7 +6763,7 @@ YY_RULE_SETUP
 case 51:
 /* rule 51 can match eol */
 YY_RULE_SETUP
-#line 749 "gibbon-clip-lexer.l"
+#line 743 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 8,
 		                                    "- \t",
@@ -6788,7 +6782,7 @@ YY_RULE_SETUP
 case 52:
 /* rule 52 can match eol */
 YY_RULE_SETUP
-#line 763 "gibbon-clip-lexer.l"
+#line 757 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 8,
 		                                    " \t",
@@ -6803,7 +6797,7 @@ YY_RULE_SETUP
 case 53:
 /* rule 53 can match eol */
 YY_RULE_SETUP
-#line 773 "gibbon-clip-lexer.l"
+#line 767 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 7,
 		                                    " \t",
@@ -6819,7 +6813,7 @@ YY_RULE_SETUP
 case 54:
 /* rule 54 can match eol */
 YY_RULE_SETUP
-#line 784 "gibbon-clip-lexer.l"
+#line 778 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 8,
 		                                    " \t",
@@ -6835,7 +6829,7 @@ YY_RULE_SETUP
 case 55:
 /* rule 55 can match eol */
 YY_RULE_SETUP
-#line 795 "gibbon-clip-lexer.l"
+#line 789 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 8,
 		                                    " \t",
@@ -6851,7 +6845,7 @@ YY_RULE_SETUP
 case 56:
 /* rule 56 can match eol */
 YY_RULE_SETUP
-#line 806 "gibbon-clip-lexer.l"
+#line 800 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 9,
 		                                    "- \t",
@@ -6869,7 +6863,7 @@ YY_RULE_SETUP
 case 57:
 /* rule 57 can match eol */
 YY_RULE_SETUP
-#line 819 "gibbon-clip-lexer.l"
+#line 813 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 5,
 		                                    " \t",
@@ -6884,7 +6878,7 @@ YY_RULE_SETUP
 case 58:
 /* rule 58 can match eol */
 YY_RULE_SETUP
-#line 829 "gibbon-clip-lexer.l"
+#line 823 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 9,
 		                                    " \t",
@@ -6900,7 +6894,7 @@ YY_RULE_SETUP
 case 59:
 /* rule 59 can match eol */
 YY_RULE_SETUP
-#line 840 "gibbon-clip-lexer.l"
+#line 834 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 2,
 		                                    " \t",
@@ -6914,7 +6908,7 @@ YY_RULE_SETUP
 case 60:
 /* rule 60 can match eol */
 YY_RULE_SETUP
-#line 849 "gibbon-clip-lexer.l"
+#line 843 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 7,
 		                                    ". \t",
@@ -6929,7 +6923,7 @@ YY_RULE_SETUP
 case 61:
 /* rule 61 can match eol */
 YY_RULE_SETUP
-#line 859 "gibbon-clip-lexer.l"
+#line 853 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 2,
 		                                    " \t",
@@ -6944,7 +6938,7 @@ YY_RULE_SETUP
 case 62:
 /* rule 62 can match eol */
 YY_RULE_SETUP
-#line 869 "gibbon-clip-lexer.l"
+#line 863 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 2,
 		                                    ": \t",
@@ -6958,7 +6952,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 63:
 YY_RULE_SETUP
-#line 879 "gibbon-clip-lexer.l"
+#line 873 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 4,
 		                                    ": \t",
@@ -6972,7 +6966,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 64:
 YY_RULE_SETUP
-#line 889 "gibbon-clip-lexer.l"
+#line 883 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 3,
 		                                    ": \t",
@@ -6987,7 +6981,7 @@ YY_RULE_SETUP
 case 65:
 /* rule 65 can match eol */
 YY_RULE_SETUP
-#line 899 "gibbon-clip-lexer.l"
+#line 893 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 5,
 		                                    ": \t",
@@ -7003,7 +6997,7 @@ YY_RULE_SETUP
 case 66:
 /* rule 66 can match eol */
 YY_RULE_SETUP
-#line 910 "gibbon-clip-lexer.l"
+#line 904 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 6,
 		                                    " \t",
@@ -7020,7 +7014,7 @@ YY_RULE_SETUP
 case 67:
 /* rule 67 can match eol */
 YY_RULE_SETUP
-#line 922 "gibbon-clip-lexer.l"
+#line 916 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 7,
 		                                    " \t",
@@ -7037,7 +7031,7 @@ YY_RULE_SETUP
 case 68:
 /* rule 68 can match eol */
 YY_RULE_SETUP
-#line 934 "gibbon-clip-lexer.l"
+#line 928 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 10,
 		                                    "- \t",
@@ -7056,7 +7050,7 @@ YY_RULE_SETUP
 case 69:
 /* rule 69 can match eol */
 YY_RULE_SETUP
-#line 948 "gibbon-clip-lexer.l"
+#line 942 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 8,
 		                                    " \t",
@@ -7073,7 +7067,7 @@ YY_RULE_SETUP
 case 70:
 /* rule 70 can match eol */
 YY_RULE_SETUP
-#line 960 "gibbon-clip-lexer.l"
+#line 954 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 8,
 		                                    "- \t",
@@ -7089,7 +7083,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 71:
 YY_RULE_SETUP
-#line 972 "gibbon-clip-lexer.l"
+#line 966 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 0,
 		                                    " \t",
@@ -7105,7 +7099,7 @@ YY_RULE_SETUP
 case 72:
 /* rule 72 can match eol */
 YY_RULE_SETUP
-#line 983 "gibbon-clip-lexer.l"
+#line 977 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 2,
 		                                    ": \t",
@@ -7121,18 +7115,18 @@ YY_RULE_SETUP
 case 73:
 /* rule 73 can match eol */
 YY_RULE_SETUP
-#line 994 "gibbon-clip-lexer.l"
+#line 988 "gibbon-clip-lexer.l"
 /* Ignore.  */ ;
 	YY_BREAK
 case 74:
 YY_RULE_SETUP
-#line 995 "gibbon-clip-lexer.l"
+#line 989 "gibbon-clip-lexer.l"
 BEGIN (INITIAL); return 2;
 	YY_BREAK
 case 75:
 /* rule 75 can match eol */
 YY_RULE_SETUP
-#line 996 "gibbon-clip-lexer.l"
+#line 990 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 7,
 		                                    "'. \t",
@@ -7147,7 +7141,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 76:
 YY_RULE_SETUP
-#line 1007 "gibbon-clip-lexer.l"
+#line 1001 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 0,
 		                                    " \t",
@@ -7163,7 +7157,7 @@ YY_RULE_SETUP
 case 77:
 /* rule 77 can match eol */
 YY_RULE_SETUP
-#line 1018 "gibbon-clip-lexer.l"
+#line 1012 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 2,
 		                                    " \t",
@@ -7178,7 +7172,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 78:
 YY_RULE_SETUP
-#line 1029 "gibbon-clip-lexer.l"
+#line 1023 "gibbon-clip-lexer.l"
 {
 		strcpy (yytext, "ready YES");
 		if (!gibbon_clip_reader_set_result (reader, yytext, 2,
@@ -7194,7 +7188,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 79:
 YY_RULE_SETUP
-#line 1041 "gibbon-clip-lexer.l"
+#line 1035 "gibbon-clip-lexer.l"
 {
 		strcpy (yytext, "ready NO");
 		if (!gibbon_clip_reader_set_result (reader, yytext, 2,
@@ -7210,7 +7204,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 80:
 YY_RULE_SETUP
-#line 1053 "gibbon-clip-lexer.l"
+#line 1047 "gibbon-clip-lexer.l"
 {
 		strcpy (yytext, "notify YES");
 		if (!gibbon_clip_reader_set_result (reader, yytext, 2,
@@ -7226,7 +7220,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 81:
 YY_RULE_SETUP
-#line 1065 "gibbon-clip-lexer.l"
+#line 1059 "gibbon-clip-lexer.l"
 {
 		strcpy (yytext, "notify NO");
 		if (!gibbon_clip_reader_set_result (reader, yytext, 2,
@@ -7242,7 +7236,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 82:
 YY_RULE_SETUP
-#line 1077 "gibbon-clip-lexer.l"
+#line 1071 "gibbon-clip-lexer.l"
 {
 		strcpy (yytext, "autoboard YES");
 		if (!gibbon_clip_reader_set_result (reader, yytext, 2,
@@ -7258,7 +7252,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 83:
 YY_RULE_SETUP
-#line 1089 "gibbon-clip-lexer.l"
+#line 1083 "gibbon-clip-lexer.l"
 {
 		strcpy (yytext, "autoboard NO");
 		if (!gibbon_clip_reader_set_result (reader, yytext, 2,
@@ -7274,7 +7268,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 84:
 YY_RULE_SETUP
-#line 1101 "gibbon-clip-lexer.l"
+#line 1095 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 0,
 		                                    " \t",
@@ -7290,7 +7284,7 @@ YY_RULE_SETUP
 case 85:
 /* rule 85 can match eol */
 YY_RULE_SETUP
-#line 1112 "gibbon-clip-lexer.l"
+#line 1106 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 4,
 		                                    "*- \t",
@@ -7307,7 +7301,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 86:
 YY_RULE_SETUP
-#line 1125 "gibbon-clip-lexer.l"
+#line 1119 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 0,
 		                                    " \t",
@@ -7323,7 +7317,7 @@ YY_RULE_SETUP
 case 87:
 /* rule 87 can match eol */
 YY_RULE_SETUP
-#line 1136 "gibbon-clip-lexer.l"
+#line 1130 "gibbon-clip-lexer.l"
 {
 		char *ptr = yytext;
 		while (*ptr && *ptr != ' ' && *ptr != '\t')
@@ -7347,7 +7341,7 @@ YY_RULE_SETUP
 case 88:
 /* rule 88 can match eol */
 YY_RULE_SETUP
-#line 1155 "gibbon-clip-lexer.l"
+#line 1149 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 5,
 		                                    " \t",
@@ -7365,7 +7359,7 @@ YY_RULE_SETUP
 case 89:
 /* rule 89 can match eol */
 YY_RULE_SETUP
-#line 1168 "gibbon-clip-lexer.l"
+#line 1162 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 5,
 		                                    "' \t",
@@ -7380,7 +7374,7 @@ YY_RULE_SETUP
 case 90:
 /* rule 90 can match eol */
 YY_RULE_SETUP
-#line 1178 "gibbon-clip-lexer.l"
+#line 1172 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 5,
 		                                    "' \t",
@@ -7394,7 +7388,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 91:
 YY_RULE_SETUP
-#line 1188 "gibbon-clip-lexer.l"
+#line 1182 "gibbon-clip-lexer.l"
 {
 		gibbon_clip_reader_set_error (reader,
    	                                      GIBBON_CLIP_ERROR_SAVED_CORRUPT,
@@ -7408,7 +7402,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 92:
 YY_RULE_SETUP
-#line 1198 "gibbon-clip-lexer.l"
+#line 1192 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 3,
 		                                    " \t",
@@ -7423,7 +7417,7 @@ YY_RULE_SETUP
 case 93:
 /* rule 93 can match eol */
 YY_RULE_SETUP
-#line 1208 "gibbon-clip-lexer.l"
+#line 1202 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_append_message (reader, yytext + 1))
 			return -1;
@@ -7434,7 +7428,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 94:
 YY_RULE_SETUP
-#line 1215 "gibbon-clip-lexer.l"
+#line 1209 "gibbon-clip-lexer.l"
 {
 		if (!gibbon_clip_reader_set_result (reader, yytext, 0,
 		                                    " \t",
@@ -7449,13 +7443,13 @@ YY_RULE_SETUP
 	YY_BREAK
 case 95:
 YY_RULE_SETUP
-#line 1226 "gibbon-clip-lexer.l"
+#line 1220 "gibbon-clip-lexer.l"
 /* Ignore! Including a full-stop!  */
 	YY_BREAK
 case 96:
 /* rule 96 can match eol */
 YY_RULE_SETUP
-#line 1227 "gibbon-clip-lexer.l"
+#line 1221 "gibbon-clip-lexer.l"
 {
 		return -1;
 		BEGIN (INITIAL);
@@ -7463,10 +7457,10 @@ YY_RULE_SETUP
 	YY_BREAK
 case 97:
 YY_RULE_SETUP
-#line 1231 "gibbon-clip-lexer.l"
+#line 1225 "gibbon-clip-lexer.l"
 ECHO;
 	YY_BREAK
-#line 7470 "gibbon-clip-lexer.c"
+#line 7464 "gibbon-clip-lexer.c"
 case YY_STATE_EOF(INITIAL):
 case YY_STATE_EOF(MOTD):
 case YY_STATE_EOF(MESSAGE):
@@ -8720,7 +8714,7 @@ void yyfree (void * ptr , yyscan_t yyscanner)
 
 /* %ok-for-header */
 
-#line 1231 "gibbon-clip-lexer.l"
+#line 1225 "gibbon-clip-lexer.l"
 
 
 
@@ -69,7 +69,7 @@ void gibbon_clip_reader_set_error (GibbonCLIPReader *self,
                                    const gchar *format, ...)
                                    G_GNUC_PRINTF (3, 4);
 gboolean gibbon_clip_reader_set_board (GibbonCLIPReader *self,
-                                       gchar **tokens);
+                                       const gchar *line);
 gboolean gibbon_clip_reader_append_message (GibbonCLIPReader *self,
                                             const gchar *line);
 gboolean gibbon_clip_reader_fixup_moves (GibbonCLIPReader *self);
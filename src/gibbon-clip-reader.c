@@ -25,9 +25,15 @@
  *
  * This class pre-processes the output from FIBS and translated it into
  * simple syntax trees.
+ *
+ * The reader keeps the result of the last line in buffers that are re-used
+ * for the next one.  gibbon_clip_reader_scan() gives access to the result
+ * without allocating memory, gibbon_clip_reader_parse() converts it into
+ * a list of #GValue pointers.
  */
 
 #include <errno.h>
+#include <string.h>
 
 #include <glib.h>
 #include <glib/gi18n.h>
@@ -37,10 +43,42 @@
 #include "gibbon-util.h"
 #include "gibbon-position.h"
 
+/*
+ * Upper bound for the number of tokens that gibbon_clip_reader_set_result()
+ * splits a line into.  The largest rule (own info) needs 22.
+ */
+#define GIBBON_CLIP_READER_MAX_TOKENS 64
+
+/*
+ * One parsed value.  Strings are stored as offsets into the string buffer
+ * because the buffer may be re-allocated while the line is parsed.  A
+ * token of type GIBBON_TYPE_POSITION refers to the board of the reader.
+ */
+typedef struct _GibbonCLIPToken GibbonCLIPToken;
+struct _GibbonCLIPToken {
+        GType type;
+        union {
+                gint64 i;
+                gdouble d;
+                gboolean b;
+                gsize offset;
+        } v;
+};
+
 typedef struct _GibbonCLIPReaderPrivate GibbonCLIPReaderPrivate;
 struct _GibbonCLIPReaderPrivate {
         void *yyscanner;
-        GSList *values;
+
+        /*
+         * The result of the last line.  All buffers are re-used for the
+         * next line so that parsing does not allocate memory once they
+         * have grown to their working size.
+         */
+        GArray *tokens;
+        GString *strings;
+        GibbonPosition board;
+        gsize board_players[2];
+        GibbonCLIPRecord record;
 };
 
 #define GIBBON_CLIP_READER_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
@@ -48,18 +86,32 @@ struct _GibbonCLIPReaderPrivate {
 
 G_DEFINE_TYPE (GibbonCLIPReader, gibbon_clip_reader, G_TYPE_OBJECT)
 
-static gboolean gibbon_clip_reader_alloc_value (GibbonCLIPReader *self,
-                                                gchar *token,
-                                                enum GibbonCLIPLexerTokenType t);
+static gboolean gibbon_clip_reader_lex_line (GibbonCLIPReader *self,
+                                             const gchar *line);
+static gboolean gibbon_clip_reader_fill_record (GibbonCLIPReader *self);
+static gboolean gibbon_clip_reader_convert (GibbonCLIPReader *self,
+                                            gchar *token,
+                                            enum GibbonCLIPLexerTokenType t,
+                                            GibbonCLIPToken *result);
+static gint gibbon_clip_reader_split (gchar *string, const gchar *set,
+                                      gint max_tokens, gchar **tokens);
+static gsize gibbon_clip_reader_add_string (GibbonCLIPReader *self,
+                                            const gchar *string);
 
-static void 
+static void
 gibbon_clip_reader_init (GibbonCLIPReader *self)
 {
         self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                 GIBBON_TYPE_CLIP_READER, GibbonCLIPReaderPrivate);
 
         self->priv->yyscanner = NULL;
-        self->priv->values = NULL;
+        self->priv->tokens = g_array_sized_new (FALSE, FALSE,
+                                                sizeof (GibbonCLIPToken),
+                                                GIBBON_CLIP_READER_MAX_TOKENS);
+        self->priv->strings = g_string_sized_new (512);
+        self->priv->board = *gibbon_position_initial ();
+        self->priv->board_players[0] = self->priv->board_players[1] = 0;
+        memset (&self->priv->record, 0, sizeof self->priv->record);
 }
 
 static void
@@ -70,6 +122,12 @@ gibbon_clip_reader_finalize (GObject *object)
         if (self->priv->yyscanner)
                 gibbon_clip_lexer_lex_destroy (self->priv->yyscanner);
 
+        if (self->priv->tokens)
+                g_array_free (self->priv->tokens, TRUE);
+
+        if (self->priv->strings)
+                g_string_free (self->priv->strings, TRUE);
+
         G_OBJECT_CLASS (gibbon_clip_reader_parent_class)->finalize(object);
 }
 
@@ -77,7 +135,7 @@ static void
 gibbon_clip_reader_class_init (GibbonCLIPReaderClass *klass)
 {
         GObjectClass *object_class = G_OBJECT_CLASS (klass);
-        
+
         g_type_class_add_private (klass, sizeof (GibbonCLIPReaderPrivate));
 
         g_value_register_transform_func (
@@ -109,18 +167,68 @@ gibbon_clip_reader_new ()
         return self;
 }
 
+/**
+ * gibbon_clip_reader_scan:
+ * @self: The #GibbonCLIPReader.
+ * @line: The line to parse.
+ *
+ * Parses one line of server output without allocating memory.  For the
+ * frequent messages (who info, chat, board, rolls, and moves) the record
+ * is completely filled.  For all other codes only the code is set, and
+ * the values must be retrieved with gibbon_clip_reader_get_values().
+ *
+ * Returns: The parsed record or %NULL if the line could not be parsed.
+ *          The record and all strings in it are owned by @self and are
+ *          valid until the next line is parsed.
+ */
+const GibbonCLIPRecord *
+gibbon_clip_reader_scan (GibbonCLIPReader *self, const gchar *line)
+{
+        g_return_val_if_fail (GIBBON_IS_CLIP_READER (self), NULL);
+        g_return_val_if_fail (line != NULL, NULL);
+
+        if (!gibbon_clip_reader_lex_line (self, line))
+                return NULL;
+
+        if (!gibbon_clip_reader_fill_record (self))
+                return NULL;
+
+        return &self->priv->record;
+}
+
+/**
+ * gibbon_clip_reader_parse:
+ * @self: The #GibbonCLIPReader.
+ * @line: The line to parse.
+ *
+ * Parses one line of server output.
+ *
+ * Returns: A list of #GValue pointers, starting with the CLIP code, or
+ *          %NULL if the line could not be parsed.  Free it with
+ *          gibbon_clip_reader_free_result().
+ */
 GSList *
 gibbon_clip_reader_parse (GibbonCLIPReader *self, const gchar *line)
 {
-        GSList *retval;
-        GValue *value;
-        GValue init = G_VALUE_INIT;
+        g_return_val_if_fail (GIBBON_IS_CLIP_READER (self), NULL);
+        g_return_val_if_fail (line != NULL, NULL);
+
+        if (!gibbon_clip_reader_lex_line (self, line))
+                return NULL;
+
+        return gibbon_clip_reader_get_values (self);
+}
+
+static gboolean
+gibbon_clip_reader_lex_line (GibbonCLIPReader *self, const gchar *line)
+{
+        GibbonCLIPToken token;
         const gchar *ptr;
         gint status;
         gboolean error = FALSE;
 
-        g_return_val_if_fail (GIBBON_IS_CLIP_READER (self), NULL);
-        g_return_val_if_fail (line != NULL, NULL);
+        g_array_set_size (self->priv->tokens, 0);
+        g_string_truncate (self->priv->strings, 0);
 
         gibbon_clip_lexer_current_buffer (self->priv->yyscanner, line);
 
@@ -139,8 +247,8 @@ gibbon_clip_reader_parse (GibbonCLIPReader *self, const gchar *line)
         }
 
         if (error) {
-                gibbon_clip_reader_free_result (self, self->priv->values);
-                self->priv->values = NULL;
+                g_array_set_size (self->priv->tokens, 0);
+                g_string_truncate (self->priv->strings, 0);
                 gibbon_clip_lexer_reset_condition_stack (self->priv->yyscanner);
 
                 /*
@@ -152,92 +260,199 @@ gibbon_clip_reader_parse (GibbonCLIPReader *self, const gchar *line)
                         while (*ptr == ' ' || *ptr == '\t')
                                 ++ptr;
 
-                        value = g_malloc (sizeof *value);
-                        *value = init;
-                        self->priv->values = g_slist_prepend (
-                                        self->priv->values, value);
-                        g_value_init (value, G_TYPE_STRING);
-                        g_value_set_string (value, ptr);
-
-                        value = g_malloc (sizeof *value);
-                        *value = init;
-                        self->priv->values = g_slist_prepend (
-                                        self->priv->values, value);
-                        g_value_init (value, G_TYPE_INT64);
-                        g_value_set_int64 (value, GIBBON_CLIP_ERROR_UNKNOWN);
-
-                        value = g_malloc (sizeof *value);
-                        *value = init;
-                        self->priv->values = g_slist_prepend (
-                                        self->priv->values, value);
-                        g_value_init (value, G_TYPE_INT64);
-                        g_value_set_int64 (value, GIBBON_CLIP_ERROR);
+                        token.type = G_TYPE_INT64;
+                        token.v.i = GIBBON_CLIP_ERROR;
+                        g_array_append_val (self->priv->tokens, token);
+
+                        token.v.i = GIBBON_CLIP_ERROR_UNKNOWN;
+                        g_array_append_val (self->priv->tokens, token);
+
+                        token.type = G_TYPE_STRING;
+                        token.v.offset =
+                                gibbon_clip_reader_add_string (self, ptr);
+                        g_array_append_val (self->priv->tokens, token);
                 } else {
-                        return NULL;
+                        return FALSE;
                 }
         }
 
-        retval = self->priv->values;
-        self->priv->values = NULL;
+        if (!self->priv->tokens->len)
+                return FALSE;
+
+        /*
+         * The string buffer will not move any more.  Now the player names
+         * of a board can be resolved.
+         */
+        token = g_array_index (self->priv->tokens, GibbonCLIPToken, 0);
+        if (token.type == G_TYPE_INT64 && token.v.i == GIBBON_CLIP_BOARD) {
+                self->priv->board.players[0] = self->priv->strings->str
+                                + self->priv->board_players[0];
+                self->priv->board.players[1] = self->priv->strings->str
+                                + self->priv->board_players[1];
+        }
 
-        return retval;
+        return TRUE;
 }
 
 static gboolean
-gibbon_clip_reader_alloc_value (GibbonCLIPReader *self,
-                                gchar *token,
-                                enum GibbonCLIPLexerTokenType type)
+gibbon_clip_reader_fill_record (GibbonCLIPReader *self)
 {
+        GibbonCLIPReaderPrivate *priv = self->priv;
+        GibbonCLIPRecord *record = &priv->record;
+        const GibbonCLIPToken *tokens;
+        const gchar *strings = priv->strings->str;
+        guint num_tokens = priv->tokens->len;
+        gsize i;
+
+        tokens = (const GibbonCLIPToken *) priv->tokens->data;
+
+        g_return_val_if_fail (tokens[0].type == G_TYPE_INT64, FALSE);
+        record->code = (enum GibbonClipCode) tokens[0].v.i;
+
+        switch (record->code) {
+        case GIBBON_CLIP_WHO_INFO:
+                if (num_tokens != 13)
+                        return FALSE;
+                record->u.who_info.who = strings + tokens[1].v.offset;
+                record->u.who_info.opponent = strings + tokens[2].v.offset;
+                record->u.who_info.watching = strings + tokens[3].v.offset;
+                record->u.who_info.ready = tokens[4].v.b;
+                record->u.who_info.away = tokens[5].v.b;
+                record->u.who_info.rating = tokens[6].v.d;
+                record->u.who_info.experience = tokens[7].v.i;
+                record->u.who_info.idle = tokens[8].v.i;
+                record->u.who_info.login = tokens[9].v.i;
+                record->u.who_info.hostname = strings + tokens[10].v.offset;
+                record->u.who_info.client = strings + tokens[11].v.offset;
+                record->u.who_info.email = strings + tokens[12].v.offset;
+                break;
+        case GIBBON_CLIP_SAYS:
+        case GIBBON_CLIP_SHOUTS:
+        case GIBBON_CLIP_WHISPERS:
+        case GIBBON_CLIP_KIBITZES:
+        case GIBBON_CLIP_ALERTS:
+                if (num_tokens != 3)
+                        return FALSE;
+                record->u.chat.sender = strings + tokens[1].v.offset;
+                record->u.chat.message = strings + tokens[2].v.offset;
+                break;
+        case GIBBON_CLIP_BOARD:
+                if (num_tokens != 3)
+                        return FALSE;
+                record->u.board.position = &priv->board;
+                record->u.board.direction = tokens[2].v.b;
+                break;
+        case GIBBON_CLIP_ROLLS:
+                if (num_tokens != 4)
+                        return FALSE;
+                record->u.rolls.who = strings + tokens[1].v.offset;
+                record->u.rolls.dice[0] = tokens[2].v.i;
+                record->u.rolls.dice[1] = tokens[3].v.i;
+                break;
+        case GIBBON_CLIP_MOVES:
+                if (num_tokens < 2
+                    || num_tokens - 2
+                       > 2 * G_N_ELEMENTS (record->u.moves.movements))
+                        return FALSE;
+                record->u.moves.who = strings + tokens[1].v.offset;
+                record->u.moves.num_movements = (num_tokens - 2) >> 1;
+                for (i = 0; i < record->u.moves.num_movements; ++i) {
+                        record->u.moves.movements[i].from =
+                                        tokens[2 + 2 * i].v.i;
+                        record->u.moves.movements[i].to =
+                                        tokens[3 + 2 * i].v.i;
+                }
+                break;
+        default:
+                break;
+        }
+
+        return TRUE;
+}
+
+/**
+ * gibbon_clip_reader_get_values:
+ * @self: The #GibbonCLIPReader.
+ *
+ * Converts the result of the last call to gibbon_clip_reader_scan() into
+ * a list of #GValue pointers.
+ *
+ * Returns: A list of #GValue pointers, starting with the CLIP code.  Free
+ *          it with gibbon_clip_reader_free_result().
+ */
+GSList *
+gibbon_clip_reader_get_values (const GibbonCLIPReader *self)
+{
+        GSList *values = NULL;
         GValue *value;
         GValue init = G_VALUE_INIT;
+        const GibbonCLIPToken *token;
+        const gchar *strings;
+        guint i;
+
+        g_return_val_if_fail (GIBBON_IS_CLIP_READER (self), NULL);
+
+        strings = self->priv->strings->str;
+
+        for (i = self->priv->tokens->len; i > 0; --i) {
+                token = &g_array_index (self->priv->tokens, GibbonCLIPToken,
+                                        i - 1);
+                value = g_malloc (sizeof *value);
+                *value = init;
+                values = g_slist_prepend (values, value);
+                g_value_init (value, token->type);
+                if (token->type == G_TYPE_INT64)
+                        g_value_set_int64 (value, token->v.i);
+                else if (token->type == G_TYPE_DOUBLE)
+                        g_value_set_double (value, token->v.d);
+                else if (token->type == G_TYPE_BOOLEAN)
+                        g_value_set_boolean (value, token->v.b);
+                else if (token->type == G_TYPE_STRING)
+                        g_value_set_string (value, strings + token->v.offset);
+                else if (token->type == GIBBON_TYPE_POSITION)
+                        g_value_set_boxed (value, &self->priv->board);
+        }
+
+        return values;
+}
+
+static gboolean
+gibbon_clip_reader_convert (GibbonCLIPReader *self,
+                            gchar *token,
+                            enum GibbonCLIPLexerTokenType type,
+                            GibbonCLIPToken *result)
+{
         gint64 i;
-        gdouble d;
         size_t length;
 
         g_return_val_if_fail (GIBBON_IS_CLIP_READER (self), FALSE);
         g_return_val_if_fail (token != NULL, FALSE);
 
-        value = g_malloc (sizeof *value);
-        *value = init;
-
-        self->priv->values = g_slist_prepend (self->priv->values, value);
-
         switch (type) {
         case GIBBON_TT_END:
-                /*
-                 * We have to initialize the value.  Otherwise, the test
-                 * suite will fail.
-                 */
-                g_value_init (value, G_TYPE_INT64);
                 g_return_val_if_fail (type != GIBBON_TT_END, FALSE);
                 break;
         case GIBBON_TT_USER:
-                g_value_init (value, G_TYPE_STRING);
                 if (!g_strcmp0 (token, "You"))
                         return FALSE;
-                g_value_set_string (value, token);
+                result->type = G_TYPE_STRING;
                 break;
         case GIBBON_TT_MAYBE_YOU:
-                g_value_init (value, G_TYPE_STRING);
-                g_value_set_string (value, token);
+                result->type = G_TYPE_STRING;
                 break;
         case GIBBON_TT_MAYBE_USER:
-                g_value_init (value, G_TYPE_STRING);
                 if (!g_strcmp0 (token, "-"))
-                        token = "";
-                g_value_set_string (value, token);
+                        token[0] = 0;
+                result->type = G_TYPE_STRING;
                 break;
         case GIBBON_TT_TIMESTAMP:
-                g_value_init (value, G_TYPE_INT64);
-                i = g_ascii_strtoll (token, NULL, 10);
-                g_value_set_int64 (value, i);
+                result->type = G_TYPE_INT64;
+                result->v.i = g_ascii_strtoll (token, NULL, 10);
                 break;
         case GIBBON_TT_WORD:
-                g_value_init (value, G_TYPE_STRING);
-                g_value_set_string (value, token);
+                result->type = G_TYPE_STRING;
                 break;
         case GIBBON_TT_BOOLEAN:
-                g_value_init (value, G_TYPE_BOOLEAN);
                 if (token[0] == '0')
                         i = FALSE;
                 else if (token[0] == '1')
@@ -246,57 +461,54 @@ gibbon_clip_reader_alloc_value (GibbonCLIPReader *self,
                         return FALSE;
                 if (token[1])
                         return FALSE;
-                g_value_set_boolean (value, i);
+                result->type = G_TYPE_BOOLEAN;
+                result->v.b = i;
                 break;
         case GIBBON_TT_N0:
-                g_value_init (value, G_TYPE_INT64);
                 i = g_ascii_strtoll (token, NULL, 10);
                 if (i < 0)
                         return FALSE;
-                g_value_set_int64 (value, i);
+                result->type = G_TYPE_INT64;
+                result->v.i = i;
                 break;
         case GIBBON_TT_POSITIVE:
-                g_value_init (value, G_TYPE_INT64);
                 i = g_ascii_strtoll (token, NULL, 10);
                 if (i < 1)
                         return FALSE;
-                g_value_set_int64 (value, i);
+                result->type = G_TYPE_INT64;
+                result->v.i = i;
                 break;
         case GIBBON_TT_DOUBLE:
-                g_value_init (value, G_TYPE_DOUBLE);
-                d = g_ascii_strtod (token, NULL);
-                g_value_set_double (value, d);
+                result->type = G_TYPE_DOUBLE;
+                result->v.d = g_ascii_strtod (token, NULL);
                 break;
         case GIBBON_TT_REDOUBLES:
-                g_value_init (value, G_TYPE_INT64);
                 if (!g_strcmp0 (token, "unlimited"))
                         i = -1;
                 else if (!g_strcmp0 (token, "none"))
                         i = 0;
                 else
                         i = g_ascii_strtoull (token, NULL, 10);
-                g_value_set_int64 (value, i);
+                result->type = G_TYPE_INT64;
+                result->v.i = i;
                 break;
         case GIBBON_TT_MESSAGE:
-                g_value_init (value, G_TYPE_STRING);
-                g_value_set_string (value, token);
+                result->type = G_TYPE_STRING;
                 break;
         case GIBBON_TT_HOSTNAME:
-                g_value_init (value, G_TYPE_STRING);
                 length = strlen (token);
                 if ('*' == token[length - 1])
                         token[length - 1] = 0;
-                g_value_set_string (value, token);
+                result->type = G_TYPE_STRING;
                 break;
         case GIBBON_TT_DIE:
-                g_value_init (value, G_TYPE_INT64);
                 i = token[0] - '0';
                 if (token[1] || i < 1 || i > 6)
                         return FALSE;
-                g_value_set_int64 (value, i);
+                result->type = G_TYPE_INT64;
+                result->v.i = i;
                 break;
         case GIBBON_TT_POINT:
-                g_value_init (value, G_TYPE_INT64);
                 /*
                  * At this point we cannot decide whether off and bar
                  * correspond to 0 or 25.  We will fix that up in a later step
@@ -308,17 +520,17 @@ gibbon_clip_reader_alloc_value (GibbonCLIPReader *self,
                         i = 0;
                 else
                         i = g_ascii_strtoull (token, NULL, 10);
-                g_value_set_int64 (value, i);
+                result->type = G_TYPE_INT64;
+                result->v.i = i;
                 break;
         case GIBBON_TT_CUBE:
-                g_value_init (value, G_TYPE_INT64);
                 i = g_ascii_strtoll (token, NULL, 10);
                 if (i <= 0 || (i & (~i + 1)) != i)
                         return FALSE;
-                g_value_set_int64 (value, i);
+                result->type = G_TYPE_INT64;
+                result->v.i = i;
                 break;
         case GIBBON_TT_MATCH_LENGTH:
-                g_value_init (value, G_TYPE_INT64);
                 if (!g_strcmp0 ("unlimited", token)) {
                         i = 0;
                 } else if (!g_strcmp0 ("resume", token)) {
@@ -328,23 +540,85 @@ gibbon_clip_reader_alloc_value (GibbonCLIPReader *self,
                         if (i < 1)
                                 return FALSE;
                 }
-                g_value_set_int64 (value, i);
+                result->type = G_TYPE_INT64;
+                result->v.i = i;
                 break;
         case GIBBON_TT_YESNO:
-                g_value_init (value, G_TYPE_BOOLEAN);
                 if (!g_strcmp0 (token, "YES"))
                         i = TRUE;
                 else if (!g_strcmp0 (token, "NO"))
                         i = FALSE;
                 else
                         return FALSE;
-                g_value_set_boolean (value, i);
+                result->type = G_TYPE_BOOLEAN;
+                result->v.b = i;
                 break;
         }
 
+        if (result->type == G_TYPE_STRING)
+                result->v.offset = token - self->priv->strings->str;
+
         return TRUE;
 }
 
+/*
+ * Splits STRING in place like gibbon_strsplit_set() and stores pointers
+ * to the tokens in TOKENS which must have room for MAX_TOKENS elements.
+ */
+static gint
+gibbon_clip_reader_split (gchar *string, const gchar *set, gint max_tokens,
+                          gchar **tokens)
+{
+        gint num_tokens = 0;
+        gchar lookup[256];
+        gchar *ptr;
+        gchar *end;
+
+        memset (lookup, 0, sizeof lookup);
+        while (*set) {
+                lookup[(guchar) *set] = 1;
+                ++set;
+        }
+
+        ptr = string;
+
+        while (1) {
+                while (lookup[(guchar) *ptr])
+                        ++ptr;
+                if (!*ptr)
+                        break;
+                tokens[num_tokens++] = ptr;
+                if (num_tokens >= max_tokens) {
+                        /* Remove trailing delimiters.  */
+                        end = ptr + strlen (ptr) - 1;
+                        while (lookup[(guchar) *end])
+                                *end-- = 0;
+                        break;
+                }
+                while (*ptr && !lookup[(guchar) *ptr])
+                        ++ptr;
+                if (!*ptr)
+                        break;
+                *ptr++ = 0;
+        }
+
+        return num_tokens;
+}
+
+/*
+ * Copies STRING including the terminating null byte into the string
+ * buffer and returns its offset.
+ */
+static gsize
+gibbon_clip_reader_add_string (GibbonCLIPReader *self, const gchar *string)
+{
+        gsize offset = self->priv->strings->len;
+
+        g_string_append_len (self->priv->strings, string, strlen (string) + 1);
+
+        return offset;
+}
+
 void
 gibbon_clip_reader_free_result (GibbonCLIPReader *self, GSList *values)
 {
@@ -356,21 +630,27 @@ gibbon_clip_reader_free_result (GibbonCLIPReader *self, GSList *values)
 }
 
 gboolean
-gibbon_clip_reader_set_board (GibbonCLIPReader *self, gchar **tokens)
+gibbon_clip_reader_set_board (GibbonCLIPReader *self, const gchar *string)
 {
-        GValue *value;
-        GValue init = G_VALUE_INIT;
+        GibbonCLIPToken token;
         GibbonPosition *pos;
         GibbonPositionSide color, turn;
         gboolean direction;
         gboolean post_crawford, no_crawford;
         gint64 numbers[50];
+        gchar *tokens[53];
+        gchar *copy;
+        gsize offset;
         gint i;
         gchar *end = NULL;
 
         g_return_val_if_fail (GIBBON_IS_CLIP_READER (self), FALSE);
+        g_return_val_if_fail (string != NULL, FALSE);
 
-        if (52 != g_strv_length (tokens))
+        offset = gibbon_clip_reader_add_string (self, string);
+        copy = self->priv->strings->str + offset;
+        if (52 != gibbon_clip_reader_split (copy, ":", G_N_ELEMENTS (tokens),
+                                            tokens))
                 return FALSE;
 
         errno = 0;
@@ -382,7 +662,8 @@ gibbon_clip_reader_set_board (GibbonCLIPReader *self, gchar **tokens)
                         return FALSE;
         }
 
-        pos = gibbon_position_new ();
+        pos = &self->priv->board;
+        *pos = *gibbon_position_initial ();
 
         /*
          * Clear all points.
@@ -394,33 +675,35 @@ gibbon_clip_reader_set_board (GibbonCLIPReader *self, gchar **tokens)
          *
          * The documentation for the data structure is available at
          * http://www.fibs.com/fibs_interface.html#board_state
+         *
+         * The player names are resolved, when the line is complete because
+         * the string buffer may still move.
          */
-
-        pos->players[0] = g_strdup (tokens[0]);
-        pos->players[1] = g_strdup (tokens[1]);
+        self->priv->board_players[0] = tokens[0] - self->priv->strings->str;
+        self->priv->board_players[1] = tokens[1] - self->priv->strings->str;
 
         if (numbers[0] < 1)
-                goto bail_out_board;
+                return FALSE;
         if (numbers[0] >= 9999)
                 numbers[0] = 0;
         pos->match_length = numbers[0];
 
         if (numbers[1] < 0)
-                goto bail_out_board;
+                return FALSE;
         pos->scores[0] = numbers[1];
 
         if (numbers[2] < 0)
-                goto bail_out_board;
+                return FALSE;
         pos->scores[1] = numbers[2];
 
         /* Color.  */
         if (numbers[38] != -1 && numbers[38] != 1)
-                goto bail_out_board;
+                return FALSE;
         color = numbers[38];
 
         /* Direction.  */
         if (numbers[39] != -1 && numbers[39] != 1)
-                goto bail_out_board;
+                return FALSE;
         direction = numbers[39];
 
         /* Regular points.  */
@@ -428,30 +711,30 @@ gibbon_clip_reader_set_board (GibbonCLIPReader *self, gchar **tokens)
                 for (i = 0; i < 24; ++i) {
                         numbers[i + 4] *= color;
                         if (numbers[i + 4] < -15 || numbers[i + 4] > +15)
-                                goto bail_out_board;
+                                return FALSE;
                         pos->points[i] = numbers[i + 4];
                 }
         } else {
                 for (i = 0; i < 24; ++i) {
                         numbers[i + 4] *= color;
                         if (numbers[i + 4] < -15 || numbers[i + 4] > +15)
-                                goto bail_out_board;
+                                return FALSE;
                         pos->points[23 - i] = numbers[i + 4];
                 }
         }
 
         if (numbers[29] < -1 || numbers[29] > 1)
-                goto bail_out_board;
+                return FALSE;
         turn = numbers[29];
 
         if (numbers[30] < 0 || numbers[30] > 6)
-                goto bail_out_board;
+                return FALSE;
         if (numbers[31] < 0 || numbers[31] > 6)
-                goto bail_out_board;
+                return FALSE;
         if (numbers[32] < 0 || numbers[32] > 6)
-                goto bail_out_board;
+                return FALSE;
         if (numbers[33] < 0 || numbers[33] > 6)
-                goto bail_out_board;
+                return FALSE;
 
         /*
          * Translate FIBS' notion to who is on turn to our internal one.
@@ -470,34 +753,34 @@ gibbon_clip_reader_set_board (GibbonCLIPReader *self, gchar **tokens)
 
         if (numbers[34] < 0
             || (numbers[34] & (~numbers[34] + 1)) != numbers[34])
-                goto bail_out_board;
+                return FALSE;
         pos->cube = numbers[34];
 
         /*
          * May double flags.  These may have to be corrected later.
          */
         if (numbers[35] != 0 && numbers[35] != 1)
-                goto bail_out_board;
+                return FALSE;
         pos->may_double[0] = numbers[35];
         if (numbers[36] != 0 && numbers[36] != 1)
-                goto bail_out_board;
+                return FALSE;
         pos->may_double[1] = numbers[36];
 
         /*
          * Cube currently turned? Documented as "Was Doubled".
          */
         if (numbers[37] != 0 && numbers[37] != 1)
-                goto bail_out_board;
+                return FALSE;
         pos->cube_turned = numbers[37];
 
         /*
          * Number of checkers on the bar.
          */
         if (numbers[44] < 0 || numbers[44] > 15)
-                goto bail_out_board;
+                return FALSE;
         pos->bar[0] = numbers[44];
         if (numbers[45] < 0 || numbers[45] > 15)
-                goto bail_out_board;
+                return FALSE;
         pos->bar[1] = numbers[45];
 
         /*
@@ -523,49 +806,43 @@ gibbon_clip_reader_set_board (GibbonCLIPReader *self, gchar **tokens)
          * flag.  If one opponent is 1-away, and the flag is set, we know
          * that the Crawford rule applies, and that this is a post-Crawford
          * game.
+         *
+         * The board is never freed, the game info can therefore point
+         * to the translated string.
          */
         if (numbers[47] < 0)
-                goto bail_out_board;
+                return FALSE;
         no_crawford = (gboolean) numbers[47];
         if (numbers[48] != 0 && numbers[48] != 1)
-                goto bail_out_board;
+                return FALSE;
         post_crawford = numbers[48];
 
         if (!no_crawford && pos->match_length
             && (pos->scores[0] == pos->match_length - 1
                 || pos->scores[1] == pos->match_length - 1)) {
                 if (post_crawford) {
-                        pos->game_info = g_strdup (_("Post-Crawford game"));
+                        pos->game_info = (gchar *) _("Post-Crawford game");
                 } else {
-                        pos->game_info = g_strdup (_("Crawford game"));
+                        pos->game_info = (gchar *) _("Crawford game");
                         pos->may_double[0] = pos->may_double[1] = FALSE;
                 }
         }
 
-        value = g_malloc (sizeof *value);
-        *value = init;
-        self->priv->values = g_slist_prepend (NULL, value);
-        g_value_init (value, G_TYPE_BOOLEAN);
-        g_value_set_boolean (value, direction == -1);
-
-        value = g_malloc (sizeof *value);
-        *value = init;
-        self->priv->values = g_slist_prepend (self->priv->values, value);
-        g_value_init (value, GIBBON_TYPE_POSITION);
-        g_value_set_boxed (value, pos);
+        /* A board always stands on its own.  */
+        g_array_set_size (self->priv->tokens, 0);
 
-        value = g_malloc (sizeof *value);
-        *value = init;
-        self->priv->values = g_slist_prepend (self->priv->values, value);
-        g_value_init (value, G_TYPE_INT64);
-        g_value_set_int64 (value, GIBBON_CLIP_BOARD);
+        token.type = G_TYPE_INT64;
+        token.v.i = GIBBON_CLIP_BOARD;
+        g_array_append_val (self->priv->tokens, token);
 
-        return TRUE;
+        token.type = GIBBON_TYPE_POSITION;
+        g_array_append_val (self->priv->tokens, token);
 
-bail_out_board:
-        gibbon_position_free (pos);
+        token.type = G_TYPE_BOOLEAN;
+        token.v.b = direction == -1;
+        g_array_append_val (self->priv->tokens, token);
 
-        return FALSE;
+        return TRUE;
 }
 
 gboolean
@@ -578,32 +855,41 @@ gibbon_clip_reader_set_result (GibbonCLIPReader *self, const gchar *yytext,
         int position;
         gboolean retval = TRUE;
 
-        gchar **tokens = NULL;
-        GValue *value;
-        GValue init = G_VALUE_INIT;
+        gchar *tokens[GIBBON_CLIP_READER_MAX_TOKENS];
         gint vector_length = 0;
+        GibbonCLIPToken values[GIBBON_CLIP_READER_MAX_TOKENS + 1];
+        gsize first = G_N_ELEMENTS (values);
+        gsize offset;
 
         g_return_val_if_fail (yytext != NULL, FALSE);
         g_return_val_if_fail (max_tokens >= 0, FALSE);
+        g_return_val_if_fail (max_tokens <= GIBBON_CLIP_READER_MAX_TOKENS,
+                              FALSE);
 
         if (max_tokens && delimiter) {
-                tokens = gibbon_strsplit_set (yytext, delimiter, max_tokens);
-                vector_length = g_strv_length (tokens);
+                offset = gibbon_clip_reader_add_string (self, yytext);
+                vector_length = gibbon_clip_reader_split (
+                                self->priv->strings->str + offset,
+                                delimiter, max_tokens, tokens);
         }
 
         va_start (args, clip_code);
 
+        /*
+         * The values are stored back to front so that they end up in the
+         * same order as before, when they were prepended to a list.
+         */
         while ((type = va_arg (args, enum GibbonCLIPLexerTokenType))
                != GIBBON_TT_END) {
                 position = va_arg (args, guint);
                 if (position < 0)
                         position = vector_length + position;
-                if (position > vector_length || position < 0) {
+                if (position >= vector_length || position < 0 || first <= 1) {
                         retval = FALSE;
                         break;
                 }
-                if (!gibbon_clip_reader_alloc_value (self, tokens[position],
-                                                     type)) {
+                if (!gibbon_clip_reader_convert (self, tokens[position],
+                                                 type, values + --first)) {
                         retval = FALSE;
                         break;
                 }
@@ -611,37 +897,31 @@ gibbon_clip_reader_set_result (GibbonCLIPReader *self, const gchar *yytext,
 
         va_end (args);
 
-        if (tokens)
-                g_strfreev (tokens);
-
-        if (retval && clip_code) {
-                value = g_malloc (sizeof *value);
-                *value = init;
+        if (!retval)
+                return FALSE;
 
-                g_value_init (value, G_TYPE_INT64);
-                g_value_set_int64 (value, clip_code);
-                self->priv->values = g_slist_prepend (self->priv->values,
-                                                      value);
+        if (clip_code) {
+                --first;
+                values[first].type = G_TYPE_INT64;
+                values[first].v.i = clip_code;
         }
 
-        return retval;
+        g_array_prepend_vals (self->priv->tokens, values + first,
+                              G_N_ELEMENTS (values) - first);
+
+        return TRUE;
 }
 
 gboolean
 gibbon_clip_reader_append_message (GibbonCLIPReader *self, const gchar *yytext)
 {
-        GValue *value;
-        GValue init = G_VALUE_INIT;
+        GibbonCLIPToken token;
 
         g_return_val_if_fail (yytext != NULL, FALSE);
 
-        value = g_malloc (sizeof *value);
-        *value = init;
-
-        self->priv->values = g_slist_append (self->priv->values, value);
-
-        g_value_init (value, G_TYPE_STRING);
-        g_value_set_string (value, yytext);
+        token.type = G_TYPE_STRING;
+        token.v.offset = gibbon_clip_reader_add_string (self, yytext);
+        g_array_append_val (self->priv->tokens, token);
 
         return TRUE;
 }
@@ -652,76 +932,57 @@ gibbon_clip_reader_set_error (GibbonCLIPReader *self,
                               const gchar *format, ...)
 {
         va_list args;
-        gchar *msg;
-        GValue *value;
-        GValue init = G_VALUE_INIT;
+        GibbonCLIPToken tokens[3];
+
+        tokens[0].type = G_TYPE_INT64;
+        tokens[0].v.i = GIBBON_CLIP_ERROR;
+        tokens[1].type = G_TYPE_INT64;
+        tokens[1].v.i = code;
+        tokens[2].type = G_TYPE_STRING;
+        tokens[2].v.offset = self->priv->strings->len;
 
         va_start (args, format);
-        msg = g_strdup_vprintf (format, args);
+        g_string_append_vprintf (self->priv->strings, format, args);
         va_end (args);
+        g_string_append_c (self->priv->strings, 0);
 
-        value = g_malloc (sizeof *value);
-        *value = init;
-        self->priv->values = g_slist_prepend (self->priv->values, value);
-        g_value_init (value, G_TYPE_STRING);
-        g_value_set_string (value, msg);
-        g_free (msg);
-
-        value = g_malloc (sizeof *value);
-        *value = init;
-        self->priv->values = g_slist_prepend (self->priv->values, value);
-        g_value_init (value, G_TYPE_INT64);
-        g_value_set_int64 (value, (gint64) code);
-
-        value = g_malloc (sizeof *value);
-        *value = init;
-        self->priv->values = g_slist_prepend (self->priv->values, value);
-        g_value_init (value, G_TYPE_INT64);
-        g_value_set_int64 (value, (gint64) GIBBON_CLIP_ERROR);
+        g_array_prepend_vals (self->priv->tokens, tokens,
+                              G_N_ELEMENTS (tokens));
 }
 
 gboolean
 gibbon_clip_reader_fixup_moves (GibbonCLIPReader *self)
 {
-        GSList *iter;
-        gint i;
+        GibbonCLIPToken *tokens;
+        guint num_tokens;
+        guint i;
         gint64 from, to;
-        GValue *vfrom;
-        GValue *vto;
 
         g_return_val_if_fail (GIBBON_IS_CLIP_READER (self), FALSE);
 
-        iter = self->priv->values;
-        g_return_val_if_fail (iter != NULL, FALSE);
+        tokens = (GibbonCLIPToken *) self->priv->tokens->data;
+        num_tokens = self->priv->tokens->len;
 
         /*
          * Skip GIBBON_CLIP_MOVE and the player name.
          */
-        iter = iter->next;
-        g_return_val_if_fail (iter != NULL, FALSE);
-        iter = iter->next;
-        g_return_val_if_fail (iter != NULL, FALSE);
-
-        for (i = 0; iter != NULL && i < 4; ++i, iter = iter->next) {
-                g_return_val_if_fail (iter != NULL, FALSE);
-                vfrom = (GValue *) iter->data;
-                from = g_value_get_int64 (vfrom);
+        g_return_val_if_fail (num_tokens >= 2, FALSE);
 
-                iter = iter->next;
-                g_return_val_if_fail (iter != NULL, FALSE);
-                vto = (GValue *) iter->data;
-                to = g_value_get_int64 (vto);
+        for (i = 2; i < num_tokens && i < 10; i += 2) {
+                g_return_val_if_fail (i + 1 < num_tokens, FALSE);
+                from = tokens[i].v.i;
+                to = tokens[i + 1].v.i;
 
                 if (from < 0 || to < 0)
                         return FALSE;
 
                 if (from == 0 && to > 18) {
                         from = 25;
-                        g_value_set_int64 (vfrom, 25);
+                        tokens[i].v.i = 25;
                 }
                 if (to == 0 && from > 18) {
                         to = 25;
-                        g_value_set_int64 (vto, 25);
+                        tokens[i + 1].v.i = 25;
                 }
                 if (from == to)
                         return FALSE;
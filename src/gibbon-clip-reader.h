@@ -27,6 +27,8 @@
 #include <glib.h>
 #include <glib-object.h>
 
+#include "gibbon-position.h"
+
 #define GIBBON_TYPE_CLIP_READER \
         (gibbon_clip_reader_get_type ())
 #define GIBBON_CLIP_READER(obj) \
@@ -144,6 +146,117 @@ enum GibbonCLIPErrorCode {
         GIBBON_CLIP_ERROR_SAVED_CORRUPT = 4
 };
 
+/**
+ * GibbonCLIPWhoInfo:
+ * @who: The player's name.
+ * @opponent: The opponent or the empty string.
+ * @watching: The player watched or the empty string.
+ * @ready: %TRUE if ready to play.
+ * @away: %TRUE if away.
+ * @rating: The rating.
+ * @experience: The experience.
+ * @idle: Idle time in seconds.
+ * @login: Login time as a Unix timestamp.
+ * @hostname: The host the player logged in from.
+ * @client: The raw client string.
+ * @email: The email address.
+ *
+ * Typed result for %GIBBON_CLIP_WHO_INFO.
+ */
+typedef struct _GibbonCLIPWhoInfo GibbonCLIPWhoInfo;
+struct _GibbonCLIPWhoInfo {
+        const gchar *who;
+        const gchar *opponent;
+        const gchar *watching;
+        gboolean ready;
+        gboolean away;
+        gdouble rating;
+        gint64 experience;
+        gint64 idle;
+        gint64 login;
+        const gchar *hostname;
+        const gchar *client;
+        const gchar *email;
+};
+
+/**
+ * GibbonCLIPChat:
+ * @sender: The sender of the message.
+ * @message: The message.
+ *
+ * Typed result for %GIBBON_CLIP_SAYS, %GIBBON_CLIP_SHOUTS,
+ * %GIBBON_CLIP_WHISPERS, %GIBBON_CLIP_KIBITZES, and %GIBBON_CLIP_ALERTS.
+ */
+typedef struct _GibbonCLIPChat GibbonCLIPChat;
+struct _GibbonCLIPChat {
+        const gchar *sender;
+        const gchar *message;
+};
+
+/**
+ * GibbonCLIPBoard:
+ * @position: The position.
+ * @direction: %TRUE if the player moves from 24 to 1.
+ *
+ * Typed result for %GIBBON_CLIP_BOARD.
+ */
+typedef struct _GibbonCLIPBoard GibbonCLIPBoard;
+struct _GibbonCLIPBoard {
+        const GibbonPosition *position;
+        gboolean direction;
+};
+
+/**
+ * GibbonCLIPRolls:
+ * @who: The player that rolled, possibly "You".
+ * @dice: The dice.
+ *
+ * Typed result for %GIBBON_CLIP_ROLLS.
+ */
+typedef struct _GibbonCLIPRolls GibbonCLIPRolls;
+struct _GibbonCLIPRolls {
+        const gchar *who;
+        gint dice[2];
+};
+
+/**
+ * GibbonCLIPMoves:
+ * @who: The player that moved, possibly "You".
+ * @num_movements: Number of valid elements in @movements.
+ * @movements: The checker movements.
+ *
+ * Typed result for %GIBBON_CLIP_MOVES.
+ */
+typedef struct _GibbonCLIPMoves GibbonCLIPMoves;
+struct _GibbonCLIPMoves {
+        const gchar *who;
+        guint num_movements;
+        struct {
+                gint from;
+                gint to;
+        } movements[4];
+};
+
+/**
+ * GibbonCLIPRecord:
+ * @code: The #GibbonClipCode.
+ * @u: The typed data, only valid for the codes mentioned in the
+ *     documentation of the respective structures.
+ *
+ * The result of gibbon_clip_reader_scan().
+ */
+typedef struct _GibbonCLIPRecord GibbonCLIPRecord;
+struct _GibbonCLIPRecord {
+        enum GibbonClipCode code;
+        union {
+                GibbonCLIPWhoInfo who_info;
+                GibbonCLIPChat chat;
+                GibbonCLIPBoard board;
+                GibbonCLIPRolls rolls;
+                GibbonCLIPMoves moves;
+        } u;
+};
+
 /**
  * GibbonCLIPReader:
  *
@@ -175,6 +288,9 @@ GType gibbon_clip_reader_get_type (void) G_GNUC_CONST;
 
 GibbonCLIPReader *gibbon_clip_reader_new ();
 GSList *gibbon_clip_reader_parse (GibbonCLIPReader *self, const gchar *line);
+const GibbonCLIPRecord *gibbon_clip_reader_scan (GibbonCLIPReader *self,
+                                                 const gchar *line);
+GSList *gibbon_clip_reader_get_values (const GibbonCLIPReader *self);
 void gibbon_clip_reader_free_result (GibbonCLIPReader *self, GSList *values);
 gboolean gibbon_clip_reader_get_int64 (const GibbonCLIPReader *self,
                                        GSList **iter, gint64 *i);
@@ -68,9 +68,16 @@ struct _GibbonConnectionPrivate {
         
         gchar *error;
         
+        /*
+         * Data from the server is read directly into in_buffer.  The
+         * unprocessed input is between in_start and in_end and is always
+         * terminated by a null byte.
+         */
 #define GIBBON_CONNECTION_CHUNK_SIZE 8192
-        guchar read_buf[GIBBON_CONNECTION_CHUNK_SIZE];
         gchar *in_buffer;
+        gsize in_size;
+        gsize in_start;
+        gsize in_end;
         GList *out_queue;
         gboolean out_ready;
         
@@ -95,6 +102,9 @@ static void gibbon_connection_handle_output (GOutputStream *stream,
                                              GAsyncResult *result,
                                              GibbonConnection *self);
 static void gibbon_connection_send_chunk (GibbonConnection *self);
+static gchar *gibbon_connection_reserve_input (GibbonConnection *self);
+static void gibbon_connection_clear_input (GibbonConnection *self);
+static gsize gibbon_connection_filter_input (gchar *data, gsize length);
 static void gibbon_connection_on_connect (GObject *src_object,
                                           GAsyncResult *res,
                                           gpointer _self);
@@ -123,7 +133,10 @@ gibbon_connection_init (GibbonConnection *conn)
         
         conn->priv->error = NULL;
         
-        conn->priv->in_buffer = g_strconcat ("", NULL);
+        conn->priv->in_size = 2 * GIBBON_CONNECTION_CHUNK_SIZE;
+        conn->priv->in_buffer = g_malloc (conn->priv->in_size);
+        conn->priv->in_start = 0;
+        gibbon_connection_clear_input (conn);
         
         conn->priv->out_queue = NULL;
         conn->priv->out_ready = FALSE;
@@ -356,20 +369,19 @@ gibbon_connection_handle_input (GInputStream *input_stream,
                                 GAsyncResult *result,
                                 GibbonConnection *self)
 {
-        gsize bytes_read;
+        gssize bytes_read;
         GError *error = NULL;
         gchar *pretty_login;
         gchar *package;
         gint clip_code;
-        gchar *head;
+        gchar *data;
         gchar *ptr;
         gchar *line_end;
-        gchar *console_output;
+        gchar *pending;
         GibbonServerConsole *console;
         GibbonSession *session;
         GibbonApp *app;
-        gsize i, eaten = 0;
-        
+
         bytes_read = g_input_stream_read_finish (input_stream, result, &error);
         if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED) 
             || !self || !GIBBON_IS_CONNECTION (self))
@@ -395,67 +407,50 @@ gibbon_connection_handle_input (GInputStream *input_stream,
                 return;
         }
         
-        /* The input fifo is not exactly efficient.  */
-        head = self->priv->in_buffer;
-        self->priv->read_buf[bytes_read] = 0;
-
         /*
          * Filter out all 8 bit data, for example telnet echo will
          * and echo wont.
          */
-        for (i = 0; i < bytes_read; ++i) {
-                if (self->priv->read_buf[i] < '\n'
-                    || (self->priv->read_buf[i] > '\n' 
-                        && self->priv->read_buf[i] < ' ')
-                    || self->priv->read_buf[i] >= 127) {
-                        ++eaten;
-                } else if (eaten) {
-                        self->priv->read_buf[i - eaten] = 
-                                self->priv->read_buf[i];
-                }
-        }
-        self->priv->read_buf[i - eaten] = 0;
-
-        self->priv->in_buffer = g_strconcat (head,
-                                             self->priv->read_buf,
-                                             NULL);
-        g_free (head);
-
-        #ifndef HAVE_INDEX
-#define index(str, c) memchr (str, c, strlen (str))
-#endif
+        data = self->priv->in_buffer + self->priv->in_end;
+        self->priv->in_end += gibbon_connection_filter_input (data,
+                                                              bytes_read);
+        self->priv->in_buffer[self->priv->in_end] = 0;
 
         console = gibbon_app_get_server_console (app);
 
-        ptr = self->priv->in_buffer;
-        while ((line_end = index (ptr, '\012')) != NULL) {
+        /*
+         * The lines are handed to the session in place.  Our handler may
+         * destroy the connection.  The reference keeps the object and the
+         * buffer alive until we are done with them.
+         */
+        g_object_ref (self);
+
+        /* A partial line from the last read cannot contain a newline.  */
+        ptr = self->priv->in_buffer + self->priv->in_start;
+        while ((line_end = memchr (data, '\012',
+                                   self->priv->in_buffer + self->priv->in_end
+                                   - data)) != NULL) {
                 *line_end = 0;
                 if (line_end > ptr && *(line_end - 1) == '\015')
                         *(line_end - 1) = 0;
+                self->priv->in_start = line_end + 1 - self->priv->in_buffer;
                 if (self->priv->state != WAIT_LOGIN_PROMPT) {
                         session = self->priv->session;
-                        /*
-                         * We need a copy of string because it could be
-                         * destroyed during handling the server output.
-                         */
-                        console_output = g_alloca (1 + strlen (ptr));
-                        strcpy (console_output, ptr);
                         if (self->priv->debug_input)
                                 g_printerr ("<<< %s\n", ptr);
                         clip_code = gibbon_session_process_server_line (session,
                                                                         ptr);
                         if (clip_code >= 0) {
                                 gibbon_server_console_print_output (console,
-                                                                console_output);
+                                                                    ptr);
                         } else {
                                 gibbon_server_console_print_info (console,
-                                                                console_output);
+                                                                  ptr);
                         }
-                        /*
-                         * Our handler may have destroyed the connection.
-                         */
-                        if (!GIBBON_IS_CONNECTION (self))
+                        if (gibbon_app_get_connection (app) != self) {
+                                g_object_unref (self);
                                 return;
+                        }
                         if (clip_code == GIBBON_CLIP_WELCOME) {
                                 self->priv->state = WAIT_COMMANDS;
                                 g_signal_emit (self,
@@ -467,19 +462,18 @@ gibbon_connection_handle_input (GInputStream *input_stream,
                 } else {
                         gibbon_server_console_print_info (console, ptr);
                 }
-                ptr = line_end + 1;
+                ptr = data = self->priv->in_buffer + self->priv->in_start;
         }
 
-        if (ptr != self->priv->in_buffer) {
-                head = self->priv->in_buffer;
-                self->priv->in_buffer = g_strdup (ptr);
-                g_free (head);
-        }
+        if (self->priv->in_start == self->priv->in_end)
+                gibbon_connection_clear_input (self);
+
+        pending = self->priv->in_buffer + self->priv->in_start;
 
         if (self->priv->state == WAIT_LOGIN_PROMPT) {
-                if (g_strcmp0 (self->priv->in_buffer, "login: ") == 0) {
+                if (g_strcmp0 (pending, "login: ") == 0) {
                         gibbon_server_console_print_raw (console,
-                                                         self->priv->in_buffer);
+                                                         pending);
                         self->priv->out_ready = TRUE;
                         if (self->priv->guest_login) {
                                 gibbon_connection_queue_command (self, FALSE,
@@ -498,8 +492,7 @@ gibbon_connection_handle_input (GInputStream *input_stream,
                                                                  self->priv->password);
                                 g_free (package);
                         }
-                        g_free (self->priv->in_buffer);
-                        self->priv->in_buffer = g_strdup ("");
+                        gibbon_connection_clear_input (self);
                         self->priv->state = WAIT_WELCOME;
                         if (self->priv->guest_login) {
                                 pretty_login = g_strdup ("guest");
@@ -516,39 +509,37 @@ gibbon_connection_handle_input (GInputStream *input_stream,
                         g_free (pretty_login);
                 }
         } else if (self->priv->state == WAIT_WELCOME) {
-                if (strcmp (self->priv->in_buffer, "login: ") == 0) {
+                if (strcmp (pending, "login: ") == 0) {
                         gibbon_server_console_print_output (console, "login: ");
                         g_signal_emit (self, signals[NETWORK_ERROR], 0,
                                        _("Authentication failed."));
+                        g_object_unref (self);
                         return;
                 }
         }
 
         if (self->priv->guest_login) {
-                if ('>' == self->priv->in_buffer[0]
-                    && ' ' == self->priv->in_buffer[1]
-                    && !self->priv->in_buffer[2]) {
+                if ('>' == pending[0]
+                    && ' ' == pending[1]
+                    && !pending[2]) {
                         gibbon_server_console_print_raw (console,
-                                                         self->priv->in_buffer);
+                                                         pending);
                         self->priv->out_ready = TRUE;
-                        g_free (self->priv->in_buffer);
-                        self->priv->in_buffer = g_strdup ("");
+                        gibbon_connection_clear_input (self);
                         gibbon_session_handle_prompt (self->priv->session);
                 } else if (0 == g_strcmp0 ("Please give your password: ",
-                                           self->priv->in_buffer)) {
+                                           pending)) {
                         gibbon_server_console_print_raw (console,
-                                                         self->priv->in_buffer);
+                                                         pending);
                         self->priv->out_ready = TRUE;
-                        g_free (self->priv->in_buffer);
-                        self->priv->in_buffer = g_strdup ("");
+                        gibbon_connection_clear_input (self);
                         gibbon_session_handle_pw_prompt (self->priv->session);
                 } else if (0 == g_strcmp0 ("Please retype your password: ",
-                                           self->priv->in_buffer)) {
+                                           pending)) {
                         gibbon_server_console_print_raw (console,
-                                                         self->priv->in_buffer);
+                                                         pending);
                         self->priv->out_ready = TRUE;
-                        g_free (self->priv->in_buffer);
-                        self->priv->in_buffer = g_strdup ("");
+                        gibbon_connection_clear_input (self);
                         gibbon_session_handle_pw_prompt (self->priv->session);
                 }
         }
@@ -556,20 +547,88 @@ gibbon_connection_handle_input (GInputStream *input_stream,
         /*
          * Our handler may have destroyed the connection.
          */
-        if (!gibbon_app_get_connection (app))
+        if (!gibbon_app_get_connection (app)) {
+                g_object_unref (self);
                 return;
+        }
 
         self->priv->read_cancellable = g_cancellable_new ();
         g_input_stream_read_async (input_stream,
-                                   self->priv->read_buf,
-                                   sizeof self->priv->read_buf,
+                                   gibbon_connection_reserve_input (self),
+                                   GIBBON_CONNECTION_CHUNK_SIZE,
                                    G_PRIORITY_DEFAULT,
                                    self->priv->read_cancellable,
                                    (GAsyncReadyCallback)
                                    gibbon_connection_handle_input,
                                    self);
 
-        return;
+        g_object_unref (self);
+}
+
+/*
+ * Makes room for one chunk after the pending input.  Only the partial
+ * line left over from the last read is moved to the front of the buffer.
+ */
+static gchar *
+gibbon_connection_reserve_input (GibbonConnection *self)
+{
+        gsize pending = self->priv->in_end - self->priv->in_start;
+        gsize size = self->priv->in_size;
+
+        if (self->priv->in_start) {
+                memmove (self->priv->in_buffer,
+                         self->priv->in_buffer + self->priv->in_start,
+                         pending + 1);
+                self->priv->in_start = 0;
+                self->priv->in_end = pending;
+        }
+
+        /* One more byte for the terminating null byte.  */
+        while (size - self->priv->in_end < GIBBON_CONNECTION_CHUNK_SIZE + 1)
+                size <<= 1;
+        if (size != self->priv->in_size) {
+                self->priv->in_buffer = g_realloc (self->priv->in_buffer, size);
+                self->priv->in_size = size;
+        }
+
+        return self->priv->in_buffer + self->priv->in_end;
+}
+
+static void
+gibbon_connection_clear_input (GibbonConnection *self)
+{
+        /* Pointers to the pending input now see an empty string.  */
+        self->priv->in_buffer[self->priv->in_start] = 0;
+        self->priv->in_buffer[0] = 0;
+        self->priv->in_start = self->priv->in_end = 0;
+}
+
+/*
+ * Removes control characters except for a linefeed, and all 8 bit data.
+ * Returns the new length.
+ */
+static gsize
+gibbon_connection_filter_input (gchar *data, gsize length)
+{
+        guchar *src = (guchar *) data;
+        guchar *end = src + length;
+        guchar *dest;
+
+#define GIBBON_CONNECTION_IS_CLEAN(c) \
+        ((c) >= ' ' ? (c) < 127 : (c) == '\n')
+
+        /* Normally, nothing has to be removed.  */
+        while (src < end && GIBBON_CONNECTION_IS_CLEAN (*src))
+                ++src;
+
+        for (dest = src; src < end; ++src) {
+                if (GIBBON_CONNECTION_IS_CLEAN (*src))
+                        *dest++ = *src;
+        }
+
+#undef GIBBON_CONNECTION_IS_CLEAN
+
+        return dest - (guchar *) data;
 }
 
 static void
@@ -675,8 +734,8 @@ gibbon_connection_on_connect (GObject *src_object,
         input_stream = g_io_stream_get_input_stream (
                         G_IO_STREAM (self->priv->socket_connection));
         g_input_stream_read_async (input_stream,
-                                   self->priv->read_buf,
-                                   sizeof self->priv->read_buf,
+                                   gibbon_connection_reserve_input (self),
+                                   GIBBON_CONNECTION_CHUNK_SIZE,
                                    G_PRIORITY_DEFAULT,
                                    self->priv->read_cancellable,
                                    (GAsyncReadyCallback)
@@ -21,6 +21,7 @@
 # include <config.h>
 #endif
 
+#include <errno.h>
 #include <locale.h>
 #include <string.h>
 
@@ -28,6 +29,8 @@
 #include <gio/gio.h>
 #include <gdk/gdk.h>
 
+#include <libgsgf/gsgf.h>
+
 #include "gibbon-gmd-reader.h"
 #include "gibbon-gmd-writer.h"
 #include "gibbon-sgf-reader.h"
@@ -45,11 +48,27 @@ typedef enum {
         GIBBON_CONVERT_FORMAT_JELLY_FISH = 4
 } GibbonConvertFormat;
 
+typedef struct _GibbonConvertJob GibbonConvertJob;
+struct _GibbonConvertJob {
+        gchar *input;
+        gchar *output;
+        GibbonConvertFormat format;
+
+        /* Error messages in reverse order.  */
+        GSList *messages;
+        gboolean done;
+        gboolean success;
+};
+
 static gchar *program_name;
 static gchar *input_filename = NULL;
 static gchar *output_filename = NULL;
 static gchar *from_format = NULL;
 static gchar *to_format = NULL;
+static gchar *output_directory = NULL;
+static gchar *files_from = NULL;
+static gint num_jobs = 0;
+static GPtrArray *input_names = NULL;
 
 GibbonConvertFormat input_format = GIBBON_CONVERT_FORMAT_UNKNOWN;
 GibbonConvertFormat output_format = GIBBON_CONVERT_FORMAT_UNKNOWN;
@@ -76,6 +95,21 @@ static const GOptionEntry options[] =
                   N_("output format (omit for automatic detection)"),
                   N_("FORMAT")
                 },
+                { "output-directory", 'd', 0, G_OPTION_ARG_FILENAME,
+                  &output_directory,
+                  N_("batch mode: convert all input files and directories"
+                     " into DIRECTORY"),
+                  N_("DIRECTORY")
+                },
+                { "files-from", 'T', 0, G_OPTION_ARG_FILENAME, &files_from,
+                  N_("batch mode: read names of input files from FILENAME,"
+                     " one per line"),
+                  N_("FILENAME")
+                },
+                { "jobs", 'j', 0, G_OPTION_ARG_INT, &num_jobs,
+                  N_("number of files to convert in parallel in batch mode"),
+                  N_("N")
+                },
                 { "debug", 'D', 0, G_OPTION_ARG_STRING, &debug,
                   N_("enable various debugging flags"),
                   NULL
@@ -98,6 +132,20 @@ static void usage_error ();
 static gboolean parse_command_line (int argc, char *argv[]);
 static GibbonConvertFormat guess_format_from_id (const gchar *id);
 static GibbonConvertFormat guess_format_from_filename (const gchar *name);
+static GibbonConvertFormat format_from_filename (const gchar *name);
+static const gchar *format_extension (GibbonConvertFormat format);
+static GibbonMatchReader *create_reader (GibbonConvertFormat format,
+                                         GibbonMatchReaderErrorFunc yyerror,
+                                         gpointer user_data);
+static GibbonMatchWriter *create_writer (GibbonConvertFormat format);
+static int convert_batch (void);
+static gboolean read_file_list (GPtrArray *names);
+static void add_jobs (GPtrArray *jobs, const gchar *path,
+                      const gchar *relative, gboolean scanned);
+static void convert_job (GibbonConvertJob *job, GAsyncQueue *results);
+static void convert_job_error (GibbonConvertJob *job, const gchar *msg);
+static void report_job (const GibbonConvertJob *job, guint done, guint total);
+static void free_job (GibbonConvertJob *job);
 
 int
 main (int argc, char *argv[])
@@ -132,6 +180,17 @@ main (int argc, char *argv[])
         if (debug)
                 g_setenv ("GIBBON_DEBUG", debug, TRUE);
 
+        if (!g_thread_supported ()) {
+#if (GLIB_MAJOR_VERSION < 2 \
+     || (GLIB_MAJOR_VERSION == 2 && GLIB_MINOR_VERSION < 32))
+                g_thread_init (NULL);
+#endif
+                gdk_threads_init ();
+        }
+
+        if (output_directory)
+                return convert_batch ();
+
         if (from_format) {
                 input_format = guess_format_from_id (from_format);
                 if (!input_format)
@@ -166,36 +225,9 @@ main (int argc, char *argv[])
                 return 1;
         }
 
-        if (!g_thread_supported ()) {
-#if (GLIB_MAJOR_VERSION < 2 \
-     || (GLIB_MAJOR_VERSION == 2 && GLIB_MINOR_VERSION < 32))
-                g_thread_init (NULL);
-#endif
-                gdk_threads_init ();
-        }
-
-        switch (input_format) {
-        case GIBBON_CONVERT_FORMAT_UNKNOWN:
+        reader = create_reader (input_format, NULL, NULL);
+        if (!reader)
                 return 1;
-        case GIBBON_CONVERT_FORMAT_SGF:
-                reader = GIBBON_MATCH_READER (gibbon_sgf_reader_new (NULL,
-                                                                     NULL));
-                break;
-        case GIBBON_CONVERT_FORMAT_GMD:
-                reader = GIBBON_MATCH_READER (gibbon_gmd_reader_new (NULL,
-                                                                     NULL));
-                break;
-        case GIBBON_CONVERT_FORMAT_JAVA_FIBS:
-                reader =
-                   GIBBON_MATCH_READER (gibbon_java_fibs_reader_new (NULL,
-                                                                     NULL));
-                break;
-        case GIBBON_CONVERT_FORMAT_JELLY_FISH:
-                reader =
-                   GIBBON_MATCH_READER (gibbon_jelly_fish_reader_new (NULL,
-                                                                      NULL));
-                break;
-        }
 
         match = gibbon_match_reader_parse (reader, input_filename);
         if (!match)
@@ -208,22 +240,10 @@ main (int argc, char *argv[])
                 return 1;
         }
 
-        switch (output_format) {
-        case GIBBON_CONVERT_FORMAT_UNKNOWN:
+        writer = create_writer (output_format);
+        if (!writer) {
                 g_object_unref (match);
                 return 1;
-        case GIBBON_CONVERT_FORMAT_SGF:
-                writer = GIBBON_MATCH_WRITER (gibbon_sgf_writer_new ());
-                break;
-        case GIBBON_CONVERT_FORMAT_GMD:
-                writer = GIBBON_MATCH_WRITER (gibbon_gmd_writer_new ());
-                break;
-        case GIBBON_CONVERT_FORMAT_JAVA_FIBS:
-                writer = GIBBON_MATCH_WRITER (gibbon_java_fibs_writer_new ());
-                break;
-        case GIBBON_CONVERT_FORMAT_JELLY_FISH:
-                writer = GIBBON_MATCH_WRITER (gibbon_jelly_fish_writer_new ());
-                break;
         }
 
         if (output_filename) {
@@ -318,6 +338,7 @@ parse_command_line (int argc, char *argv[])
         GError *error = NULL;
         gchar *description;
         gchar *alt_usage;
+        gint i;
 
         context = g_option_context_new (_("- Gibbon match converter"));
         g_option_context_set_summary (context, _("Convert popular backgammon"
@@ -325,9 +346,11 @@ parse_command_line (int argc, char *argv[])
         alt_usage = g_strdup_printf (
                         _("Alternative usages:\n"
                           " %s [OPTION ...] INPUTFILE\n"
-                          " %s [OPTION ...] INPUTFILE OUTPUTFILE\n"),
-                          program_name, program_name);
-        description = g_strdup_printf ("%s\n%s\n%s\n%s\n",
+                          " %s [OPTION ...] INPUTFILE OUTPUTFILE\n"
+                          " %s [OPTION ...] --output-directory=DIRECTORY"
+                          " INPUT...\n"),
+                          program_name, program_name, program_name);
+        description = g_strdup_printf ("%s\n%s\n%s\n%s\n%s\n",
                         alt_usage,
                         _("Recognized values for FORMAT are 'SGF' for"
                           " the Smart Game format (used by\n"
@@ -340,6 +363,11 @@ parse_command_line (int argc, char *argv[])
                           " SGF, '.mat' for Jellyfish, '.gmd' for the"
                           " Gibbon match format, and\n"
                           "'.match' for the internal format of JavaFIBS.\n"),
+                        _("In batch mode, every INPUT can be a file or a"
+                          " directory that is searched recursively for"
+                          " match files.\n"
+                          "The converted files are written to DIRECTORY,"
+                          " keeping the directory structure.\n"),
                         _("Report bugs at"
                           " <https://savannah.nongnu.org/projects/gibbon>!"));
         g_free (alt_usage);
@@ -358,6 +386,25 @@ parse_command_line (int argc, char *argv[])
                 return FALSE;
         }
 
+        if (files_from && !output_directory) {
+                usage_error (_("The option `--files-from' requires the option"
+                               " `--output-directory'."));
+                return FALSE;
+        }
+
+        if (output_directory) {
+                if (input_filename || output_filename) {
+                        usage_error (_("The options `--input-file' and"
+                                       " `--output-file' cannot be used in"
+                                       " batch mode."));
+                        return FALSE;
+                }
+                input_names = g_ptr_array_new_with_free_func (g_free);
+                for (i = 1; i < argc; ++i)
+                        g_ptr_array_add (input_names, g_strdup (argv[i]));
+                return TRUE;
+        }
+
         if (argc == 2) {
                 if (input_filename) {
                         usage_error (_("Either use the option `--input-file'"
@@ -459,29 +506,491 @@ guess_format_from_id (const gchar *id)
 static GibbonConvertFormat
 guess_format_from_filename (const gchar *filename)
 {
-        const gchar *last_dot;
+        GibbonConvertFormat format;
         gchar *msg;
 
+        format = format_from_filename (filename);
+        if (format)
+                return format;
+
+        msg = g_strdup_printf (_("Cannot guess format of `%s'!"), filename);
+        usage_error (msg);
+        g_free (msg);
+        return GIBBON_CONVERT_FORMAT_UNKNOWN;
+}
+
+static GibbonConvertFormat
+format_from_filename (const gchar *filename)
+{
+        const gchar *last_dot;
+
         last_dot = rindex (filename, '.');
 
-        if (!last_dot) {
-                msg = g_strdup_printf (_("Cannot guess format of `%s'!"),
-                                       filename);
-                usage_error (msg);
-                g_free (msg);
+        if (!last_dot)
                 return GIBBON_CONVERT_FORMAT_UNKNOWN;
-        } else if (0 == g_ascii_strcasecmp (".sgf", last_dot)) {
+        else if (0 == g_ascii_strcasecmp (".sgf", last_dot))
                 return GIBBON_CONVERT_FORMAT_SGF;
-        } else if (0 == g_ascii_strcasecmp (".gmd", last_dot)) {
+        else if (0 == g_ascii_strcasecmp (".gmd", last_dot))
                 return GIBBON_CONVERT_FORMAT_GMD;
-        } else if (0 == g_ascii_strcasecmp (".match", last_dot)) {
+        else if (0 == g_ascii_strcasecmp (".match", last_dot))
                 return GIBBON_CONVERT_FORMAT_JAVA_FIBS;
-        } else if (0 == g_ascii_strcasecmp (".mat", last_dot)) {
+        else if (0 == g_ascii_strcasecmp (".mat", last_dot))
                 return GIBBON_CONVERT_FORMAT_JELLY_FISH;
-        }
 
-        msg = g_strdup_printf (_("Cannot guess format of `%s'!"), filename);
-        usage_error (msg);
-        g_free (msg);
         return GIBBON_CONVERT_FORMAT_UNKNOWN;
 }
+
+static const gchar *
+format_extension (GibbonConvertFormat format)
+{
+        switch (format) {
+        case GIBBON_CONVERT_FORMAT_UNKNOWN:
+                break;
+        case GIBBON_CONVERT_FORMAT_SGF:
+                return ".sgf";
+        case GIBBON_CONVERT_FORMAT_GMD:
+                return ".gmd";
+        case GIBBON_CONVERT_FORMAT_JAVA_FIBS:
+                return ".match";
+        case GIBBON_CONVERT_FORMAT_JELLY_FISH:
+                return ".mat";
+        }
+
+        return "";
+}
+
+static GibbonMatchReader *
+create_reader (GibbonConvertFormat format, GibbonMatchReaderErrorFunc yyerror,
+               gpointer user_data)
+{
+        switch (format) {
+        case GIBBON_CONVERT_FORMAT_UNKNOWN:
+                break;
+        case GIBBON_CONVERT_FORMAT_SGF:
+                return GIBBON_MATCH_READER (gibbon_sgf_reader_new (yyerror,
+                                                                   user_data));
+        case GIBBON_CONVERT_FORMAT_GMD:
+                return GIBBON_MATCH_READER (gibbon_gmd_reader_new (yyerror,
+                                                                   user_data));
+        case GIBBON_CONVERT_FORMAT_JAVA_FIBS:
+                return GIBBON_MATCH_READER (
+                        gibbon_java_fibs_reader_new (yyerror, user_data));
+        case GIBBON_CONVERT_FORMAT_JELLY_FISH:
+                return GIBBON_MATCH_READER (
+                        gibbon_jelly_fish_reader_new (yyerror, user_data));
+        }
+
+        return NULL;
+}
+
+static GibbonMatchWriter *
+create_writer (GibbonConvertFormat format)
+{
+        switch (format) {
+        case GIBBON_CONVERT_FORMAT_UNKNOWN:
+                break;
+        case GIBBON_CONVERT_FORMAT_SGF:
+                return GIBBON_MATCH_WRITER (gibbon_sgf_writer_new ());
+        case GIBBON_CONVERT_FORMAT_GMD:
+                return GIBBON_MATCH_WRITER (gibbon_gmd_writer_new ());
+        case GIBBON_CONVERT_FORMAT_JAVA_FIBS:
+                return GIBBON_MATCH_WRITER (gibbon_java_fibs_writer_new ());
+        case GIBBON_CONVERT_FORMAT_JELLY_FISH:
+                return GIBBON_MATCH_WRITER (gibbon_jelly_fish_writer_new ());
+        }
+
+        return NULL;
+}
+
+static int
+convert_batch (void)
+{
+        GPtrArray *jobs;
+        GHashTable *outputs;
+        GThreadPool *pool;
+        GAsyncQueue *results;
+        GibbonConvertJob *job;
+        const GibbonConvertJob *other;
+        GError *error = NULL;
+        guint i, total, pending = 0, done = 0, failed = 0;
+        gchar *msg;
+
+        if (from_format) {
+                input_format = guess_format_from_id (from_format);
+                if (!input_format)
+                        return 1;
+        }
+
+        if (!to_format) {
+                usage_error (_("The option `--to-format' is mandatory in"
+                               " batch mode."));
+                return 1;
+        }
+        output_format = guess_format_from_id (to_format);
+        if (!output_format)
+                return 1;
+
+        if (input_format == output_format) {
+                usage_error (_("The output format is the same as the input"
+                               " format."));
+                return 1;
+        }
+
+        if (files_from && !read_file_list (input_names))
+                return 1;
+
+        if (!input_names->len) {
+                usage_error (_("No input files specified!"));
+                return 1;
+        }
+
+        jobs = g_ptr_array_new_with_free_func ((GDestroyNotify) free_job);
+        for (i = 0; i < input_names->len; ++i)
+                add_jobs (jobs, g_ptr_array_index (input_names, i), NULL,
+                          FALSE);
+        total = jobs->len;
+
+        /*
+         * Two input files must not be converted into the same output
+         * file.  The first one wins.
+         */
+        outputs = g_hash_table_new (g_str_hash, g_str_equal);
+        for (i = 0; i < total; ++i) {
+                job = g_ptr_array_index (jobs, i);
+                if (job->done)
+                        continue;
+                other = g_hash_table_lookup (outputs, job->output);
+                if (other) {
+                        msg = g_strdup_printf (_("Output file `%s' is"
+                                                 " already written for"
+                                                 " `%s'!"),
+                                               job->output, other->input);
+                        job->messages = g_slist_prepend (job->messages, msg);
+                        job->done = TRUE;
+                        continue;
+                }
+                g_hash_table_insert (outputs, job->output, job);
+        }
+        g_hash_table_destroy (outputs);
+
+        if (num_jobs <= 0) {
+#if GLIB_CHECK_VERSION (2, 36, 0)
+                num_jobs = g_get_num_processors ();
+#else
+                num_jobs = 2;
+#endif
+        }
+
+        gsgf_threads_init ();
+
+        results = g_async_queue_new ();
+        pool = g_thread_pool_new ((GFunc) convert_job, results, num_jobs, TRUE,
+                                  &error);
+        if (!pool) {
+                g_printerr (_("%s: Error creating new thread: %s!\n"),
+                            program_name, error->message);
+                g_error_free (error);
+                g_async_queue_unref (results);
+                g_ptr_array_free (jobs, TRUE);
+                return 1;
+        }
+
+        for (i = 0; i < total; ++i) {
+                job = g_ptr_array_index (jobs, i);
+                if (job->done) {
+                        report_job (job, ++done, total);
+                } else {
+                        g_thread_pool_push (pool, job, NULL);
+                        ++pending;
+                }
+        }
+
+        /* Results arrive in the order in which the workers finish.  */
+        while (pending--) {
+                job = g_async_queue_pop (results);
+                report_job (job, ++done, total);
+        }
+
+        g_thread_pool_free (pool, FALSE, TRUE);
+        g_async_queue_unref (results);
+
+        for (i = 0; i < total; ++i) {
+                job = g_ptr_array_index (jobs, i);
+                if (!job->success)
+                        ++failed;
+        }
+
+        g_print (_("%u of %u file(s) converted, %u failed.\n"),
+                 total - failed, total, failed);
+        if (failed) {
+                g_printerr (_("%s: The following files could not be"
+                              " converted:\n"), program_name);
+                for (i = 0; i < total; ++i) {
+                        job = g_ptr_array_index (jobs, i);
+                        if (!job->success)
+                                g_printerr ("  %s\n", job->input);
+                }
+        }
+
+        g_ptr_array_free (jobs, TRUE);
+
+        return failed ? 1 : 0;
+}
+
+static gboolean
+read_file_list (GPtrArray *names)
+{
+        GIOChannel *channel;
+        GIOStatus status;
+        GError *error = NULL;
+        gchar *line;
+        gsize terminator;
+
+        if (0 == g_strcmp0 ("-", files_from)) {
+#ifdef G_OS_WIN32
+                channel = g_io_channel_win32_new_fd (0);
+#else
+                channel = g_io_channel_unix_new (0);
+#endif
+        } else {
+                channel = g_io_channel_new_file (files_from, "r", &error);
+                if (!channel) {
+                        g_printerr (_("%s: Error reading `%s': %s!\n"),
+                                    program_name, files_from,
+                                    error->message);
+                        g_error_free (error);
+                        return FALSE;
+                }
+        }
+
+        /* Filenames are not necessarily UTF-8.  */
+        (void) g_io_channel_set_encoding (channel, NULL, NULL);
+
+        while (G_IO_STATUS_NORMAL
+               == (status = g_io_channel_read_line (channel, &line, NULL,
+                                                    &terminator, &error))) {
+                line[terminator] = 0;
+                if (*line)
+                        g_ptr_array_add (names, line);
+                else
+                        g_free (line);
+        }
+        g_io_channel_unref (channel);
+
+        if (status == G_IO_STATUS_ERROR) {
+                g_printerr (_("%s: Error reading `%s': %s!\n"),
+                            program_name, files_from, error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+static void
+add_jobs (GPtrArray *jobs, const gchar *path, const gchar *relative,
+          gboolean scanned)
+{
+        GibbonConvertJob *job;
+        GDir *dir;
+        const gchar *name;
+        gchar *child;
+        gchar *subdir;
+        gchar *basename;
+        gchar *last_dot;
+        gchar *output_name;
+        GError *error = NULL;
+
+        if (g_file_test (path, G_FILE_TEST_IS_DIR)) {
+                dir = g_dir_open (path, 0, &error);
+                if (!dir) {
+                        job = g_malloc0 (sizeof *job);
+                        job->input = g_strdup (path);
+                        job->messages = g_slist_prepend (NULL,
+                                                g_strdup (error->message));
+                        job->done = TRUE;
+                        g_error_free (error);
+                        g_ptr_array_add (jobs, job);
+                        return;
+                }
+
+                /*
+                 * The contents of directories given on the command line
+                 * go directly into the output directory, subdirectories
+                 * are recreated there.
+                 */
+                if (!scanned) {
+                        subdir = NULL;
+                } else {
+                        basename = g_path_get_basename (path);
+                        if (relative)
+                                subdir = g_build_filename (relative, basename,
+                                                           NULL);
+                        else
+                                subdir = g_strdup (basename);
+                        g_free (basename);
+                }
+
+                while ((name = g_dir_read_name (dir))) {
+                        child = g_build_filename (path, name, NULL);
+                        add_jobs (jobs, child, subdir, TRUE);
+                        g_free (child);
+                }
+                g_dir_close (dir);
+                g_free (subdir);
+                return;
+        }
+
+        job = g_malloc0 (sizeof *job);
+        job->input = g_strdup (path);
+        if (input_format)
+                job->format = input_format;
+        else
+                job->format = format_from_filename (path);
+
+        /*
+         * Files found in directories are silently skipped, when they do
+         * not look like match files of the requested input format.
+         */
+        if (scanned && format_from_filename (path) != job->format) {
+                free_job (job);
+                return;
+        }
+
+        if (!job->format) {
+                job->messages = g_slist_prepend (NULL,
+                                g_strdup_printf (_("Cannot guess format of"
+                                                   " `%s'!"), path));
+                job->done = TRUE;
+                g_ptr_array_add (jobs, job);
+                return;
+        }
+
+        basename = g_path_get_basename (path);
+        last_dot = rindex (basename, '.');
+        if (last_dot && last_dot != basename)
+                *last_dot = 0;
+        output_name = g_strconcat (basename, format_extension (output_format),
+                                   NULL);
+        g_free (basename);
+
+        if (relative)
+                job->output = g_build_filename (output_directory, relative,
+                                                output_name, NULL);
+        else
+                job->output = g_build_filename (output_directory,
+                                                output_name, NULL);
+        g_free (output_name);
+
+        g_ptr_array_add (jobs, job);
+}
+
+/*
+ * Runs in one of the worker threads.  Every job gets its own reader and
+ * writer.  The readers are reentrant, so that any number of them can
+ * parse in parallel.
+ */
+static void
+convert_job (GibbonConvertJob *job, GAsyncQueue *results)
+{
+        GibbonMatchReader *reader;
+        GibbonMatchWriter *writer;
+        GibbonMatch *match;
+        GFile *file;
+        GFileOutputStream *fout;
+        GOutputStream *out;
+        GError *error = NULL;
+        gchar *directory;
+
+        reader = create_reader (job->format,
+                                (GibbonMatchReaderErrorFunc) convert_job_error,
+                                job);
+        match = gibbon_match_reader_parse (reader, job->input);
+        g_object_unref (reader);
+
+        if (!match) {
+                if (!job->messages)
+                        convert_job_error (job, _("Parse error!"));
+                goto done;
+        }
+
+        if (!gibbon_match_get_current_game (match)) {
+                convert_job_error (job, _("Empty or incomplete match file!"));
+                g_object_unref (match);
+                goto done;
+        }
+
+        directory = g_path_get_dirname (job->output);
+        if (0 != g_mkdir_with_parents (directory, 0755)) {
+                job->messages = g_slist_prepend (job->messages,
+                                g_strdup_printf (_("Error creating directory"
+                                                   " `%s': %s!"),
+                                                 directory,
+                                                 g_strerror (errno)));
+                g_free (directory);
+                g_object_unref (match);
+                goto done;
+        }
+        g_free (directory);
+
+        file = g_file_new_for_path (job->output);
+        fout = g_file_replace (file, NULL, FALSE, G_FILE_COPY_OVERWRITE,
+                               NULL, &error);
+        g_object_unref (file);
+        if (!fout) {
+                convert_job_error (job, error->message);
+                g_error_free (error);
+                g_object_unref (match);
+                goto done;
+        }
+        out = G_OUTPUT_STREAM (fout);
+
+        writer = create_writer (output_format);
+        if (!gibbon_match_writer_write_stream (writer, out, match, &error)
+            || !g_output_stream_close (out, NULL, &error)) {
+                convert_job_error (job, error->message);
+                g_error_free (error);
+        } else {
+                job->success = TRUE;
+        }
+        g_object_unref (writer);
+        g_object_unref (out);
+        g_object_unref (match);
+
+done:
+        g_async_queue_push (results, job);
+}
+
+static void
+convert_job_error (GibbonConvertJob *job, const gchar *msg)
+{
+        job->messages = g_slist_prepend (job->messages, g_strdup (msg));
+}
+
+static void
+report_job (const GibbonConvertJob *job, guint done, guint total)
+{
+        GSList *messages, *iter;
+
+        if (job->success) {
+                g_print ("[%u/%u] %s -> %s\n", done, total,
+                         job->input, job->output);
+                return;
+        }
+
+        g_print (_("[%u/%u] %s: failed\n"), done, total, job->input);
+
+        messages = g_slist_reverse (g_slist_copy (job->messages));
+        for (iter = messages; iter; iter = iter->next)
+                g_printerr ("%s: %s\n", job->input, (gchar *) iter->data);
+        g_slist_free (messages);
+}
+
+static void
+free_job (GibbonConvertJob *job)
+{
+        g_free (job->input);
+        g_free (job->output);
+        g_slist_free_full (job->messages, g_free);
+        g_free (job);
+}
@@ -29,7 +29,9 @@
 
 #include <glib.h>
 #include <glib/gi18n.h>
+#include <glib/gprintf.h>
 #include <stdarg.h>
+#include <string.h>
 #include <sqlite3.h>
 
 #include "gibbon-app.h"
@@ -45,13 +47,30 @@
 /* Differences in the minor schema version require conditional creation of
  * new tables or indexes.
  */
-#define GIBBON_DATABASE_SCHEMA_MINOR 6
+#define GIBBON_DATABASE_SCHEMA_MINOR 7
 
 /* Differences in the schema revision are for cosmetic changes that will
  * not have any impact on existing databases (case, column order, ...).
  */
 #define GIBBON_DATABASE_SCHEMA_REVISION 1
 
+/* Maximum number of rows in one multi-row INSERT.  SQLite limits the number
+ * of host parameters to 999 by default.
+ */
+#define GIBBON_DATABASE_BULK_ROWS 300
+
+/*
+ * The mapping from servers and logins to ids never changes, once the
+ * records are created.  It is therefore cached in memory.
+ */
+typedef struct _GibbonDatabaseServer GibbonDatabaseServer;
+struct _GibbonDatabaseServer {
+        guint id;
+
+        /* Login -> user id.  */
+        GHashTable *user_ids;
+};
+
 typedef struct _GibbonDatabasePrivate GibbonDatabasePrivate;
 struct _GibbonDatabasePrivate {
         sqlite3 *dbh;
@@ -86,10 +105,8 @@ struct _GibbonDatabasePrivate {
         sqlite3_stmt *update_user;
 
 #define GIBBON_DATABASE_UPDATE_RANK                                          \
-	"INSERT INTO ranks (user_id, rating, experience, date_time)" \
-	" VALUES ((SELECT id FROM users WHERE name = ? AND server_id =" \
-	"         (SELECT id FROM servers WHERE name = ? AND port = ?)), " \
-	" ?, ?, ?)"
+        "INSERT INTO ranks (user_id, rating, experience, date_time)"         \
+        " VALUES (?, ?, ?, ?)"
         sqlite3_stmt *update_rank;
 
 #define GIBBON_DATABASE_SELECT_RANK                                          \
@@ -104,26 +121,41 @@ struct _GibbonDatabasePrivate {
         "INSERT INTO activities (user_id, value, date_time) VALUES (?, ?, ?)"
         sqlite3_stmt *insert_activity;
 
-#define GIBBON_DATABASE_SELECT_ACTIVITY                                      \
-        "SELECT AVG(value), COUNT(*) FROM activities a WHERE a.user_id = ?"
-        sqlite3_stmt *select_activity;
-
 #define GIBBON_DATABASE_DELETE_ACTIVITY                                   \
-        "DELETE FROM activity WHERE id = "                                \
-        " (SELECT MAX(id) FROM activity WHERE user_id = ? AND value = ?)"
+        "DELETE FROM activities WHERE id = "                              \
+        " (SELECT MAX(id) FROM activities WHERE user_id = ? AND value = ?)"
         sqlite3_stmt *delete_activity;
 
+#define GIBBON_DATABASE_SELECT_RELIABILITY                                \
+        "SELECT value_sum, value_count FROM reliabilities WHERE user_id = ?"
+        sqlite3_stmt *select_reliability;
+
+#define GIBBON_DATABASE_CREATE_RELIABILITY                                \
+        "INSERT OR IGNORE INTO reliabilities (user_id, value_sum,"        \
+        "                                     value_count)"               \
+        " VALUES (?, 0, 0)"
+        sqlite3_stmt *create_reliability;
+
+#define GIBBON_DATABASE_UPDATE_RELIABILITY                                \
+        "UPDATE reliabilities SET value_sum = value_sum + ?,"             \
+        "                         value_count = value_count + ?"          \
+        " WHERE user_id = ?"
+        sqlite3_stmt *update_reliability;
+
 #define GIBBON_DATABASE_SELECT_IP2COUNTRY_UPDATE                           \
         "SELECT last_update FROM ip2country_update"
         sqlite3_stmt *select_ip2country_update;
 
-#define GIBBON_DATABASE_INSERT_IP2COUNTRY                                  \
-        "INSERT INTO ip2country (start_ip, end_ip, code) VALUES (?, ?, ?)"
+/* Multi-row insert of GIBBON_DATABASE_BULK_ROWS rows into the staging
+ * table, see gibbon_database_insert_ip2country_sql().
+ */
+#define GIBBON_DATABASE_INSERT_IP2COUNTRY                               \
+        "INSERT INTO ip2country_new (start_ip, end_ip, code) VALUES"
         sqlite3_stmt *insert_ip2country;
 
 #define GIBBON_DATABASE_SELECT_IP2COUNTRY                       \
-        "SELECT DISTINCT code FROM ip2country"                  \
-        " WHERE start_ip <= ? AND end_ip >= ?"
+        "SELECT start_ip, end_ip, code FROM ip2country"         \
+        " ORDER BY start_ip"
         sqlite3_stmt *select_ip2country;
 
 #define GIBBON_DATABASE_SELECT_GROUP_ID                                 \
@@ -163,12 +195,8 @@ struct _GibbonDatabasePrivate {
         sqlite3_stmt *create_relation;
 
 #define GIBBON_DATABASE_SELECT_MATCH_ID                                 \
-        "SELECT m.id FROM matches m, users u1, users u2, servers s"     \
-        " WHERE m.user_id1 = u1.id AND m.user_id2 = u2.id"              \
-        "   AND u1.server_id = s.id AND u2.server_id = s.id"            \
-        "   AND s.name = ? AND s.port = ?"                              \
-        "   AND u1.name = ? AND u2.name = ?"                            \
-        "   AND m.date_time = ?"
+        "SELECT id FROM matches"                                        \
+        " WHERE user_id1 = ? AND user_id2 = ? AND date_time = ?"
         sqlite3_stmt *select_match_id;
 
 #define GIBBON_DATABASE_CREATE_MATCH                                    \
@@ -179,8 +207,12 @@ struct _GibbonDatabasePrivate {
 
         gboolean in_transaction;
 
+        /* "hostname:port" -> GibbonDatabaseServer.  */
+        GHashTable *servers;
+
         gchar *path;
         GibbonGeoIPUpdater *geo_ip_updater;
+        GArray *geo_ip_batch;
         gboolean allow_gdk;
 };
 
@@ -189,6 +221,12 @@ struct _GibbonDatabasePrivate {
 
 G_DEFINE_TYPE (GibbonDatabase, gibbon_database, G_TYPE_OBJECT)
 
+enum gibbon_database_signals {
+        GEO_IP_UPDATED,
+        LAST_SIGNAL
+};
+static guint signals[LAST_SIGNAL] = { 0 };
+
 static GibbonDatabase *singleton = NULL;
 static gchar *last_path = NULL;
 
@@ -206,6 +244,9 @@ static gboolean gibbon_database_rollback (GibbonDatabase *self,
                                           GError **error);
 static gboolean gibbon_database_maintain (GibbonDatabase *self,
                                           GError **error);
+static gboolean gibbon_database_add_reliability (GibbonDatabase *self,
+                                                 guint user_id, gdouble value,
+                                                 gint count, GError **error);
 static gboolean gibbon_database_set_error (GibbonDatabase *self, GError **error,
                                            const gchar *msg_fmt, ...);
 static gboolean gibbon_database_sql_do (GibbonDatabase *self, GError **error,
@@ -222,6 +263,16 @@ static gboolean gibbon_database_get_statement (GibbonDatabase *self,
                                                sqlite3_stmt **stmt,
                                                const gchar *sql,
                                                GError **error);
+static guint gibbon_database_cached_id (const GibbonDatabase *self,
+                                        const gchar *hostname, guint port,
+                                        const gchar *login);
+static void gibbon_database_cache_id (GibbonDatabase *self,
+                                      const gchar *hostname, guint port,
+                                      const gchar *login, guint id);
+static void gibbon_database_server_free (GibbonDatabaseServer *server);
+static gchar *gibbon_database_insert_ip2country_sql (gsize num_rows);
+static gboolean gibbon_database_flush_geo_ip (GibbonDatabase *self,
+                                              GError **error);
 
 static void 
 gibbon_database_init (GibbonDatabase *self)
@@ -241,8 +292,10 @@ gibbon_database_init (GibbonDatabase *self)
         self->priv->update_rank = NULL;
         self->priv->select_rank = NULL;
         self->priv->insert_activity = NULL;
-        self->priv->select_activity = NULL;
         self->priv->delete_activity = NULL;
+        self->priv->select_reliability = NULL;
+        self->priv->create_reliability = NULL;
+        self->priv->update_reliability = NULL;
         self->priv->select_ip2country_update = NULL;
         self->priv->insert_ip2country = NULL;
         self->priv->select_ip2country = NULL;
@@ -255,8 +308,14 @@ gibbon_database_init (GibbonDatabase *self)
 
         self->priv->in_transaction = FALSE;
 
+        self->priv->servers =
+                g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                       (GDestroyNotify)
+                                       gibbon_database_server_free);
+
         self->priv->path = NULL;
         self->priv->geo_ip_updater = NULL;
+        self->priv->geo_ip_batch = NULL;
 
         self->priv->allow_gdk = FALSE;
 }
@@ -292,10 +351,14 @@ gibbon_database_finalize (GObject *object)
                         sqlite3_finalize (self->priv->select_rank);
                 if (self->priv->insert_activity)
                         sqlite3_finalize (self->priv->insert_activity);
-                if (self->priv->select_activity)
-                        sqlite3_finalize (self->priv->select_activity);
                 if (self->priv->delete_activity)
                         sqlite3_finalize (self->priv->delete_activity);
+                if (self->priv->select_reliability)
+                        sqlite3_finalize (self->priv->select_reliability);
+                if (self->priv->create_reliability)
+                        sqlite3_finalize (self->priv->create_reliability);
+                if (self->priv->update_reliability)
+                        sqlite3_finalize (self->priv->update_reliability);
                 if (self->priv->select_ip2country_update)
                         sqlite3_finalize (self->priv->select_ip2country_update);
                 if (self->priv->insert_ip2country)
@@ -320,6 +383,12 @@ gibbon_database_finalize (GObject *object)
         if (self->priv->path)
                 g_free (self->priv->path);
 
+        if (self->priv->geo_ip_batch)
+                g_array_free (self->priv->geo_ip_batch, TRUE);
+
+        if (self->priv->servers)
+                g_hash_table_destroy (self->priv->servers);
+
         g_free (last_path);
         singleton = NULL;
 
@@ -334,6 +403,22 @@ gibbon_database_class_init (GibbonDatabaseClass *klass)
         g_type_class_add_private (klass, sizeof (GibbonDatabasePrivate));
 
         object_class->finalize = gibbon_database_finalize;
+
+        /**
+         * GibbonDatabase::geo-ip-updated:
+         * @database: The #GibbonDatabase that emitted the signal.
+         *
+         * Emitted after a new GeoIP database has been committed.
+         */
+        signals[GEO_IP_UPDATED] =
+                g_signal_new ("geo-ip-updated",
+                              G_TYPE_FROM_CLASS (klass),
+                              G_SIGNAL_RUN_FIRST,
+                              0,
+                              NULL, NULL,
+                              g_cclosure_marshal_VOID__VOID,
+                              G_TYPE_NONE,
+                              0);
 }
 
 /**
@@ -448,6 +533,7 @@ gibbon_database_initialize (GibbonDatabase *self, GError **error)
         sqlite3 *dbh;
         gboolean drop_first = FALSE;
         gboolean new_database = FALSE;
+        gboolean fill_reliabilities;
         const gchar *sql_select_version =
                         "SELECT major, minor FROM version";
 
@@ -598,6 +684,46 @@ gibbon_database_initialize (GibbonDatabase *self, GError **error)
                                      " ON activities (date_time)"))
                 return FALSE;
 
+        /* Needed for voiding activities and for expiring reliabilities.  */
+        if (!gibbon_database_sql_do (self, error,
+                                     "CREATE INDEX IF NOT EXISTS"
+                                     " activities_user_id_index"
+                                     " ON activities (user_id)"))
+                return FALSE;
+
+        /*
+         * The reliabilities table holds the running sum and count of all
+         * activities per user so that the reliability can be looked up
+         * with a single primary key access instead of aggregating all
+         * activities of a user.  It is redundant and gets re-populated
+         * from the activities, whenever it is created.
+         */
+        if (drop_first
+            && !gibbon_database_sql_do (self, error,
+                                        "DROP TABLE IF EXISTS reliabilities"))
+                return FALSE;
+        fill_reliabilities = !gibbon_database_exists_table (self,
+                                                            "reliabilities");
+        if (!gibbon_database_sql_do (self, error,
+                                     "CREATE TABLE IF NOT EXISTS"
+                                     " reliabilities ("
+                                     "  user_id INTEGER PRIMARY KEY,"
+                                     "  value_sum REAL NOT NULL,"
+                                     "  value_count INTEGER NOT NULL,"
+                                     "  FOREIGN KEY (user_id)"
+                                     "    REFERENCES users (id)"
+                                     "    ON DELETE CASCADE"
+                                     ")"))
+                return FALSE;
+        if (fill_reliabilities
+            && !gibbon_database_sql_do (self, error,
+                                        "INSERT INTO reliabilities"
+                                        " (user_id, value_sum, value_count)"
+                                        " SELECT user_id, TOTAL(value),"
+                                        "        COUNT(*)"
+                                        " FROM activities GROUP BY user_id"))
+                return FALSE;
+
         if (!gibbon_database_sql_do (self, error, 
                                      "DROP TABLE IF EXISTS geoip"))
                 return FALSE;
@@ -839,6 +965,9 @@ gibbon_database_rollback (GibbonDatabase *self, GError **error)
         }
         self->priv->in_transaction = FALSE;
 
+        /* Ids created in this transaction are now invalid.  */
+        g_hash_table_remove_all (self->priv->servers);
+
         if (!self->priv->rollback) {
                 if (sqlite3_prepare_v2 (self->priv->dbh,
                                         "ROLLBACK",
@@ -1092,7 +1221,7 @@ gboolean
 gibbon_database_update_user_full (GibbonDatabase *self,
                                   const gchar *hostname, guint port,
                                   const gchar *login,
-                                  gdouble rating, guint experience,
+                                  gdouble rating, guint64 experience,
                                   GError **error)
 {
         gint64 now;
@@ -1118,7 +1247,7 @@ gibbon_database_update_user_full (GibbonDatabase *self,
                                           G_TYPE_UINT, &port,
                                           G_TYPE_STRING, &login,
                                           G_TYPE_INT64, &now,
-                                          G_TYPE_UINT, &experience,
+                                          G_TYPE_UINT64, &experience,
                                           G_TYPE_DOUBLE, &rating,
                                           -1)) {
                 gibbon_database_rollback (self, NULL);
@@ -1133,13 +1262,192 @@ gibbon_database_update_user_full (GibbonDatabase *self,
         return TRUE;
 }
 
+/**
+ * gibbon_database_update_users:
+ * @self: The #GibbonDatabase.
+ * @hostname: The server's hostname.
+ * @port: The server's port.
+ * @users: An array of #GibbonDatabaseUser records.
+ * @num_users: Number of elements in @users.
+ * @error: Location for a #GError or %NULL.
+ *
+ * Creates or updates all @users in one single transaction and retrieves
+ * their reliabilities.  This is meant for the bursts of who information
+ * that FIBS sends right after login.  If a login occurs more than once
+ * in @users, only the last record is honored.
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_database_update_users (GibbonDatabase *self,
+                              const gchar *hostname, guint port,
+                              GibbonDatabaseUser *users, gsize num_users,
+                              GError **error)
+{
+        guint server_id;
+        gint64 now;
+        gsize i, offset, chunk;
+        GString *sql;
+        sqlite3_stmt *stmt;
+        int status;
+        gint param;
+        GHashTable *index;
+        GibbonDatabaseUser *user;
+        const gchar *name;
+        gint count;
+
+        gibbon_return_val_if_fail (GIBBON_IS_DATABASE (self), FALSE, error);
+        gibbon_return_val_if_fail (hostname != NULL, FALSE, error);
+        gibbon_return_val_if_fail (port != 0, FALSE, error);
+        gibbon_return_val_if_fail (users != NULL || !num_users, FALSE, error);
+
+        if (!num_users)
+                return TRUE;
+
+        server_id = gibbon_database_get_server_id (self, hostname, port, error);
+        if (!server_id)
+                return FALSE;
+
+        if (!gibbon_database_begin_transaction (self, error))
+                return FALSE;
+
+        if (!gibbon_database_sql_do (self, error,
+                                     "CREATE TEMP TABLE IF NOT EXISTS"
+                                     " who_infos ("
+                                     "  name TEXT PRIMARY KEY,"
+                                     "  experience INTEGER,"
+                                     "  rating REAL"
+                                     ")")
+            || !gibbon_database_sql_do (self, error, "DELETE FROM who_infos")) {
+                gibbon_database_rollback (self, NULL);
+                return FALSE;
+        }
+
+        for (offset = 0; offset < num_users; offset += chunk) {
+                chunk = MIN (num_users - offset, GIBBON_DATABASE_BULK_ROWS);
+                sql = g_string_new ("INSERT OR REPLACE INTO who_infos"
+                                    " (name, experience, rating) VALUES");
+                for (i = 0; i < chunk; ++i)
+                        g_string_append (sql, i ? ", (?, ?, ?)" : " (?, ?, ?)");
+
+                if (sqlite3_prepare_v2 (self->priv->dbh, sql->str, -1,
+                                        &stmt, NULL)) {
+                        gibbon_database_set_error (self, error, sql->str);
+                        g_string_free (sql, TRUE);
+                        gibbon_database_rollback (self, NULL);
+                        return FALSE;
+                }
+
+                param = 0;
+                for (i = offset; i < offset + chunk; ++i) {
+                        user = users + i;
+                        sqlite3_bind_text (stmt, ++param, user->login, -1,
+                                           SQLITE_STATIC);
+                        sqlite3_bind_int64 (stmt, ++param, user->experience);
+                        sqlite3_bind_double (stmt, ++param, user->rating);
+                }
+
+                status = sqlite3_step (stmt);
+                sqlite3_finalize (stmt);
+                if (status != SQLITE_DONE) {
+                        gibbon_database_set_error (self, error, sql->str);
+                        g_string_free (sql, TRUE);
+                        gibbon_database_rollback (self, NULL);
+                        return FALSE;
+                }
+                g_string_free (sql, TRUE);
+        }
+
+        now = g_get_real_time ();
+        if (!gibbon_database_sql_do (self, error,
+                                     "INSERT OR IGNORE INTO users"
+                                     " (server_id, name, last_seen,"
+                                     "  experience, rating)"
+                                     " SELECT %u, name, %lld, experience,"
+                                     "        rating"
+                                     " FROM who_infos",
+                                     server_id, (long long) now)
+            || !gibbon_database_sql_do (self, error,
+                                        "UPDATE users SET last_seen = %lld,"
+                                        " experience ="
+                                        "  (SELECT w.experience"
+                                        "   FROM who_infos w"
+                                        "   WHERE w.name = users.name),"
+                                        " rating ="
+                                        "  (SELECT w.rating"
+                                        "   FROM who_infos w"
+                                        "   WHERE w.name = users.name)"
+                                        " WHERE server_id = %u"
+                                        "   AND name IN"
+                                        "    (SELECT name FROM who_infos)",
+                                        (long long) now, server_id)) {
+                gibbon_database_rollback (self, NULL);
+                return FALSE;
+        }
+
+        sql = g_string_new (NULL);
+        g_string_printf (sql,
+                         "SELECT w.name, r.value_sum, r.value_count, u.id"
+                         " FROM who_infos w"
+                         " JOIN users u ON u.name = w.name"
+                         "              AND u.server_id = %u"
+                         " LEFT JOIN reliabilities r ON r.user_id = u.id",
+                         server_id);
+        if (sqlite3_prepare_v2 (self->priv->dbh, sql->str, -1, &stmt, NULL)) {
+                gibbon_database_set_error (self, error, sql->str);
+                g_string_free (sql, TRUE);
+                gibbon_database_rollback (self, NULL);
+                return FALSE;
+        }
+
+        index = g_hash_table_new (g_str_hash, g_str_equal);
+        for (i = 0; i < num_users; ++i) {
+                users[i].reliability = 0;
+                users[i].confidence = 0;
+                g_hash_table_insert (index, (gpointer) users[i].login,
+                                     users + i);
+        }
+
+        while (SQLITE_ROW == (status = sqlite3_step (stmt))) {
+                name = (const gchar *) sqlite3_column_text (stmt, 0);
+                gibbon_database_cache_id (self, hostname, port, name,
+                                          sqlite3_column_int (stmt, 3));
+                user = g_hash_table_lookup (index, name);
+                count = sqlite3_column_int (stmt, 2);
+                if (!user || count <= 0)
+                        continue;
+                user->reliability = sqlite3_column_double (stmt, 1) / count;
+                user->confidence = count;
+        }
+
+        g_hash_table_destroy (index);
+        sqlite3_finalize (stmt);
+
+        if (status != SQLITE_DONE) {
+                gibbon_database_set_error (self, error, sql->str);
+                g_string_free (sql, TRUE);
+                gibbon_database_rollback (self, NULL);
+                return FALSE;
+        }
+        g_string_free (sql, TRUE);
+
+        if (!gibbon_database_commit (self, error)) {
+                gibbon_database_rollback (self, NULL);
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
 gboolean
 gibbon_database_update_rank (GibbonDatabase *self,
                              const gchar *hostname, guint port,
                              const gchar *login,
-                             gdouble rating, guint experience,
+                             gdouble rating, guint64 experience,
                              gint64 timestamp, GError **error)
 {
+        guint user_id;
+
         gibbon_return_val_if_fail (GIBBON_IS_DATABASE (self), FALSE, error);
         gibbon_return_val_if_fail (hostname != NULL, FALSE, error);
         gibbon_return_val_if_fail (port != 0, FALSE, error);
@@ -1150,17 +1458,20 @@ gibbon_database_update_rank (GibbonDatabase *self,
                                             error))
                 return FALSE;
 
+        user_id = gibbon_database_get_user_id (self, hostname, port, login,
+                                               error);
+        if (!user_id)
+                return FALSE;
+
         if (!gibbon_database_begin_transaction (self, error))
                 return FALSE;
 
         if (!gibbon_database_sql_execute (self, self->priv->update_rank,
                                           error,
                                           GIBBON_DATABASE_UPDATE_RANK,
-                                          G_TYPE_STRING, &login,
-                                          G_TYPE_STRING, &hostname,
-                                          G_TYPE_UINT, &port,
+                                          G_TYPE_UINT, &user_id,
                                           G_TYPE_DOUBLE, &rating,
-                                          G_TYPE_UINT, &experience,
+                                          G_TYPE_UINT64, &experience,
                                           G_TYPE_INT64, &timestamp,
                                           -1)) {
                 gibbon_database_rollback (self, NULL);
@@ -1268,6 +1579,11 @@ gibbon_database_insert_activity (GibbonDatabase *self,
                 return FALSE;
         }
 
+        if (!gibbon_database_add_reliability (self, user_id, value, 1, error)) {
+                gibbon_database_rollback (self, NULL);
+                return FALSE;
+        }
+
         if (!gibbon_database_commit (self, error)) {
                 gibbon_database_rollback (self, NULL);
                 return FALSE;
@@ -1291,6 +1607,49 @@ gibbon_database_maintain (GibbonDatabase *self, GError **error)
          */
         now = g_get_real_time ();
         then = now - 100ULL * 24 * 60 * 60 * 1000000;
+
+        /* The expired activities must first be subtracted from the
+         * reliabilities.
+         */
+        sql = "UPDATE reliabilities SET"
+              " value_sum = value_sum"
+              "  - (SELECT TOTAL(a.value) FROM activities a"
+              "      WHERE a.user_id = reliabilities.user_id"
+              "        AND (a.date_time < ?1 OR a.date_time > ?2)),"
+              " value_count = value_count"
+              "  - (SELECT COUNT(*) FROM activities a"
+              "      WHERE a.user_id = reliabilities.user_id"
+              "        AND (a.date_time < ?1 OR a.date_time > ?2))"
+              " WHERE user_id IN (SELECT user_id FROM activities"
+              "                    WHERE date_time < ?1 OR date_time > ?2)";
+        if (SQLITE_OK != sqlite3_prepare_v2 (self->priv->dbh, sql,
+                                             -1, &stmt, NULL)) {
+                gibbon_database_rollback (self, NULL);
+                return TRUE;
+        }
+
+        /*
+         * The status of the step is checked directly because
+         * gibbon_database_sql_execute() does not report failed steps.
+         * If the aggregates cannot be updated, the activities must not
+         * be deleted either, or the aggregates would be wrong for good.
+         */
+        if (SQLITE_OK != sqlite3_bind_int64 (stmt, 1, then)
+            || SQLITE_OK != sqlite3_bind_int64 (stmt, 2, now)
+            || SQLITE_DONE != sqlite3_step (stmt)) {
+                sqlite3_finalize (stmt);
+                gibbon_database_rollback (self, NULL);
+                return TRUE;
+        }
+        sqlite3_finalize (stmt);
+
+        sql = "DELETE FROM reliabilities WHERE value_count <= 0";
+        if (SQLITE_OK == sqlite3_prepare_v2 (self->priv->dbh, sql,
+                                             -1, &stmt, NULL)) {
+                (void) gibbon_database_sql_execute (self, stmt, NULL, sql, -1);
+                sqlite3_finalize (stmt);
+        }
+
         sql = "DELETE FROM activities WHERE (date_time < ? OR date_time > ?)";
         if (SQLITE_OK == sqlite3_prepare_v2 (self->priv->dbh, sql,
                                              -1, &stmt, NULL)) {
@@ -1324,6 +1683,10 @@ gibbon_database_get_reliability (GibbonDatabase *self,
                                  GError **error)
 {
         guint user_id;
+        gdouble sum;
+        guint count;
+        sqlite3_stmt *stmt;
+        gint status;
 
         gibbon_return_val_if_fail (GIBBON_IS_DATABASE (self), FALSE, error);
         gibbon_return_val_if_fail (login != NULL, FALSE, error);
@@ -1332,8 +1695,9 @@ gibbon_database_get_reliability (GibbonDatabase *self,
         gibbon_return_val_if_fail (hostname != NULL, FALSE, error);
         gibbon_return_val_if_fail (port != 0, FALSE, error);
 
-        if (!gibbon_database_get_statement (self, &self->priv->select_activity,
-                                            GIBBON_DATABASE_SELECT_ACTIVITY,
+        if (!gibbon_database_get_statement (self,
+                                            &self->priv->select_reliability,
+                                            GIBBON_DATABASE_SELECT_RELIABILITY,
                                             error))
                 return FALSE;
 
@@ -1342,32 +1706,89 @@ gibbon_database_get_reliability (GibbonDatabase *self,
         if (!user_id)
                 return FALSE;
 
-        if (!gibbon_database_begin_transaction (self, error))
-                return FALSE;
-
-        if (!gibbon_database_sql_execute (self, self->priv->select_activity,
+        /*
+         * A single primary key lookup.  No transaction needed.
+         */
+        if (!gibbon_database_sql_execute (self, self->priv->select_reliability,
                                           error,
-                                          GIBBON_DATABASE_SELECT_ACTIVITY,
+                                          GIBBON_DATABASE_SELECT_RELIABILITY,
                                           G_TYPE_UINT, &user_id,
-                                          -1)) {
-                gibbon_database_rollback (self, NULL);
+                                          -1))
                 return FALSE;
+
+        /*
+         * No row means no activities recorded.  Every other failure of the
+         * step is an error, and must not be reported as zero reliability.
+         */
+        stmt = self->priv->select_reliability;
+        status = sqlite3_step (stmt);
+        if (status == SQLITE_DONE) {
+                *value = 0;
+                *confidence = 0;
+                return TRUE;
+        } else if (status != SQLITE_ROW) {
+                return gibbon_database_set_error (
+                                self, error,
+                                GIBBON_DATABASE_SELECT_RELIABILITY);
         }
 
-        if (!gibbon_database_sql_select_row (self, self->priv->select_activity,
-                                             error,
-                                             GIBBON_DATABASE_SELECT_ACTIVITY,
-                                             G_TYPE_DOUBLE, value,
-                                             G_TYPE_UINT, confidence,
-                                            -1)) {
-                gibbon_database_rollback (self, NULL);
-                return FALSE;
+        sum = sqlite3_column_double (stmt, 0);
+        count = sqlite3_column_int (stmt, 1);
+        if (!count) {
+                *value = 0;
+                *confidence = 0;
+                return TRUE;
         }
 
-        if (!gibbon_database_commit (self, error)) {
-                gibbon_database_rollback (self, NULL);
+        *value = sum / count;
+        *confidence = count;
+
+        return TRUE;
+}
+
+/*
+ * Must be called inside a transaction.
+ */
+static gboolean
+gibbon_database_add_reliability (GibbonDatabase *self, guint user_id,
+                                 gdouble value, gint count, GError **error)
+{
+        sqlite3_stmt *stmt;
+
+        if (!gibbon_database_get_statement (self,
+                                            &self->priv->create_reliability,
+                                            GIBBON_DATABASE_CREATE_RELIABILITY,
+                                            error))
                 return FALSE;
-        }
+
+        if (!gibbon_database_get_statement (self,
+                                            &self->priv->update_reliability,
+                                            GIBBON_DATABASE_UPDATE_RELIABILITY,
+                                            error))
+                return FALSE;
+
+        /*
+         * The steps are checked here because gibbon_database_sql_execute()
+         * does not see a failed step.  The caller rolls back, so that the
+         * aggregate never disagrees with the activities.
+         */
+        stmt = self->priv->create_reliability;
+        sqlite3_reset (stmt);
+        if (SQLITE_OK != sqlite3_bind_int (stmt, 1, user_id)
+            || SQLITE_DONE != sqlite3_step (stmt))
+                return gibbon_database_set_error (
+                                self, error,
+                                GIBBON_DATABASE_CREATE_RELIABILITY);
+
+        stmt = self->priv->update_reliability;
+        sqlite3_reset (stmt);
+        if (SQLITE_OK != sqlite3_bind_double (stmt, 1, value)
+            || SQLITE_OK != sqlite3_bind_int (stmt, 2, count)
+            || SQLITE_OK != sqlite3_bind_int (stmt, 3, user_id)
+            || SQLITE_DONE != sqlite3_step (stmt))
+                return gibbon_database_set_error (
+                                self, error,
+                                GIBBON_DATABASE_UPDATE_RELIABILITY);
 
         return TRUE;
 }
@@ -1386,6 +1807,14 @@ gibbon_database_get_user_id (GibbonDatabase *self,
         gibbon_return_val_if_fail (port != 0, 0, error);
         gibbon_return_val_if_fail (login != NULL, 0, error);
 
+        user_id = gibbon_database_cached_id (self, hostname, port, login);
+        if (user_id)
+                return user_id;
+
+        /* The user can only be cached, when the server is.  */
+        if (!gibbon_database_get_server_id (self, hostname, port, error))
+                return 0;
+
         if (!gibbon_database_get_statement (self, &self->priv->select_user_id,
                                             GIBBON_DATABASE_SELECT_USER_ID,
                                             error))
@@ -1404,8 +1833,10 @@ gibbon_database_get_user_id (GibbonDatabase *self,
                                             NULL,
                                             GIBBON_DATABASE_SELECT_USER_ID,
                                             G_TYPE_UINT, &user_id,
-                                           -1))
+                                           -1)) {
+                gibbon_database_cache_id (self, hostname, port, login, user_id);
                 return user_id;
+        }
 
         /* We have to create a new user.  */
         if (!gibbon_database_begin_transaction (self, error))
@@ -1451,6 +1882,7 @@ gibbon_database_get_user_id (GibbonDatabase *self,
                                             GIBBON_DATABASE_SELECT_USER_ID,
                                             G_TYPE_UINT, &user_id,
                                            -1)) {
+                gibbon_database_cache_id (self, hostname, port, login, user_id);
                 return user_id;
         }
 
@@ -1470,6 +1902,10 @@ gibbon_database_get_server_id (GibbonDatabase *self,
         gibbon_return_val_if_fail (hostname != NULL, 0, error);
         gibbon_return_val_if_fail (port != 0, 0, error);
 
+        server_id = gibbon_database_cached_id (self, hostname, port, NULL);
+        if (server_id)
+                return server_id;
+
         if (!gibbon_database_get_statement (self, &self->priv->select_server_id,
                                             GIBBON_DATABASE_SELECT_SERVER_ID,
                                             error))
@@ -1487,8 +1923,11 @@ gibbon_database_get_server_id (GibbonDatabase *self,
                                             NULL,
                                             GIBBON_DATABASE_SELECT_SERVER_ID,
                                             G_TYPE_UINT, &server_id,
-                                            -1))
+                                            -1)) {
+                gibbon_database_cache_id (self, hostname, port, NULL,
+                                          server_id);
                 return server_id;
+        }
 
         /* We have to create a new server.  */
         if (!gibbon_database_get_statement (self, &self->priv->insert_server,
@@ -1523,6 +1962,8 @@ gibbon_database_get_server_id (GibbonDatabase *self,
                                             GIBBON_DATABASE_SELECT_SERVER_ID,
                                             G_TYPE_UINT, &server_id,
                                            -1)) {
+                gibbon_database_cache_id (self, hostname, port, NULL,
+                                          server_id);
                 return server_id;
         }
 
@@ -1558,7 +1999,6 @@ gibbon_database_void_activity (GibbonDatabase *self,
         if (!gibbon_database_begin_transaction (self, error))
                 return FALSE;
 
-
         if (!gibbon_database_sql_execute (self, self->priv->delete_activity,
                                           error,
                                           GIBBON_DATABASE_DELETE_ACTIVITY,
@@ -1569,6 +2009,13 @@ gibbon_database_void_activity (GibbonDatabase *self,
                 return FALSE;
         }
 
+        if (sqlite3_changes (self->priv->dbh)
+            && !gibbon_database_add_reliability (self, user_id, -value, -1,
+                                                 error)) {
+                gibbon_database_rollback (self, NULL);
+                return FALSE;
+        }
+
         if (!gibbon_database_commit (self, error)) {
                 gibbon_database_rollback (self, NULL);
                 return FALSE;
@@ -1577,13 +2024,18 @@ gibbon_database_void_activity (GibbonDatabase *self,
         return TRUE;
 }
 
-gchar *
-gibbon_database_get_country (GibbonDatabase *self, guint32 _address)
+GibbonDatabaseIPRange *
+gibbon_database_get_ip_ranges (GibbonDatabase *self, gsize *num_ranges)
 {
-        guint64 address;
-        gchar *alpha2;
+        GArray *ranges;
+        GibbonDatabaseIPRange range;
+        const gchar *alpha2;
+        int status;
 
         g_return_val_if_fail (GIBBON_IS_DATABASE (self), NULL);
+        g_return_val_if_fail (num_ranges != NULL, NULL);
+
+        *num_ranges = 0;
 
         if (!gibbon_database_get_statement (self, &self->priv->select_ip2country,
                                             GIBBON_DATABASE_SELECT_IP2COUNTRY,
@@ -1591,30 +2043,43 @@ gibbon_database_get_country (GibbonDatabase *self, guint32 _address)
                 return NULL;
         }
 
-        address = (guint) _address;
-
         if (!gibbon_database_sql_execute (self,
                                           self->priv->select_ip2country,
                                           NULL,
                                           GIBBON_DATABASE_SELECT_IP2COUNTRY,
-                                          G_TYPE_UINT64, &address,
-                                          G_TYPE_UINT64, &address,
                                           -1)) {
                 return NULL;
         }
 
-        if (!gibbon_database_sql_select_row (self,
-                                             self->priv->select_ip2country,
-                                             NULL,
-                                             GIBBON_DATABASE_SELECT_IP2COUNTRY,
-                                             G_TYPE_STRING, &alpha2,
-                                             -1)) {
+        /* Keep the padding defined, the array may be written to disk.  */
+        memset (&range, 0, sizeof range);
+        ranges = g_array_new (FALSE, FALSE, sizeof range);
+        while (SQLITE_ROW ==
+               (status = sqlite3_step (self->priv->select_ip2country))) {
+                alpha2 = (const gchar *)
+                        sqlite3_column_text (self->priv->select_ip2country, 2);
+                if (!alpha2 || !alpha2[0] || !alpha2[1])
+                        continue;
+                range.start = (guint32) sqlite3_column_int64 (
+                                self->priv->select_ip2country, 0);
+                range.end = (guint32) sqlite3_column_int64 (
+                                self->priv->select_ip2country, 1);
+                range.alpha2[0] = alpha2[0];
+                range.alpha2[1] = alpha2[1];
+                g_array_append_val (ranges, range);
+        }
+        sqlite3_reset (self->priv->select_ip2country);
+
+        if (SQLITE_DONE != status) {
+                gibbon_database_set_error (self, NULL,
+                                           GIBBON_DATABASE_SELECT_IP2COUNTRY);
+                g_array_free (ranges, TRUE);
                 return NULL;
         }
 
-        alpha2 = g_strdup (alpha2);
+        *num_ranges = ranges->len;
 
-        return alpha2;
+        return (GibbonDatabaseIPRange *) g_array_free (ranges, FALSE);
 }
 
 static gboolean
@@ -1622,7 +2087,6 @@ gibbon_database_check_ip2country (GibbonDatabase *self, GError **error)
 {
         gint64 last_update;
         gint64 now;
-        guint64 diff;
 
         if (!gibbon_database_begin_transaction (self, NULL))
                 return FALSE;
@@ -1647,10 +2111,14 @@ gibbon_database_check_ip2country (GibbonDatabase *self, GError **error)
                         -1))
                 last_update = 0;
 
+        /*
+         * Without an earlier online update, the snapshot installed with the
+         * program is used, and nothing has to be imported.  The updater
+         * only refreshes the data from the internet.
+         */
         now = g_get_real_time ();
-        diff = now - last_update;
-
-        if (now - last_update >= 30ULL * 24 * 60 * 60 * 1000000)
+        if (last_update
+            && now - last_update >= 30ULL * 24 * 60 * 60 * 1000000)
                 self->priv->geo_ip_updater =
                                 gibbon_geo_ip_updater_new (self, last_update);
         if (self->priv->geo_ip_updater)
@@ -1674,6 +2142,13 @@ gibbon_database_cancel_geo_ip_update (GibbonDatabase *self)
                 self->priv->geo_ip_updater = NULL;
         }
 
+        if (self->priv->geo_ip_batch)
+                g_array_set_size (self->priv->geo_ip_batch, 0);
+
+        /*
+         * The staging table is created inside the transaction and goes
+         * away with the rollback.
+         */
         if (self->priv->in_transaction)
                 gibbon_database_rollback (self, NULL);
 }
@@ -1686,6 +2161,37 @@ gibbon_database_close_geo_ip_update (GibbonDatabase *self)
         g_return_if_fail (GIBBON_IS_DATABASE (self));
         g_return_if_fail (self->priv->geo_ip_updater != NULL);
 
+        if (!gibbon_database_flush_geo_ip (self, NULL)) {
+                gibbon_database_cancel_geo_ip_update (self);
+                return;
+        }
+
+        /*
+         * The statement refers to the staging table that is about to be
+         * renamed.
+         */
+        if (self->priv->insert_ip2country) {
+                sqlite3_finalize (self->priv->insert_ip2country);
+                self->priv->insert_ip2country = NULL;
+        }
+
+        /*
+         * Building the index once over the complete data is a lot cheaper
+         * than maintaining it for every single row.  The swap is atomic
+         * because it happens in the same transaction as the import.
+         */
+        if (!gibbon_database_sql_do (self, NULL, "DROP TABLE ip2country")
+            || !gibbon_database_sql_do (self, NULL,
+                                        "ALTER TABLE ip2country_new"
+                                        " RENAME TO ip2country")
+            || !gibbon_database_sql_do (self, NULL,
+                                        "CREATE UNIQUE INDEX"
+                                        " ip2country_range_index"
+                                        " ON ip2country (start_ip, end_ip)")) {
+                gibbon_database_cancel_geo_ip_update (self);
+                return;
+        }
+
         if (!gibbon_database_sql_do (self, NULL,
                                      "DELETE FROM ip2country_update")) {
                 gibbon_database_cancel_geo_ip_update (self);
@@ -1702,53 +2208,152 @@ gibbon_database_close_geo_ip_update (GibbonDatabase *self)
         g_object_unref (self->priv->geo_ip_updater);
         self->priv->geo_ip_updater = NULL;
 
-        gibbon_database_commit (self, NULL);
+        if (!gibbon_database_commit (self, NULL)) {
+                gibbon_database_rollback (self, NULL);
+                return;
+        }
+
+        g_signal_emit (self, signals[GEO_IP_UPDATED], 0);
 }
 
-void
+/*
+ * Unlike the other geo ip functions, this one does not cancel the update on
+ * failure.  That is left to the caller.
+ */
+gboolean
 gibbon_database_on_start_geo_ip_update (GibbonDatabase *self)
 {
-        g_return_if_fail (GIBBON_IS_DATABASE (self));
-        g_return_if_fail (self->priv->geo_ip_updater != NULL);
+        g_return_val_if_fail (GIBBON_IS_DATABASE (self), FALSE);
+        g_return_val_if_fail (self->priv->geo_ip_updater != NULL, FALSE);
 
         if (!gibbon_database_begin_transaction (self, NULL))
-                gibbon_database_cancel_geo_ip_update (self);
+                return FALSE;
 
-        if (!gibbon_database_sql_do (self, NULL, "%s", "DELETE FROM ip2country"))
-                gibbon_database_cancel_geo_ip_update (self);
+        /*
+         * The data is loaded into a staging table without any index.  It
+         * replaces the ip2country table in gibbon_database_close_geo_ip_update.
+         */
+        if (!gibbon_database_sql_do (self, NULL,
+                                     "DROP TABLE IF EXISTS ip2country_new"))
+                return FALSE;
+        if (!gibbon_database_sql_do (self, NULL,
+                                     "CREATE TABLE ip2country_new ("
+                                     " start_ip UINT32 NOT NULL,"
+                                     " end_ip UINT32 NOT NULL,"
+                                     " code CHAR(2) NOT NULL)"))
+                return FALSE;
+
+        if (!self->priv->geo_ip_batch)
+                self->priv->geo_ip_batch =
+                        g_array_sized_new (FALSE, TRUE,
+                                           sizeof (GibbonDatabaseIPRange),
+                                           GIBBON_DATABASE_BULK_ROWS);
+        g_array_set_size (self->priv->geo_ip_batch, 0);
+
+        return TRUE;
 }
 
-void
+/*
+ * Like gibbon_database_on_start_geo_ip_update(), the caller has to cancel
+ * the update on failure.
+ */
+gboolean
 gibbon_database_set_geo_ip (GibbonDatabase *self,
-                            const gchar *from_ip, const gchar *to_ip,
+                            guint32 from_ip, guint32 to_ip,
                             const gchar *alpha2)
 {
-        g_return_if_fail (GIBBON_IS_DATABASE (self));
-        g_return_if_fail (from_ip != NULL);
-        g_return_if_fail (to_ip != NULL);
-        g_return_if_fail (alpha2 != NULL);
-        g_return_if_fail (alpha2[0] >= 'a' && alpha2[0] <= 'z');
-        g_return_if_fail (alpha2[1] >= 'a' && alpha2[1] <= 'z');
-        g_return_if_fail (alpha2[3]);
+        GibbonDatabaseIPRange range;
 
-        if (!gibbon_database_get_statement (self,
-                                            &self->priv->insert_ip2country,
-                                            GIBBON_DATABASE_INSERT_IP2COUNTRY,
-                                            NULL)) {
-                gibbon_database_cancel_geo_ip_update (self);
-                return;
+        g_return_val_if_fail (GIBBON_IS_DATABASE (self), FALSE);
+        g_return_val_if_fail (self->priv->geo_ip_batch != NULL, FALSE);
+        g_return_val_if_fail (from_ip <= to_ip, FALSE);
+        g_return_val_if_fail (alpha2 != NULL, FALSE);
+        g_return_val_if_fail (alpha2[0] >= 'a' && alpha2[0] <= 'z', FALSE);
+        g_return_val_if_fail (alpha2[1] >= 'a' && alpha2[1] <= 'z', FALSE);
+
+        memset (&range, 0, sizeof range);
+        range.start = from_ip;
+        range.end = to_ip;
+        range.alpha2[0] = alpha2[0];
+        range.alpha2[1] = alpha2[1];
+        g_array_append_val (self->priv->geo_ip_batch, range);
+
+        if (self->priv->geo_ip_batch->len < GIBBON_DATABASE_BULK_ROWS)
+                return TRUE;
+
+        return gibbon_database_flush_geo_ip (self, NULL);
+}
+
+static gchar *
+gibbon_database_insert_ip2country_sql (gsize num_rows)
+{
+        GString *sql = g_string_new (GIBBON_DATABASE_INSERT_IP2COUNTRY);
+        gsize i;
+
+        for (i = 0; i < num_rows; ++i)
+                g_string_append (sql, i ? ", (?, ?, ?)" : " (?, ?, ?)");
+
+        return g_string_free (sql, FALSE);
+}
+
+static gboolean
+gibbon_database_flush_geo_ip (GibbonDatabase *self, GError **error)
+{
+        GArray *batch = self->priv->geo_ip_batch;
+        const GibbonDatabaseIPRange *range;
+        sqlite3_stmt *stmt;
+        gchar *sql;
+        gsize i;
+        gint param = 0;
+        int status;
+
+        if (!batch || !batch->len)
+                return TRUE;
+
+        /*
+         * Full batches share one prepared statement.  Only the last one
+         * is usually shorter and needs a statement of its own.
+         */
+        if (batch->len == GIBBON_DATABASE_BULK_ROWS
+            && self->priv->insert_ip2country) {
+                stmt = self->priv->insert_ip2country;
+                sqlite3_reset (stmt);
+        } else {
+                sql = gibbon_database_insert_ip2country_sql (batch->len);
+                if (sqlite3_prepare_v2 (self->priv->dbh, sql, -1, &stmt,
+                                        NULL)) {
+                        gibbon_database_set_error (self, error, sql);
+                        g_free (sql);
+                        return FALSE;
+                }
+                g_free (sql);
+                if (batch->len == GIBBON_DATABASE_BULK_ROWS)
+                        self->priv->insert_ip2country = stmt;
         }
 
-        if (!gibbon_database_sql_execute (self,
-                                          self->priv->insert_ip2country,
-                                          NULL,
-                                          GIBBON_DATABASE_INSERT_IP2COUNTRY,
-                                          G_TYPE_STRING, &from_ip,
-                                          G_TYPE_STRING, &to_ip,
-                                          G_TYPE_STRING, &alpha2,
-                                          -1)) {
-                gibbon_database_cancel_geo_ip_update (self);
+        for (i = 0; i < batch->len; ++i) {
+                range = &g_array_index (batch, GibbonDatabaseIPRange, i);
+                sqlite3_bind_int64 (stmt, ++param, range->start);
+                sqlite3_bind_int64 (stmt, ++param, range->end);
+                sqlite3_bind_text (stmt, ++param, range->alpha2, 2,
+                                   SQLITE_STATIC);
         }
+
+        status = sqlite3_step (stmt);
+        if (SQLITE_DONE != status) {
+                sql = gibbon_database_insert_ip2country_sql (batch->len);
+                gibbon_database_set_error (self, error, sql);
+                g_free (sql);
+        }
+
+        if (stmt == self->priv->insert_ip2country)
+                sqlite3_reset (stmt);
+        else
+                sqlite3_finalize (stmt);
+
+        g_array_set_size (batch, 0);
+
+        return SQLITE_DONE == status;
 }
 
 gboolean
@@ -2005,6 +2610,20 @@ gibbon_database_save_match (GibbonDatabase *self,
         gibbon_return_val_if_fail (white != NULL, FALSE, error);
         gibbon_return_val_if_fail (black != NULL, FALSE, error);
 
+        /*
+         * Both opponents must exist in the database.  Retrieving their ids
+         * creates them on demand.
+         */
+        user1 = gibbon_database_get_user_id (self, hostname, port, white,
+                                             error);
+        if (!user1)
+                return FALSE;
+
+        user2 = gibbon_database_get_user_id (self, hostname, port, black,
+                                             error);
+        if (!user2)
+                return FALSE;
+
         if (!gibbon_database_get_statement (self, &self->priv->select_match_id,
                                             GIBBON_DATABASE_SELECT_MATCH_ID,
                                             error)) {
@@ -2014,10 +2633,8 @@ gibbon_database_save_match (GibbonDatabase *self,
         if (!gibbon_database_sql_execute (self, self->priv->select_match_id,
                                           error,
                                           GIBBON_DATABASE_SELECT_MATCH_ID,
-                                          G_TYPE_STRING, &hostname,
-                                          G_TYPE_UINT, &port,
-                                          G_TYPE_STRING, &white,
-                                          G_TYPE_STRING, &black,
+                                          G_TYPE_UINT, &user1,
+                                          G_TYPE_UINT, &user2,
                                           G_TYPE_INT64, &date_time,
                                           -1))
                 return FALSE;
@@ -2030,21 +2647,6 @@ gibbon_database_save_match (GibbonDatabase *self,
                 return TRUE;
         }
 
-        /*
-         * We must create a new match record.  Since we must make sure that
-         * both opponents already exist in the database we first retrieve
-         * their user ids.
-         */
-        user1 = gibbon_database_get_user_id (self, hostname, port, white,
-                                             error);
-        if (!user1)
-                return FALSE;
-
-        user2 = gibbon_database_get_user_id (self, hostname, port, black,
-                                             error);
-        if (!user2)
-                return FALSE;
-
         if (!gibbon_database_get_statement (self, &self->priv->create_match,
                                             GIBBON_DATABASE_CREATE_MATCH,
                                             error)) {
@@ -2073,3 +2675,65 @@ gibbon_database_save_match (GibbonDatabase *self,
 
         return TRUE;
 }
+
+static guint
+gibbon_database_cached_id (const GibbonDatabase *self,
+                           const gchar *hostname, guint port,
+                           const gchar *login)
+{
+        gchar *key = g_alloca (strlen (hostname) + 12);
+        GibbonDatabaseServer *server;
+
+        g_sprintf (key, "%s:%u", hostname, port);
+        server = g_hash_table_lookup (self->priv->servers, key);
+        if (!server)
+                return 0;
+
+        if (!login)
+                return server->id;
+
+        return GPOINTER_TO_UINT (g_hash_table_lookup (server->user_ids,
+                                                      login));
+}
+
+static void
+gibbon_database_cache_id (GibbonDatabase *self,
+                          const gchar *hostname, guint port,
+                          const gchar *login, guint id)
+{
+        gchar *key;
+        GibbonDatabaseServer *server;
+
+        if (!id)
+                return;
+
+        key = g_strdup_printf ("%s:%u", hostname, port);
+        server = g_hash_table_lookup (self->priv->servers, key);
+
+        if (!login) {
+                if (!server) {
+                        server = g_malloc (sizeof *server);
+                        server->id = id;
+                        server->user_ids = g_hash_table_new_full (g_str_hash,
+                                                                  g_str_equal,
+                                                                  g_free,
+                                                                  NULL);
+                        g_hash_table_insert (self->priv->servers, key, server);
+                        return;
+                }
+        } else if (server) {
+                g_hash_table_insert (server->user_ids, g_strdup (login),
+                                     GUINT_TO_POINTER (id));
+        }
+
+        g_free (key);
+}
+
+static void
+gibbon_database_server_free (GibbonDatabaseServer *server)
+{
+        if (server) {
+                g_hash_table_destroy (server->user_ids);
+                g_free (server);
+        }
+}
@@ -70,6 +70,43 @@ struct _GibbonDatabaseClass
         GObjectClass parent_class;
 };
 
+/**
+ * GibbonDatabaseUser:
+ * @login: The login name.
+ * @rating: The current rating.
+ * @experience: The current experience.
+ * @reliability: Filled by gibbon_database_update_users().
+ * @confidence: Filled by gibbon_database_update_users().
+ *
+ * One record for gibbon_database_update_users().
+ */
+typedef struct _GibbonDatabaseUser GibbonDatabaseUser;
+struct _GibbonDatabaseUser
+{
+        const gchar *login;
+        gdouble rating;
+        guint64 experience;
+
+        gdouble reliability;
+        guint confidence;
+};
+
+/**
+ * GibbonDatabaseIPRange:
+ * @start: First address of the range in host byte order.
+ * @end: Last address of the range in host byte order.
+ * @alpha2: The ISO 3166 alpha-2 country code, not NUL-terminated.
+ *
+ * One row of the ip2country table in packed form.
+ */
+typedef struct _GibbonDatabaseIPRange GibbonDatabaseIPRange;
+struct _GibbonDatabaseIPRange
+{
+        guint32 start;
+        guint32 end;
+        gchar alpha2[2];
+};
+
 GType gibbon_database_get_type (void) G_GNUC_CONST;
 
 GibbonDatabase *gibbon_database_new (const gchar *path, GError **error);
@@ -80,12 +117,17 @@ guint gibbon_database_get_server_id (GibbonDatabase *self,
 gboolean gibbon_database_update_user_full (GibbonDatabase *self,
                                            const gchar *hostname, guint port,
                                            const gchar *login,
-                                           gdouble rating, guint experience,
+                                           gdouble rating, guint64 experience,
                                            GError **error);
+gboolean gibbon_database_update_users (GibbonDatabase *self,
+                                       const gchar *hostname, guint port,
+                                       GibbonDatabaseUser *users,
+                                       gsize num_users,
+                                       GError **error);
 gboolean gibbon_database_update_rank (GibbonDatabase *self,
                                       const gchar *hostname, guint port,
                                       const gchar *login,
-                                      gdouble rating, guint experience,
+                                      gdouble rating, guint64 experience,
                                       gint64 timestamp,
                                       GError **error);
 gboolean gibbon_database_get_rank (GibbonDatabase *self,
@@ -112,14 +154,16 @@ guint gibbon_database_get_user_id (GibbonDatabase *self,
                                    const gchar *hostname, guint port,
                                    const gchar *login, GError **error);
 /*
- * This function does not report errors because it can theoretically
- * happen that it returns NULL without an error.
+ * This function does not report errors.  The ranges are sorted by start
+ * address and must be freed with g_free().  The return value may be NULL
+ * for an empty table.
  */
-gchar *gibbon_database_get_country (GibbonDatabase *self, guint32 address);
-void gibbon_database_on_start_geo_ip_update (GibbonDatabase *self);
-void gibbon_database_set_geo_ip (GibbonDatabase *self,
-                                 const gchar *from_ip, const gchar *to_ip,
-                                 const gchar *alpha2);
+GibbonDatabaseIPRange *gibbon_database_get_ip_ranges (GibbonDatabase *self,
+                                                      gsize *num_ranges);
+gboolean gibbon_database_on_start_geo_ip_update (GibbonDatabase *self);
+gboolean gibbon_database_set_geo_ip (GibbonDatabase *self,
+                                     guint32 from_ip, guint32 to_ip,
+                                     const gchar *alpha2);
 void gibbon_database_cancel_geo_ip_update (GibbonDatabase *self);
 void gibbon_database_close_geo_ip_update (GibbonDatabase *self);
 gboolean gibbon_database_create_group (GibbonDatabase *self,
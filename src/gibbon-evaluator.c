@@ -0,0 +1,709 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gibbon-evaluator
+ * @short_description: Neural network position evaluator.
+ *
+ * Since: 0.2.0
+ *
+ * A multi-layer perceptron with one hidden layer in the style of gnubg.
+ * The position is encoded with the truncated unary encoding that gnubg
+ * uses for its base inputs, see gibbon_evaluator_encode().  The network
+ * estimates the five probabilities of a #GibbonAnalysisMove for the side
+ * that is about to roll.  Both layers use the logistic activation
+ * function.
+ *
+ * The hidden layer is stored input-major, so that the weights of one
+ * input to all hidden units are contiguous.  Most inputs are zero, and
+ * the hidden layer is accumulated by adding the rows of the non-zero
+ * inputs only.  When a batch of positions is evaluated, every row is
+ * loaded once for the whole batch.  The kernels use AVX or SSE
+ * instructions, if the compiler is allowed to emit them, for example
+ * with CFLAGS="-O2 -mavx2 -mfma".
+ *
+ * Weight files start with a #GibbonEvaluatorHeader, followed by the hidden
+ * weights (inputs x hidden), the hidden biases, the output weights
+ * (outputs x hidden) and the output biases, all as single precision
+ * floating point numbers.  Like the header fields, they are stored in
+ * little-endian byte order, so that weight files can be exchanged between
+ * machines.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#if defined (__AVX__)
+# include <immintrin.h>
+#elif defined (__SSE__)
+# include <xmmintrin.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "gibbon-evaluator.h"
+#include "gibbon-analysis-move.h"
+#include "gibbon-util.h"
+
+#define GIBBON_EVALUATOR_MAGIC "GibbonNN"
+#define GIBBON_EVALUATOR_VERSION 3
+
+/* The hidden layer is padded to a multiple of the vector width.  */
+#define GIBBON_EVALUATOR_ALIGN 8
+
+typedef struct _GibbonEvaluatorHeader GibbonEvaluatorHeader;
+struct _GibbonEvaluatorHeader {
+        GibbonFileHeader file;
+        guint32 num_inputs;
+        guint32 num_hidden;
+        guint32 num_outputs;
+};
+
+struct _GibbonEvaluator {
+        guint num_hidden;
+
+        /* Number of hidden units rounded up to GIBBON_EVALUATOR_ALIGN.  */
+        guint stride;
+
+        /* All layers are padded with zeros.  */
+        gfloat *hidden_weights;
+        gfloat *hidden_bias;
+        gfloat *output_weights;
+        gfloat output_bias[GIBBON_EVALUATOR_OUTPUTS];
+};
+
+static void gibbon_evaluator_forward (const GibbonEvaluator *self,
+                                      const gfloat *inputs, gsize n,
+                                      gdouble (*p)[GIBBON_EVALUATOR_OUTPUTS]);
+static void gibbon_evaluator_axpy (gfloat *y, gfloat a, const gfloat *x,
+                                   gsize n);
+static gfloat gibbon_evaluator_dot (const gfloat *x, const gfloat *y, gsize n);
+static gfloat gibbon_evaluator_sigmoid (gfloat x);
+static gboolean gibbon_evaluator_game_over (const gint8 board[26],
+                                            gdouble p[GIBBON_EVALUATOR_OUTPUTS]);
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+static void gibbon_evaluator_swap_floats (gfloat *data, gsize n);
+#endif
+
+/**
+ * gibbon_evaluator_new:
+ * @num_hidden: Number of hidden units.
+ * @hidden_weights: The %GIBBON_EVALUATOR_INPUTS x @num_hidden weights of the
+ *                  hidden layer, input-major.
+ * @hidden_bias: The @num_hidden biases of the hidden layer.
+ * @output_weights: The %GIBBON_EVALUATOR_OUTPUTS x @num_hidden weights of
+ *                  the output layer, output-major.
+ * @output_bias: The %GIBBON_EVALUATOR_OUTPUTS biases of the output layer.
+ *
+ * Creates a new #GibbonEvaluator.  The weights are copied.
+ *
+ * Returns: The new #GibbonEvaluator, free with gibbon_evaluator_free().
+ */
+GibbonEvaluator *
+gibbon_evaluator_new (guint num_hidden,
+                      const gfloat *hidden_weights, const gfloat *hidden_bias,
+                      const gfloat *output_weights, const gfloat *output_bias)
+{
+        GibbonEvaluator *self;
+        gsize i;
+
+        g_return_val_if_fail (num_hidden > 0, NULL);
+        g_return_val_if_fail (hidden_weights != NULL, NULL);
+        g_return_val_if_fail (hidden_bias != NULL, NULL);
+        g_return_val_if_fail (output_weights != NULL, NULL);
+        g_return_val_if_fail (output_bias != NULL, NULL);
+
+        self = g_malloc (sizeof *self);
+        self->num_hidden = num_hidden;
+        self->stride = (num_hidden + GIBBON_EVALUATOR_ALIGN - 1)
+                       & ~(GIBBON_EVALUATOR_ALIGN - 1);
+
+        self->hidden_weights = g_malloc0 (GIBBON_EVALUATOR_INPUTS
+                                          * self->stride
+                                          * sizeof *self->hidden_weights);
+        for (i = 0; i < GIBBON_EVALUATOR_INPUTS; ++i)
+                memcpy (self->hidden_weights + i * self->stride,
+                        hidden_weights + i * num_hidden,
+                        num_hidden * sizeof *hidden_weights);
+
+        self->hidden_bias = g_malloc0 (self->stride
+                                       * sizeof *self->hidden_bias);
+        memcpy (self->hidden_bias, hidden_bias,
+                num_hidden * sizeof *hidden_bias);
+
+        self->output_weights = g_malloc0 (GIBBON_EVALUATOR_OUTPUTS
+                                          * self->stride
+                                          * sizeof *self->output_weights);
+        for (i = 0; i < GIBBON_EVALUATOR_OUTPUTS; ++i)
+                memcpy (self->output_weights + i * self->stride,
+                        output_weights + i * num_hidden,
+                        num_hidden * sizeof *output_weights);
+
+        memcpy (self->output_bias, output_bias, sizeof self->output_bias);
+
+        return self;
+}
+
+/**
+ * gibbon_evaluator_load:
+ * @path: The weight file.
+ * @error: Location to store errors or %NULL.
+ *
+ * Loads the weights written by gibbon_evaluator_save().  The header and
+ * the checksum are verified.
+ *
+ * Returns: The new #GibbonEvaluator or %NULL in case of failure.
+ */
+GibbonEvaluator *
+gibbon_evaluator_load (const gchar *path, GError **error)
+{
+        GibbonEvaluator *self;
+        GMappedFile *mapped;
+        const GibbonEvaluatorHeader *header;
+        const gfloat *data;
+        gsize length, num_hidden, expected;
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+        gfloat *converted;
+#endif
+
+        gibbon_return_val_if_fail (path != NULL, NULL, error);
+
+        mapped = gibbon_map_checked_file (path, GIBBON_EVALUATOR_MAGIC,
+                                          GIBBON_EVALUATOR_VERSION,
+                                          sizeof *header, TRUE, error);
+        if (!mapped)
+                return NULL;
+
+        length = g_mapped_file_get_length (mapped);
+        header = (const GibbonEvaluatorHeader *)
+                        g_mapped_file_get_contents (mapped);
+
+        if (GUINT32_FROM_LE (header->num_inputs) != GIBBON_EVALUATOR_INPUTS
+            || (GUINT32_FROM_LE (header->num_outputs)
+                != GIBBON_EVALUATOR_OUTPUTS)
+            || !header->num_hidden) {
+                g_set_error (error, GIBBON_ERROR, -1,
+                             _("`%s' is not a neural network weight file!"),
+                             path);
+                g_mapped_file_unref (mapped);
+                return NULL;
+        }
+
+        num_hidden = GUINT32_FROM_LE (header->num_hidden);
+        expected = (GIBBON_EVALUATOR_INPUTS + 1 + GIBBON_EVALUATOR_OUTPUTS)
+                   * num_hidden + GIBBON_EVALUATOR_OUTPUTS;
+        data = (const gfloat *) (header + 1);
+        length -= sizeof *header;
+        if (length != expected * sizeof *data) {
+                g_set_error (error, GIBBON_ERROR, -1,
+                             _("Neural network weight file `%s' is"
+                               " corrupted!"),
+                             path);
+                g_mapped_file_unref (mapped);
+                return NULL;
+        }
+
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+        converted = g_memdup (data, length);
+        gibbon_evaluator_swap_floats (converted, expected);
+        g_mapped_file_unref (mapped);
+        data = converted;
+#endif
+
+        self = gibbon_evaluator_new (num_hidden, data,
+                        data + GIBBON_EVALUATOR_INPUTS * num_hidden,
+                        data + (GIBBON_EVALUATOR_INPUTS + 1) * num_hidden,
+                        data + (GIBBON_EVALUATOR_INPUTS + 1
+                                + GIBBON_EVALUATOR_OUTPUTS) * num_hidden);
+
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+        g_free (converted);
+#else
+        g_mapped_file_unref (mapped);
+#endif
+
+        return self;
+}
+
+void
+gibbon_evaluator_free (GibbonEvaluator *self)
+{
+        if (!self)
+                return;
+
+        g_free (self->hidden_weights);
+        g_free (self->hidden_bias);
+        g_free (self->output_weights);
+        g_free (self);
+}
+
+/**
+ * gibbon_evaluator_save:
+ * @self: The #GibbonEvaluator.
+ * @path: The output file.
+ * @error: Location to store errors or %NULL.
+ *
+ * Writes the weights into @path.  The file is replaced atomically.
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_evaluator_save (const GibbonEvaluator *self, const gchar *path,
+                       GError **error)
+{
+        GibbonEvaluatorHeader *header;
+        gfloat *data;
+        gsize num_floats, i;
+        gchar *buffer;
+        gboolean retval;
+
+        gibbon_return_val_if_fail (self != NULL, FALSE, error);
+        gibbon_return_val_if_fail (path != NULL, FALSE, error);
+
+        num_floats = (GIBBON_EVALUATOR_INPUTS + 1 + GIBBON_EVALUATOR_OUTPUTS)
+                     * self->num_hidden + GIBBON_EVALUATOR_OUTPUTS;
+        buffer = g_malloc0 (sizeof *header + num_floats * sizeof *data);
+        header = (GibbonEvaluatorHeader *) buffer;
+        data = (gfloat *) (header + 1);
+
+        header->num_inputs = GUINT32_TO_LE (GIBBON_EVALUATOR_INPUTS);
+        header->num_hidden = GUINT32_TO_LE (self->num_hidden);
+        header->num_outputs = GUINT32_TO_LE (GIBBON_EVALUATOR_OUTPUTS);
+
+        /* Strip the padding.  */
+        for (i = 0; i < GIBBON_EVALUATOR_INPUTS; ++i) {
+                memcpy (data, self->hidden_weights + i * self->stride,
+                        self->num_hidden * sizeof *data);
+                data += self->num_hidden;
+        }
+        memcpy (data, self->hidden_bias, self->num_hidden * sizeof *data);
+        data += self->num_hidden;
+        for (i = 0; i < GIBBON_EVALUATOR_OUTPUTS; ++i) {
+                memcpy (data, self->output_weights + i * self->stride,
+                        self->num_hidden * sizeof *data);
+                data += self->num_hidden;
+        }
+        memcpy (data, self->output_bias, sizeof self->output_bias);
+
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+        gibbon_evaluator_swap_floats ((gfloat *) (header + 1), num_floats);
+#endif
+
+        retval = gibbon_save_checked_file (path, GIBBON_EVALUATOR_MAGIC,
+                                           GIBBON_EVALUATOR_VERSION, buffer,
+                                           sizeof *header
+                                           + num_floats * sizeof *data,
+                                           error);
+        g_free (buffer);
+
+        return retval;
+}
+
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+/*
+ * Converts single precision numbers between host and little-endian byte
+ * order.  The numbers are copied as words in order to not violate the
+ * aliasing rules.
+ */
+static void
+gibbon_evaluator_swap_floats (gfloat *data, gsize n)
+{
+        guint32 word;
+        gsize i;
+
+        for (i = 0; i < n; ++i) {
+                memcpy (&word, data + i, sizeof word);
+                word = GUINT32_SWAP_LE_BE (word);
+                memcpy (data + i, &word, sizeof word);
+        }
+}
+#endif
+
+guint
+gibbon_evaluator_get_num_hidden (const GibbonEvaluator *self)
+{
+        g_return_val_if_fail (self != NULL, 0);
+
+        return self->num_hidden;
+}
+
+/**
+ * gibbon_evaluator_encode:
+ * @board: The board seen from the side about to roll, see
+ *         #GibbonPositionPlay.
+ * @inputs: Location to store the inputs.
+ *
+ * Encodes a board as network inputs.  The first 100 inputs describe the
+ * checkers of the side about to roll, the last 100 inputs those of the
+ * opponent, both starting with the ace point of the respective side and
+ * ending with the bar.  For n checkers on a point the four inputs are
+ * n == 1, n == 2, n >= 3, and (n - 3) / 2 for n > 3.
+ */
+void
+gibbon_evaluator_encode (const gint8 board[26],
+                         gfloat inputs[GIBBON_EVALUATOR_INPUTS])
+{
+        gint i, n;
+        gfloat *mine = inputs;
+        gfloat *theirs = inputs + GIBBON_EVALUATOR_INPUTS / 2;
+
+        memset (inputs, 0, GIBBON_EVALUATOR_INPUTS * sizeof *inputs);
+
+        for (i = 1; i <= 25; ++i) {
+                n = i < 25 ? board[i] : board[25];
+                if (n > 0) {
+                        mine[0] = n == 1;
+                        mine[1] = n == 2;
+                        mine[2] = n >= 3;
+                        mine[3] = n > 3 ? (n - 3) / 2.0f : 0.0f;
+                }
+                mine += 4;
+
+                n = i < 25 ? -board[25 - i] : board[0];
+                if (n > 0) {
+                        theirs[0] = n == 1;
+                        theirs[1] = n == 2;
+                        theirs[2] = n >= 3;
+                        theirs[3] = n > 3 ? (n - 3) / 2.0f : 0.0f;
+                }
+                theirs += 4;
+        }
+}
+
+/**
+ * gibbon_evaluator_evaluate:
+ * @self: The #GibbonEvaluator.
+ * @pos: The #GibbonPosition.
+ * @side: The side about to roll.
+ * @p: Location to store the probabilities.
+ *
+ * Evaluates @pos for @side before rolling.  The dice in @pos are ignored.
+ */
+void
+gibbon_evaluator_evaluate (const GibbonEvaluator *self,
+                           const GibbonPosition *pos, GibbonPositionSide side,
+                           gdouble p[GIBBON_EVALUATOR_OUTPUTS])
+{
+        gint8 board[26];
+        gfloat inputs[GIBBON_EVALUATOR_INPUTS];
+
+        g_return_if_fail (self != NULL);
+        g_return_if_fail (pos != NULL);
+        g_return_if_fail (side != GIBBON_POSITION_SIDE_NONE);
+        g_return_if_fail (p != NULL);
+
+        gibbon_position_normalize (pos, side, board);
+        gibbon_evaluator_encode (board, inputs);
+        gibbon_evaluator_forward (self, inputs, 1,
+                                  (gdouble (*)[GIBBON_EVALUATOR_OUTPUTS]) p);
+}
+
+/**
+ * gibbon_evaluator_evaluate_plays:
+ * @self: The #GibbonEvaluator.
+ * @plays: The candidate plays as produced by
+ *         gibbon_position_generate_moves().
+ * @num_plays: The number of elements in @plays.
+ * @p: Location to store @num_plays sets of probabilities.
+ *
+ * Evaluates the resulting positions of all candidate plays for one roll
+ * in a single batch.  The probabilities are seen from the side that made
+ * the plays.  Plays that bear off the last checker are not evaluated by
+ * the network but get their exact result.
+ */
+void
+gibbon_evaluator_evaluate_plays (const GibbonEvaluator *self,
+                                 const GibbonPositionPlay *plays,
+                                 gsize num_plays,
+                                 gdouble (*p)[GIBBON_EVALUATOR_OUTPUTS])
+{
+        gfloat *inputs;
+        gdouble (*q)[GIBBON_EVALUATOR_OUTPUTS];
+        gsize *indices;
+        gint8 board[26];
+        gsize i, n = 0;
+        gint j;
+
+        g_return_if_fail (self != NULL);
+        g_return_if_fail (plays != NULL || !num_plays);
+        g_return_if_fail (p != NULL || !num_plays);
+
+        if (!num_plays)
+                return;
+
+        inputs = g_malloc (num_plays * GIBBON_EVALUATOR_INPUTS
+                           * sizeof *inputs);
+        indices = g_malloc (num_plays * sizeof *indices);
+
+        for (i = 0; i < num_plays; ++i) {
+                if (gibbon_evaluator_game_over (plays[i].board, p[i]))
+                        continue;
+
+                /* After the play, the opponent is about to roll.  */
+                board[0] = plays[i].board[25];
+                board[25] = plays[i].board[0];
+                for (j = 1; j <= 24; ++j)
+                        board[j] = -plays[i].board[25 - j];
+                gibbon_evaluator_encode (board,
+                                         inputs + n * GIBBON_EVALUATOR_INPUTS);
+                indices[n++] = i;
+        }
+
+        if (n) {
+                q = g_malloc (n * sizeof *q);
+                gibbon_evaluator_forward (self, inputs, n, q);
+                for (i = 0; i < n; ++i) {
+                        p[indices[i]][GIBBON_ANALYSIS_MOVE_PWIN] =
+                                1.0 - q[i][GIBBON_ANALYSIS_MOVE_PWIN];
+                        p[indices[i]][GIBBON_ANALYSIS_MOVE_PWIN_GAMMON] =
+                                q[i][GIBBON_ANALYSIS_MOVE_PLOSE_GAMMON];
+                        p[indices[i]][GIBBON_ANALYSIS_MOVE_PWIN_BACKGAMMON] =
+                                q[i][GIBBON_ANALYSIS_MOVE_PLOSE_BACKGAMMON];
+                        p[indices[i]][GIBBON_ANALYSIS_MOVE_PLOSE_GAMMON] =
+                                q[i][GIBBON_ANALYSIS_MOVE_PWIN_GAMMON];
+                        p[indices[i]][GIBBON_ANALYSIS_MOVE_PLOSE_BACKGAMMON] =
+                                q[i][GIBBON_ANALYSIS_MOVE_PWIN_BACKGAMMON];
+                }
+                g_free (q);
+        }
+
+        g_free (indices);
+        g_free (inputs);
+}
+
+/**
+ * gibbon_evaluator_rank_plays:
+ * @self: The #GibbonEvaluator.
+ * @plays: The candidate plays.
+ * @num_plays: The number of elements in @plays, at least one.
+ * @p: Location to store the probabilities of the best play or %NULL.
+ *
+ * Evaluates all plays with gibbon_evaluator_evaluate_plays() and picks
+ * the one with the highest cubeless money equity.
+ *
+ * Returns: The index of the best play.
+ */
+gsize
+gibbon_evaluator_rank_plays (const GibbonEvaluator *self,
+                             const GibbonPositionPlay *plays, gsize num_plays,
+                             gdouble p[GIBBON_EVALUATOR_OUTPUTS])
+{
+        gdouble (*results)[GIBBON_EVALUATOR_OUTPUTS];
+        gdouble equity, best_equity;
+        gsize i, best = 0;
+
+        g_return_val_if_fail (self != NULL, 0);
+        g_return_val_if_fail (plays != NULL, 0);
+        g_return_val_if_fail (num_plays > 0, 0);
+
+        results = g_malloc (num_plays * sizeof *results);
+        gibbon_evaluator_evaluate_plays (self, plays, num_plays, results);
+
+        best_equity = gibbon_money_equity (results[0]);
+        for (i = 1; i < num_plays; ++i) {
+                equity = gibbon_money_equity (results[i]);
+                if (equity > best_equity) {
+                        best_equity = equity;
+                        best = i;
+                }
+        }
+
+        if (p)
+                memcpy (p, results[best], sizeof results[best]);
+
+        g_free (results);
+
+        return best;
+}
+
+/*
+ * One forward pass for a batch of n encoded positions.
+ */
+static void
+gibbon_evaluator_forward (const GibbonEvaluator *self,
+                          const gfloat *inputs, gsize n,
+                          gdouble (*p)[GIBBON_EVALUATOR_OUTPUTS])
+{
+        gfloat *hidden;
+        gfloat *h;
+        const gfloat *row;
+        gfloat x;
+        gsize c, i;
+
+        hidden = g_malloc (n * self->stride * sizeof *hidden);
+        for (c = 0; c < n; ++c)
+                memcpy (hidden + c * self->stride, self->hidden_bias,
+                        self->stride * sizeof *hidden);
+
+        /*
+         * Input-major loop order, so that each row of weights is fetched
+         * into the cache only once per batch.
+         */
+        for (i = 0; i < GIBBON_EVALUATOR_INPUTS; ++i) {
+                row = self->hidden_weights + i * self->stride;
+                for (c = 0; c < n; ++c) {
+                        x = inputs[c * GIBBON_EVALUATOR_INPUTS + i];
+                        if (x != 0.0f)
+                                gibbon_evaluator_axpy (hidden
+                                                       + c * self->stride,
+                                                       x, row, self->stride);
+                }
+        }
+
+        for (c = 0; c < n; ++c) {
+                h = hidden + c * self->stride;
+                for (i = 0; i < self->num_hidden; ++i)
+                        h[i] = gibbon_evaluator_sigmoid (h[i]);
+                /* The padding must not contribute.  */
+                for (; i < self->stride; ++i)
+                        h[i] = 0.0f;
+
+                for (i = 0; i < GIBBON_EVALUATOR_OUTPUTS; ++i) {
+                        x = self->output_bias[i]
+                            + gibbon_evaluator_dot (self->output_weights
+                                                    + i * self->stride,
+                                                    h, self->stride);
+                        p[c][i] = gibbon_evaluator_sigmoid (x);
+                }
+        }
+
+        g_free (hidden);
+}
+
+/* y += a * x, n must be a multiple of GIBBON_EVALUATOR_ALIGN.  */
+static void
+gibbon_evaluator_axpy (gfloat *y, gfloat a, const gfloat *x, gsize n)
+{
+        gsize i;
+#if defined (__AVX__)
+        __m256 va = _mm256_set1_ps (a);
+        __m256 vy;
+
+        for (i = 0; i < n; i += 8) {
+                vy = _mm256_loadu_ps (y + i);
+# if defined (__FMA__)
+                vy = _mm256_fmadd_ps (va, _mm256_loadu_ps (x + i), vy);
+# else
+                vy = _mm256_add_ps (vy, _mm256_mul_ps (va,
+                                                       _mm256_loadu_ps (x
+                                                                        + i)));
+# endif
+                _mm256_storeu_ps (y + i, vy);
+        }
+#elif defined (__SSE__)
+        __m128 va = _mm_set1_ps (a);
+        __m128 vy;
+
+        for (i = 0; i < n; i += 4) {
+                vy = _mm_loadu_ps (y + i);
+                vy = _mm_add_ps (vy, _mm_mul_ps (va, _mm_loadu_ps (x + i)));
+                _mm_storeu_ps (y + i, vy);
+        }
+#else
+        for (i = 0; i < n; ++i)
+                y[i] += a * x[i];
+#endif
+}
+
+/* n must be a multiple of GIBBON_EVALUATOR_ALIGN.  */
+static gfloat
+gibbon_evaluator_dot (const gfloat *x, const gfloat *y, gsize n)
+{
+        gsize i;
+#if defined (__AVX__)
+        __m256 sum = _mm256_setzero_ps ();
+        __m128 low;
+
+        for (i = 0; i < n; i += 8)
+                sum = _mm256_add_ps (sum,
+                                     _mm256_mul_ps (_mm256_loadu_ps (x + i),
+                                                    _mm256_loadu_ps (y + i)));
+
+        low = _mm_add_ps (_mm256_castps256_ps128 (sum),
+                          _mm256_extractf128_ps (sum, 1));
+        low = _mm_add_ps (low, _mm_movehl_ps (low, low));
+        low = _mm_add_ss (low, _mm_shuffle_ps (low, low, 1));
+
+        return _mm_cvtss_f32 (low);
+#elif defined (__SSE__)
+        __m128 sum = _mm_setzero_ps ();
+
+        for (i = 0; i < n; i += 4)
+                sum = _mm_add_ps (sum, _mm_mul_ps (_mm_loadu_ps (x + i),
+                                                   _mm_loadu_ps (y + i)));
+
+        sum = _mm_add_ps (sum, _mm_movehl_ps (sum, sum));
+        sum = _mm_add_ss (sum, _mm_shuffle_ps (sum, sum, 1));
+
+        return _mm_cvtss_f32 (sum);
+#else
+        gfloat sum = 0.0f;
+
+        for (i = 0; i < n; ++i)
+                sum += x[i] * y[i];
+
+        return sum;
+#endif
+}
+
+static gfloat
+gibbon_evaluator_sigmoid (gfloat x)
+{
+        /* Avoid overflows in expf().  */
+        if (x < -40.0f)
+                return 0.0f;
+        else if (x > 40.0f)
+                return 1.0f;
+
+        return 1.0f / (1.0f + expf (-x));
+}
+
+/*
+ * Check whether the side that made the play has borne off all checkers
+ * and fill in the exact result.
+ */
+static gboolean
+gibbon_evaluator_game_over (const gint8 board[26],
+                            gdouble p[GIBBON_EVALUATOR_OUTPUTS])
+{
+        gint i;
+        gint opponent = board[0];
+        gboolean backgammon = board[0] > 0;
+
+        if (board[25])
+                return FALSE;
+
+        for (i = 1; i <= 24; ++i) {
+                if (board[i] > 0)
+                        return FALSE;
+                opponent -= board[i];
+                if (board[i] < 0 && i <= 6)
+                        backgammon = TRUE;
+        }
+
+        p[GIBBON_ANALYSIS_MOVE_PWIN] = 1.0;
+        p[GIBBON_ANALYSIS_MOVE_PWIN_GAMMON] = opponent == 15 ? 1.0 : 0.0;
+        p[GIBBON_ANALYSIS_MOVE_PWIN_BACKGAMMON] =
+                opponent == 15 && backgammon ? 1.0 : 0.0;
+        p[GIBBON_ANALYSIS_MOVE_PLOSE_GAMMON] = 0.0;
+        p[GIBBON_ANALYSIS_MOVE_PLOSE_BACKGAMMON] = 0.0;
+
+        return TRUE;
+}
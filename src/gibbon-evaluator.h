@@ -0,0 +1,78 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GIBBON_EVALUATOR_H
+# define _GIBBON_EVALUATOR_H
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "gibbon-position.h"
+
+G_BEGIN_DECLS
+
+/* Four inputs for each of the 24 points and the bar, for both sides.  */
+#define GIBBON_EVALUATOR_INPUTS 200
+
+/*
+ * Probabilities in the order used by GibbonAnalysisMove: win, win gammon,
+ * win backgammon, lose gammon, lose backgammon.
+ */
+#define GIBBON_EVALUATOR_OUTPUTS 5
+
+/**
+ * GibbonEvaluator:
+ *
+ * A neural network with one hidden layer that estimates the outcome of
+ * a backgammon position.  All members are private.
+ */
+typedef struct _GibbonEvaluator GibbonEvaluator;
+
+GibbonEvaluator *gibbon_evaluator_new (guint num_hidden,
+                                       const gfloat *hidden_weights,
+                                       const gfloat *hidden_bias,
+                                       const gfloat *output_weights,
+                                       const gfloat *output_bias);
+GibbonEvaluator *gibbon_evaluator_load (const gchar *path, GError **error);
+void gibbon_evaluator_free (GibbonEvaluator *self);
+gboolean gibbon_evaluator_save (const GibbonEvaluator *self,
+                                const gchar *path, GError **error);
+guint gibbon_evaluator_get_num_hidden (const GibbonEvaluator *self);
+
+void gibbon_evaluator_encode (const gint8 board[26],
+                              gfloat inputs[GIBBON_EVALUATOR_INPUTS]);
+void gibbon_evaluator_evaluate (const GibbonEvaluator *self,
+                                const GibbonPosition *pos,
+                                GibbonPositionSide side,
+                                gdouble p[GIBBON_EVALUATOR_OUTPUTS]);
+void gibbon_evaluator_evaluate_plays (const GibbonEvaluator *self,
+                                      const GibbonPositionPlay *plays,
+                                      gsize num_plays,
+                                      gdouble (*p)[GIBBON_EVALUATOR_OUTPUTS]);
+gsize gibbon_evaluator_rank_plays (const GibbonEvaluator *self,
+                                   const GibbonPositionPlay *plays,
+                                   gsize num_plays,
+                                   gdouble p[GIBBON_EVALUATOR_OUTPUTS]);
+
+G_END_DECLS
+
+#endif
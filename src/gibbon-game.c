@@ -27,6 +27,7 @@
  **/
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <glib.h>
 #include <glib/gi18n.h>
@@ -36,13 +37,66 @@
 #include "gibbon-game-actions.h"
 #include "gibbon-util.h"
 
+/*
+ * The properties of a position that change rarely during a game.  They are
+ * stored once per change and shared by all snapshots.
+ */
+typedef struct _GibbonGameScalars GibbonGameScalars;
+struct _GibbonGameScalars {
+        guint64 match_length;
+        guint64 cube;
+        guint64 scores[2];
+        gint64 resigned;
+        guint64 score;
+        gboolean may_double[2];
+        gboolean dice_swapped;
+};
+
+/*
+ * A position packed into 32 bytes.  Player names and the game info are
+ * taken from the initial position, and the status is re-created from the
+ * actions.
+ */
+typedef struct _GibbonGamePackedPosition GibbonGamePackedPosition;
+struct _GibbonGamePackedPosition {
+        gint8 points[24];
+        guint8 bar[2];
+        gint8 dice[2];
+        gint8 turn;
+        gint8 cube_turned;
+        guint16 scalars;
+};
+
+typedef struct _GibbonGameSnapshot GibbonGameSnapshot;
+struct _GibbonGameSnapshot {
+        GibbonGameAction *action;
+        GibbonAnalysis *analysis;
+        gint64 timestamp;
+        GibbonPositionSide side;
+        GibbonGamePackedPosition position;
+};
+
+/*
+ * Number of unpacked positions kept around by gibbon_game_get_nth_position().
+ */
+#define GIBBON_GAME_CACHE_SIZE 4
+
 typedef struct _GibbonGamePrivate GibbonGamePrivate;
 struct _GibbonGamePrivate {
         GibbonPosition *initial_position;
         gboolean edited;
 
         gsize num_snapshots;
+        gsize allocated_snapshots;
         GibbonGameSnapshot *snapshots;
+        GArray *scalars;
+
+        /* The resulting position of the last snapshot, unpacked.  */
+        GibbonPosition *position;
+
+        GibbonPosition *cached_positions[GIBBON_GAME_CACHE_SIZE];
+        gsize cached_indices[GIBBON_GAME_CACHE_SIZE];
+        guint next_cached;
 
         gint64 score;
         gboolean resigned;
@@ -97,6 +151,17 @@ static const GibbonGameSnapshot *gibbon_game_get_snapshot (const GibbonGame
                                                            *self);
 static const GibbonGameSnapshot *gibbon_game_get_nth_snapshot (const GibbonGame
                                                                *self, gint n);
+static void gibbon_game_pack_position (GibbonGame *self,
+                                       const GibbonPosition *position,
+                                       GibbonGamePackedPosition *packed);
+static void gibbon_game_unpack_position (const GibbonGame *self, gsize n,
+                                         GibbonPosition *position);
+static GibbonPosition *gibbon_game_materialize (const GibbonGame *self,
+                                                gsize n);
+static void gibbon_game_cache_position (const GibbonGame *self, gsize n,
+                                        GibbonPosition *position);
+static gchar *gibbon_game_format_status (const GibbonGame *self, gsize n,
+                                         const GibbonPosition *position);
 
 static void 
 gibbon_game_init (GibbonGame *self)
@@ -109,6 +174,14 @@ gibbon_game_init (GibbonGame *self)
 
         self->priv->snapshots = NULL;
         self->priv->num_snapshots = 0;
+        self->priv->allocated_snapshots = 0;
+        self->priv->scalars = g_array_new (FALSE, TRUE,
+                                           sizeof (GibbonGameScalars));
+
+        self->priv->position = NULL;
+        memset (self->priv->cached_positions, 0,
+                sizeof self->priv->cached_positions);
+        self->priv->next_cached = 0;
 
         self->priv->score = 0;
         self->priv->resigned = FALSE;
@@ -132,9 +205,15 @@ gibbon_game_finalize (GObject *object)
                 g_object_unref (snapshot->action);
                 if (snapshot->analysis)
                         g_object_unref (snapshot->analysis);
-                gibbon_position_free (snapshot->resulting_position);
         }
         g_free (self->priv->snapshots);
+        g_array_free (self->priv->scalars, TRUE);
+
+        if (self->priv->position)
+                gibbon_position_free (self->priv->position);
+        for (i = 0; i < GIBBON_GAME_CACHE_SIZE; ++i)
+                if (self->priv->cached_positions[i])
+                        gibbon_position_free (self->priv->cached_positions[i]);
 
         G_OBJECT_CLASS (gibbon_game_parent_class)->finalize(object);
 }
@@ -280,7 +359,6 @@ gibbon_game_add_roll (GibbonGame *self, GibbonPositionSide side,
                       GibbonRoll *roll, gint64 timestamp, GError **error)
 {
         GibbonPosition *pos;
-        const GibbonGameSnapshot *snapshot;
 
         if (gibbon_game_over (self)) {
                 g_set_error_literal (error, GIBBON_ERROR,
@@ -289,13 +367,7 @@ gibbon_game_add_roll (GibbonGame *self, GibbonPositionSide side,
                 return FALSE;
         }
 
-        snapshot = gibbon_game_get_snapshot (self);
-
-        if (snapshot) {
-                pos = gibbon_position_copy (snapshot->resulting_position);
-        } else {
-                pos = gibbon_position_copy (self->priv->initial_position);
-        }
+        pos = gibbon_position_copy (gibbon_game_get_position (self));
 
         if (side && pos->turn && side != pos->turn) {
                 gibbon_position_free (pos);
@@ -344,7 +416,6 @@ gibbon_game_add_move (GibbonGame *self, GibbonPositionSide side,
                       GibbonMove *move, gint64 timestamp, GError **error)
 {
         GibbonPosition *pos;
-        gchar *pretty_move;
 
         gibbon_return_val_if_fail (move->number <= 4, FALSE, error);
 
@@ -384,27 +455,6 @@ gibbon_game_add_move (GibbonGame *self, GibbonPositionSide side,
                 return FALSE;
         }
 
-        g_free (pos->status);
-        if (move->movements) {
-                pretty_move = gibbon_position_format_move (pos, move, side,
-                                                           FALSE);
-                pos->status = g_strdup_printf (_("%d%d: %s has moved %s."),
-                                               move->die1, move->die2,
-                                               side
-                                               == GIBBON_POSITION_SIDE_BLACK
-                                               ? pos->players[1]
-                                               : pos->players[0],
-                                               pretty_move);
-                g_free (pretty_move);
-        } else {
-                pos->status = g_strdup_printf (_("%d%d: %s cannot move!"),
-                                               move->die1, move->die2,
-                                               side
-                                               == GIBBON_POSITION_SIDE_BLACK
-                                               ? pos->players[1]
-                                               : pos->players[0]);
-        }
-
         gibbon_game_add_snapshot (self, GIBBON_GAME_ACTION (move), side, pos,
                                   timestamp);
 
@@ -460,16 +510,10 @@ gibbon_game_add_double (GibbonGame *self, GibbonPositionSide side,
                 return FALSE;
         }
 
-        g_free (pos->status);
-        if (side == GIBBON_POSITION_SIDE_WHITE) {
+        if (side == GIBBON_POSITION_SIDE_WHITE)
                 pos->cube_turned = GIBBON_POSITION_SIDE_WHITE;
-                pos->status = g_strdup_printf (_("%s offers a double."),
-                                               pos->players[0]);
-        } else {
+        else
                 pos->cube_turned = GIBBON_POSITION_SIDE_BLACK;
-                pos->status = g_strdup_printf (_("%s offers a double."),
-                                               pos->players[1]);
-        }
 
         /* Beaver? */
         snapshot = gibbon_game_get_snapshot (self);
@@ -503,20 +547,14 @@ gibbon_game_add_drop (GibbonGame *self, GibbonPositionSide side,
                 return FALSE;
         }
 
-        g_free (pos->status);
         if (side == GIBBON_POSITION_SIDE_WHITE) {
                 self->priv->score = -pos->cube;
                 pos->scores[1] += pos->cube;
                 pos->score = pos->cube;
-                pos->status = g_strdup_printf (_("%s refuses the cube."),
-                                               pos->players[0]);
-
         } else {
                 self->priv->score = pos->cube;
                 pos->scores[0] += pos->cube;
                 pos->score = -pos->cube;
-                pos->status = g_strdup_printf (_("%s refuses the cube."),
-                                               pos->players[1]);
         }
 
         pos->cube_turned = GIBBON_POSITION_SIDE_NONE;
@@ -602,7 +640,6 @@ gibbon_game_add_reject (GibbonGame *self, GibbonPositionSide side,
                         GibbonReject *reject, gint64 timestamp, GError **error)
 {
         GibbonPosition *pos;
-        gchar *player;
         GibbonPositionSide other;
         const GibbonGameSnapshot *snapshot = NULL;
 
@@ -630,15 +667,6 @@ gibbon_game_add_reject (GibbonGame *self, GibbonPositionSide side,
 
         pos->resigned = 0;
 
-        if (side == GIBBON_POSITION_SIDE_BLACK) {
-                player = pos->players[1];
-        } else {
-                player = pos->players[0];
-        }
-
-        g_free (pos->status);
-        pos->status = g_strdup_printf (_("%s rejects."), player);
-
         gibbon_game_add_snapshot (self, GIBBON_GAME_ACTION (reject), side, pos,
                                   timestamp);
 
@@ -678,16 +706,6 @@ gibbon_game_add_accept (GibbonGame *self, GibbonPositionSide side,
 
         pos = gibbon_position_copy (gibbon_game_get_position (self));
 
-        g_free (pos->status);
-        pos->status = g_strdup_printf (
-                        g_dngettext (GETTEXT_PACKAGE,
-                                     "%s resigns and gives up one point.",
-                                     "%s resigns and gives up %llu points.",
-                                     resign->value),
-                      other == GIBBON_POSITION_SIDE_BLACK ?
-                                      pos->players[0] : pos->players[1],
-                      (unsigned long long) pos->cube);
-
         if (side == GIBBON_POSITION_SIDE_BLACK) {
                 pos->scores[1] += resign->value;
                 self->priv->score = -resign->value;
@@ -718,13 +736,10 @@ gibbon_game_over (const GibbonGame *self)
 const GibbonPosition *
 gibbon_game_get_position (const GibbonGame *self)
 {
-        const GibbonGameSnapshot *snapshot;
-
         g_return_val_if_fail (GIBBON_IS_GAME (self), NULL);
 
-        snapshot = gibbon_game_get_snapshot (self);
-        if (snapshot)
-                return snapshot->resulting_position;
+        if (self->priv->position)
+                return self->priv->position;
         else
                 return self->priv->initial_position;
 }
@@ -735,18 +750,219 @@ gibbon_game_add_snapshot (GibbonGame *self, GibbonGameAction *action,
                           gint64 timestamp)
 {
         GibbonGameSnapshot *snapshot;
+        gsize n = self->priv->num_snapshots;
+        gchar *status;
+
+        /*
+         * Grow geometrically, so that recording a game stays linear in the
+         * number of actions.
+         */
+        if (n >= self->priv->allocated_snapshots) {
+                self->priv->allocated_snapshots =
+                        self->priv->allocated_snapshots
+                        ? self->priv->allocated_snapshots << 1 : 64;
+                self->priv->snapshots =
+                        g_renew (GibbonGameSnapshot, self->priv->snapshots,
+                                 self->priv->allocated_snapshots);
+        }
+        ++self->priv->num_snapshots;
 
-        self->priv->snapshots = g_realloc (self->priv->snapshots,
-                                           ++self->priv->num_snapshots
-                                           * sizeof *self->priv->snapshots);
-
-        snapshot = self->priv->snapshots + self->priv->num_snapshots - 1;
+        snapshot = self->priv->snapshots + n;
 
         snapshot->action = action;
         snapshot->side = side;
-        snapshot->resulting_position = position;
         snapshot->analysis = NULL;
         snapshot->timestamp = timestamp;
+        gibbon_game_pack_position (self, position, &snapshot->position);
+
+        status = gibbon_game_format_status (self, n, position);
+        if (status) {
+                g_free (position->status);
+                position->status = status;
+        }
+
+        /*
+         * The previous position may still be referenced by the caller.  It
+         * is therefore moved to the cache instead of being freed.
+         */
+        if (self->priv->position)
+                gibbon_game_cache_position (self, n - 1, self->priv->position);
+        self->priv->position = position;
+}
+
+static void
+gibbon_game_pack_position (GibbonGame *self, const GibbonPosition *position,
+                           GibbonGamePackedPosition *packed)
+{
+        GibbonGameScalars scalars;
+        GArray *table = self->priv->scalars;
+        gint i;
+
+        for (i = 0; i < 24; ++i)
+                packed->points[i] = position->points[i];
+        packed->bar[0] = position->bar[0];
+        packed->bar[1] = position->bar[1];
+        packed->dice[0] = (gint) position->dice[0];
+        packed->dice[1] = (gint) position->dice[1];
+        packed->turn = position->turn;
+        packed->cube_turned = position->cube_turned;
+
+        memset (&scalars, 0, sizeof scalars);
+        scalars.match_length = position->match_length;
+        scalars.cube = position->cube;
+        scalars.scores[0] = position->scores[0];
+        scalars.scores[1] = position->scores[1];
+        scalars.resigned = position->resigned;
+        scalars.score = position->score;
+        scalars.may_double[0] = position->may_double[0];
+        scalars.may_double[1] = position->may_double[1];
+        scalars.dice_swapped = position->dice_swapped;
+
+        /*
+         * A new record is only needed after a cube action, a resignation,
+         * or at the end of the game.
+         */
+        if (!table->len
+            || memcmp (&scalars,
+                       &g_array_index (table, GibbonGameScalars,
+                                       table->len - 1),
+                       sizeof scalars))
+                g_array_append_val (table, scalars);
+
+        packed->scalars = table->len - 1;
+}
+
+static void
+gibbon_game_unpack_position (const GibbonGame *self, gsize n,
+                             GibbonPosition *position)
+{
+        const GibbonGamePackedPosition *packed =
+                        &self->priv->snapshots[n].position;
+        const GibbonGameScalars *scalars =
+                        &g_array_index (self->priv->scalars, GibbonGameScalars,
+                                        packed->scalars);
+        gint i;
+
+        for (i = 0; i < 24; ++i)
+                position->points[i] = packed->points[i];
+        position->bar[0] = packed->bar[0];
+        position->bar[1] = packed->bar[1];
+        position->dice[0] = packed->dice[0];
+        position->dice[1] = packed->dice[1];
+        position->turn = packed->turn;
+        position->cube_turned = packed->cube_turned;
+
+        position->match_length = scalars->match_length;
+        position->cube = scalars->cube;
+        position->scores[0] = scalars->scores[0];
+        position->scores[1] = scalars->scores[1];
+        position->resigned = scalars->resigned;
+        position->score = scalars->score;
+        position->may_double[0] = scalars->may_double[0];
+        position->may_double[1] = scalars->may_double[1];
+        position->dice_swapped = scalars->dice_swapped;
+
+        memset (position->unused_dice, 0, sizeof position->unused_dice);
+}
+
+static GibbonPosition *
+gibbon_game_materialize (const GibbonGame *self, gsize n)
+{
+        const GibbonPosition *initial = self->priv->initial_position;
+        GibbonPosition *position = gibbon_position_new ();
+        GibbonPosition scratch;
+        gchar *status = NULL;
+        gsize i;
+
+        gibbon_game_unpack_position (self, n, position);
+        position->players[0] = g_strdup (initial->players[0]);
+        position->players[1] = g_strdup (initial->players[1]);
+        position->game_info = g_strdup (initial->game_info);
+
+        /*
+         * The status is that of the last action that changed it.  The
+         * names are borrowed from the initial position, and the scratch
+         * position must therefore not be freed.
+         */
+        scratch = *initial;
+        for (i = n + 1; i-- > 0;) {
+                gibbon_game_unpack_position (self, i, &scratch);
+                status = gibbon_game_format_status (self, i, &scratch);
+                if (status)
+                        break;
+        }
+        position->status = status ? status : g_strdup (initial->status);
+
+        return position;
+}
+
+static void
+gibbon_game_cache_position (const GibbonGame *self, gsize n,
+                            GibbonPosition *position)
+{
+        GibbonGamePrivate *priv = self->priv;
+        guint slot = priv->next_cached;
+
+        priv->next_cached = (slot + 1) % GIBBON_GAME_CACHE_SIZE;
+
+        if (priv->cached_positions[slot])
+                gibbon_position_free (priv->cached_positions[slot]);
+        priv->cached_positions[slot] = position;
+        priv->cached_indices[slot] = n;
+}
+
+/*
+ * Returns the new status for the action of snapshot N, or NULL if the
+ * action does not change the status.
+ */
+static gchar *
+gibbon_game_format_status (const GibbonGame *self, gsize n,
+                           const GibbonPosition *pos)
+{
+        const GibbonGameSnapshot *snapshot = self->priv->snapshots + n;
+        GibbonGameAction *action = snapshot->action;
+        GibbonPositionSide side = snapshot->side;
+        GibbonMove *move;
+        GibbonResign *resign;
+        gchar *pretty_move;
+        gchar *status;
+        const gchar *player;
+
+        player = side == GIBBON_POSITION_SIDE_BLACK ?
+                        pos->players[1] : pos->players[0];
+
+        if (GIBBON_IS_MOVE (action)) {
+                move = GIBBON_MOVE (action);
+                if (!move->movements)
+                        return g_strdup_printf (_("%d%d: %s cannot move!"),
+                                                move->die1, move->die2,
+                                                player);
+                pretty_move = gibbon_position_format_move (pos, move, side,
+                                                           FALSE);
+                status = g_strdup_printf (_("%d%d: %s has moved %s."),
+                                          move->die1, move->die2,
+                                          player, pretty_move);
+                g_free (pretty_move);
+                return status;
+        } else if (GIBBON_IS_DOUBLE (action)) {
+                return g_strdup_printf (_("%s offers a double."), player);
+        } else if (GIBBON_IS_DROP (action)) {
+                return g_strdup_printf (_("%s refuses the cube."), player);
+        } else if (GIBBON_IS_REJECT (action)) {
+                return g_strdup_printf (_("%s rejects."), player);
+        } else if (GIBBON_IS_ACCEPT (action) && n) {
+                resign = GIBBON_RESIGN (snapshot[-1].action);
+                return g_strdup_printf (
+                        g_dngettext (GETTEXT_PACKAGE,
+                                     "%s resigns and gives up one point.",
+                                     "%s resigns and gives up %llu points.",
+                                     resign->value),
+                      side == GIBBON_POSITION_SIDE_WHITE ?
+                                      pos->players[0] : pos->players[1],
+                      (unsigned long long) pos->cube);
+        }
+
+        return NULL;
 }
 
 static const GibbonGameSnapshot *
@@ -799,19 +1015,45 @@ gibbon_game_get_edited (const GibbonGame *self)
         return self->priv->edited;
 }
 
+/**
+ * gibbon_game_get_nth_position:
+ * @self: The #GibbonGame.
+ * @n: Index of the action, counting from the end if negative.
+ *
+ * Snapshots are stored in a packed form and unpacked on demand.  The
+ * returned position is owned by @self and is only valid until a few other
+ * positions have been retrieved.  Use gibbon_position_copy() if you need it
+ * for longer.
+ *
+ * Returns: The position resulting from the @n-th action or %NULL.
+ */
 const GibbonPosition *
 gibbon_game_get_nth_position (const GibbonGame *self, gint n)
 {
         const GibbonGameSnapshot *snapshot;
+        GibbonPosition *position;
+        gsize i;
+        guint slot;
 
         g_return_val_if_fail (GIBBON_IS_GAME (self), NULL);
 
         snapshot = gibbon_game_get_nth_snapshot (self, n);
-
-        if (snapshot)
-                return snapshot->resulting_position;
-        else
+        if (!snapshot)
                 return NULL;
+
+        i = snapshot - self->priv->snapshots;
+        if (i + 1 == self->priv->num_snapshots)
+                return self->priv->position;
+
+        for (slot = 0; slot < GIBBON_GAME_CACHE_SIZE; ++slot)
+                if (self->priv->cached_positions[slot]
+                    && self->priv->cached_indices[slot] == i)
+                        return self->priv->cached_positions[slot];
+
+        position = gibbon_game_materialize (self, i);
+        gibbon_game_cache_position (self, i, position);
+
+        return position;
 }
 
 GibbonAnalysis *
@@ -872,7 +1114,6 @@ void
 gibbon_game_set_white (GibbonGame *self, const gchar *white)
 {
         GibbonPosition *position;
-        GibbonGameSnapshot *snapshot;
         gsize i;
 
         g_return_if_fail (GIBBON_IS_GAME (self));
@@ -881,9 +1122,13 @@ gibbon_game_set_white (GibbonGame *self, const gchar *white)
         g_free (position->players[0]);
         position->players[0] = g_strdup (white);
 
-        for (i = 0; i < self->priv->num_snapshots; ++i) {
-                snapshot = self->priv->snapshots + i;
-                position = snapshot->resulting_position;
+        for (i = 0; i <= GIBBON_GAME_CACHE_SIZE; ++i) {
+                if (i < GIBBON_GAME_CACHE_SIZE)
+                        position = self->priv->cached_positions[i];
+                else
+                        position = self->priv->position;
+                if (!position)
+                        continue;
                 g_free (position->players[0]);
                 position->players[0] = g_strdup (white);
         }
@@ -895,7 +1140,6 @@ void
 gibbon_game_set_black (GibbonGame *self, const gchar *black)
 {
         GibbonPosition *position;
-        GibbonGameSnapshot *snapshot;
         gsize i;
 
         g_return_if_fail (GIBBON_IS_GAME (self));
@@ -904,9 +1148,13 @@ gibbon_game_set_black (GibbonGame *self, const gchar *black)
         g_free (position->players[1]);
         position->players[1] = g_strdup (black);
 
-        for (i = 0; i < self->priv->num_snapshots; ++i) {
-                snapshot = self->priv->snapshots + i;
-                position = snapshot->resulting_position;
+        for (i = 0; i <= GIBBON_GAME_CACHE_SIZE; ++i) {
+                if (i < GIBBON_GAME_CACHE_SIZE)
+                        position = self->priv->cached_positions[i];
+                else
+                        position = self->priv->position;
+                if (!position)
+                        continue;
                 g_free (position->players[1]);
                 position->players[1] = g_strdup (black);
         }
@@ -918,7 +1166,6 @@ void
 gibbon_game_set_match_length (GibbonGame *self, gsize length)
 {
         GibbonPosition *position;
-        GibbonGameSnapshot *snapshot;
         gsize i;
 
         g_return_if_fail (GIBBON_IS_GAME (self));
@@ -926,10 +1173,17 @@ gibbon_game_set_match_length (GibbonGame *self, gsize length)
         position = self->priv->initial_position;
         position->match_length = length;
 
-        for (i = 0; i < self->priv->num_snapshots; ++i) {
-                snapshot = self->priv->snapshots + i;
-                position = snapshot->resulting_position;
-                position->match_length = length;
+        for (i = 0; i < self->priv->scalars->len; ++i)
+                g_array_index (self->priv->scalars, GibbonGameScalars,
+                               i).match_length = length;
+
+        for (i = 0; i <= GIBBON_GAME_CACHE_SIZE; ++i) {
+                if (i < GIBBON_GAME_CACHE_SIZE)
+                        position = self->priv->cached_positions[i];
+                else
+                        position = self->priv->position;
+                if (position)
+                        position->match_length = length;
         }
 
         return;
@@ -0,0 +1,470 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gibbon-geo-ip-snapshot
+ * @short_description: Compiled, memory-mapped GeoIP table.
+ *
+ * Since: 0.2.0
+ *
+ * The GeoIP data is compiled into a flat binary file that can be
+ * memory-mapped at startup.  The snapshot of the ip2country file shipped
+ * with Gibbon is created by gibbon-make-geo-ip at build time, online
+ * updates are imported into the database and compiled into a per-user
+ * snapshot.
+ *
+ * The file starts with a #GibbonGeoIPSnapshotHeader, followed by the
+ * #GibbonDatabaseIPRange records sorted by start address.  All numbers
+ * are stored in little-endian byte order.
+ *
+ * Loading a snapshot only checks the header and the file size so that
+ * pages of the table are only read when they are needed for a lookup.
+ * The checksum over the records can be verified later with
+ * gibbon_geo_ip_snapshot_verify().  On big-endian machines the records
+ * are converted into memory instead, and the checksum is verified while
+ * loading.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "gibbon-geo-ip-snapshot.h"
+#include "gibbon-util.h"
+
+#define GIBBON_GEO_IP_SNAPSHOT_MAGIC "GibbonIP"
+#define GIBBON_GEO_IP_SNAPSHOT_VERSION 3
+
+typedef struct _GibbonGeoIPSnapshotHeader GibbonGeoIPSnapshotHeader;
+struct _GibbonGeoIPSnapshotHeader {
+        GibbonFileHeader file;
+        guint32 record_size;
+        guint32 num_ranges;
+};
+
+static gboolean gibbon_geo_ip_snapshot_field (const gchar **ptr,
+                                              const gchar *end,
+                                              const gchar **field,
+                                              gsize *length);
+static gboolean gibbon_geo_ip_snapshot_ip (const gchar *field, gsize length,
+                                           guint32 *ip);
+
+struct _GibbonGeoIPSnapshot {
+        GMappedFile *mapped;
+
+        /* Points into the mapped file or is owned if not mapped.  */
+        GibbonDatabaseIPRange *ranges;
+        gsize num_ranges;
+};
+
+/**
+ * gibbon_geo_ip_snapshot_new:
+ * @ranges: (transfer full): The ranges sorted by start address.
+ * @num_ranges: Number of elements in @ranges.
+ *
+ * Creates a new #GibbonGeoIPSnapshot from memory.  The snapshot takes
+ * ownership of @ranges which must have been allocated with g_malloc().
+ *
+ * Returns: The new #GibbonGeoIPSnapshot, free with
+ *          gibbon_geo_ip_snapshot_free().
+ */
+GibbonGeoIPSnapshot *
+gibbon_geo_ip_snapshot_new (GibbonDatabaseIPRange *ranges, gsize num_ranges)
+{
+        GibbonGeoIPSnapshot *self = g_malloc (sizeof *self);
+
+        self->mapped = NULL;
+        self->ranges = ranges;
+        self->num_ranges = ranges ? num_ranges : 0;
+
+        return self;
+}
+
+/**
+ * gibbon_geo_ip_snapshot_load:
+ * @path: The snapshot file.
+ * @error: Location to store errors or %NULL.
+ *
+ * Memory-maps a snapshot file written by gibbon_geo_ip_snapshot_save().
+ * Only the header and the size of the file are checked, the records are
+ * not read.  Use gibbon_geo_ip_snapshot_verify() for a complete check.
+ * On big-endian machines the records are converted and verified
+ * immediately.
+ *
+ * Returns: The new #GibbonGeoIPSnapshot or %NULL in case of failure.
+ */
+GibbonGeoIPSnapshot *
+gibbon_geo_ip_snapshot_load (const gchar *path, GError **error)
+{
+        GibbonGeoIPSnapshot *self;
+        GMappedFile *mapped;
+        const GibbonGeoIPSnapshotHeader *header;
+        GibbonDatabaseIPRange *ranges;
+        gsize length;
+        gsize num_ranges;
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+        gsize i;
+#endif
+
+        gibbon_return_val_if_fail (path != NULL, NULL, error);
+
+        mapped = gibbon_map_checked_file (path, GIBBON_GEO_IP_SNAPSHOT_MAGIC,
+                                          GIBBON_GEO_IP_SNAPSHOT_VERSION,
+                                          sizeof *header,
+                                          G_BYTE_ORDER == G_BIG_ENDIAN,
+                                          error);
+        if (!mapped)
+                return NULL;
+
+        length = g_mapped_file_get_length (mapped);
+        header = (const GibbonGeoIPSnapshotHeader *)
+                        g_mapped_file_get_contents (mapped);
+
+        if (GUINT32_FROM_LE (header->record_size) != sizeof *ranges) {
+                g_set_error (error, GIBBON_ERROR, -1,
+                             _("`%s' is not a GeoIP snapshot file!"), path);
+                g_mapped_file_unref (mapped);
+                return NULL;
+        }
+
+        num_ranges = GUINT32_FROM_LE (header->num_ranges);
+        ranges = (GibbonDatabaseIPRange *) (header + 1);
+        length -= sizeof *header;
+        if (length % sizeof *ranges
+            || length / sizeof *ranges != num_ranges) {
+                g_set_error (error, GIBBON_ERROR, -1,
+                             _("GeoIP snapshot file `%s' is corrupted!"),
+                             path);
+                g_mapped_file_unref (mapped);
+                return NULL;
+        }
+
+        self = g_malloc (sizeof *self);
+        self->num_ranges = num_ranges;
+
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+        self->ranges = g_memdup (ranges, length);
+        for (i = 0; i < num_ranges; ++i) {
+                self->ranges[i].start = GUINT32_FROM_LE (ranges[i].start);
+                self->ranges[i].end = GUINT32_FROM_LE (ranges[i].end);
+        }
+        g_mapped_file_unref (mapped);
+        self->mapped = NULL;
+#else
+        self->mapped = mapped;
+        self->ranges = ranges;
+#endif
+
+        return self;
+}
+
+/**
+ * gibbon_geo_ip_snapshot_verify:
+ * @self: The #GibbonGeoIPSnapshot.
+ * @error: Location to store errors or %NULL.
+ *
+ * Compares the checksum stored in the snapshot file with the mapped
+ * records.  This reads the complete table.  Snapshots created in memory
+ * or converted while loading are always valid.
+ *
+ * Returns: %TRUE if the records are intact, %FALSE otherwise.
+ */
+gboolean
+gibbon_geo_ip_snapshot_verify (const GibbonGeoIPSnapshot *self,
+                               GError **error)
+{
+        gibbon_return_val_if_fail (self != NULL, FALSE, error);
+
+        if (!self->mapped)
+                return TRUE;
+
+        if (!gibbon_verify_checked_file (self->mapped)) {
+                g_set_error_literal (error, GIBBON_ERROR, -1,
+                                     _("GeoIP snapshot file is corrupted!"));
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+void
+gibbon_geo_ip_snapshot_free (GibbonGeoIPSnapshot *self)
+{
+        if (!self)
+                return;
+
+        if (self->mapped)
+                g_mapped_file_unref (self->mapped);
+        else
+                g_free (self->ranges);
+
+        g_free (self);
+}
+
+/**
+ * gibbon_geo_ip_snapshot_save:
+ * @self: The #GibbonGeoIPSnapshot.
+ * @path: The output file.
+ * @error: Location to store errors or %NULL.
+ *
+ * Writes the snapshot into @path.  The file is replaced atomically so that
+ * a concurrently running instance never maps a half-written file.
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_geo_ip_snapshot_save (const GibbonGeoIPSnapshot *self,
+                             const gchar *path, GError **error)
+{
+        GibbonGeoIPSnapshotHeader *header;
+        GibbonDatabaseIPRange *ranges;
+        gsize data_size;
+        gchar *buffer;
+        gboolean retval;
+        gsize i;
+
+        gibbon_return_val_if_fail (self != NULL, FALSE, error);
+        gibbon_return_val_if_fail (path != NULL, FALSE, error);
+
+        data_size = self->num_ranges * sizeof *self->ranges;
+        buffer = g_malloc0 (sizeof *header + data_size);
+        header = (GibbonGeoIPSnapshotHeader *) buffer;
+
+        header->record_size = GUINT32_TO_LE (sizeof *self->ranges);
+        header->num_ranges = GUINT32_TO_LE (self->num_ranges);
+
+        /* Copy field by field, so that the padding is zero.  */
+        ranges = (GibbonDatabaseIPRange *) (header + 1);
+        for (i = 0; i < self->num_ranges; ++i) {
+                ranges[i].start = GUINT32_TO_LE (self->ranges[i].start);
+                ranges[i].end = GUINT32_TO_LE (self->ranges[i].end);
+                ranges[i].alpha2[0] = self->ranges[i].alpha2[0];
+                ranges[i].alpha2[1] = self->ranges[i].alpha2[1];
+        }
+
+        retval = gibbon_save_checked_file (path, GIBBON_GEO_IP_SNAPSHOT_MAGIC,
+                                           GIBBON_GEO_IP_SNAPSHOT_VERSION,
+                                           buffer, sizeof *header + data_size,
+                                           error);
+        g_free (buffer);
+
+        return retval;
+}
+
+gsize
+gibbon_geo_ip_snapshot_get_num_ranges (const GibbonGeoIPSnapshot *self)
+{
+        g_return_val_if_fail (self != NULL, 0);
+
+        return self->num_ranges;
+}
+
+/**
+ * gibbon_geo_ip_snapshot_lookup:
+ * @self: The #GibbonGeoIPSnapshot.
+ * @address: An IPv4 address in host byte order.
+ * @alpha2: A buffer for the NUL-terminated country code.
+ *
+ * Looks up the country for @address.
+ *
+ * Returns: %TRUE if the address was found, %FALSE otherwise.
+ */
+gboolean
+gibbon_geo_ip_snapshot_lookup (const GibbonGeoIPSnapshot *self,
+                               guint32 address, gchar alpha2[3])
+{
+        const GibbonDatabaseIPRange *base;
+        gsize n;
+        gsize half;
+
+        g_return_val_if_fail (self != NULL, FALSE);
+
+        base = self->ranges;
+        n = self->num_ranges;
+        if (!n)
+                return FALSE;
+
+        /*
+         * Find the last range starting at or before the address.  The loop
+         * body compiles to a conditional move, and the number of iterations
+         * only depends on the size of the table.
+         */
+        while (n > 1) {
+                half = n >> 1;
+                base = (base[half].start <= address) ? base + half : base;
+                n -= half;
+        }
+
+        if (base->start > address || base->end < address)
+                return FALSE;
+
+        alpha2[0] = base->alpha2[0];
+        alpha2[1] = base->alpha2[1];
+        alpha2[2] = 0;
+
+        return TRUE;
+}
+
+/**
+ * gibbon_geo_ip_snapshot_parse_line:
+ * @line: One line of the ip2country CSV file, not NUL-terminated.
+ * @length: Length of @line without the newline.
+ * @range: Location to store the range.
+ * @near: Location to store the position of an error.
+ *
+ * Parses one line of the ip2country CSV file.  Lines look like this:
+ *
+ * "16777216","16777471","apnic","1313020800","AU","AUS","Australia"
+ *
+ * The country code is converted to lowercase.  In case of an error, @near
+ * points to the offending part of the line, or to its end if the line is
+ * incomplete.
+ *
+ * Returns: What the line contained.
+ */
+GibbonGeoIPLine
+gibbon_geo_ip_snapshot_parse_line (const gchar *line, gsize length,
+                                   GibbonDatabaseIPRange *range,
+                                   const gchar **near)
+{
+        const gchar *ptr = line;
+        const gchar *end = line + length;
+        const gchar *fields[7];
+        gsize lengths[7];
+        gsize i;
+
+        g_return_val_if_fail (line != NULL, GIBBON_GEO_IP_LINE_ERROR);
+        g_return_val_if_fail (range != NULL, GIBBON_GEO_IP_LINE_ERROR);
+        g_return_val_if_fail (near != NULL, GIBBON_GEO_IP_LINE_ERROR);
+
+        while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\r'))
+                ++ptr;
+
+        if (ptr == end || *ptr == '#')
+                return GIBBON_GEO_IP_LINE_EMPTY;
+
+        for (i = 0; i < G_N_ELEMENTS (fields); ++i) {
+                if (i) {
+                        if (ptr >= end || *ptr != ',')
+                                goto parse_error;
+                        ++ptr;
+                }
+                if (!gibbon_geo_ip_snapshot_field (&ptr, end, fields + i,
+                                                   lengths + i))
+                        goto parse_error;
+        }
+
+        /* Anything after the last field is ignored.  */
+
+        if (!gibbon_geo_ip_snapshot_ip (fields[0], lengths[0], &range->start))
+                goto field_error;
+        if (!gibbon_geo_ip_snapshot_ip (fields[1], lengths[1], &range->end))
+                goto field_error;
+        if (range->start > range->end)
+                goto field_error;
+
+        /* We are not prepared for escaping ... */
+        if (memchr (fields[2], '\\', lengths[2]))
+                goto field_error;
+
+        if (!lengths[3])
+                goto field_error;
+        for (i = 0; i < lengths[3]; ++i)
+                if (fields[3][i] < '0' || fields[3][i] > '9')
+                        goto field_error;
+
+        if (2 != lengths[4])
+                goto field_error;
+        for (i = 0; i < 2; ++i) {
+                if (fields[4][i] < 'A' || fields[4][i] > 'Z')
+                        goto field_error;
+                range->alpha2[i] = fields[4][i] - 'A' + 'a';
+        }
+
+        /* 3-letter code for EU is EU.  */
+        if (3 != lengths[5] && 2 != lengths[5])
+                goto field_error;
+        for (i = 0; i < lengths[5]; ++i)
+                if (fields[5][i] < 'A' || fields[5][i] > 'Z')
+                        goto field_error;
+
+        if (memchr (fields[6], '\\', lengths[6]))
+                goto field_error;
+
+        return GIBBON_GEO_IP_LINE_RANGE;
+
+field_error:
+        /* Point to the start of the offending line.  */
+        ptr = line;
+
+parse_error:
+        *near = ptr < end ? ptr : end;
+
+        return GIBBON_GEO_IP_LINE_ERROR;
+}
+
+/*
+ * Scans a field in double quotes.  On success, *ptr is advanced behind the
+ * closing quote.
+ */
+static gboolean
+gibbon_geo_ip_snapshot_field (const gchar **ptr, const gchar *end,
+                              const gchar **field, gsize *length)
+{
+        const gchar *start = *ptr;
+        const gchar *closing;
+
+        if (start >= end || *start != '"')
+                return FALSE;
+        ++start;
+
+        closing = memchr (start, '"', end - start);
+        if (!closing)
+                return FALSE;
+
+        *field = start;
+        *length = closing - start;
+        *ptr = closing + 1;
+
+        return TRUE;
+}
+
+static gboolean
+gibbon_geo_ip_snapshot_ip (const gchar *field, gsize length, guint32 *ip)
+{
+        guint64 num = 0;
+        gsize i;
+
+        if (!length || length > 10)
+                return FALSE;
+
+        for (i = 0; i < length; ++i) {
+                if (field[i] < '0' || field[i] > '9')
+                        return FALSE;
+                num = 10 * num + field[i] - '0';
+        }
+
+        if (num > G_MAXUINT32)
+                return FALSE;
+
+        *ip = (guint32) num;
+
+        return TRUE;
+}
@@ -0,0 +1,74 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GIBBON_GEO_IP_SNAPSHOT_H
+# define _GIBBON_GEO_IP_SNAPSHOT_H
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "gibbon-database.h"
+
+G_BEGIN_DECLS
+
+/**
+ * GibbonGeoIPSnapshot:
+ *
+ * A read-only, sorted table of IP ranges and their countries.  The table
+ * is either memory-mapped from a compiled snapshot file or owned by the
+ * structure.  All members are private.
+ */
+typedef struct _GibbonGeoIPSnapshot GibbonGeoIPSnapshot;
+
+/**
+ * GibbonGeoIPLine:
+ * @GIBBON_GEO_IP_LINE_EMPTY: An empty line or a comment.
+ * @GIBBON_GEO_IP_LINE_RANGE: A line with an IP range.
+ * @GIBBON_GEO_IP_LINE_ERROR: A malformed line.
+ *
+ * Result of parsing one line of the ip2country CSV file.
+ */
+typedef enum {
+        GIBBON_GEO_IP_LINE_EMPTY = 0,
+        GIBBON_GEO_IP_LINE_RANGE = 1,
+        GIBBON_GEO_IP_LINE_ERROR = 2
+} GibbonGeoIPLine;
+
+GibbonGeoIPSnapshot *gibbon_geo_ip_snapshot_new (GibbonDatabaseIPRange *ranges,
+                                                 gsize num_ranges);
+GibbonGeoIPSnapshot *gibbon_geo_ip_snapshot_load (const gchar *path,
+                                                  GError **error);
+void gibbon_geo_ip_snapshot_free (GibbonGeoIPSnapshot *self);
+gboolean gibbon_geo_ip_snapshot_verify (const GibbonGeoIPSnapshot *self,
+                                        GError **error);
+gboolean gibbon_geo_ip_snapshot_save (const GibbonGeoIPSnapshot *self,
+                                      const gchar *path, GError **error);
+gsize gibbon_geo_ip_snapshot_get_num_ranges (const GibbonGeoIPSnapshot *self);
+gboolean gibbon_geo_ip_snapshot_lookup (const GibbonGeoIPSnapshot *self,
+                                        guint32 address, gchar alpha2[3]);
+GibbonGeoIPLine gibbon_geo_ip_snapshot_parse_line (
+                const gchar *line, gsize length,
+                GibbonDatabaseIPRange *range, const gchar **near);
+
+G_END_DECLS
+
+#endif
@@ -26,14 +26,14 @@
  * Class for updating the Gibbon GeoIP database.
  */
 
-#include <errno.h>
+#include <string.h>
 
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
 
 #include "gibbon-app.h"
 #include "gibbon-geo-ip-updater.h"
-#include "gibbon-geo-ip-data.h"
+#include "gibbon-geo-ip-snapshot.h"
 
 typedef struct _GibbonGeoIPUpdaterPrivate GibbonGeoIPUpdaterPrivate;
 struct _GibbonGeoIPUpdaterPrivate {
@@ -49,11 +49,17 @@ struct _GibbonGeoIPUpdaterPrivate {
         GCancellable *cancellable;
         GInputStream *stream;
 
+        /*
+         * The decompressor writes directly into this buffer, and lines are
+         * parsed in place.  Only an incomplete last line is moved to the
+         * start.  The buffer only grows for lines longer than its size.
+         */
         gchar *buf;
-#define GIBBON_GEO_IP_UPDATER_CHUNK_SIZE 8192
+#define GIBBON_GEO_IP_UPDATER_CHUNK_SIZE 65536
         gsize buf_size;
         gsize buf_fill;
         gsize lineno;
+        gdouble fraction;
 };
 
 #define GIBBON_GEO_IP_UPDATER_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
@@ -94,6 +100,7 @@ gibbon_geo_ip_updater_init (GibbonGeoIPUpdater *self)
         self->priv->buf_size = 0;
         self->priv->buf_fill = 0;
         self->priv->lineno = 0;
+        self->priv->fraction = 0.0;
 }
 
 static void
@@ -139,127 +146,80 @@ gibbon_geo_ip_updater_class_init (GibbonGeoIPUpdaterClass *klass)
 /**
  * gibbon_geo_ip_updater_new:
  * @database: The #GibbonDatabase.
+ * @last_update: Time of the last online update in microseconds since the
+ *               epoch.
  *
- * Creates a new #GibbonGeoIPUpdater.
+ * Creates a new #GibbonGeoIPUpdater for refreshing the GeoIP database from
+ * the internet.  The user is asked first.  The database installed with the
+ * program is never imported, it is used as a compiled snapshot instead.
  *
- * Returns: The newly created #GibbonGeoIPUpdater or %NULL in case of failure.
+ * Returns: The newly created #GibbonGeoIPUpdater or %NULL if the user did
+ * not want an update.
  */
 GibbonGeoIPUpdater *
-gibbon_geo_ip_updater_new (GibbonDatabase *database,
-                           gint64 _last_update)
+gibbon_geo_ip_updater_new (GibbonDatabase *database, gint64 last_update)
 {
-        GibbonGeoIPUpdater *self = g_object_new (GIBBON_TYPE_GEO_IP_UPDATER, NULL);
+        GibbonGeoIPUpdater *self;
         GtkWindow *main_window;
-        guint64 diff;
+        GtkWidget *dialog;
         GtkDialogFlags flags;
         GtkMessageType mtype;
         GtkButtonsType btype;
         guint64 months;
         gchar *question;
-        gint64 last_update;
         gint reply;
-        gboolean download = FALSE;
-#ifdef G_OS_WIN32
-        gchar *win32_dir;
-#endif
 
-        self->priv->database = database;
+        g_return_val_if_fail (GIBBON_IS_DATABASE (database), NULL);
 
         main_window = GTK_WINDOW (gibbon_app_get_window (app));
 
-        if (_last_update == 0)
-                last_update = GIBBON_GEO_IP_DATA_UPDATE;
-        else
-                last_update = _last_update;
-
-        diff = (gint64) time (NULL) - last_update;
-        if (diff > 30 * 24 * 60 * 60) {
-                months = diff / (30 * 24 * 60 * 60);
-                flags = GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT;
-                mtype = GTK_MESSAGE_QUESTION;
-                btype = GTK_BUTTONS_YES_NO;
-                if (_last_update) {
-                        question = g_strdup_printf (g_dngettext (GETTEXT_PACKAGE,
-                                                    "Your database used for"
-                                                    " locating other players"
-                                                    " geographically is"
-                                                    " more than one month old. "
-                                                    " Should a new one be"
-                                                    " downloaded (1-2 MB) from"
-                                                    " the internet?",
-                                                    "Your database used for"
-                                                    " locating other players"
-                                                    " geographically is"
-                                                    " more than %llu months old. "
-                                                    " Should a new one be"
-                                                    " downloaded (1-2 MB) from"
-                                                    " the internet?",
-                                                    months),
-                                                    (unsigned long long) months);
-                } else {
-                        question = g_strdup_printf (g_dngettext (GETTEXT_PACKAGE,
-                                                    "The database used for"
-                                                    " locating other players"
-                                                    " geographically that"
-                                                    " was installed with this"
-                                                    " program is more than"
-                                                    " one month old. "
-                                                    " Should a new one be"
-                                                    " downloaded (1-2 MB) from"
-                                                    " the internet?",
-                                                    "The database used for"
-                                                    " locating other players"
-                                                    " geographically that"
-                                                    " was installed with this"
-                                                    " program is more than"
-                                                    " %llu months old. "
-                                                    " Should a new one be"
-                                                    " downloaded (1-2 MB) from"
-                                                    " the internet?",
-                                                    months),
-                                                    (unsigned long long) months);
-                }
-
-                self->priv->dialog = gtk_message_dialog_new (main_window,
-                                                             flags, mtype,
-                                                             btype,
-                                                             "%s", question);
-                g_free (question);
-                gtk_dialog_set_default_response (GTK_DIALOG (self->priv->dialog),
-                                                 GTK_RESPONSE_YES);
-                reply = gtk_dialog_run (GTK_DIALOG (self->priv->dialog));
-                gtk_widget_destroy (self->priv->dialog);
-                self->priv->dialog = NULL;
-
-                if (reply == GTK_RESPONSE_YES) {
-                        download = TRUE;
-                } else if (_last_update) {
-                        g_object_unref (self);
-                        return NULL;
-                }
-        }
+        months = (g_get_real_time () - last_update)
+                 / (30LL * 24 * 60 * 60 * G_USEC_PER_SEC);
+        if (!months)
+                months = 1;
+
+        flags = GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT;
+        mtype = GTK_MESSAGE_QUESTION;
+        btype = GTK_BUTTONS_YES_NO;
+        question = g_strdup_printf (g_dngettext (GETTEXT_PACKAGE,
+                                    "Your database used for"
+                                    " locating other players"
+                                    " geographically is"
+                                    " more than one month old. "
+                                    " Should a new one be"
+                                    " downloaded (1-2 MB) from"
+                                    " the internet?",
+                                    "Your database used for"
+                                    " locating other players"
+                                    " geographically is"
+                                    " more than %llu months old. "
+                                    " Should a new one be"
+                                    " downloaded (1-2 MB) from"
+                                    " the internet?",
+                                    months),
+                                    (unsigned long long) months);
+
+        dialog = gtk_message_dialog_new (main_window, flags, mtype, btype,
+                                         "%s", question);
+        g_free (question);
+        gtk_dialog_set_default_response (GTK_DIALOG (dialog),
+                                         GTK_RESPONSE_YES);
+        reply = gtk_dialog_run (GTK_DIALOG (dialog));
+        gtk_widget_destroy (dialog);
+
+        if (reply != GTK_RESPONSE_YES)
+                return NULL;
+
+        self = g_object_new (GIBBON_TYPE_GEO_IP_UPDATER, NULL);
+        self->priv->database = database;
 
 #if 0
 # define GEO_IP_DEFAULT_URI "http://software77.net/geo-ip/?DL=1"
 #else
 #define GEO_IP_DEFAULT_URI "http://www.gibbon.bg/ip2country.csv.gz"
 #endif
-        if (download) {
-                self->priv->file = g_file_new_for_uri (GEO_IP_DEFAULT_URI);
-                self->priv->uri = g_strdup (GEO_IP_DEFAULT_URI);
-        } else {
-
-#ifdef G_OS_WIN32
-                win32_dir =
-                    g_win32_get_package_installation_directory_of_module (NULL);
-                self->priv->uri = g_build_filename (win32_dir, "share", PACKAGE,
-                                                    "ip2country.csv.gz", NULL);
-#else
-                self->priv->uri = g_build_filename (GIBBON_DATADIR, PACKAGE,
-                                                    "ip2country.csv.gz", NULL);
-#endif                                                    
-                self->priv->file = g_file_new_for_path (self->priv->uri);
-        }
+        self->priv->file = g_file_new_for_uri (GEO_IP_DEFAULT_URI);
+        self->priv->uri = g_strdup (GEO_IP_DEFAULT_URI);
 
         return self;
 }
@@ -366,7 +326,15 @@ gibbon_geo_ip_updater_on_open (GFile *file, GAsyncResult *res,
                 return;
         }
 
-        gibbon_database_on_start_geo_ip_update (self->priv->database);
+        if (!gibbon_database_on_start_geo_ip_update (self->priv->database)) {
+                g_object_unref (fstream);
+                gtk_widget_hide (self->priv->dialog);
+                gibbon_app_display_error (app, NULL, "%s",
+                                          _("Cannot prepare the database for"
+                                            " the GeoIP update!"));
+                gibbon_database_cancel_geo_ip_update (self->priv->database);
+                return;
+        }
 
         msg = g_strdup_printf (_("Reading `%s'."), self->priv->uri);
         gtk_label_set_text (GTK_LABEL (self->priv->label), msg);
@@ -383,6 +351,8 @@ gibbon_geo_ip_updater_on_open (GFile *file, GAsyncResult *res,
                                      GIBBON_GEO_IP_UPDATER_CHUNK_SIZE);
         self->priv->buf_size = GIBBON_GEO_IP_UPDATER_CHUNK_SIZE;
         self->priv->buf_fill = 0;
+        self->priv->lineno = 0;
+        self->priv->fraction = 0.0;
 
         callback = (GAsyncReadyCallback) gibbon_geo_ip_updater_on_read;
         g_input_stream_read_async (stream,
@@ -401,7 +371,7 @@ gibbon_geo_ip_updater_on_read (GInputStream *stream, GAsyncResult *res,
         GError *error = NULL;
         gchar *start_of_line;
         gchar *end_of_line;
-        gsize wanted_size;
+        gchar *end_of_buf;
         GAsyncReadyCallback callback;
 
         g_return_if_fail (G_IS_INPUT_STREAM (stream));
@@ -422,26 +392,28 @@ gibbon_geo_ip_updater_on_read (GInputStream *stream, GAsyncResult *res,
 
         self->priv->buf_fill += read_bytes;
 
-        start_of_line = end_of_line = self->priv->buf;
-        while (end_of_line < self->priv->buf + self->priv->buf_fill) {
-                if (*end_of_line == '\n') {
-                        if (!gibbon_geo_ip_updater_parse (self,
-                                                          start_of_line,
-                                                          end_of_line
-                                                          - start_of_line)) {
-                                gibbon_database_cancel_geo_ip_update (
-                                                self->priv->database);
-                                return;
-                        }
-                        ++end_of_line;
-                        start_of_line = end_of_line;
-                        continue;
+        start_of_line = self->priv->buf;
+        end_of_buf = self->priv->buf + self->priv->buf_fill;
+        while ((end_of_line = memchr (start_of_line, '\n',
+                                      end_of_buf - start_of_line))) {
+                if (!gibbon_geo_ip_updater_parse (self,
+                                                  start_of_line,
+                                                  end_of_line
+                                                  - start_of_line)) {
+                        gibbon_database_cancel_geo_ip_update (
+                                        self->priv->database);
+                        return;
                 }
-                ++end_of_line;
+                start_of_line = end_of_line + 1;
         }
 
-        self->priv->buf_fill = end_of_line - start_of_line;
-        if (self->priv->buf_fill)
+        /* Updating the progress bar once per chunk is enough.  */
+        gtk_progress_bar_set_fraction (
+                        GTK_PROGRESS_BAR (self->priv->progress_bar),
+                        self->priv->fraction);
+
+        self->priv->buf_fill = end_of_buf - start_of_line;
+        if (self->priv->buf_fill && start_of_line != self->priv->buf)
                 memmove (self->priv->buf, start_of_line, self->priv->buf_fill);
 
         if (!read_bytes) {
@@ -459,248 +431,77 @@ gibbon_geo_ip_updater_on_read (GInputStream *stream, GAsyncResult *res,
                 return;
         }
 
-        wanted_size = self->priv->buf_fill + GIBBON_GEO_IP_UPDATER_CHUNK_SIZE;
-        if (self->priv->buf_size < wanted_size) {
-                self->priv->buf_size = wanted_size;
-                self->priv->buf = g_realloc (self->priv->buf, wanted_size);
+        if (self->priv->buf_fill == self->priv->buf_size) {
+                self->priv->buf_size <<= 1;
+                self->priv->buf = g_realloc (self->priv->buf,
+                                             self->priv->buf_size);
         }
 
         callback = (GAsyncReadyCallback) gibbon_geo_ip_updater_on_read;
         g_input_stream_read_async (stream,
                                    self->priv->buf + self->priv->buf_fill,
-                                   GIBBON_GEO_IP_UPDATER_CHUNK_SIZE,
+                                   self->priv->buf_size - self->priv->buf_fill,
                                    G_PRIORITY_DEFAULT,
                                    self->priv->cancellable,
                                    callback, self);
 }
 
 /*
- * And now the mother of all spaghetti code routines spiced with some
- * beautiful sugo di goto.
+ * The line is parsed in place and is not NUL-terminated.
  */
 static gboolean
 gibbon_geo_ip_updater_parse (GibbonGeoIPUpdater *self, const gchar *line_start,
                              gsize length)
 {
-        gchar *ptr = g_alloca (length + 1);
-        gchar *from_ip;
-        gchar *to_ip;
-        guint max_ip = 4294967295U;
-        guint num;
-        gchar *registry;
-        gchar *timestamp;
-        gchar *alpha2;
-        gchar *alpha3;
-        gchar *country;
-        gdouble fraction;
+        const gchar *end = line_start + length;
+        GibbonDatabaseIPRange range;
+        const gchar *ptr;
+        gchar *near;
 
         ++self->priv->lineno;
 
-        strncpy (ptr, line_start, length);
-        ptr[length] = 0;
-
-        while (*ptr == ' ' || *ptr == '\t') {
-                if (!*ptr)
-                        return TRUE;
-        }
-
-        if (*ptr == '#')
+        switch (gibbon_geo_ip_snapshot_parse_line (line_start, length,
+                                                   &range, &ptr)) {
+        case GIBBON_GEO_IP_LINE_EMPTY:
                 return TRUE;
-
-        if (*ptr != '"')
-                goto parse_error;
-        ++ptr;
-
-        from_ip = ptr;
-        while (*ptr) {
-                if ('"' == *ptr)
-                        break;
-                if (*ptr < '0' || *ptr > '9')
-                        goto parse_error;
-                ++ptr;
-        }
-
-        *ptr = 0;
-        ++ptr;
-
-        /* Bail out on leading zeros.  */
-        if (!*from_ip && from_ip[1])
-                goto parse_error;
-
-        if (*ptr != ',')
+        case GIBBON_GEO_IP_LINE_RANGE:
+                break;
+        case GIBBON_GEO_IP_LINE_ERROR:
                 goto parse_error;
-        ++ptr;
-        if (*ptr != '"')
-                goto parse_error;
-        ++ptr;
-
-        to_ip = ptr;
-        while (*ptr) {
-                if ('"' == *ptr)
-                        break;
-                if (*ptr < '0' || *ptr > '9')
-                        goto parse_error;
-                ++ptr;
-        }
-
-        *ptr = 0;
-        ++ptr;
-
-        /* Bail out on leading zeros.  */
-        if (!*to_ip && to_ip[1])
-                goto parse_error;
-
-        if (!(strlen (to_ip) >= strlen (from_ip)
-              || g_strcmp0 (from_ip, to_ip) < 0))
-                goto parse_error;
-
-        errno = 0;
-        num = g_ascii_strtoull (to_ip, NULL, 10);
-        if (errno)
-                goto parse_error;
-        if (num > max_ip)
-                goto parse_error;
-        fraction = (gdouble) num / (gdouble) max_ip;
-
-        if (*ptr != ',')
-                goto parse_error;
-        ++ptr;
-        if (*ptr != '"')
-                goto parse_error;
-        ++ptr;
-
-        registry = ptr;
-        while (*ptr) {
-                if ('"' == *ptr)
-                        break;
-                /* We are not prepared for escaping ... */
-                if (*ptr == '\\')
-                        goto parse_error;
-                ++ptr;
-        }
-        if (*ptr != '"')
-                goto parse_error;
-        *ptr = 0;
-        ++ptr;
-        if (*ptr != ',')
-                goto parse_error;
-        ++ptr;
-        if (*ptr != '"')
-                goto parse_error;
-        ++ptr;
-
-        timestamp = ptr;
-        while (*ptr) {
-                if ('"' == *ptr)
-                        break;
-                if (*ptr < '0' || *ptr > '9')
-                        goto parse_error;
-                ++ptr;
         }
 
-        *ptr = 0;
-        ++ptr;
-
-        /* Bail out on leading zeros.  */
-        if (!*timestamp)
-                goto parse_error;
-
-        if (*ptr != ',')
-                goto parse_error;
-        ++ptr;
-        if (*ptr != '"')
-                goto parse_error;
-        ++ptr;
-
-        alpha2 = ptr;
-        while (*ptr) {
-                if ('"' == *ptr)
-                        break;
-                if (*ptr < 'A' || *ptr > 'Z')
-                        goto parse_error;
-                *ptr -= 'Q' - 'q';
-                ++ptr;
-        }
-        if (*ptr != '"')
-                goto parse_error;
-        *ptr = 0;
-        if (2 != strlen (alpha2))
-                goto parse_error;
-        ++ptr;
-        if (*ptr != ',')
-                goto parse_error;
-        ++ptr;
-        if (*ptr != '"')
-                goto parse_error;
-        ++ptr;
-
-        alpha3 = ptr;
-        while (*ptr) {
-                if ('"' == *ptr)
-                        break;
-                if (*ptr < 'A' || *ptr > 'Z')
-                        goto parse_error;
-                ++ptr;
-        }
-        if (*ptr != '"')
-                goto parse_error;
-        *ptr = 0;
-        /* 3-letter code for EU is EU.  */
-        if (3 != strlen (alpha3) && 2 != strlen (alpha3))
-                goto parse_error;
-        ++ptr;
-        if (*ptr != ',')
-                goto parse_error;
-        ++ptr;
-        if (*ptr != '"')
-                goto parse_error;
-        ++ptr;
-
-        country = ptr;
-        while (*ptr) {
-                if ('"' == *ptr)
-                        break;
-                /* We are not prepared for escaping ... */
-                if (*ptr == '\\')
-                        goto parse_error;
-                ++ptr;
-        }
-        if (*ptr != '"')
-                goto parse_error;
-        *ptr = 0;
-        ++ptr;
-
-        while (*ptr) {
-                if ('#' == *ptr)
-                        break;
-                if (' ' == *ptr || '\t' == *ptr)
-                        continue;
-                ++ptr;
+        if (!gibbon_database_set_geo_ip (self->priv->database,
+                                         range.start, range.end,
+                                         range.alpha2)) {
+                gtk_widget_hide (self->priv->dialog);
+                gibbon_app_display_error (app, NULL, "%s",
+                                          _("Error writing the GeoIP"
+                                            " database!"));
+                return FALSE;
         }
 
-        gibbon_database_set_geo_ip (self->priv->database,
-                                    from_ip, to_ip, alpha2);
-
-        gtk_progress_bar_set_fraction (
-                        GTK_PROGRESS_BAR (self->priv->progress_bar), fraction);
+        self->priv->fraction = (gdouble) range.end / (gdouble) G_MAXUINT32;
 
         return TRUE;
 
 parse_error:
         gtk_widget_hide (self->priv->dialog);
-        if (*ptr)
+        if (ptr < end) {
+                near = g_strndup (ptr, end - ptr);
                 gibbon_app_display_error (app, NULL,
                                           _("%s: line %u: Parse error near"
                                             " `%s'!"),
                                            self->priv->uri,
                                            (unsigned) self->priv->lineno,
-                                           ptr);
-        else
+                                           near);
+                g_free (near);
+        } else {
                 gibbon_app_display_error (app, NULL,
                                           _("%s: line %u: Unexpected end of"
                                             " line!"),
                                            self->priv->uri,
                                            (unsigned) self->priv->lineno);
+        }
 
         return FALSE;
 }
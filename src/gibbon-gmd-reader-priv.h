@@ -30,8 +30,6 @@
 
 G_BEGIN_DECLS
 
-extern GibbonGMDReader *_gibbon_gmd_reader_instance;
-
 void _gibbon_gmd_reader_set_player (GibbonGMDReader *self,
                                     GibbonPositionSide side,
                                     const gchar *white);
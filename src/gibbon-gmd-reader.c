@@ -182,6 +182,47 @@ gibbon_gmd_reader_parse (GibbonMatchReader *_self, const gchar *filename)
         return self->priv->match;
 }
 
+/**
+ * gibbon_gmd_reader_recover:
+ * @filename: The GMD file to recover.
+ * @error: Return location for an error or %NULL.
+ *
+ * GMD files are append-only, one record per line.  When the program
+ * crashes while the match tracker is writing, the file can end with an
+ * incomplete record.  This function cuts off such a trailing partial line,
+ * so that the file can be parsed again.  Files that end with a newline are
+ * left untouched.
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_gmd_reader_recover (const gchar *filename, GError **error)
+{
+        gchar *contents;
+        gsize length;
+        gsize complete;
+        gboolean retval;
+
+        g_return_val_if_fail (filename != NULL, FALSE);
+
+        if (!g_file_get_contents (filename, &contents, &length, error))
+                return FALSE;
+
+        complete = length;
+        while (complete && contents[complete - 1] != '\n')
+                --complete;
+
+        if (complete == length) {
+                g_free (contents);
+                return TRUE;
+        }
+
+        retval = g_file_set_contents (filename, contents, complete, error);
+        g_free (contents);
+
+        return retval;
+}
+
 static void
 gibbon_gmd_reader_error (const GibbonGMDReader *self, const gchar *msg)
 {
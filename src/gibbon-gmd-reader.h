@@ -77,5 +77,6 @@ GType gibbon_gmd_reader_get_type (void) G_GNUC_CONST;
 GibbonGMDReader *gibbon_gmd_reader_new (
                 GibbonMatchReaderErrorFunc error_func,
                 gpointer user_data);
+gboolean gibbon_gmd_reader_recover (const gchar *filename, GError **error);
 
 #endif
@@ -163,7 +163,7 @@ gibbon_inviter_list_class_init (GibbonInviterListClass *klass)
         gibbon_inviter_list_column_types[GIBBON_INVITER_LIST_COL_RATING] = 
                 G_TYPE_DOUBLE;
         gibbon_inviter_list_column_types[GIBBON_INVITER_LIST_COL_EXPERIENCE] = 
-                G_TYPE_UINT;
+                G_TYPE_UINT64;
         gibbon_inviter_list_column_types[GIBBON_INVITER_LIST_COL_CLIENT] =
                 G_TYPE_STRING;
         gibbon_inviter_list_column_types[GIBBON_INVITER_LIST_COL_CLIENT_ICON] =
@@ -216,7 +216,7 @@ gibbon_inviter_list_set (GibbonInviterList *self,
                         const gchar *name,
                         gboolean has_saved,
                         gdouble rating,
-                        guint experience,
+                        guint64 experience,
                         gdouble reliability,
                         guint confidence,
                         const gchar *client,
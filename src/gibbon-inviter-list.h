@@ -77,7 +77,7 @@ void gibbon_inviter_list_set (GibbonInviterList *self,
                               const gchar *inviter_name,
                               gboolean has_saved,
                               gdouble rating,
-                              guint experience,
+                              guint64 experience,
                               gdouble reliability,
                               guint confidence,
                               const gchar *client,
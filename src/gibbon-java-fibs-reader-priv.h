@@ -30,8 +30,6 @@
 
 G_BEGIN_DECLS
 
-extern GibbonJavaFIBSReader *_gibbon_java_fibs_reader_instance;
-
 void _gibbon_java_fibs_reader_set_white (GibbonJavaFIBSReader *self,
                                          const gchar *white);
 void _gibbon_java_fibs_reader_set_black (GibbonJavaFIBSReader *self,
@@ -53,8 +53,6 @@ struct _GibbonJellyFishReaderPrivate {
         GibbonPositionSide side;
 };
 
-GibbonJellyFishReader *_gibbon_jelly_fish_reader_instance = NULL;
-
 #define GIBBON_JELLY_FISH_READER_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
         GIBBON_TYPE_JELLY_FISH_READER, GibbonJellyFishReaderPrivate))
 
@@ -0,0 +1,450 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gibbon-journal
+ * @short_description: Buffered append-only journal file.
+ *
+ * Since: 0.2.0
+ *
+ * A #GibbonJournal is a #GOutputStream for line-oriented, append-only
+ * files like the GMD files written by the match tracker.  Writes only
+ * copy the data into a memory buffer.  A worker thread commits the
+ * buffer to disk, at the latest after the group-commit interval has
+ * elapsed.
+ *
+ * Timed commits only ever write complete lines.  A record that is
+ * still incomplete stays in the buffer until the next commit, so that
+ * a crash can at worst leave a truncated last line in the file.  See
+ * gibbon_gmd_reader_recover() for cutting that off again.
+ *
+ * Flushing the stream with g_output_stream_flush() commits everything
+ * written so far and waits for the commit to finish.  Write errors
+ * encountered by the worker thread are reported by the next write,
+ * flush or close operation.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_WIN32
+# include <io.h>
+# define fsync _commit
+#else
+# include <unistd.h>
+#endif
+
+#include "gibbon-journal.h"
+
+#ifndef O_BINARY
+# define O_BINARY 0
+#endif
+
+typedef struct _GibbonJournalPrivate GibbonJournalPrivate;
+struct _GibbonJournalPrivate {
+        gchar *filename;
+        gint fd;
+        guint interval;
+        GibbonJournalSync sync;
+
+        GThread *worker;
+        GMutex mutex;
+        GCond cond;
+
+        /* Protected by the mutex.  */
+        GByteArray *pending;
+        guint64 requested;
+        guint64 committed;
+        gboolean closing;
+        GError *error;
+
+        /* Only touched by the worker thread.  */
+        GByteArray *buffer;
+};
+
+#define GIBBON_JOURNAL_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
+        GIBBON_TYPE_JOURNAL, GibbonJournalPrivate))
+
+G_DEFINE_TYPE (GibbonJournal, gibbon_journal, G_TYPE_OUTPUT_STREAM)
+
+static gssize gibbon_journal_write_fn (GOutputStream *stream,
+                                       const void *buffer, gsize count,
+                                       GCancellable *cancellable,
+                                       GError **error);
+static gboolean gibbon_journal_flush (GOutputStream *stream,
+                                      GCancellable *cancellable,
+                                      GError **error);
+static gboolean gibbon_journal_close_fn (GOutputStream *stream,
+                                         GCancellable *cancellable,
+                                         GError **error);
+static gpointer gibbon_journal_work (GibbonJournal *self);
+static gboolean gibbon_journal_write_buffer (GibbonJournal *self,
+                                             GError **error);
+static gboolean gibbon_journal_check_error (GibbonJournal *self,
+                                            GError **error);
+
+static void
+gibbon_journal_init (GibbonJournal *self)
+{
+        self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+                GIBBON_TYPE_JOURNAL, GibbonJournalPrivate);
+
+        self->priv->filename = NULL;
+        self->priv->fd = -1;
+        self->priv->interval = 0;
+        self->priv->sync = GIBBON_JOURNAL_SYNC_NEVER;
+
+        self->priv->worker = NULL;
+        g_mutex_init (&self->priv->mutex);
+        g_cond_init (&self->priv->cond);
+
+        self->priv->pending = g_byte_array_new ();
+        self->priv->requested = 0;
+        self->priv->committed = 0;
+        self->priv->closing = FALSE;
+        self->priv->error = NULL;
+
+        self->priv->buffer = g_byte_array_new ();
+}
+
+static void
+gibbon_journal_finalize (GObject *object)
+{
+        GibbonJournal *self = GIBBON_JOURNAL (object);
+
+        /*
+         * The parent's dispose method has already closed the stream and
+         * thereby stopped the worker.
+         */
+        g_free (self->priv->filename);
+
+        g_byte_array_free (self->priv->pending, TRUE);
+        g_byte_array_free (self->priv->buffer, TRUE);
+
+        if (self->priv->error)
+                g_error_free (self->priv->error);
+
+        g_cond_clear (&self->priv->cond);
+        g_mutex_clear (&self->priv->mutex);
+
+        G_OBJECT_CLASS (gibbon_journal_parent_class)->finalize(object);
+}
+
+static void
+gibbon_journal_class_init (GibbonJournalClass *klass)
+{
+        GObjectClass *object_class = G_OBJECT_CLASS (klass);
+        GOutputStreamClass *stream_class = G_OUTPUT_STREAM_CLASS (klass);
+
+        g_type_class_add_private (klass, sizeof (GibbonJournalPrivate));
+
+        stream_class->write_fn = gibbon_journal_write_fn;
+        stream_class->flush = gibbon_journal_flush;
+        stream_class->close_fn = gibbon_journal_close_fn;
+
+        object_class->finalize = gibbon_journal_finalize;
+}
+
+/**
+ * gibbon_journal_new:
+ * @filename: The file to write to.
+ * @append: %TRUE for appending to an existing file, %FALSE for truncating it.
+ * @interval: Group-commit interval in milliseconds, must not be 0.
+ * @sync: When to synchronize the file to disk.
+ * @error: Return location for an error or %NULL.
+ *
+ * Creates a new #GibbonJournal and starts its worker thread.  Data written
+ * to the journal reaches the disk no later than @interval milliseconds
+ * after the line it belongs to has been completed.
+ *
+ * Returns: The newly created #GibbonJournal or %NULL in case of failure.
+ */
+GibbonJournal *
+gibbon_journal_new (const gchar *filename, gboolean append, guint interval,
+                    GibbonJournalSync sync, GError **error)
+{
+        GibbonJournal *self;
+        gint flags;
+        gint mode;
+        gint fd;
+
+        g_return_val_if_fail (filename != NULL, NULL);
+        g_return_val_if_fail (interval != 0, NULL);
+
+        flags = O_WRONLY | O_CREAT | O_BINARY;
+        if (append)
+                flags |= O_APPEND;
+        else
+                flags |= O_TRUNC;
+
+#ifdef G_OS_WIN32
+        mode = S_IRUSR | S_IWUSR;
+#else
+        mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+#endif
+        fd = g_open (filename, flags, mode);
+        if (fd < 0) {
+                g_set_error_literal (error, G_IO_ERROR,
+                                     g_io_error_from_errno (errno),
+                                     strerror (errno));
+                return NULL;
+        }
+
+        self = g_object_new (GIBBON_TYPE_JOURNAL, NULL);
+
+        self->priv->filename = g_strdup (filename);
+        self->priv->fd = fd;
+        self->priv->interval = interval;
+        self->priv->sync = sync;
+
+        self->priv->worker = g_thread_try_new ("gibbon-journal",
+                                               (GThreadFunc)
+                                               gibbon_journal_work,
+                                               self, error);
+        if (!self->priv->worker) {
+                g_object_unref (self);
+                return NULL;
+        }
+
+        return self;
+}
+
+/**
+ * gibbon_journal_get_filename:
+ * @self: The #GibbonJournal.
+ *
+ * Returns: The name of the file written to.
+ */
+const gchar *
+gibbon_journal_get_filename (const GibbonJournal *self)
+{
+        g_return_val_if_fail (GIBBON_IS_JOURNAL (self), NULL);
+
+        return self->priv->filename;
+}
+
+static gssize
+gibbon_journal_write_fn (GOutputStream *stream, const void *buffer,
+                         gsize count, GCancellable *cancellable,
+                         GError **error)
+{
+        GibbonJournal *self = GIBBON_JOURNAL (stream);
+
+        g_mutex_lock (&self->priv->mutex);
+
+        if (!gibbon_journal_check_error (self, error)) {
+                g_mutex_unlock (&self->priv->mutex);
+                return -1;
+        }
+
+        /* Wake up the worker so that it starts the commit timer.  */
+        if (!self->priv->pending->len)
+                g_cond_broadcast (&self->priv->cond);
+
+        g_byte_array_append (self->priv->pending, buffer, count);
+
+        g_mutex_unlock (&self->priv->mutex);
+
+        return count;
+}
+
+static gboolean
+gibbon_journal_flush (GOutputStream *stream, GCancellable *cancellable,
+                      GError **error)
+{
+        GibbonJournal *self = GIBBON_JOURNAL (stream);
+        guint64 generation;
+        gboolean retval;
+
+        g_mutex_lock (&self->priv->mutex);
+
+        generation = ++self->priv->requested;
+        g_cond_broadcast (&self->priv->cond);
+
+        while (self->priv->committed < generation && !self->priv->error)
+                g_cond_wait (&self->priv->cond, &self->priv->mutex);
+
+        retval = gibbon_journal_check_error (self, error);
+
+        g_mutex_unlock (&self->priv->mutex);
+
+        return retval;
+}
+
+static gboolean
+gibbon_journal_close_fn (GOutputStream *stream, GCancellable *cancellable,
+                         GError **error)
+{
+        GibbonJournal *self = GIBBON_JOURNAL (stream);
+        gboolean retval;
+
+        if (self->priv->worker) {
+                g_mutex_lock (&self->priv->mutex);
+                self->priv->closing = TRUE;
+                g_cond_broadcast (&self->priv->cond);
+                g_mutex_unlock (&self->priv->mutex);
+
+                g_thread_join (self->priv->worker);
+                self->priv->worker = NULL;
+        }
+
+        g_mutex_lock (&self->priv->mutex);
+        retval = gibbon_journal_check_error (self, error);
+        g_mutex_unlock (&self->priv->mutex);
+
+        if (self->priv->fd >= 0) {
+                if (close (self->priv->fd) != 0 && retval) {
+                        g_set_error_literal (error, G_IO_ERROR,
+                                             g_io_error_from_errno (errno),
+                                             strerror (errno));
+                        retval = FALSE;
+                }
+                self->priv->fd = -1;
+        }
+
+        return retval;
+}
+
+static gpointer
+gibbon_journal_work (GibbonJournal *self)
+{
+        GibbonJournalPrivate *priv = self->priv;
+        gint64 deadline;
+        guint64 generation;
+        gboolean closing;
+        guint length;
+        gboolean synchronize;
+        GError *error = NULL;
+
+        g_mutex_lock (&priv->mutex);
+
+        while (1) {
+                while (!priv->closing && priv->requested == priv->committed
+                       && !priv->pending->len)
+                        g_cond_wait (&priv->cond, &priv->mutex);
+
+                /*
+                 * Something has been written.  Give the writer the
+                 * group-commit interval for adding more.
+                 */
+                deadline = g_get_monotonic_time ()
+                        + priv->interval * G_TIME_SPAN_MILLISECOND;
+                while (!priv->closing && priv->requested == priv->committed) {
+                        if (!g_cond_wait_until (&priv->cond, &priv->mutex,
+                                                deadline))
+                                break;
+                }
+
+                closing = priv->closing;
+                generation = priv->requested;
+
+                /*
+                 * Explicit commits take everything, timed commits only
+                 * complete lines.
+                 */
+                length = priv->pending->len;
+                if (!closing && generation == priv->committed) {
+                        while (length && priv->pending->data[length - 1] != '\n')
+                                --length;
+                }
+                if (length) {
+                        g_byte_array_append (priv->buffer,
+                                             priv->pending->data, length);
+                        g_byte_array_remove_range (priv->pending, 0, length);
+                }
+
+                g_mutex_unlock (&priv->mutex);
+
+                synchronize = FALSE;
+                if (priv->buffer->len) {
+                        if (gibbon_journal_write_buffer (self, &error)
+                            && priv->sync == GIBBON_JOURNAL_SYNC_COMMIT)
+                                synchronize = TRUE;
+                }
+                if (closing && priv->sync != GIBBON_JOURNAL_SYNC_NEVER)
+                        synchronize = TRUE;
+                if (!error && synchronize && fsync (priv->fd) != 0)
+                        g_set_error_literal (&error, G_IO_ERROR,
+                                             g_io_error_from_errno (errno),
+                                             strerror (errno));
+
+                g_mutex_lock (&priv->mutex);
+
+                if (error && !priv->error)
+                        priv->error = error;
+                else if (error)
+                        g_error_free (error);
+                error = NULL;
+
+                priv->committed = generation;
+                g_cond_broadcast (&priv->cond);
+
+                if (closing)
+                        break;
+        }
+
+        g_mutex_unlock (&priv->mutex);
+
+        return NULL;
+}
+
+static gboolean
+gibbon_journal_write_buffer (GibbonJournal *self, GError **error)
+{
+        GByteArray *buffer = self->priv->buffer;
+        gsize written = 0;
+        gssize bytes;
+
+        while (written < buffer->len) {
+                bytes = write (self->priv->fd, buffer->data + written,
+                               buffer->len - written);
+                if (bytes < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        g_set_error_literal (error, G_IO_ERROR,
+                                             g_io_error_from_errno (errno),
+                                             strerror (errno));
+                        g_byte_array_set_size (buffer, 0);
+                        return FALSE;
+                }
+                written += bytes;
+        }
+
+        g_byte_array_set_size (buffer, 0);
+
+        return TRUE;
+}
+
+/* Must be called with the mutex held.  */
+static gboolean
+gibbon_journal_check_error (GibbonJournal *self, GError **error)
+{
+        if (!self->priv->error)
+                return TRUE;
+
+        g_propagate_error (error, g_error_copy (self->priv->error));
+
+        return FALSE;
+}
@@ -0,0 +1,95 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GIBBON_JOURNAL_H
+# define _GIBBON_JOURNAL_H
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#define GIBBON_TYPE_JOURNAL \
+        (gibbon_journal_get_type ())
+#define GIBBON_JOURNAL(obj) \
+        (G_TYPE_CHECK_INSTANCE_CAST ((obj), GIBBON_TYPE_JOURNAL, \
+                GibbonJournal))
+#define GIBBON_JOURNAL_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST ((klass), \
+        GIBBON_TYPE_JOURNAL, GibbonJournalClass))
+#define GIBBON_IS_JOURNAL(obj) \
+        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), \
+                GIBBON_TYPE_JOURNAL))
+#define GIBBON_IS_JOURNAL_CLASS(klass) \
+        (G_TYPE_CHECK_CLASS_TYPE ((klass), \
+                GIBBON_TYPE_JOURNAL))
+#define GIBBON_JOURNAL_GET_CLASS(obj) \
+        (G_TYPE_INSTANCE_GET_CLASS ((obj), \
+                GIBBON_TYPE_JOURNAL, GibbonJournalClass))
+
+/**
+ * GibbonJournalSync:
+ * @GIBBON_JOURNAL_SYNC_NEVER: Leave it to the operating system when data
+ *                             hits the disk.
+ * @GIBBON_JOURNAL_SYNC_CLOSE: Synchronize once, when the journal is closed.
+ * @GIBBON_JOURNAL_SYNC_COMMIT: Synchronize after every group commit.
+ *
+ * When to call fsync() on the underlying file.
+ */
+typedef enum {
+        GIBBON_JOURNAL_SYNC_NEVER = 0,
+        GIBBON_JOURNAL_SYNC_CLOSE = 1,
+        GIBBON_JOURNAL_SYNC_COMMIT = 2
+} GibbonJournalSync;
+
+/**
+ * GibbonJournal:
+ *
+ * One instance of a #GibbonJournal.  All properties are private.
+ */
+typedef struct _GibbonJournal GibbonJournal;
+struct _GibbonJournal
+{
+        GOutputStream parent_instance;
+
+        /*< private >*/
+        struct _GibbonJournalPrivate *priv;
+};
+
+/**
+ * GibbonJournalClass:
+ *
+ * Buffered, line-oriented output stream with background commits.
+ */
+typedef struct _GibbonJournalClass GibbonJournalClass;
+struct _GibbonJournalClass
+{
+        /* <private >*/
+        GOutputStreamClass parent_class;
+};
+
+GType gibbon_journal_get_type (void) G_GNUC_CONST;
+
+GibbonJournal *gibbon_journal_new (const gchar *filename, gboolean append,
+                                   guint interval, GibbonJournalSync sync,
+                                   GError **error);
+const gchar *gibbon_journal_get_filename (const GibbonJournal *self);
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compiles the one-sided bearoff database.
+ *
+ * Usage: gibbon-make-bearoff OUTPUT
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "gibbon-bearoff.h"
+
+int
+main (int argc, char *argv[])
+{
+        GibbonBearoff *bearoff;
+        GError *error = NULL;
+
+        if (argc != 2) {
+                g_printerr ("Usage: %s OUTPUT\n", argv[0]);
+                return 1;
+        }
+
+        bearoff = gibbon_bearoff_new ();
+        if (!gibbon_bearoff_save (bearoff, argv[1], &error)) {
+                g_printerr ("%s: %s\n", argv[1], error->message);
+                g_error_free (error);
+                gibbon_bearoff_free (bearoff);
+                return 1;
+        }
+
+        gibbon_bearoff_free (bearoff);
+
+        return 0;
+}
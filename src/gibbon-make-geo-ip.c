@@ -0,0 +1,140 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compiles the gzipped ip2country CSV file into a GeoIP snapshot.
+ *
+ * Usage: gibbon-make-geo-ip INPUT OUTPUT
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "gibbon-geo-ip-snapshot.h"
+
+static gint compare_ranges (gconstpointer a, gconstpointer b);
+
+int
+main (int argc, char *argv[])
+{
+        GFile *file;
+        GFileInputStream *fstream;
+        GZlibDecompressor *filter;
+        GInputStream *stream;
+        GDataInputStream *lines;
+        GArray *ranges;
+        GibbonDatabaseIPRange range;
+        GibbonGeoIPSnapshot *snapshot;
+        gchar *line;
+        gsize length;
+        gsize num_ranges;
+        guint lineno = 0;
+        const gchar *near;
+        GError *error = NULL;
+
+        if (argc != 3) {
+                g_printerr ("Usage: %s INPUT OUTPUT\n", argv[0]);
+                return 1;
+        }
+
+        g_type_init ();
+
+        file = g_file_new_for_path (argv[1]);
+        fstream = g_file_read (file, NULL, &error);
+        g_object_unref (file);
+        if (!fstream) {
+                g_printerr ("%s: %s\n", argv[1], error->message);
+                g_error_free (error);
+                return 1;
+        }
+
+        filter = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP);
+        stream = g_converter_input_stream_new (G_INPUT_STREAM (fstream),
+                                               G_CONVERTER (filter));
+        g_object_unref (filter);
+        g_object_unref (fstream);
+        lines = g_data_input_stream_new (stream);
+        g_object_unref (stream);
+
+        ranges = g_array_new (FALSE, FALSE, sizeof range);
+        while ((line = g_data_input_stream_read_line (lines, &length,
+                                                      NULL, &error))) {
+                ++lineno;
+                switch (gibbon_geo_ip_snapshot_parse_line (line, length,
+                                                           &range, &near)) {
+                case GIBBON_GEO_IP_LINE_EMPTY:
+                        break;
+                case GIBBON_GEO_IP_LINE_RANGE:
+                        g_array_append_val (ranges, range);
+                        break;
+                case GIBBON_GEO_IP_LINE_ERROR:
+                        g_printerr ("%s:%u: Parse error near `%s'.\n",
+                                    argv[1], lineno, near);
+                        g_free (line);
+                        g_array_free (ranges, TRUE);
+                        g_object_unref (lines);
+                        return 1;
+                }
+                g_free (line);
+        }
+        g_object_unref (lines);
+
+        if (error) {
+                g_printerr ("%s: %s\n", argv[1], error->message);
+                g_error_free (error);
+                g_array_free (ranges, TRUE);
+                return 1;
+        }
+
+        /* The lookup is a binary search over the start addresses.  */
+        g_array_sort (ranges, compare_ranges);
+
+        num_ranges = ranges->len;
+        snapshot = gibbon_geo_ip_snapshot_new (
+                        (GibbonDatabaseIPRange *) g_array_free (ranges, FALSE),
+                        num_ranges);
+        if (!gibbon_geo_ip_snapshot_save (snapshot, argv[2], &error)) {
+                g_printerr ("%s: %s\n", argv[2], error->message);
+                g_error_free (error);
+                gibbon_geo_ip_snapshot_free (snapshot);
+                return 1;
+        }
+
+        gibbon_geo_ip_snapshot_free (snapshot);
+
+        return 0;
+}
+
+static gint
+compare_ranges (gconstpointer a, gconstpointer b)
+{
+        const GibbonDatabaseIPRange *r1 = a;
+        const GibbonDatabaseIPRange *r2 = b;
+
+        if (r1->start < r2->start)
+                return -1;
+        else if (r1->start > r2->start)
+                return 1;
+
+        return 0;
+}
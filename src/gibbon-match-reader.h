@@ -64,7 +64,8 @@ struct _GibbonMatchReader
  * GibbonMatchReaderClass:
  * @parse: Parse the given filename or %NULL for standard input.
  *
- * IMPORTANT: The @parse method is usually NOT thread-safe!
+ * IMPORTANT: A reader instance must not be used by several threads at
+ * once.  Different instances may parse files in parallel.
  *
  * Abstract base class for readers for backgammon match files.
  */
@@ -26,6 +26,10 @@
  * A #GibbonMatchTracker records all relevant match actions and triggers
  * appropriate actions.  It continually updates the match file in the
  * archive and it adds moves made to the move list view.
+ *
+ * The match file is written through a #GibbonJournal so that recording
+ * an action does not block the main loop with disk I/O.  The commit
+ * interval and the fsync policy are taken from the match preferences.
  */
 
 #include <glib.h>
@@ -39,8 +43,10 @@
 #include "gibbon-gmd-writer.h"
 #include "gibbon-connection.h"
 #include "gibbon-gmd-reader.h"
+#include "gibbon-journal.h"
 #include "gibbon-match-play.h"
 #include "gibbon-match-list.h"
+#include "gibbon-settings.h"
 #include "gibbon-util.h"
 
 typedef struct _GibbonMatchTrackerPrivate GibbonMatchTrackerPrivate;
@@ -74,6 +80,11 @@ static GibbonMatch *gibbon_match_tracker_init_match (GibbonMatchTracker *self,
                                                      const gchar *player2,
                                                      const GibbonPosition
                                                      *initial);
+static GOutputStream *gibbon_match_tracker_open (const GibbonMatchTracker
+                                                 *self,
+                                                 const gchar *path,
+                                                 gboolean append);
+static void gibbon_match_tracker_close (GibbonMatchTracker *self);
 
 static void 
 gibbon_match_tracker_init (GibbonMatchTracker *self)
@@ -83,6 +94,7 @@ gibbon_match_tracker_init (GibbonMatchTracker *self)
 
         self->priv->outname = NULL;
         self->priv->writer = NULL;
+        self->priv->out = NULL;
         self->priv->wrank = self->priv->brank = NULL;
 
         self->priv->debug = FALSE;
@@ -92,20 +104,8 @@ static void
 gibbon_match_tracker_finalize (GObject *object)
 {
         GibbonMatchTracker *self = GIBBON_MATCH_TRACKER (object);
-        GError *error = NULL;
-
-        if (self->priv->out && !g_output_stream_close (self->priv->out,
-                                                       NULL, &error)) {
-                gibbon_app_fatal_error (app, _("Write Error"),
-                                        _("Error writing to `%s': %s!\n"),
-                                        self->priv->outname,
-                                        error->message);
-        }
 
-        g_free (self->priv->outname);
-
-        if (self->priv->writer)
-                g_object_unref (self->priv->writer);
+        gibbon_match_tracker_close (self);
 
         g_free (self->priv->wrank);
         g_free (self->priv->brank);
@@ -164,7 +164,7 @@ gibbon_match_tracker_store_rank (const GibbonMatchTracker *self,
                                  const gchar *rank,
                                  GibbonPositionSide side)
 {
-        GError *error;
+        GError *error = NULL;
         GibbonMatch *match;
 
         g_return_if_fail (GIBBON_IS_MATCH_TRACKER (self));
@@ -190,7 +190,6 @@ gibbon_match_tracker_store_rank (const GibbonMatchTracker *self,
                                         self->priv->outname,
                                         error->message);
         }
-        g_output_stream_flush (self->priv->out, NULL, NULL);
 }
 
 static void
@@ -221,6 +220,27 @@ gibbon_match_tracker_unlink_or_archive (GibbonMatchTracker *self,
                         return;
         }
 
+        /* The file may be the one that we are currently writing to.  */
+        if (self->priv->out && !g_output_stream_flush (self->priv->out,
+                                                       NULL, &error)) {
+                gibbon_app_fatal_error (app, _("Write Error"),
+                                        _("Error writing to `%s': %s!\n"),
+                                        self->priv->outname,
+                                        error->message);
+        }
+
+        /*
+         * Cut off a record that was interrupted by a crash.  If that fails,
+         * the file is kept, so that nothing is lost that could still be
+         * repaired by hand.
+         */
+        if (!gibbon_gmd_reader_recover (path, &error)) {
+                g_warning ("Cannot recover `%s': %s!",
+                           path, error->message);
+                g_error_free (error);
+                return;
+        }
+
         if (self->priv->debug)
                 yyerror = NULL;
         else
@@ -444,8 +464,6 @@ gibbon_match_tracker_resume (GibbonMatchTracker *self,
         GibbonMatch *match;
         GibbonMatchReaderErrorFunc yyerror;
         GError *error = NULL;
-        GFile *file;
-        GFileOutputStream *out;
 
         path = gibbon_archive_get_saved_name (archive, player1, player2,
                                               &error);
@@ -462,6 +480,13 @@ gibbon_match_tracker_resume (GibbonMatchTracker *self,
                         return NULL;
         }
 
+        if (!gibbon_gmd_reader_recover (path, &error)) {
+                g_warning ("Cannot recover `%s': %s!",
+                           path, error->message);
+                g_error_free (error);
+                return NULL;
+        }
+
         yyerror = (GibbonMatchReaderErrorFunc) gibbon_match_reader_no_yyerror;
         reader = GIBBON_MATCH_READER (gibbon_gmd_reader_new (yyerror,
                                                              (gpointer) self));
@@ -479,20 +504,9 @@ gibbon_match_tracker_resume (GibbonMatchTracker *self,
 
         gibbon_app_set_match (app, match);
 
-        file = g_file_new_for_path (path);
-        out = g_file_append_to (file, G_FILE_CREATE_NONE, NULL, &error);
-        g_object_unref (file);
-        if (!out) {
-                gibbon_app_fatal_error (app, _("Write Error"),
-                                        _("Error writing to"
-                                          " `%s': %s!\n"),
-                                        path,
-                                        error->message);
-                /* NOTREACHED */
-        }
-
+        gibbon_match_tracker_close (self);
+        self->priv->out = gibbon_match_tracker_open (self, path, TRUE);
         self->priv->outname = path;
-        self->priv->out = G_OUTPUT_STREAM (out);
         self->priv->writer = gibbon_gmd_writer_new ();
 
         return match;
@@ -504,8 +518,6 @@ gibbon_match_tracker_init_match (GibbonMatchTracker *self, gsize length,
                                  const GibbonPosition *initial)
 {
         GibbonArchive *archive = gibbon_app_get_archive (app);
-        GFile *file;
-        GFileOutputStream *fout;
         GError *error = NULL;
         GibbonMatchWriter *writer;
         GibbonConnection *connection;
@@ -515,6 +527,8 @@ gibbon_match_tracker_init_match (GibbonMatchTracker *self, gsize length,
         GibbonGame *game;
         GibbonMatch *match;
 
+        gibbon_match_tracker_close (self);
+
         self->priv->outname = gibbon_archive_get_saved_name (archive,
                                                              player1,
                                                              player2,
@@ -524,17 +538,9 @@ gibbon_match_tracker_init_match (GibbonMatchTracker *self, gsize length,
                 /* NOTREACHED */
         }
 
-        file = g_file_new_for_path (self->priv->outname);
-        fout = g_file_replace (file, NULL, FALSE, G_FILE_COPY_OVERWRITE,
-                               NULL, &error);
-        g_object_unref (file);
-        if (!fout) {
-                gibbon_app_fatal_error (app, _("Write Error"),
-                                        _("Error writing to `%s': %s!\n"),
-                                        self->priv->outname,
-                                        error->message);
-        }
-        self->priv->out = G_OUTPUT_STREAM (fout);
+        self->priv->out = gibbon_match_tracker_open (self,
+                                                     self->priv->outname,
+                                                     FALSE);
 
         /*
          * We always assume that the Crawford rule applies for
@@ -574,11 +580,78 @@ gibbon_match_tracker_init_match (GibbonMatchTracker *self, gsize length,
                                         self->priv->outname,
                                         error->message);
         }
-        g_output_stream_flush (self->priv->out, NULL, NULL);
+        if (!g_output_stream_flush (self->priv->out, NULL, &error)) {
+                gibbon_app_fatal_error (app, _("Write Error"),
+                                        _("Error writing to `%s': %s!\n"),
+                                        self->priv->outname,
+                                        error->message);
+        }
 
         return match;
 }
 
+static GOutputStream *
+gibbon_match_tracker_open (const GibbonMatchTracker *self, const gchar *path,
+                           gboolean append)
+{
+        GSettings *settings;
+        guint interval;
+        gchar *policy;
+        GibbonJournalSync sync;
+        GibbonJournal *journal;
+        GError *error = NULL;
+
+        settings = g_settings_new (GIBBON_PREFS_MATCH_SCHEMA);
+        interval = g_settings_get_uint (settings,
+                                        GIBBON_PREFS_MATCH_JOURNAL_INTERVAL);
+        policy = g_settings_get_string (settings,
+                                        GIBBON_PREFS_MATCH_JOURNAL_SYNC);
+        g_object_unref (settings);
+
+        if (0 == g_strcmp0 ("never", policy))
+                sync = GIBBON_JOURNAL_SYNC_NEVER;
+        else if (0 == g_strcmp0 ("commit", policy))
+                sync = GIBBON_JOURNAL_SYNC_COMMIT;
+        else
+                sync = GIBBON_JOURNAL_SYNC_CLOSE;
+        g_free (policy);
+
+        journal = gibbon_journal_new (path, append, interval, sync, &error);
+        if (!journal) {
+                gibbon_app_fatal_error (app, _("Write Error"),
+                                        _("Error writing to `%s': %s!\n"),
+                                        path, error->message);
+                /* NOTREACHED */
+        }
+
+        return G_OUTPUT_STREAM (journal);
+}
+
+static void
+gibbon_match_tracker_close (GibbonMatchTracker *self)
+{
+        GError *error = NULL;
+
+        if (self->priv->out) {
+                if (!g_output_stream_close (self->priv->out, NULL, &error)) {
+                        gibbon_app_fatal_error (app, _("Write Error"),
+                                                _("Error writing to `%s':"
+                                                  " %s!\n"),
+                                                self->priv->outname,
+                                                error->message);
+                }
+                g_object_unref (self->priv->out);
+                self->priv->out = NULL;
+        }
+
+        g_free (self->priv->outname);
+        self->priv->outname = NULL;
+
+        if (self->priv->writer)
+                g_object_unref (self->priv->writer);
+        self->priv->writer = NULL;
+}
+
 void
 gibbon_match_tracker_set_crawford (GibbonMatchTracker *self, gboolean flag)
 {
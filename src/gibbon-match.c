@@ -42,7 +42,7 @@
 
 typedef struct _GibbonMatchPrivate GibbonMatchPrivate;
 struct _GibbonMatchPrivate {
-        GList *games;
+        GPtrArray *games;
 
         gchar *white;
         gchar *black;
@@ -53,6 +53,23 @@ struct _GibbonMatchPrivate {
         gchar *location;
 
         gboolean debug;
+
+        guint search_depth;
+        gdouble search_time;
+};
+
+/*
+ * One node in the search for missing actions.  The plays are the ones that
+ * lead from the parent node to this one, latest first.
+ */
+typedef struct _GibbonMatchSearchNode GibbonMatchSearchNode;
+struct _GibbonMatchSearchNode {
+        GibbonPosition *position;
+        struct _GibbonMatchSearchNode *parent;
+        GSList *plays;
+        guint depth;
+        gboolean try_move;
+        guint64 key;
 };
 
 #define GIBBON_MATCH_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
@@ -61,9 +78,14 @@ struct _GibbonMatchPrivate {
 G_DEFINE_TYPE (GibbonMatch, gibbon_match, G_TYPE_OBJECT)
 
 static GSList *_gibbon_match_get_missing_actions (const GibbonMatch *self,
-                                                  GibbonPosition *current,
-                                                  const GibbonPosition *target,
-                                                  gboolean try_move);
+                                                  const GibbonPosition *current,
+                                                  const GibbonPosition *target);
+static void gibbon_match_expand_node (const GibbonMatch *self,
+                                      GibbonMatchSearchNode *node,
+                                      const GibbonPosition *target,
+                                      GQueue *queue, GHashTable *visited,
+                                      GPtrArray *nodes);
+static void gibbon_match_search_node_free (GibbonMatchSearchNode *node);
 static GSList *gibbon_match_try_roll (const GibbonMatch *self,
                                       GibbonPosition *current,
                                       const GibbonPosition *target,
@@ -90,7 +112,7 @@ gibbon_match_init (GibbonMatch *self)
         self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                 GIBBON_TYPE_MATCH, GibbonMatchPrivate);
 
-        self->priv->games = NULL;
+        self->priv->games = g_ptr_array_new_with_free_func (g_object_unref);
 
         self->priv->white = NULL;
         self->priv->black = NULL;
@@ -101,6 +123,9 @@ gibbon_match_init (GibbonMatch *self)
         self->priv->location = NULL;
 
         self->priv->debug = FALSE;
+
+        self->priv->search_depth = 12;
+        self->priv->search_time = 0.25;
 }
 
 static void
@@ -108,11 +133,8 @@ gibbon_match_finalize (GObject *object)
 {
         GibbonMatch *self = GIBBON_MATCH (object);
 
-        if (self->priv->games) {
-                g_list_foreach (self->priv->games,
-                                (GFunc) g_object_unref, NULL);
-                g_list_free (self->priv->games);
-        }
+        if (self->priv->games)
+                g_ptr_array_free (self->priv->games, TRUE);
         self->priv->games = NULL;
 
         g_free (self->priv->white);
@@ -163,15 +185,15 @@ gibbon_match_new (const gchar *white, const gchar *black,
 GibbonGame *
 gibbon_match_get_current_game (const GibbonMatch *self)
 {
-        GList *iter;
+        GPtrArray *games;
 
         g_return_val_if_fail (GIBBON_IS_MATCH (self), NULL);
 
-        iter = g_list_last (self->priv->games);
-        if (!iter)
+        games = self->priv->games;
+        if (!games->len)
                 return NULL;
 
-        return iter->data;
+        return g_ptr_array_index (games, games->len - 1);
 }
 
 GibbonGame *
@@ -183,14 +205,12 @@ gibbon_match_add_game (GibbonMatch *self, GError **error)
         gboolean is_crawford = FALSE;
         gint white_away, black_away;
         const GibbonPosition *last_position;
-        GList *iter;
 
         gibbon_return_val_if_fail (GIBBON_IS_MATCH (self), NULL, error);
 
-        iter = g_list_last (self->priv->games);
+        game = gibbon_match_get_current_game (self);
 
-        if (iter) {
-                game = iter->data;
+        if (game) {
                 position = gibbon_position_copy (gibbon_game_get_position (game));
                 gibbon_position_reset (position);
         } else {
@@ -259,11 +279,11 @@ gibbon_match_add_game (GibbonMatch *self, GError **error)
          * that the last match
          */
     no_crawford:
-        game_number = g_list_length (self->priv->games);
+        game_number = self->priv->games->len;
         game = gibbon_game_new (self, position,
                                 self->priv->crawford, is_crawford);
         gibbon_position_free (position);
-        self->priv->games = g_list_append (self->priv->games, game);
+        g_ptr_array_add (self->priv->games, game);
 
         return game;
 }
@@ -284,7 +304,7 @@ gibbon_match_get_current_position (const GibbonMatch *self)
 void
 gibbon_match_set_white (GibbonMatch *self, const gchar *white)
 {
-        GList *iter;
+        guint i;
         GibbonGame *game;
 
         g_return_if_fail (GIBBON_IS_MATCH (self));
@@ -295,11 +315,9 @@ gibbon_match_set_white (GibbonMatch *self, const gchar *white)
         else
                 self->priv->white = g_strdup ("white");
 
-        iter = self->priv->games;
-        while (iter) {
-                game = GIBBON_GAME (iter->data);
+        for (i = 0; i < self->priv->games->len; ++i) {
+                game = g_ptr_array_index (self->priv->games, i);
                 gibbon_game_set_white (game, self->priv->white);
-                iter = iter->next;
         }
 }
 
@@ -314,7 +332,7 @@ gibbon_match_get_white (const GibbonMatch *self)
 void
 gibbon_match_set_black (GibbonMatch *self, const gchar *black)
 {
-        GList *iter;
+        guint i;
         GibbonGame *game;
 
         g_return_if_fail (GIBBON_IS_MATCH (self));
@@ -325,11 +343,9 @@ gibbon_match_set_black (GibbonMatch *self, const gchar *black)
         else
                 self->priv->black = g_strdup ("black");
 
-        iter = self->priv->games;
-        while (iter) {
-                game = GIBBON_GAME (iter->data);
+        for (i = 0; i < self->priv->games->len; ++i) {
+                game = g_ptr_array_index (self->priv->games, i);
                 gibbon_game_set_black (game, self->priv->black);
-                iter = iter->next;
         }
 }
 const gchar *
@@ -371,18 +387,16 @@ gibbon_match_get_rank (const GibbonMatch *self, GibbonPositionSide side)
 void
 gibbon_match_set_length (GibbonMatch *self, gsize length)
 {
-        GList *iter;
+        guint i;
         GibbonGame *game;
 
         g_return_if_fail (GIBBON_IS_MATCH (self));
 
         self->priv->length = length;
 
-        iter = self->priv->games;
-        while (iter) {
-                game = GIBBON_GAME (iter->data);
+        for (i = 0; i < self->priv->games->len; ++i) {
+                game = g_ptr_array_index (self->priv->games, i);
                 gibbon_game_set_match_length (game, length);
-                iter = iter->next;
         }
 
 }
@@ -419,21 +433,18 @@ gibbon_match_get_number_of_games (const GibbonMatch *self)
 {
         g_return_val_if_fail (GIBBON_IS_MATCH (self), 0);
 
-        return g_list_length (self->priv->games);
+        return self->priv->games->len;
 }
 
 GibbonGame *
 gibbon_match_get_nth_game (const GibbonMatch *self, gsize i)
 {
-        GList *iter;
-
         g_return_val_if_fail (GIBBON_IS_MATCH (self), NULL);
 
-        iter = g_list_nth (self->priv->games, i);
-        if (!iter)
+        if (i >= self->priv->games->len)
                 return NULL;
 
-        return iter->data;
+        return g_ptr_array_index (self->priv->games, i);
 }
 
 gboolean
@@ -512,6 +523,9 @@ gibbon_match_add_action (GibbonMatch *self, GibbonPositionSide side,
  * once, and give up if the target position cannot be achieved after
  * one try.
  *
+ * The search for the missing actions is breadth-first and bounded in depth
+ * and time, see gibbon_match_set_search_limits().
+ *
  * It lies in the nature of the problem that certain sequences of game actions
  * cannot be recovered, for example a rejected resignation or a roll, move,
  * roll, move sequence, when both opponents dance.  But this is only
@@ -583,8 +597,7 @@ gibbon_match_get_missing_actions (const GibbonMatch *self,
                 current->match_length = target->match_length;
         }
 
-        result = _gibbon_match_get_missing_actions (self, current,
-                                                    target, TRUE);
+        result = _gibbon_match_get_missing_actions (self, current, target);
         gibbon_position_free (current);
 
         if (result) {
@@ -596,21 +609,119 @@ gibbon_match_get_missing_actions (const GibbonMatch *self,
         return FALSE;
 }
 
+/**
+ * gibbon_match_set_search_limits:
+ * @self: The #GibbonMatch.
+ * @max_depth: Maximum number of steps between the current and the target
+ *             position.
+ * @max_seconds: Maximum time to spend on the search.
+ *
+ * Limits the effort spent by gibbon_match_get_missing_actions().  A step
+ * consists of one or two actions, for example a roll and the following move.
+ */
+void
+gibbon_match_set_search_limits (GibbonMatch *self, guint max_depth,
+                                gdouble max_seconds)
+{
+        g_return_if_fail (GIBBON_IS_MATCH (self));
+
+        self->priv->search_depth = max_depth;
+        self->priv->search_time = max_seconds;
+}
+
+/*
+ * Breadth-first search from the current to the target position.  The
+ * successors of a node are queued in the order of their likelihood so that
+ * the most plausible of the shortest explanations is found.  Positions that
+ * have already been reached are not visited again.
+ */
 static GSList *
 _gibbon_match_get_missing_actions (const GibbonMatch *self,
-                                   GibbonPosition *current,
-                                   const GibbonPosition *target,
-                                   gboolean try_move)
+                                   const GibbonPosition *current,
+                                   const GibbonPosition *target)
 {
         GSList *retval = NULL;
-        GSList *head;
-        const GibbonPosition *initial;
+        GQueue *queue;
+        GHashTable *visited;
+        GPtrArray *nodes;
+        GibbonMatchSearchNode *node, *goal = NULL, *deepest;
+        GTimer *timer;
         GTimeVal timeval;
         struct tm *now;
 
-        g_return_val_if_fail (GIBBON_IS_MATCH (self), FALSE);
-        g_return_val_if_fail (target != NULL, FALSE);
+        queue = g_queue_new ();
+        visited = g_hash_table_new (g_int64_hash, g_int64_equal);
+        nodes = g_ptr_array_new_with_free_func (
+                        (GDestroyNotify) gibbon_match_search_node_free);
+        timer = g_timer_new ();
+
+        node = g_malloc0 (sizeof *node);
+        node->position = gibbon_position_copy (current);
+        node->try_move = TRUE;
+        g_ptr_array_add (nodes, node);
+        g_queue_push_tail (queue, node);
+        deepest = node;
+
+        while (!g_queue_is_empty (queue)) {
+                node = g_queue_pop_head (queue);
+                if (node->depth > deepest->depth)
+                        deepest = node;
+                if (node->depth
+                    && gibbon_position_equals_technically (node->position,
+                                                           target)) {
+                        goal = node;
+                        break;
+                }
+                if (node->depth >= self->priv->search_depth)
+                        continue;
+                if (g_timer_elapsed (timer, NULL) > self->priv->search_time)
+                        break;
+                gibbon_match_expand_node (self, node, target, queue, visited,
+                                          nodes);
+        }
+
+        for (node = goal; node; node = node->parent) {
+                retval = g_slist_concat (retval, node->plays);
+                node->plays = NULL;
+        }
+
+        if (!goal && self->priv->debug) {
+                g_get_current_time (&timeval);
+                now = localtime ((time_t *) &timeval.tv_sec);
+                g_printerr ("[%02d:%02d:%02d.%06ld] Got stuck after %u nodes"
+                            " and %f s here:\n",
+                           now->tm_hour, now->tm_min, now->tm_sec,
+                           timeval.tv_usec, nodes->len,
+                           g_timer_elapsed (timer, NULL));
+                gibbon_position_dump (deepest->position);
+        }
+
+        g_timer_destroy (timer);
+        g_ptr_array_free (nodes, TRUE);
+        g_hash_table_destroy (visited);
+        g_queue_free (queue);
 
+        return retval;
+}
+
+static void
+gibbon_match_expand_node (const GibbonMatch *self,
+                          GibbonMatchSearchNode *node,
+                          const GibbonPosition *target,
+                          GQueue *queue, GHashTable *visited,
+                          GPtrArray *nodes)
+{
+        GibbonPosition *current;
+        GibbonMatchSearchNode *child;
+        /* Successor positions, the actions leading there, and the new value
+         * of the try_move flag.
+         */
+        GibbonPosition *positions[2];
+        GSList *plays[2];
+        gboolean try_move[2];
+        gsize num = 0, i;
+
+        current = gibbon_position_copy (node->position);
         if (gibbon_position_game_over (current)) {
                 gibbon_position_reset (current);
                 /*
@@ -619,58 +730,78 @@ _gibbon_match_get_missing_actions (const GibbonMatch *self,
                  */
         }
 
+        /*
+         * Only one move can be deduced because the move is checked against
+         * the target position.  A roll without a move uses up this chance
+         * as well.
+         */
+        for (i = 0; i < G_N_ELEMENTS (positions); ++i)
+                positions[i] = gibbon_position_copy (current);
+
         if (current->resigned) {
-                retval = gibbon_match_try_accept (self, current, target);
+                plays[num] = gibbon_match_try_accept (self, positions[num],
+                                                      target);
+                try_move[num++] = node->try_move;
         } else if (current->cube_turned) {
-                retval = gibbon_match_try_take (self, current, target);
-                if (!retval)
-                        retval = gibbon_match_try_drop (self, current, target);
+                plays[num] = gibbon_match_try_take (self, positions[num],
+                                                    target);
+                try_move[num++] = node->try_move;
+                plays[num] = gibbon_match_try_drop (self, positions[num],
+                                                    target);
+                try_move[num++] = node->try_move;
         } else if (!current->dice[0]) {
-                retval = gibbon_match_try_double (self, current, target);
-                if (!retval) {
-                        retval = gibbon_match_try_roll (self, current, target,
-                                                        try_move);
-                        try_move = FALSE;
-                }
-        } else {
-                initial = gibbon_position_initial ();
+                plays[num] = gibbon_match_try_double (self, positions[num],
+                                                      target);
+                try_move[num++] = node->try_move;
+                plays[num] = gibbon_match_try_roll (self, positions[num],
+                                                    target, node->try_move);
+                try_move[num++] = FALSE;
+        } else if (!current->turn) {
                 /*
                  * Handle the case after an initial opening double.
                  */
-                if (!current->turn) {
-                        retval = gibbon_match_try_roll (self, current, target,
-                                                        try_move);
-                } else if (!retval && try_move) {
-                        retval = gibbon_match_try_move (self, current, target);
-                        try_move = FALSE;
-                }
+                plays[num] = gibbon_match_try_roll (self, positions[num],
+                                                    target, node->try_move);
+                try_move[num++] = node->try_move;
+        } else if (node->try_move) {
+                plays[num] = gibbon_match_try_move (self, positions[num],
+                                                    target);
+                try_move[num++] = FALSE;
         }
 
-        if (!retval && self->priv->debug) {
-                g_get_current_time (&timeval);
-                now = localtime ((time_t *) &timeval.tv_sec);
-                g_printerr ("[%02d:%02d:%02d.%06ld] Got stuck here:\n",
-                           now->tm_hour, now->tm_min, now->tm_sec,
-                           timeval.tv_usec);
-                gibbon_position_dump (current);
-        }
-
-        if (!retval)
-                return NULL;
-
-        if (gibbon_position_equals_technically (current, target))
-                return retval;
+        gibbon_position_free (current);
 
-        head = _gibbon_match_get_missing_actions (self, current, target,
-                                                  try_move);
+        for (i = 0; i < G_N_ELEMENTS (positions); ++i) {
+                if (i >= num || !plays[i]) {
+                        gibbon_position_free (positions[i]);
+                        continue;
+                }
 
-        if (!head) {
-                g_slist_free_full (retval,
-                                   (GDestroyNotify) gibbon_match_play_free);
-                return NULL;
+                child = g_malloc0 (sizeof *child);
+                child->position = positions[i];
+                child->parent = node;
+                child->plays = plays[i];
+                child->depth = node->depth + 1;
+                child->try_move = try_move[i];
+                child->key = gibbon_position_hash (child->position);
+                if (child->try_move)
+                        child->key = ~child->key;
+                g_ptr_array_add (nodes, child);
+
+                if (g_hash_table_lookup (visited, &child->key))
+                        continue;
+                g_hash_table_insert (visited, &child->key, child);
+                g_queue_push_tail (queue, child);
         }
+}
 
-        return g_slist_concat (head, retval);
+static void
+gibbon_match_search_node_free (GibbonMatchSearchNode *node)
+{
+        gibbon_position_free (node->position);
+        g_slist_free_full (node->plays,
+                           (GDestroyNotify) gibbon_match_play_free);
+        g_free (node);
 }
 
 static GSList *
@@ -149,6 +149,8 @@ gboolean gibbon_match_add_action (GibbonMatch *self, GibbonPositionSide side,
 gboolean gibbon_match_get_missing_actions (const GibbonMatch *self,
                                            const GibbonPosition *target,
                                            GSList **result);
+void gibbon_match_set_search_limits (GibbonMatch *self, guint max_depth,
+                                     gdouble max_seconds);
 gint64 gibbon_match_get_start_time (const GibbonMatch *self);
 void gibbon_match_set_start_time (GibbonMatch *self, gint64 timestamp);
 guint gibbon_match_get_white_score (const GibbonMatch *self);
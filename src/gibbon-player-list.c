@@ -17,23 +17,90 @@
  * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/**
+ * SECTION:gibbon-player-list
+ * @short_description: The list of players logged in.
+ *
+ * Since: 0.1.0
+ *
+ * The player list is a #GtkTreeModel and #GtkTreeSortable of its own.
+ * The data is kept in a table with one array per column, and the values
+ * for the view are only produced when asked for.  All strings are interned,
+ * countries are stored as one-byte indices into a lookup table, and
+ * clients as their #GibbonClientType.
+ *
+ * The current sort order is kept as a permutation of the table rows, so
+ * that an update to a single row only has to move that row.
+ */
+
+#include <string.h>
+
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 
+#include "gibbon-app.h"
+#include "gibbon-client-icons.h"
 #include "gibbon-player-list.h"
 #include "gibbon-reliability.h"
 
+#define GIBBON_PLAYER_LIST_HAS_SAVED 0x1
+#define GIBBON_PLAYER_LIST_AVAILABLE 0x2
+#define GIBBON_PLAYER_LIST_PLAYING   0x4
+
+/*
+ * The string chunk is rebuilt from the live rows, when the strings that
+ * are no longer referenced take more space than this and more than the
+ * ones still in use.
+ */
+#define GIBBON_PLAYER_LIST_MIN_GARBAGE (64 << 10)
+
 struct _GibbonPlayerListPrivate {
+        /* Maps interned names to their row number plus one.  */
         GHashTable *hash;
-        GtkListStore *store;
-};
+        GStringChunk *strings;
 
-struct GibbonPlayer {
-        GtkTreeIter iter;
-        
-        guint experience;
-        gdouble rating;
-        gboolean use_backslash_u;
+        /*
+         * Estimated size of the strings in the chunk that are still in
+         * use and of those that have been released.
+         */
+        gsize live_bytes;
+        gsize dead_bytes;
+
+        guint num_rows;
+        guint allocated;
+
+        /* The table, one array per column.  */
+        const gchar **names;
+        const gchar **name_keys;
+        const gchar **opponents;
+        const gchar **watching;
+        const gchar **clients;
+        const gchar **client_keys;
+        const gchar **hostnames;
+        const gchar **emails;
+        gfloat *ratings;
+        guint64 *experiences;
+        gfloat *reliabilities;
+        guint *confidences;
+        guint8 *flags;
+        guint8 *client_types;
+        guint8 *countries;
+
+        /* Lookup table for the country indices.  Index 0 is no country.  */
+        GPtrArray *country_table;
+        GPtrArray *country_keys;
+        GHashTable *country_index;
+
+        /* Sort permutation, order maps positions to rows, positions back.  */
+        guint *order;
+        guint *positions;
+
+        gint stamp;
+
+        /* Sorting is suspended while updates are pending.  */
+        guint update_depth;
+        gint sort_column;
+        GtkSortType sort_order;
 };
 
 static GType gibbon_player_list_column_types[GIBBON_PLAYER_LIST_N_COLUMNS];
@@ -42,113 +109,145 @@ static GType gibbon_player_list_column_types[GIBBON_PLAYER_LIST_N_COLUMNS];
                                        GIBBON_TYPE_PLAYER_LIST,           \
                                        GibbonPlayerListPrivate))
 
-static gint gibbon_player_list_compare_status (GtkTreeModel *model,
-                                               GtkTreeIter *a,
-                                               GtkTreeIter *b,
-                                               gpointer user_data);
-static gint gibbon_player_list_compare_country (GtkTreeModel *model,
-                                                GtkTreeIter *a,
-                                                GtkTreeIter *b,
-                                                gpointer user_data);
-static gint gibbon_player_list_compare_reliability (GtkTreeModel *model,
-                                                    GtkTreeIter *a,
-                                                    GtkTreeIter *b,
-                                                    gpointer user_data);
-
-G_DEFINE_TYPE (GibbonPlayerList, gibbon_player_list, G_TYPE_OBJECT);
+static void gibbon_player_list_tree_model_init (GtkTreeModelIface *iface);
+static void gibbon_player_list_tree_sortable_init (GtkTreeSortableIface
+                                                   *iface);
+G_DEFINE_TYPE_WITH_CODE (GibbonPlayerList, gibbon_player_list, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                           gibbon_player_list_tree_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_SORTABLE,
+                                        gibbon_player_list_tree_sortable_init))
+
+static const gchar *gibbon_player_list_intern (GibbonPlayerList *self,
+                                               const gchar *string);
+static const gchar *gibbon_player_list_intern_key (GibbonPlayerList *self,
+                                                   const gchar *string);
+static void gibbon_player_list_store (GibbonPlayerList *self,
+                                      const gchar **slot,
+                                      const gchar *interned);
+static void gibbon_player_list_release (GibbonPlayerList *self,
+                                        const gchar *string);
+static void gibbon_player_list_release_row (GibbonPlayerList *self, guint row);
+static void gibbon_player_list_move_string (GibbonPlayerList *self,
+                                            const gchar **slot);
+static void gibbon_player_list_collect_garbage (GibbonPlayerList *self);
+static guint8 gibbon_player_list_country_index (GibbonPlayerList *self,
+                                                const GibbonCountry *country);
+static void gibbon_player_list_grow (GibbonPlayerList *self);
+static void gibbon_player_list_copy_row (GibbonPlayerList *self,
+                                         guint from, guint to);
+static gint gibbon_player_list_compare (const GibbonPlayerList *self,
+                                        guint a, guint b);
+static gint gibbon_player_list_compare_rows (gconstpointer a, gconstpointer b,
+                                             gpointer self);
+static gint gibbon_player_list_compare_reliability (const GibbonPlayerList
+                                                    *self,
+                                                    guint a, guint b);
+static guint gibbon_player_list_find_position (const GibbonPlayerList *self,
+                                               guint row, guint n);
+static void gibbon_player_list_insert_position (GibbonPlayerList *self,
+                                                guint row, guint position,
+                                                guint n);
+static void gibbon_player_list_remove_position (GibbonPlayerList *self,
+                                                guint position, guint n);
+static void gibbon_player_list_reposition (GibbonPlayerList *self, guint row);
+static void gibbon_player_list_sort (GibbonPlayerList *self);
+static void gibbon_player_list_row_changed (GibbonPlayerList *self, guint row);
 
 static void
 gibbon_player_list_init (GibbonPlayerList *self)
 {
-        GtkListStore *store;
-        
-        self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, 
-                                                  GIBBON_TYPE_PLAYER_LIST, 
+        self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+                                                  GIBBON_TYPE_PLAYER_LIST,
                                                   GibbonPlayerListPrivate);
 
-        self->priv->hash = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                  g_free,
-                                                  g_free);
-
-        store = gtk_list_store_new (GIBBON_PLAYER_LIST_N_COLUMNS, 
-                                    G_TYPE_STRING,
-                                    G_TYPE_UINT,
-                                    G_TYPE_STRING,
-                                    G_TYPE_DOUBLE, 
-                                    G_TYPE_UINT,
-                                    G_TYPE_STRING,
-                                    GDK_TYPE_PIXBUF,
-                                    GIBBON_TYPE_RELIABILITY,
-                                    G_TYPE_STRING,
-                                    G_TYPE_STRING,
-                                    G_TYPE_STRING,
-                                    GIBBON_TYPE_COUNTRY,
-                                    GDK_TYPE_PIXBUF,
-                                    G_TYPE_STRING);
-        self->priv->store = store;
-        
-        gtk_tree_sortable_set_sort_func (
-                GTK_TREE_SORTABLE (store), 
-                GIBBON_PLAYER_LIST_COL_NAME,
-                gibbon_compare_string_column,
-                GINT_TO_POINTER (GIBBON_PLAYER_LIST_COL_NAME), 
-                NULL);
+        /* Keys are interned in the string chunk.  */
+        self->priv->hash = g_hash_table_new (g_str_hash, g_str_equal);
+        self->priv->strings = g_string_chunk_new (4096);
+        self->priv->live_bytes = 0;
+        self->priv->dead_bytes = 0;
+
+        self->priv->num_rows = 0;
+        self->priv->allocated = 0;
+
+        self->priv->names = NULL;
+        self->priv->name_keys = NULL;
+        self->priv->opponents = NULL;
+        self->priv->watching = NULL;
+        self->priv->clients = NULL;
+        self->priv->client_keys = NULL;
+        self->priv->hostnames = NULL;
+        self->priv->emails = NULL;
+        self->priv->ratings = NULL;
+        self->priv->experiences = NULL;
+        self->priv->reliabilities = NULL;
+        self->priv->confidences = NULL;
+        self->priv->flags = NULL;
+        self->priv->client_types = NULL;
+        self->priv->countries = NULL;
+
+        self->priv->country_table = g_ptr_array_new ();
+        g_ptr_array_add (self->priv->country_table, NULL);
+        self->priv->country_keys = g_ptr_array_new_with_free_func (g_free);
+        g_ptr_array_add (self->priv->country_keys, g_strdup (""));
+        self->priv->country_index = g_hash_table_new_full (g_str_hash,
+                                                           g_str_equal,
+                                                           g_free, NULL);
+
+        self->priv->order = NULL;
+        self->priv->positions = NULL;
+
+        self->priv->stamp = g_random_int ();
+
+        self->priv->update_depth = 0;
+
         /*
          * Initially sort by name.  FIXME! We should save the last sorting
          * in the user preferences.
          */
-        gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store),
-                                              GIBBON_PLAYER_LIST_COL_NAME, 
-                                              GTK_SORT_ASCENDING);
-
-        gtk_tree_sortable_set_sort_func (
-                GTK_TREE_SORTABLE (store),
-                GIBBON_PLAYER_LIST_COL_AVAILABLE,
-                gibbon_player_list_compare_status,
-                GINT_TO_POINTER (GIBBON_PLAYER_LIST_COL_AVAILABLE),
-                NULL);
-        gtk_tree_sortable_set_sort_func (
-                GTK_TREE_SORTABLE (store),
-                GIBBON_PLAYER_LIST_COL_COUNTRY,
-                gibbon_player_list_compare_country,
-                GINT_TO_POINTER (GIBBON_PLAYER_LIST_COL_COUNTRY),
-                NULL);
-        gtk_tree_sortable_set_sort_func (
-                GTK_TREE_SORTABLE (store),
-                GIBBON_PLAYER_LIST_COL_RATING,
-                gibbon_compare_double_column,
-                GINT_TO_POINTER (GIBBON_PLAYER_LIST_COL_RATING),
-                NULL);
-        gtk_tree_sortable_set_sort_func (
-                GTK_TREE_SORTABLE (store),
-                GIBBON_PLAYER_LIST_COL_EXPERIENCE,
-                gibbon_compare_uint_column,
-                GINT_TO_POINTER (GIBBON_PLAYER_LIST_COL_EXPERIENCE),
-                NULL);
-        gtk_tree_sortable_set_sort_func (
-                GTK_TREE_SORTABLE (store),
-                GIBBON_PLAYER_LIST_COL_CLIENT,
-                gibbon_compare_string_column,
-                GINT_TO_POINTER (GIBBON_PLAYER_LIST_COL_CLIENT),
-                NULL);
-        gtk_tree_sortable_set_sort_func (
-                GTK_TREE_SORTABLE (store),
-                GIBBON_PLAYER_LIST_COL_RELIABILITY,
-                gibbon_player_list_compare_reliability,
-                GINT_TO_POINTER (GIBBON_PLAYER_LIST_COL_RELIABILITY),
-                NULL);
+        self->priv->sort_column = GIBBON_PLAYER_LIST_COL_NAME;
+        self->priv->sort_order = GTK_SORT_ASCENDING;
 }
 
 static void
 gibbon_player_list_finalize (GObject *object)
 {
         GibbonPlayerList *self = GIBBON_PLAYER_LIST (object);
+        guint i;
 
         if (self->priv->hash)
                 g_hash_table_destroy (self->priv->hash);
-        
-        if (self->priv->store)
-                g_object_unref (self->priv->store);
+        if (self->priv->strings)
+                g_string_chunk_free (self->priv->strings);
+
+        g_free (self->priv->names);
+        g_free (self->priv->name_keys);
+        g_free (self->priv->opponents);
+        g_free (self->priv->watching);
+        g_free (self->priv->clients);
+        g_free (self->priv->client_keys);
+        g_free (self->priv->hostnames);
+        g_free (self->priv->emails);
+        g_free (self->priv->ratings);
+        g_free (self->priv->experiences);
+        g_free (self->priv->reliabilities);
+        g_free (self->priv->confidences);
+        g_free (self->priv->flags);
+        g_free (self->priv->client_types);
+        g_free (self->priv->countries);
+        g_free (self->priv->order);
+        g_free (self->priv->positions);
+
+        if (self->priv->country_table) {
+                for (i = 1; i < self->priv->country_table->len; ++i)
+                        g_object_unref (g_ptr_array_index (
+                                        self->priv->country_table, i));
+                g_ptr_array_free (self->priv->country_table, TRUE);
+        }
+        if (self->priv->country_keys)
+                g_ptr_array_free (self->priv->country_keys, TRUE);
+        if (self->priv->country_index)
+                g_hash_table_destroy (self->priv->country_index);
 
         G_OBJECT_CLASS (gibbon_player_list_parent_class)->finalize (object);
 }
@@ -160,16 +259,16 @@ gibbon_player_list_class_init (GibbonPlayerListClass *klass)
 
         g_type_class_add_private (klass, sizeof (GibbonPlayerListPrivate));
 
-        gibbon_player_list_column_types[GIBBON_PLAYER_LIST_COL_NAME] = 
+        gibbon_player_list_column_types[GIBBON_PLAYER_LIST_COL_NAME] =
                 G_TYPE_STRING;
         gibbon_player_list_column_types[GIBBON_PLAYER_LIST_COL_NAME_WEIGHT] =
                 G_TYPE_INT;
         gibbon_player_list_column_types[GIBBON_PLAYER_LIST_COL_AVAILABLE] =
                 G_TYPE_STRING;
-        gibbon_player_list_column_types[GIBBON_PLAYER_LIST_COL_RATING] = 
+        gibbon_player_list_column_types[GIBBON_PLAYER_LIST_COL_RATING] =
                 G_TYPE_DOUBLE;
-        gibbon_player_list_column_types[GIBBON_PLAYER_LIST_COL_EXPERIENCE] = 
-                G_TYPE_UINT;
+        gibbon_player_list_column_types[GIBBON_PLAYER_LIST_COL_EXPERIENCE] =
+                G_TYPE_UINT64;
         gibbon_player_list_column_types[GIBBON_PLAYER_LIST_COL_CLIENT] =
                 G_TYPE_STRING;
         gibbon_player_list_column_types[GIBBON_PLAYER_LIST_COL_CLIENT_ICON] =
@@ -188,7 +287,7 @@ gibbon_player_list_class_init (GibbonPlayerListClass *klass)
                 GDK_TYPE_PIXBUF;
         gibbon_player_list_column_types[GIBBON_PLAYER_LIST_COL_EMAIL] =
                 G_TYPE_STRING;
-                
+
         G_OBJECT_CLASS (parent_class)->finalize = gibbon_player_list_finalize;
 }
 
@@ -201,90 +300,148 @@ gibbon_player_list_new ()
 }
 
 void
-gibbon_player_list_set (GibbonPlayerList *self, 
+gibbon_player_list_set (GibbonPlayerList *self,
                         const gchar *name,
                         gboolean has_saved,
                         gboolean available,
                         gdouble rating,
-                        guint experience,
+                        guint64 experience,
                         gdouble reliability,
                         guint confidence,
                         const gchar *opponent,
                         const gchar *watching,
                         const gchar *client,
-                        const GdkPixbuf *client_icon,
+                        enum GibbonClientType client_type,
                         const gchar *hostname,
                         const GibbonCountry *country,
                         const gchar *email)
 {
-        struct GibbonPlayer *player;
-        const gchar *version_string = NULL;
-        const gchar *stock_id;
-        GibbonReliability rel;
-        const GdkPixbuf *country_icon;
-        gint name_weight = has_saved ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL;
+        GibbonPlayerListPrivate *priv;
+        gpointer lookup;
+        guint row;
+        guint position;
+        const gchar *interned;
+        guint8 flags = 0;
+        GtkTreePath *path;
+        GtkTreeIter iter;
 
         g_return_if_fail (GIBBON_IS_PLAYER_LIST (self));
         g_return_if_fail (name);
-        
-        rel.value = reliability;
-        rel.confidence = confidence;
-
-        player = g_hash_table_lookup (self->priv->hash, name);
-        if (!player) {
-                player = g_malloc0 (sizeof *player);
-                g_hash_table_insert (self->priv->hash, g_strdup (name), player);
-                gtk_list_store_append (self->priv->store, 
-                                       &player->iter);
+
+        priv = self->priv;
+
+        lookup = g_hash_table_lookup (priv->hash, name);
+        if (lookup) {
+                row = GPOINTER_TO_UINT (lookup) - 1;
+        } else {
+                if (priv->num_rows >= priv->allocated)
+                        gibbon_player_list_grow (self);
+                row = priv->num_rows++;
+                priv->names[row] = NULL;
+                priv->name_keys[row] = NULL;
+                gibbon_player_list_store (self, &priv->names[row],
+                                          gibbon_player_list_intern (self,
+                                                                     name));
+                gibbon_player_list_store (self, &priv->name_keys[row],
+                                          gibbon_player_list_intern_key (self,
+                                                                         name));
+                priv->opponents[row] = NULL;
+                priv->watching[row] = NULL;
+                priv->hostnames[row] = NULL;
+                priv->emails[row] = NULL;
+                priv->clients[row] = NULL;
+                priv->client_keys[row] = NULL;
+                g_hash_table_insert (priv->hash, (gpointer) priv->names[row],
+                                     GUINT_TO_POINTER (row + 1));
         }
 
-        player->rating = rating;
-        player->experience = experience;
-        player->use_backslash_u = FALSE;
-
-        if (client) {
-                if (strncmp ("BGOnline v", client, 10) == 0)
-                        version_string = client + 10;
-                else if (strncmp ("Padgammon v", client, 11) == 0)
-                        version_string = client + 11;
-
-                if (version_string) {
-                        if ((version_string[0] == '1'
-                             && version_string[1] == '.')
-                            || (version_string[0] == '2'
-                                && version_string[1] == '.'
-                                && version_string[2] == '0'))
-                                player->use_backslash_u = TRUE;
-                }
+        if (has_saved)
+                flags |= GIBBON_PLAYER_LIST_HAS_SAVED;
+        if (available)
+                flags |= GIBBON_PLAYER_LIST_AVAILABLE;
+        else if (opponent && *opponent)
+                flags |= GIBBON_PLAYER_LIST_PLAYING;
+
+        priv->flags[row] = flags;
+        priv->ratings[row] = rating;
+        priv->experiences[row] = experience;
+        priv->reliabilities[row] = reliability;
+        priv->confidences[row] = confidence;
+        gibbon_player_list_store (self, &priv->opponents[row],
+                                  gibbon_player_list_intern (self, opponent));
+        gibbon_player_list_store (self, &priv->watching[row],
+                                  gibbon_player_list_intern (self, watching));
+        gibbon_player_list_store (self, &priv->hostnames[row],
+                                  gibbon_player_list_intern (self, hostname));
+        gibbon_player_list_store (self, &priv->emails[row],
+                                  gibbon_player_list_intern (self, email));
+        priv->client_types[row] = client_type;
+        priv->countries[row] = gibbon_player_list_country_index (self,
+                                                                 country);
+
+        /* Interned strings can be compared by address.  */
+        interned = gibbon_player_list_intern (self, client);
+        if (!priv->client_keys[row] || interned != priv->clients[row]) {
+                gibbon_player_list_store (self, &priv->clients[row], interned);
+                gibbon_player_list_store (self, &priv->client_keys[row],
+                                          gibbon_player_list_intern_key (
+                                                  self, client));
         }
 
-        if (available) {
-                stock_id = GTK_STOCK_YES;
-        } else {
-                if (opponent && *opponent)
-                        stock_id = GTK_STOCK_NO;
-                else
-                        stock_id = GTK_STOCK_STOP;
+        if (lookup) {
+                gibbon_player_list_reposition (self, row);
+                gibbon_player_list_row_changed (self, row);
+                gibbon_player_list_collect_garbage (self);
+                return;
         }
 
-        country_icon = gibbon_country_get_pixbuf (country);
-        gtk_list_store_set (self->priv->store,
-                            &player->iter,
-                            GIBBON_PLAYER_LIST_COL_NAME, name,
-                            GIBBON_PLAYER_LIST_COL_NAME_WEIGHT, name_weight,
-                            GIBBON_PLAYER_LIST_COL_AVAILABLE, stock_id,
-                            GIBBON_PLAYER_LIST_COL_RATING, rating,
-                            GIBBON_PLAYER_LIST_COL_EXPERIENCE, experience,
-                            GIBBON_PLAYER_LIST_COL_RELIABILITY, &rel,
-                            GIBBON_PLAYER_LIST_COL_OPPONENT, opponent,
-                            GIBBON_PLAYER_LIST_COL_WATCHING, watching,
-                            GIBBON_PLAYER_LIST_COL_CLIENT, client,
-                            GIBBON_PLAYER_LIST_COL_CLIENT_ICON, client_icon,
-                            GIBBON_PLAYER_LIST_COL_HOSTNAME, hostname,
-                            GIBBON_PLAYER_LIST_COL_COUNTRY, country,
-                            GIBBON_PLAYER_LIST_COL_COUNTRY_ICON, country_icon,
-                            GIBBON_PLAYER_LIST_COL_EMAIL, email,
-                            -1);
+        position = gibbon_player_list_find_position (self, row,
+                                                     priv->num_rows - 1);
+        gibbon_player_list_insert_position (self, row, position,
+                                            priv->num_rows - 1);
+
+        iter.stamp = priv->stamp;
+        iter.user_data = GUINT_TO_POINTER (row);
+        path = gtk_tree_path_new_from_indices (position, -1);
+        gtk_tree_model_row_inserted (GTK_TREE_MODEL (self), path, &iter);
+        gtk_tree_path_free (path);
+
+        gibbon_player_list_collect_garbage (self);
+}
+
+/**
+ * gibbon_player_list_begin_update:
+ * @self: The #GibbonPlayerList.
+ *
+ * Suspends sorting of the list until the matching call to
+ * gibbon_player_list_end_update().  Use this around bursts of changes
+ * so that the list is sorted only once.  Calls can be nested.
+ */
+void
+gibbon_player_list_begin_update (GibbonPlayerList *self)
+{
+        g_return_if_fail (GIBBON_IS_PLAYER_LIST (self));
+
+        ++self->priv->update_depth;
+}
+
+/**
+ * gibbon_player_list_end_update:
+ * @self: The #GibbonPlayerList.
+ *
+ * Ends a batch of updates started with gibbon_player_list_begin_update().
+ * The outermost call sorts the list once.
+ */
+void
+gibbon_player_list_end_update (GibbonPlayerList *self)
+{
+        g_return_if_fail (GIBBON_IS_PLAYER_LIST (self));
+        g_return_if_fail (self->priv->update_depth > 0);
+
+        if (--self->priv->update_depth)
+                return;
+
+        gibbon_player_list_sort (self);
 }
 
 void
@@ -293,16 +450,33 @@ gibbon_player_list_connect_view (GibbonPlayerList *self, GtkTreeView *view)
         g_return_if_fail (GIBBON_IS_PLAYER_LIST (self));
         g_return_if_fail (GTK_IS_TREE_VIEW (view));
 
-        gtk_tree_view_set_model (view, GTK_TREE_MODEL (self->priv->store));
+        gtk_tree_view_set_model (view, GTK_TREE_MODEL (self));
 }
 
 void
 gibbon_player_list_clear (GibbonPlayerList *self)
 {
+        GtkTreePath *path;
+
         g_return_if_fail (GIBBON_IS_PLAYER_LIST (self));
-        
+
+        /*
+         * The strings stay valid until all rows are gone, the view may
+         * still look at them while the rows are being deleted.
+         */
+        while (self->priv->num_rows) {
+                --self->priv->num_rows;
+                path = gtk_tree_path_new_from_indices (self->priv->num_rows,
+                                                       -1);
+                gtk_tree_model_row_deleted (GTK_TREE_MODEL (self), path);
+                gtk_tree_path_free (path);
+        }
+
         g_hash_table_remove_all (self->priv->hash);
-        gtk_list_store_clear (self->priv->store);
+        g_string_chunk_clear (self->priv->strings);
+        self->priv->live_bytes = 0;
+        self->priv->dead_bytes = 0;
+        ++self->priv->stamp;
 }
 
 gboolean
@@ -310,104 +484,104 @@ gibbon_player_list_exists (const GibbonPlayerList *self, const gchar *name)
 {
         g_return_val_if_fail (GIBBON_IS_PLAYER_LIST (self), FALSE);
 
-        return g_hash_table_lookup (self->priv->hash, name) ? FALSE : TRUE;
+        return g_hash_table_lookup (self->priv->hash, name) ? TRUE : FALSE;
 }
 
 void
 gibbon_player_list_remove (GibbonPlayerList *self,
                            const gchar *name)
 {
-        struct GibbonPlayer *player = g_hash_table_lookup (self->priv->hash,
-                                                           name);
-        GtkTreeIter iter;
+        GibbonPlayerListPrivate *priv;
+        gpointer lookup;
+        guint row, last;
+        guint position;
+        GtkTreePath *path;
 
-        if (!player)
+        g_return_if_fail (GIBBON_IS_PLAYER_LIST (self));
+
+        priv = self->priv;
+        lookup = g_hash_table_lookup (priv->hash, name);
+        if (!lookup)
                 return;
 
-        iter = player->iter;
+        row = GPOINTER_TO_UINT (lookup) - 1;
+        position = priv->positions[row];
+        (void) g_hash_table_remove (priv->hash, name);
+        gibbon_player_list_release_row (self, row);
+
+        gibbon_player_list_remove_position (self, position, priv->num_rows);
+
+        /* Fill the hole with the last row of the table.  */
+        last = priv->num_rows - 1;
+        if (row != last) {
+                gibbon_player_list_copy_row (self, last, row);
+                priv->positions[row] = priv->positions[last];
+                priv->order[priv->positions[row]] = row;
+                g_hash_table_insert (priv->hash, (gpointer) priv->names[row],
+                                     GUINT_TO_POINTER (row + 1));
+        }
+        --priv->num_rows;
 
-        gtk_list_store_remove (self->priv->store, &iter);
+        path = gtk_tree_path_new_from_indices (position, -1);
+        gtk_tree_model_row_deleted (GTK_TREE_MODEL (self), path);
+        gtk_tree_path_free (path);
 
-        (void) g_hash_table_remove (self->priv->hash, name);
+        gibbon_player_list_collect_garbage (self);
 }
 
 gchar *
 gibbon_player_list_get_opponent (const GibbonPlayerList *self,
                                  const gchar *name)
 {
-        struct GibbonPlayer *player = g_hash_table_lookup (self->priv->hash,
-                                                           name);
-        GtkTreeIter iter;
-        gchar *opponent;
+        gpointer lookup;
+        const gchar *opponent;
 
         g_return_val_if_fail (GIBBON_IS_PLAYER_LIST (self), NULL);
 
-        if (!player)
+        lookup = g_hash_table_lookup (self->priv->hash, name);
+        if (!lookup)
                 return NULL;
 
-        iter = player->iter;
-
-        gtk_tree_model_get (GTK_TREE_MODEL (self->priv->store), &iter,
-                            GIBBON_PLAYER_LIST_COL_OPPONENT, &opponent,
-                            -1);
-
-        if (!*opponent) {
-                g_free (opponent);
+        opponent = self->priv->opponents[GPOINTER_TO_UINT (lookup) - 1];
+        if (!opponent || !*opponent)
                 return NULL;
-        }
-        return opponent;
+
+        return g_strdup (opponent);
 }
 
 gboolean
 gibbon_player_list_get_available (const GibbonPlayerList *self,
                                   const gchar *name)
 {
-        struct GibbonPlayer *player;
-        GtkTreeIter iter;
-        gchar *status;
-        gboolean available;
+        gpointer lookup;
 
         g_return_val_if_fail (GIBBON_IS_PLAYER_LIST (self), FALSE);
 
-        player = g_hash_table_lookup (self->priv->hash, name);
-        if (!player)
+        lookup = g_hash_table_lookup (self->priv->hash, name);
+        if (!lookup)
                 return FALSE;
 
-        iter = player->iter;
-
-        gtk_tree_model_get (GTK_TREE_MODEL (self->priv->store), &iter,
-                            GIBBON_PLAYER_LIST_COL_AVAILABLE, &status,
-                            -1);
-
-        if (g_strcmp0 ("gtk-yes", status))
-                available = FALSE;
-        else
-                available = TRUE;
+        if (self->priv->flags[GPOINTER_TO_UINT (lookup) - 1]
+            & GIBBON_PLAYER_LIST_AVAILABLE)
+                return TRUE;
 
-        return available;
-}
-
-GtkListStore *
-gibbon_player_list_get_store (GibbonPlayerList *self)
-{
-        g_return_val_if_fail (GIBBON_IS_PLAYER_LIST (self), NULL);
-
-        return self->priv->store;
+        return FALSE;
 }
 
 gboolean
 gibbon_player_list_get_iter (GibbonPlayerList *self, const gchar *name,
                              GtkTreeIter *iter)
 {
-        struct GibbonPlayer *player;
+        gpointer lookup;
 
         g_return_val_if_fail (GIBBON_IS_PLAYER_LIST (self), FALSE);
 
-        player = g_hash_table_lookup (self->priv->hash, name);
-        if (!player)
+        lookup = g_hash_table_lookup (self->priv->hash, name);
+        if (!lookup)
                 return FALSE;
 
-        *iter = player->iter;
+        iter->stamp = self->priv->stamp;
+        iter->user_data = GUINT_TO_POINTER (GPOINTER_TO_UINT (lookup) - 1);
 
         return TRUE;
 }
@@ -417,34 +591,35 @@ gibbon_player_list_update_country (GibbonPlayerList *self,
                                    const gchar *hostname,
                                    const GibbonCountry *country)
 {
-        GtkTreeIter iter;
-        gboolean valid;
-        gchar *stored_hostname;
+        guint8 index;
+        guint row;
+        gboolean changed = FALSE;
 
         g_return_if_fail (GIBBON_IS_PLAYER_LIST (self));
         g_return_if_fail (hostname != NULL);
         g_return_if_fail (GIBBON_IS_COUNTRY (country));
 
-        valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (self->priv->store),
-                                               &iter);
-        while (valid) {
-                gtk_tree_model_get (GTK_TREE_MODEL (self->priv->store), &iter,
-                                    GIBBON_PLAYER_LIST_COL_HOSTNAME,
-                                    &stored_hostname,
-                                    -1);
-
-                if (0 == g_strcmp0 (hostname, stored_hostname)) {
-                        gtk_list_store_set (self->priv->store,
-                                            &iter,
-                                            GIBBON_PLAYER_LIST_COL_COUNTRY,
-                                            country,
-                                            GIBBON_PLAYER_LIST_COL_COUNTRY_ICON,
-                                            gibbon_country_get_pixbuf (country),
-                                            -1);
-                }
-                valid = gtk_tree_model_iter_next (
-                                GTK_TREE_MODEL (self->priv->store),
-                                &iter);
+        index = gibbon_player_list_country_index (self, country);
+
+        for (row = 0; row < self->priv->num_rows; ++row) {
+                if (self->priv->countries[row] == index
+                    || g_strcmp0 (hostname, self->priv->hostnames[row]))
+                        continue;
+                self->priv->countries[row] = index;
+                changed = TRUE;
+        }
+
+        if (!changed)
+                return;
+
+        if (self->priv->sort_column == GIBBON_PLAYER_LIST_COL_COUNTRY
+            && !self->priv->update_depth)
+                gibbon_player_list_sort (self);
+
+        for (row = 0; row < self->priv->num_rows; ++row) {
+                if (self->priv->countries[row] == index
+                    && !g_strcmp0 (hostname, self->priv->hostnames[row]))
+                        gibbon_player_list_row_changed (self, row);
         }
 }
 
@@ -452,8 +627,8 @@ void
 gibbon_player_list_update_has_saved (GibbonPlayerList *self, const gchar *who,
                                      gboolean has_saved)
 {
-        GtkTreeIter iter;
-        gint weight;
+        gpointer lookup;
+        guint row;
 
         g_return_if_fail (GIBBON_IS_PLAYER_LIST (self));
         g_return_if_fail (who != NULL);
@@ -461,105 +636,305 @@ gibbon_player_list_update_has_saved (GibbonPlayerList *self, const gchar *who,
         /*
          * Silently fail, if player is not known.
          */
-        if (!gibbon_player_list_get_iter (self, who, &iter))
+        lookup = g_hash_table_lookup (self->priv->hash, who);
+        if (!lookup)
                 return;
 
-        weight = has_saved ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL;
-        gtk_list_store_set (self->priv->store, &iter,
-                            GIBBON_PLAYER_LIST_COL_NAME_WEIGHT, weight,
-                           -1);
+        row = GPOINTER_TO_UINT (lookup) - 1;
+        if (has_saved)
+                self->priv->flags[row] |= GIBBON_PLAYER_LIST_HAS_SAVED;
+        else
+                self->priv->flags[row] &= ~GIBBON_PLAYER_LIST_HAS_SAVED;
+
+        gibbon_player_list_row_changed (self, row);
 }
 
-gint
-gibbon_player_list_compare_status (GtkTreeModel *model,
-                                   GtkTreeIter *a, GtkTreeIter *b,
-                                   gpointer user_data)
+static const gchar *
+gibbon_player_list_intern (GibbonPlayerList *self, const gchar *string)
 {
-        gchar *str_a = NULL;
-        gchar *str_b = NULL;
-        guint key_a, key_b;
+        if (!string)
+                return NULL;
 
-        gint result;
+        return g_string_chunk_insert_const (self->priv->strings, string);
+}
 
-        gint col = GPOINTER_TO_INT (user_data);
+static const gchar *
+gibbon_player_list_intern_key (GibbonPlayerList *self, const gchar *string)
+{
+        gchar *key = g_utf8_collate_key (string ? string : "", -1);
+        const gchar *interned;
 
-        gtk_tree_model_get (model, a, col, &str_a, -1);
-        if (!g_strcmp0 (str_a, GTK_STOCK_YES))
-                key_a = 2;
-        else if (!g_strcmp0 (str_a, GTK_STOCK_NO))
-                key_a = 1;
-        else
-                key_a = 0;
+        interned = g_string_chunk_insert_const (self->priv->strings, key);
+        g_free (key);
+
+        return interned;
+}
 
-        gtk_tree_model_get (model, b, col, &str_b, -1);
-        if (!g_strcmp0 (str_b, GTK_STOCK_YES))
-                key_b = 2;
-        else if (!g_strcmp0 (str_b, GTK_STOCK_NO))
-                key_b = 1;
+/*
+ * The string chunk cannot free single strings.  We only keep track of
+ * the space that is referenced by the table, and of the space that could
+ * be reclaimed.  Both are overestimated for strings that are shared by
+ * several rows, for example common client names.
+ */
+static void
+gibbon_player_list_store (GibbonPlayerList *self, const gchar **slot,
+                          const gchar *interned)
+{
+        if (interned == *slot)
+                return;
+
+        gibbon_player_list_release (self, *slot);
+        if (interned)
+                self->priv->live_bytes += strlen (interned) + 1;
+        *slot = interned;
+}
+
+static void
+gibbon_player_list_release (GibbonPlayerList *self, const gchar *string)
+{
+        gsize length;
+
+        if (!string)
+                return;
+
+        length = strlen (string) + 1;
+        self->priv->dead_bytes += length;
+        if (self->priv->live_bytes >= length)
+                self->priv->live_bytes -= length;
         else
-                key_b = 0;
+                self->priv->live_bytes = 0;
+}
 
-        result = key_a - key_b;
+static void
+gibbon_player_list_release_row (GibbonPlayerList *self, guint row)
+{
+        GibbonPlayerListPrivate *priv = self->priv;
+
+        gibbon_player_list_release (self, priv->names[row]);
+        gibbon_player_list_release (self, priv->name_keys[row]);
+        gibbon_player_list_release (self, priv->opponents[row]);
+        gibbon_player_list_release (self, priv->watching[row]);
+        gibbon_player_list_release (self, priv->clients[row]);
+        gibbon_player_list_release (self, priv->client_keys[row]);
+        gibbon_player_list_release (self, priv->hostnames[row]);
+        gibbon_player_list_release (self, priv->emails[row]);
+}
 
-        g_free (str_a);
-        g_free (str_b);
+/*
+ * Copies the strings of all rows into a new chunk and frees the old one.
+ * This is linear in the size of the table, but the garbage must have
+ * grown at least as big as the live data since the last run.
+ */
+static void
+gibbon_player_list_collect_garbage (GibbonPlayerList *self)
+{
+        GibbonPlayerListPrivate *priv = self->priv;
+        GStringChunk *old;
+        guint row;
+
+        if (priv->dead_bytes < GIBBON_PLAYER_LIST_MIN_GARBAGE
+            || priv->dead_bytes < priv->live_bytes)
+                return;
 
-        return result;
+        old = priv->strings;
+        priv->strings = g_string_chunk_new (4096);
+        priv->live_bytes = 0;
+        priv->dead_bytes = 0;
+
+        /* The hash table keys point into the old chunk.  */
+        g_hash_table_remove_all (priv->hash);
+
+        for (row = 0; row < priv->num_rows; ++row) {
+                gibbon_player_list_move_string (self, &priv->names[row]);
+                gibbon_player_list_move_string (self, &priv->name_keys[row]);
+                gibbon_player_list_move_string (self, &priv->opponents[row]);
+                gibbon_player_list_move_string (self, &priv->watching[row]);
+                gibbon_player_list_move_string (self, &priv->clients[row]);
+                gibbon_player_list_move_string (self, &priv->client_keys[row]);
+                gibbon_player_list_move_string (self, &priv->hostnames[row]);
+                gibbon_player_list_move_string (self, &priv->emails[row]);
+                g_hash_table_insert (priv->hash, (gpointer) priv->names[row],
+                                     GUINT_TO_POINTER (row + 1));
+        }
+
+        g_string_chunk_free (old);
 }
 
-gint
-gibbon_player_list_compare_country (GtkTreeModel *model,
-                                   GtkTreeIter *a, GtkTreeIter *b,
-                                   gpointer user_data)
+static void
+gibbon_player_list_move_string (GibbonPlayerList *self, const gchar **slot)
 {
-        GibbonCountry *country_a = NULL;
-        GibbonCountry *country_b = NULL;
-        const gchar *str_a;
-        const gchar *str_b;
-        gchar *key_a;
-        gchar *key_b;
+        if (!*slot)
+                return;
 
-        gint result;
+        *slot = g_string_chunk_insert_const (self->priv->strings, *slot);
+        self->priv->live_bytes += strlen (*slot) + 1;
+}
 
-        gint col = GPOINTER_TO_INT (user_data);
+static guint8
+gibbon_player_list_country_index (GibbonPlayerList *self,
+                                  const GibbonCountry *country)
+{
+        const gchar *alpha2;
+        gpointer lookup;
+        guint index;
 
-        gtk_tree_model_get (model, a, col, &country_a, -1);
-        str_a = gibbon_country_get_name (country_a);
-        key_a = g_utf8_collate_key (str_a, -1);
+        if (!country)
+                return 0;
 
-        gtk_tree_model_get (model, b, col, &country_b, -1);
-        str_b = gibbon_country_get_name (country_b);
-        key_b = g_utf8_collate_key (str_b, -1);
+        /*
+         * The archive creates a new country object for every lookup.  The
+         * table therefore holds one instance per country code.
+         */
+        alpha2 = gibbon_country_get_alpha2 (country);
+        lookup = g_hash_table_lookup (self->priv->country_index, alpha2);
+        if (lookup)
+                return GPOINTER_TO_UINT (lookup);
+
+        index = self->priv->country_table->len;
+        g_return_val_if_fail (index <= G_MAXUINT8, 0);
+
+        g_ptr_array_add (self->priv->country_table,
+                         g_object_ref ((gpointer) country));
+        g_ptr_array_add (self->priv->country_keys,
+                         g_utf8_collate_key (gibbon_country_get_name (country),
+                                             -1));
+        g_hash_table_insert (self->priv->country_index, g_strdup (alpha2),
+                             GUINT_TO_POINTER (index));
+
+        return index;
+}
 
-        result = g_strcmp0 (key_a, key_b);
+static void
+gibbon_player_list_grow (GibbonPlayerList *self)
+{
+        GibbonPlayerListPrivate *priv = self->priv;
+        guint n = priv->allocated ? priv->allocated << 1 : 256;
+
+        priv->names = g_renew (const gchar *, priv->names, n);
+        priv->name_keys = g_renew (const gchar *, priv->name_keys, n);
+        priv->opponents = g_renew (const gchar *, priv->opponents, n);
+        priv->watching = g_renew (const gchar *, priv->watching, n);
+        priv->clients = g_renew (const gchar *, priv->clients, n);
+        priv->client_keys = g_renew (const gchar *, priv->client_keys, n);
+        priv->hostnames = g_renew (const gchar *, priv->hostnames, n);
+        priv->emails = g_renew (const gchar *, priv->emails, n);
+        priv->ratings = g_renew (gfloat, priv->ratings, n);
+        priv->experiences = g_renew (guint64, priv->experiences, n);
+        priv->reliabilities = g_renew (gfloat, priv->reliabilities, n);
+        priv->confidences = g_renew (guint, priv->confidences, n);
+        priv->flags = g_renew (guint8, priv->flags, n);
+        priv->client_types = g_renew (guint8, priv->client_types, n);
+        priv->countries = g_renew (guint8, priv->countries, n);
+        priv->order = g_renew (guint, priv->order, n);
+        priv->positions = g_renew (guint, priv->positions, n);
+
+        priv->allocated = n;
+}
 
-        g_object_unref (country_a);
-        g_object_unref (country_b);
-        g_free (key_a);
-        g_free (key_b);
+static void
+gibbon_player_list_copy_row (GibbonPlayerList *self, guint from, guint to)
+{
+        GibbonPlayerListPrivate *priv = self->priv;
+
+        priv->names[to] = priv->names[from];
+        priv->name_keys[to] = priv->name_keys[from];
+        priv->opponents[to] = priv->opponents[from];
+        priv->watching[to] = priv->watching[from];
+        priv->clients[to] = priv->clients[from];
+        priv->client_keys[to] = priv->client_keys[from];
+        priv->hostnames[to] = priv->hostnames[from];
+        priv->emails[to] = priv->emails[from];
+        priv->ratings[to] = priv->ratings[from];
+        priv->experiences[to] = priv->experiences[from];
+        priv->reliabilities[to] = priv->reliabilities[from];
+        priv->confidences[to] = priv->confidences[from];
+        priv->flags[to] = priv->flags[from];
+        priv->client_types[to] = priv->client_types[from];
+        priv->countries[to] = priv->countries[from];
+}
 
-        return result;
+static gint
+gibbon_player_list_status_key (const GibbonPlayerList *self, guint row)
+{
+        if (self->priv->flags[row] & GIBBON_PLAYER_LIST_AVAILABLE)
+                return 2;
+        else if (self->priv->flags[row] & GIBBON_PLAYER_LIST_PLAYING)
+                return 1;
+        else
+                return 0;
 }
 
-gint
-gibbon_player_list_compare_reliability (GtkTreeModel *model,
-                                        GtkTreeIter *a, GtkTreeIter *b,
-                                        gpointer user_data)
+/*
+ * Names are unique.  Using them for breaking ties makes the order total,
+ * and the position of a row can be found with a binary search.
+ */
+static gint
+gibbon_player_list_compare (const GibbonPlayerList *self, guint a, guint b)
+{
+        const GibbonPlayerListPrivate *priv = self->priv;
+        gint result = 0;
+
+        switch (priv->sort_column) {
+        case GIBBON_PLAYER_LIST_COL_AVAILABLE:
+                result = gibbon_player_list_status_key (self, a)
+                         - gibbon_player_list_status_key (self, b);
+                break;
+        case GIBBON_PLAYER_LIST_COL_RATING:
+                if (priv->ratings[a] < priv->ratings[b])
+                        result = -1;
+                else if (priv->ratings[a] > priv->ratings[b])
+                        result = +1;
+                break;
+        case GIBBON_PLAYER_LIST_COL_EXPERIENCE:
+                if (priv->experiences[a] < priv->experiences[b])
+                        result = -1;
+                else if (priv->experiences[a] > priv->experiences[b])
+                        result = +1;
+                break;
+        case GIBBON_PLAYER_LIST_COL_CLIENT:
+                result = g_ascii_strcasecmp (priv->client_keys[a],
+                                             priv->client_keys[b]);
+                break;
+        case GIBBON_PLAYER_LIST_COL_RELIABILITY:
+                result = gibbon_player_list_compare_reliability (self, a, b);
+                break;
+        case GIBBON_PLAYER_LIST_COL_COUNTRY:
+                result = g_strcmp0 (g_ptr_array_index (priv->country_keys,
+                                                       priv->countries[a]),
+                                    g_ptr_array_index (priv->country_keys,
+                                                       priv->countries[b]));
+                break;
+        }
+
+        if (!result)
+                result = g_ascii_strcasecmp (priv->name_keys[a],
+                                             priv->name_keys[b]);
+        if (!result)
+                result = strcmp (priv->names[a], priv->names[b]);
+
+        return priv->sort_order == GTK_SORT_DESCENDING ? -result : result;
+}
+
+static gint
+gibbon_player_list_compare_rows (gconstpointer a, gconstpointer b,
+                                 gpointer self)
+{
+        return gibbon_player_list_compare (GIBBON_PLAYER_LIST (self),
+                                           *((const guint *) a),
+                                           *((const guint *) b));
+}
+
+static gint
+gibbon_player_list_compare_reliability (const GibbonPlayerList *self,
+                                        guint a, guint b)
 {
-        GibbonReliability *rel_a = NULL;
-        GibbonReliability *rel_b = NULL;
         gdouble value_a, value_b;
         guint grouping_a, grouping_b;
         guint confidence_a, confidence_b;
         gint factor_a = -1;
         gint factor_b = -1;
 
-        gint result;
-
-        gint col = GPOINTER_TO_INT (user_data);
-
-        gtk_tree_model_get (model, a, col, &rel_a, -1);
-        value_a = rel_a->value;
+        value_a = self->priv->reliabilities[a];
         if (value_a >= 0.95) {
                 grouping_a = 3;
                 factor_a = +1;
@@ -569,10 +944,9 @@ gibbon_player_list_compare_reliability (GtkTreeModel *model,
                 grouping_a = 1;
         else
                 grouping_a = 0;
-        confidence_a = factor_a * rel_a->confidence;
+        confidence_a = factor_a * self->priv->confidences[a];
 
-        gtk_tree_model_get (model, b, col, &rel_b, -1);
-        value_b = rel_b->value;
+        value_b = self->priv->reliabilities[b];
         if (value_b >= 0.95) {
                 grouping_b = 3;
                 factor_b = +1;
@@ -582,29 +956,449 @@ gibbon_player_list_compare_reliability (GtkTreeModel *model,
                 grouping_b = 1;
         else
                 grouping_b = 0;
-        confidence_b = factor_b * rel_b->confidence;
+        confidence_b = factor_b * self->priv->confidences[b];
 
         if (grouping_a < grouping_b)
-                result = -1;
+                return -1;
         else if (grouping_a > grouping_b)
-                result = +1;
+                return +1;
         else if (!confidence_a && confidence_b && grouping_b < 3)
-                result = +1;
+                return +1;
         else if (!confidence_a && confidence_b)
-                result = -1;
+                return -1;
         else if (!confidence_b && confidence_a && grouping_a < 3)
-                result = -1;
+                return -1;
         else if (!confidence_b && confidence_a)
-                result = +1;
+                return +1;
         else if (confidence_a < confidence_b)
-                result = -1;
+                return -1;
         else if (confidence_a > confidence_b)
-                result = +1;
+                return +1;
         else
-                result = 0;
+                return 0;
+}
+
+/*
+ * Find the position for a row that is not yet part of the permutation.
+ * While updates are pending, rows are simply appended.
+ */
+static guint
+gibbon_player_list_find_position (const GibbonPlayerList *self, guint row,
+                                  guint n)
+{
+        guint low = 0;
+        guint high = n;
+        guint mid;
+
+        if (self->priv->sort_column < 0 || self->priv->update_depth)
+                return n;
+
+        while (low < high) {
+                mid = low + ((high - low) >> 1);
+                if (gibbon_player_list_compare (self, self->priv->order[mid],
+                                                row) < 0)
+                        low = mid + 1;
+                else
+                        high = mid;
+        }
+
+        return low;
+}
+
+static void
+gibbon_player_list_insert_position (GibbonPlayerList *self, guint row,
+                                    guint position, guint n)
+{
+        guint *order = self->priv->order;
+        guint i;
+
+        memmove (order + position + 1, order + position,
+                 (n - position) * sizeof *order);
+        order[position] = row;
+
+        for (i = position; i <= n; ++i)
+                self->priv->positions[order[i]] = i;
+}
+
+static void
+gibbon_player_list_remove_position (GibbonPlayerList *self, guint position,
+                                    guint n)
+{
+        guint *order = self->priv->order;
+        guint i;
+
+        memmove (order + position, order + position + 1,
+                 (n - position - 1) * sizeof *order);
+
+        for (i = position; i < n - 1; ++i)
+                self->priv->positions[order[i]] = i;
+}
+
+/*
+ * Move a changed row to its new position.  Only the rows in between
+ * have to be shifted.
+ */
+static void
+gibbon_player_list_reposition (GibbonPlayerList *self, guint row)
+{
+        GibbonPlayerListPrivate *priv = self->priv;
+        guint n = priv->num_rows;
+        guint from = priv->positions[row];
+        guint to;
+        gint *new_order;
+        guint i;
+        GtkTreePath *path;
+
+        if (priv->sort_column < 0 || priv->update_depth)
+                return;
+
+        if ((from == 0
+             || gibbon_player_list_compare (self, priv->order[from - 1],
+                                            row) < 0)
+            && (from + 1 == n
+                || gibbon_player_list_compare (self, row,
+                                               priv->order[from + 1]) < 0))
+                return;
+
+        gibbon_player_list_remove_position (self, from, n);
+        to = gibbon_player_list_find_position (self, row, n - 1);
+        gibbon_player_list_insert_position (self, row, to, n - 1);
+
+        new_order = g_new (gint, n);
+        for (i = 0; i < n; ++i) {
+                if (i == to)
+                        new_order[i] = from;
+                else if (to < from && i > to && i <= from)
+                        new_order[i] = i - 1;
+                else if (to > from && i >= from && i < to)
+                        new_order[i] = i + 1;
+                else
+                        new_order[i] = i;
+        }
+
+        path = gtk_tree_path_new ();
+        gtk_tree_model_rows_reordered (GTK_TREE_MODEL (self), path, NULL,
+                                       new_order);
+        gtk_tree_path_free (path);
+        g_free (new_order);
+}
+
+static void
+gibbon_player_list_sort (GibbonPlayerList *self)
+{
+        GibbonPlayerListPrivate *priv = self->priv;
+        guint n = priv->num_rows;
+        gint *new_order;
+        gboolean changed = FALSE;
+        guint i;
+        GtkTreePath *path;
+
+        if (priv->sort_column < 0 || n < 2)
+                return;
+
+        g_qsort_with_data (priv->order, n, sizeof *priv->order,
+                           gibbon_player_list_compare_rows, self);
+
+        new_order = g_new (gint, n);
+        for (i = 0; i < n; ++i) {
+                new_order[i] = priv->positions[priv->order[i]];
+                if ((guint) new_order[i] != i)
+                        changed = TRUE;
+                priv->positions[priv->order[i]] = i;
+        }
+
+        if (changed) {
+                path = gtk_tree_path_new ();
+                gtk_tree_model_rows_reordered (GTK_TREE_MODEL (self), path,
+                                               NULL, new_order);
+                gtk_tree_path_free (path);
+        }
+
+        g_free (new_order);
+}
+
+static void
+gibbon_player_list_row_changed (GibbonPlayerList *self, guint row)
+{
+        GtkTreePath *path;
+        GtkTreeIter iter;
+
+        iter.stamp = self->priv->stamp;
+        iter.user_data = GUINT_TO_POINTER (row);
+        path = gtk_tree_path_new_from_indices (self->priv->positions[row], -1);
+        gtk_tree_model_row_changed (GTK_TREE_MODEL (self), path, &iter);
+        gtk_tree_path_free (path);
+}
+
+static GtkTreeModelFlags
+gibbon_player_list_get_flags (GtkTreeModel *model)
+{
+        return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+gibbon_player_list_get_n_columns (GtkTreeModel *model)
+{
+        return GIBBON_PLAYER_LIST_N_COLUMNS;
+}
+
+static GType
+gibbon_player_list_get_column_type (GtkTreeModel *model, gint column)
+{
+        g_return_val_if_fail (column >= 0, G_TYPE_INVALID);
+        g_return_val_if_fail (column < GIBBON_PLAYER_LIST_N_COLUMNS,
+                              G_TYPE_INVALID);
+
+        return gibbon_player_list_column_types[column];
+}
+
+static gboolean
+gibbon_player_list_get_tree_iter (GtkTreeModel *model, GtkTreeIter *iter,
+                                  GtkTreePath *path)
+{
+        GibbonPlayerList *self = GIBBON_PLAYER_LIST (model);
+        gint position;
+
+        g_return_val_if_fail (gtk_tree_path_get_depth (path) > 0, FALSE);
+
+        position = gtk_tree_path_get_indices (path)[0];
+        if (position < 0 || (guint) position >= self->priv->num_rows)
+                return FALSE;
+
+        iter->stamp = self->priv->stamp;
+        iter->user_data = GUINT_TO_POINTER (self->priv->order[position]);
+
+        return TRUE;
+}
+
+static GtkTreePath *
+gibbon_player_list_get_path (GtkTreeModel *model, GtkTreeIter *iter)
+{
+        GibbonPlayerList *self = GIBBON_PLAYER_LIST (model);
+        guint row = GPOINTER_TO_UINT (iter->user_data);
+
+        g_return_val_if_fail (iter->stamp == self->priv->stamp, NULL);
+
+        return gtk_tree_path_new_from_indices (self->priv->positions[row], -1);
+}
+
+static void
+gibbon_player_list_get_value (GtkTreeModel *model, GtkTreeIter *iter,
+                              gint column, GValue *value)
+{
+        GibbonPlayerList *self = GIBBON_PLAYER_LIST (model);
+        GibbonPlayerListPrivate *priv = self->priv;
+        guint row = GPOINTER_TO_UINT (iter->user_data);
+        const GibbonCountry *country;
+        const gchar *stock_id;
+        GibbonClientIcons *client_icons;
+        GibbonReliability rel;
+
+        g_return_if_fail (iter->stamp == priv->stamp);
+        g_return_if_fail (column >= 0 && column < GIBBON_PLAYER_LIST_N_COLUMNS);
+
+        g_value_init (value, gibbon_player_list_column_types[column]);
+
+        switch (column) {
+        case GIBBON_PLAYER_LIST_COL_NAME:
+                g_value_set_static_string (value, priv->names[row]);
+                break;
+        case GIBBON_PLAYER_LIST_COL_NAME_WEIGHT:
+                if (priv->flags[row] & GIBBON_PLAYER_LIST_HAS_SAVED)
+                        g_value_set_int (value, PANGO_WEIGHT_BOLD);
+                else
+                        g_value_set_int (value, PANGO_WEIGHT_NORMAL);
+                break;
+        case GIBBON_PLAYER_LIST_COL_AVAILABLE:
+                switch (gibbon_player_list_status_key (self, row)) {
+                case 2:
+                        stock_id = GTK_STOCK_YES;
+                        break;
+                case 1:
+                        stock_id = GTK_STOCK_NO;
+                        break;
+                default:
+                        stock_id = GTK_STOCK_STOP;
+                        break;
+                }
+                g_value_set_static_string (value, stock_id);
+                break;
+        case GIBBON_PLAYER_LIST_COL_RATING:
+                g_value_set_double (value, priv->ratings[row]);
+                break;
+        case GIBBON_PLAYER_LIST_COL_EXPERIENCE:
+                g_value_set_uint64 (value, priv->experiences[row]);
+                break;
+        case GIBBON_PLAYER_LIST_COL_CLIENT:
+                g_value_set_static_string (value, priv->clients[row]);
+                break;
+        case GIBBON_PLAYER_LIST_COL_CLIENT_ICON:
+                client_icons = gibbon_app_get_client_icons (app);
+                g_value_set_object (value,
+                                    gibbon_client_icons_get_icon (
+                                            client_icons,
+                                            priv->client_types[row]));
+                break;
+        case GIBBON_PLAYER_LIST_COL_RELIABILITY:
+                rel.value = priv->reliabilities[row];
+                rel.confidence = priv->confidences[row];
+                g_value_set_boxed (value, &rel);
+                break;
+        case GIBBON_PLAYER_LIST_COL_OPPONENT:
+                g_value_set_static_string (value, priv->opponents[row]);
+                break;
+        case GIBBON_PLAYER_LIST_COL_WATCHING:
+                g_value_set_static_string (value, priv->watching[row]);
+                break;
+        case GIBBON_PLAYER_LIST_COL_HOSTNAME:
+                g_value_set_static_string (value, priv->hostnames[row]);
+                break;
+        case GIBBON_PLAYER_LIST_COL_COUNTRY:
+                country = g_ptr_array_index (priv->country_table,
+                                             priv->countries[row]);
+                g_value_set_object (value, (gpointer) country);
+                break;
+        case GIBBON_PLAYER_LIST_COL_COUNTRY_ICON:
+                country = g_ptr_array_index (priv->country_table,
+                                             priv->countries[row]);
+                if (country)
+                        g_value_set_object (value,
+                                            (gpointer)
+                                            gibbon_country_get_pixbuf (
+                                                    country));
+                break;
+        case GIBBON_PLAYER_LIST_COL_EMAIL:
+                g_value_set_static_string (value, priv->emails[row]);
+                break;
+        }
+}
 
-        gibbon_reliability_free (rel_a);
-        gibbon_reliability_free (rel_b);
+static gboolean
+gibbon_player_list_iter_next (GtkTreeModel *model, GtkTreeIter *iter)
+{
+        GibbonPlayerList *self = GIBBON_PLAYER_LIST (model);
+        guint row = GPOINTER_TO_UINT (iter->user_data);
+        guint position;
+
+        g_return_val_if_fail (iter->stamp == self->priv->stamp, FALSE);
+
+        position = self->priv->positions[row] + 1;
+        if (position >= self->priv->num_rows) {
+                iter->stamp = 0;
+                return FALSE;
+        }
+
+        iter->user_data = GUINT_TO_POINTER (self->priv->order[position]);
+
+        return TRUE;
+}
 
-        return result;
+static gboolean
+gibbon_player_list_iter_nth_child (GtkTreeModel *model, GtkTreeIter *iter,
+                                   GtkTreeIter *parent, gint n)
+{
+        GibbonPlayerList *self = GIBBON_PLAYER_LIST (model);
+
+        if (parent || n < 0 || (guint) n >= self->priv->num_rows)
+                return FALSE;
+
+        iter->stamp = self->priv->stamp;
+        iter->user_data = GUINT_TO_POINTER (self->priv->order[n]);
+
+        return TRUE;
+}
+
+static gboolean
+gibbon_player_list_iter_children (GtkTreeModel *model, GtkTreeIter *iter,
+                                  GtkTreeIter *parent)
+{
+        return gibbon_player_list_iter_nth_child (model, iter, parent, 0);
+}
+
+static gboolean
+gibbon_player_list_iter_has_child (GtkTreeModel *model, GtkTreeIter *iter)
+{
+        return FALSE;
+}
+
+static gint
+gibbon_player_list_iter_n_children (GtkTreeModel *model, GtkTreeIter *iter)
+{
+        if (iter)
+                return 0;
+
+        return GIBBON_PLAYER_LIST (model)->priv->num_rows;
+}
+
+static gboolean
+gibbon_player_list_iter_parent (GtkTreeModel *model, GtkTreeIter *iter,
+                                GtkTreeIter *child)
+{
+        return FALSE;
+}
+
+static void
+gibbon_player_list_tree_model_init (GtkTreeModelIface *iface)
+{
+        iface->get_flags = gibbon_player_list_get_flags;
+        iface->get_n_columns = gibbon_player_list_get_n_columns;
+        iface->get_column_type = gibbon_player_list_get_column_type;
+        iface->get_iter = gibbon_player_list_get_tree_iter;
+        iface->get_path = gibbon_player_list_get_path;
+        iface->get_value = gibbon_player_list_get_value;
+        iface->iter_next = gibbon_player_list_iter_next;
+        iface->iter_children = gibbon_player_list_iter_children;
+        iface->iter_has_child = gibbon_player_list_iter_has_child;
+        iface->iter_n_children = gibbon_player_list_iter_n_children;
+        iface->iter_nth_child = gibbon_player_list_iter_nth_child;
+        iface->iter_parent = gibbon_player_list_iter_parent;
+}
+
+static gboolean
+gibbon_player_list_get_sort_column_id (GtkTreeSortable *sortable,
+                                       gint *sort_column_id,
+                                       GtkSortType *order)
+{
+        GibbonPlayerList *self = GIBBON_PLAYER_LIST (sortable);
+
+        if (sort_column_id)
+                *sort_column_id = self->priv->sort_column;
+        if (order)
+                *order = self->priv->sort_order;
+
+        return self->priv->sort_column >= 0;
+}
+
+static void
+gibbon_player_list_set_sort_column_id (GtkTreeSortable *sortable,
+                                       gint sort_column_id,
+                                       GtkSortType order)
+{
+        GibbonPlayerList *self = GIBBON_PLAYER_LIST (sortable);
+
+        if (self->priv->sort_column == sort_column_id
+            && self->priv->sort_order == order)
+                return;
+
+        self->priv->sort_column = sort_column_id;
+        self->priv->sort_order = order;
+
+        gtk_tree_sortable_sort_column_changed (sortable);
+
+        if (!self->priv->update_depth)
+                gibbon_player_list_sort (self);
+}
+
+static gboolean
+gibbon_player_list_has_default_sort_func (GtkTreeSortable *sortable)
+{
+        return FALSE;
+}
+
+static void
+gibbon_player_list_tree_sortable_init (GtkTreeSortableIface *iface)
+{
+        iface->get_sort_column_id = gibbon_player_list_get_sort_column_id;
+        iface->set_sort_column_id = gibbon_player_list_set_sort_column_id;
+        iface->has_default_sort_func = gibbon_player_list_has_default_sort_func;
 }
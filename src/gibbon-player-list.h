@@ -79,23 +79,24 @@ void gibbon_player_list_set (GibbonPlayerList *self,
                              gboolean has_saved,
                              gboolean available,
                              gdouble rating,
-                             guint experience,
+                             guint64 experience,
                              gdouble reliability,
                              guint confidence,
                              const gchar *opponent,
                              const gchar *watching,
                              const gchar *client,
-                             const GdkPixbuf *client_icon,
+                             enum GibbonClientType client_type,
                              const gchar *hostname,
                              const GibbonCountry *country,
                              const gchar *email);
+void gibbon_player_list_begin_update (GibbonPlayerList *self);
+void gibbon_player_list_end_update (GibbonPlayerList *self);
 gboolean gibbon_player_list_exists (const GibbonPlayerList *self,
                                     const gchar *player_name);
 gchar *gibbon_player_list_get_opponent (const GibbonPlayerList *self,
                                         const gchar *player_name);
 gboolean gibbon_player_list_get_available (const GibbonPlayerList *self,
                                            const gchar *player_name);
-GtkListStore *gibbon_player_list_get_store (GibbonPlayerList *self);
 gboolean gibbon_player_list_get_iter (GibbonPlayerList *self,
                                       const gchar *player_name,
                                       GtkTreeIter *iter);
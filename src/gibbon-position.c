@@ -58,6 +58,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <glib.h>
 #include <glib/gi18n.h>
@@ -201,9 +202,32 @@ static gboolean gibbon_position_can_move_checker (const gint board[26],
 static gboolean gibbon_position_can_move2 (gint board[26],
                                            gint die1, gint die2);
 static gint find_backmost_checker (const gint board[26]);
+static gint find_backmost_checker_int8 (const gint8 board[26]);
 static void swap_movements (GibbonMovement *m1, GibbonMovement *m2);
 static void order_movements (GibbonMove *move);
 
+typedef struct _GibbonPositionGenerator GibbonPositionGenerator;
+struct _GibbonPositionGenerator {
+        GArray *plays;
+        guint dice[4];
+        guint num_dice;
+        gboolean is_double;
+
+        guint max_used;
+        guint max_pips;
+
+        /* The play currently under construction.  */
+        GibbonPositionPlay play;
+};
+
+static void gibbon_position_generate (GibbonPositionGenerator *generator,
+                                      const gint8 board[26],
+                                      guint depth, gint start, guint pips);
+static void gibbon_position_record_play (GibbonPositionGenerator *generator,
+                                         const gint8 board[26],
+                                         guint used, guint pips);
+static gint gibbon_position_compare_plays (gconstpointer a, gconstpointer b);
+
 /**
  * gibbon_position_new:
  *
@@ -895,6 +919,18 @@ dump_move (const GibbonMove *move)
 }
 #endif
 
+static gint
+find_backmost_checker_int8 (const gint8 board[26])
+{
+        gint i;
+
+        for (i = 25; i > 0; --i)
+                if (board[i] > 0)
+                        return i;
+
+        return 0;
+}
+
 static gint
 find_backmost_checker (const gint board[26])
 {
@@ -932,6 +968,221 @@ order_movements (GibbonMove *move)
         }
 }
 
+/**
+ * gibbon_position_normalize:
+ * @self: The #GibbonPosition.
+ * @side: The side on move.
+ * @board: Location to store the normalized board.
+ *
+ * Fills @board with the checker distribution of @self, seen from @side.
+ * See #GibbonPositionPlay for a description of the layout.
+ */
+void
+gibbon_position_normalize (const GibbonPosition *self, GibbonPositionSide side,
+                           gint8 board[26])
+{
+        gint i;
+
+        g_return_if_fail (self != NULL);
+        g_return_if_fail (side != GIBBON_POSITION_SIDE_NONE);
+
+        if (side > 0) {
+                board[0] = self->bar[1];
+                for (i = 0; i < 24; ++i)
+                        board[i + 1] = self->points[i];
+                board[25] = self->bar[0];
+        } else {
+                board[0] = self->bar[0];
+                for (i = 0; i < 24; ++i)
+                        board[i + 1] = -self->points[23 - i];
+                board[25] = self->bar[1];
+        }
+}
+
+/**
+ * gibbon_position_generate_moves:
+ * @self: The #GibbonPosition.
+ * @side: The side on move.
+ * @die1: The first die.
+ * @die2: The second die.
+ * @plays: A #GArray of #GibbonPositionPlay for the result.
+ *
+ * Generates all legal plays for @side with the roll @die1 and @die2.  Only
+ * plays that use the maximum number of dice are generated, and if only one
+ * die of a non-double can be used, the higher one has to be used if
+ * possible.  Plays that lead to the same position are only reported once.
+ * If no checker can be moved, the result is a single play with no
+ * movements.
+ *
+ * The array is emptied first.  The generator itself does not allocate, so
+ * re-using the same array for many calls is cheap.
+ *
+ * Returns: The number of plays stored in @plays.
+ */
+gsize
+gibbon_position_generate_moves (const GibbonPosition *self,
+                                GibbonPositionSide side,
+                                guint die1, guint die2,
+                                GArray *plays)
+{
+        GibbonPositionGenerator generator;
+        gint8 board[26];
+        GibbonPositionPlay *play, *last;
+        guint i;
+
+        g_return_val_if_fail (self != NULL, 0);
+        g_return_val_if_fail (side != GIBBON_POSITION_SIDE_NONE, 0);
+        g_return_val_if_fail (die1 >= 1 && die1 <= 6, 0);
+        g_return_val_if_fail (die2 >= 1 && die2 <= 6, 0);
+        g_return_val_if_fail (plays != NULL, 0);
+
+        g_array_set_size (plays, 0);
+
+        gibbon_position_normalize (self, side, board);
+
+        memset (&generator, 0, sizeof generator);
+        generator.plays = plays;
+
+        if (die1 == die2) {
+                generator.is_double = TRUE;
+                generator.num_dice = 4;
+                generator.dice[0] = generator.dice[1] = generator.dice[2]
+                        = generator.dice[3] = die1;
+                gibbon_position_generate (&generator, board, 0, 25, 0);
+        } else {
+                generator.num_dice = 2;
+                generator.dice[0] = die1;
+                generator.dice[1] = die2;
+                gibbon_position_generate (&generator, board, 0, 25, 0);
+                generator.dice[0] = die2;
+                generator.dice[1] = die1;
+                gibbon_position_generate (&generator, board, 0, 25, 0);
+        }
+
+        if (plays->len < 2)
+                return plays->len;
+
+        /*
+         * The same position can be reached in different ways.  Sort the
+         * plays by the resulting position and keep the first of each.
+         */
+        g_array_sort (plays, gibbon_position_compare_plays);
+        last = &g_array_index (plays, GibbonPositionPlay, 0);
+        for (i = 1; i < plays->len; ++i) {
+                play = &g_array_index (plays, GibbonPositionPlay, i);
+                if (memcmp (play->board, last->board, sizeof last->board))
+                        *++last = *play;
+        }
+        g_array_set_size (plays,
+                          last - &g_array_index (plays, GibbonPositionPlay, 0)
+                          + 1);
+
+        return plays->len;
+}
+
+/*
+ * Depth-first search over all checker movements.  For doubles, checkers are
+ * only moved in descending order of their starting points, because the
+ * order does not matter and would only produce permutations of the same
+ * play.
+ */
+static void
+gibbon_position_generate (GibbonPositionGenerator *generator,
+                          const gint8 board[26],
+                          guint depth, gint start, guint pips)
+{
+        gint8 child[26];
+        gint from, to, last;
+        gint backmost = -1;
+        guint die;
+        gboolean moved = FALSE;
+
+        if (depth < generator->num_dice) {
+                die = generator->dice[depth];
+
+                if (board[25]) {
+                        start = last = 25;
+                } else {
+                        if (start > 24)
+                                start = 24;
+                        last = 1;
+                }
+
+                for (from = start; from >= last; --from) {
+                        if (board[from] <= 0)
+                                continue;
+
+                        to = from - die;
+                        if (to > 0) {
+                                if (board[to] < -1)
+                                        continue;
+                        } else {
+                                if (backmost < 0)
+                                        backmost = find_backmost_checker_int8 (
+                                                        board);
+                                if (backmost > 6)
+                                        continue;
+                                if (to < 0 && from != backmost)
+                                        continue;
+                                to = 0;
+                        }
+
+                        memcpy (child, board, sizeof child);
+                        --child[from];
+                        if (to) {
+                                if (child[to] == -1) {
+                                        child[to] = 0;
+                                        ++child[0];
+                                }
+                                ++child[to];
+                        }
+
+                        generator->play.movements[depth].from = from;
+                        generator->play.movements[depth].to = to;
+                        generator->play.movements[depth].die = die;
+                        moved = TRUE;
+
+                        gibbon_position_generate (generator, child, depth + 1,
+                                                  generator->is_double
+                                                  ? from : 25,
+                                                  pips + die);
+                }
+
+                if (moved)
+                        return;
+        }
+
+        gibbon_position_record_play (generator, board, depth, pips);
+}
+
+static void
+gibbon_position_record_play (GibbonPositionGenerator *generator,
+                             const gint8 board[26], guint used, guint pips)
+{
+        if (used < generator->max_used)
+                return;
+        if (used == generator->max_used && pips < generator->max_pips)
+                return;
+
+        if (used > generator->max_used || pips > generator->max_pips) {
+                g_array_set_size (generator->plays, 0);
+                generator->max_used = used;
+                generator->max_pips = pips;
+        }
+
+        memcpy (generator->play.board, board, sizeof generator->play.board);
+        generator->play.number = used;
+        g_array_append_val (generator->plays, generator->play);
+}
+
+static gint
+gibbon_position_compare_plays (gconstpointer a, gconstpointer b)
+{
+        return memcmp (((const GibbonPositionPlay *) a)->board,
+                       ((const GibbonPositionPlay *) b)->board,
+                       sizeof ((const GibbonPositionPlay *) a)->board);
+}
+
 gboolean
 gibbon_position_equals_technically (const GibbonPosition *self,
                                     const GibbonPosition *other)
@@ -961,6 +1212,525 @@ gibbon_position_equals_technically (const GibbonPosition *self,
         return TRUE;
 }
 
+static const gchar gibbon_position_base64[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+typedef struct _GibbonPositionZobrist GibbonPositionZobrist;
+struct _GibbonPositionZobrist {
+        /* Indexed by color (white first), slot (points 0-23 and the bar),
+         * and number of checkers.
+         */
+        guint64 checkers[2][25][16];
+        guint64 turn[3];
+        guint64 dice[2][13];
+        guint64 may_double[2];
+        guint64 cube_turned[3];
+
+        /* Salts for the fields that are not tabulated.  */
+        guint64 cube;
+        guint64 match_length;
+        guint64 scores[2];
+        guint64 resigned;
+        guint64 score;
+        guint64 dice_swapped;
+};
+
+static guint64
+gibbon_position_splitmix64 (guint64 *state)
+{
+        guint64 z = (*state += G_GUINT64_CONSTANT (0x9e3779b97f4a7c15));
+
+        z = (z ^ (z >> 30)) * G_GUINT64_CONSTANT (0xbf58476d1ce4e5b9);
+        z = (z ^ (z >> 27)) * G_GUINT64_CONSTANT (0x94d049bb133111eb);
+
+        return z ^ (z >> 31);
+}
+
+static const GibbonPositionZobrist *
+gibbon_position_zobrist (void)
+{
+        static GibbonPositionZobrist zobrist;
+        static gsize initialized = 0;
+        guint64 state;
+        guint64 *key;
+        gsize i;
+
+        if (g_once_init_enter (&initialized)) {
+                /*
+                 * The keys must be the same in every run, so that hashes
+                 * can be stored.  Do not change the seed.
+                 */
+                state = G_GUINT64_CONSTANT (0x6769626f6e2d7a62);
+                key = (guint64 *) &zobrist;
+                for (i = 0; i < sizeof zobrist / sizeof *key; ++i)
+                        key[i] = gibbon_position_splitmix64 (&state);
+                g_once_init_leave (&initialized, 1);
+        }
+
+        return &zobrist;
+}
+
+static guint64
+gibbon_position_mix (guint64 salt, guint64 value)
+{
+        guint64 state = salt ^ value;
+
+        return gibbon_position_splitmix64 (&state);
+}
+
+/**
+ * gibbon_position_hash:
+ * @self: The #GibbonPosition.
+ *
+ * Computes a 64 bit Zobrist hash over all significant properties of
+ * @self, i. e. those compared by gibbon_position_equals_technically().
+ * Positions that are technically equal always have the same hash.  The
+ * converse is true with overwhelming probability, so that the hash can be
+ * used as a key for caches and for discarding duplicates.
+ *
+ * The hash is not stored inside the position because the structure is
+ * modified directly in many places.  It is cheap to compute, though.
+ *
+ * Returns: The hash value.
+ */
+guint64
+gibbon_position_hash (const GibbonPosition *self)
+{
+        const GibbonPositionZobrist *z;
+        guint64 hash = 0;
+        gint i, n;
+
+        g_return_val_if_fail (self != NULL, 0);
+
+        z = gibbon_position_zobrist ();
+
+        for (i = 0; i < 24; ++i) {
+                n = self->points[i];
+                if (n > 0)
+                        hash ^= z->checkers[0][i][n & 0xf];
+                else if (n < 0)
+                        hash ^= z->checkers[1][i][-n & 0xf];
+        }
+        if (self->bar[0])
+                hash ^= z->checkers[0][24][self->bar[0] & 0xf];
+        if (self->bar[1])
+                hash ^= z->checkers[1][24][self->bar[1] & 0xf];
+
+        hash ^= z->turn[self->turn + 1];
+        for (i = 0; i < 2; ++i) {
+                n = (gint) self->dice[i];
+                if (n >= -6 && n <= 6)
+                        hash ^= z->dice[i][n + 6];
+                else
+                        hash ^= gibbon_position_mix (z->dice[i][6], n);
+                if (self->may_double[i])
+                        hash ^= z->may_double[i];
+        }
+        hash ^= z->cube_turned[self->cube_turned + 1];
+
+        hash ^= gibbon_position_mix (z->cube, self->cube);
+        hash ^= gibbon_position_mix (z->match_length, self->match_length);
+        hash ^= gibbon_position_mix (z->scores[0], self->scores[0]);
+        hash ^= gibbon_position_mix (z->scores[1], self->scores[1]);
+        hash ^= gibbon_position_mix (z->resigned, self->resigned);
+        hash ^= gibbon_position_mix (z->score, self->score);
+        if (self->dice_swapped)
+                hash ^= z->dice_swapped;
+
+        return hash;
+}
+
+static void
+gibbon_position_encode_base64 (const guint8 *bytes, gsize num_bytes,
+                               gchar *out)
+{
+        gsize i;
+        guint bits = 0, num_bits = 0;
+
+        /* Big-endian, 6 bits per character, the remainder is zero-padded.  */
+        for (i = 0; i < num_bytes; ++i) {
+                bits = (bits << 8) | bytes[i];
+                num_bits += 8;
+                while (num_bits >= 6) {
+                        num_bits -= 6;
+                        *out++ = gibbon_position_base64[(bits >> num_bits)
+                                                        & 0x3f];
+                }
+        }
+        if (num_bits)
+                *out++ = gibbon_position_base64[(bits << (6 - num_bits))
+                                                & 0x3f];
+        *out = 0;
+}
+
+static gboolean
+gibbon_position_decode_base64 (const gchar *in, gsize num_chars,
+                               guint8 *bytes)
+{
+        gsize i;
+        const gchar *found;
+        guint bits = 0, num_bits = 0;
+
+        if (strlen (in) != num_chars)
+                return FALSE;
+
+        for (i = 0; i < num_chars; ++i) {
+                found = strchr (gibbon_position_base64, in[i]);
+                if (!found)
+                        return FALSE;
+                bits = (bits << 6) | (found - gibbon_position_base64);
+                num_bits += 6;
+                if (num_bits >= 8) {
+                        num_bits -= 8;
+                        *bytes++ = (bits >> num_bits) & 0xff;
+                }
+        }
+
+        return TRUE;
+}
+
+static GibbonPositionSide
+gibbon_position_on_roll (const GibbonPosition *self)
+{
+        return self->turn == GIBBON_POSITION_SIDE_BLACK ?
+                GIBBON_POSITION_SIDE_BLACK : GIBBON_POSITION_SIDE_WHITE;
+}
+
+/*
+ * Checkers on slot 0-23 of one side, starting at that side's ace point.
+ * Slot 24 is the bar.
+ */
+static guint
+gibbon_position_get_slot (const GibbonPosition *self, GibbonPositionSide side,
+                          gint slot)
+{
+        gint n;
+
+        if (slot == 24)
+                return side == GIBBON_POSITION_SIDE_WHITE ?
+                        self->bar[0] : self->bar[1];
+
+        if (side == GIBBON_POSITION_SIDE_WHITE)
+                n = self->points[slot];
+        else
+                n = -self->points[23 - slot];
+
+        return n > 0 ? n : 0;
+}
+
+/**
+ * gibbon_position_get_key:
+ * @self: The #GibbonPosition.
+ * @key: Location to store the key.
+ *
+ * Stores the 10 byte position key of the checker distribution in @key.
+ * The key is compatible with the one used by GNU Backgammon.  The side on
+ * roll is given by the @turn field, or white if neither side is on roll.
+ */
+void
+gibbon_position_get_key (const GibbonPosition *self, guint8 key[10])
+{
+        GibbonPositionSide sides[2];
+        guint bit = 0;
+        gint i, slot;
+        guint n;
+
+        g_return_if_fail (self != NULL);
+
+        memset (key, 0, 10);
+
+        sides[1] = gibbon_position_on_roll (self);
+        sides[0] = -sides[1];
+
+        for (i = 0; i < 2; ++i) {
+                for (slot = 0; slot < 25; ++slot) {
+                        n = gibbon_position_get_slot (self, sides[i], slot);
+                        for (; n && bit < 80; --n, ++bit)
+                                key[bit >> 3] |= 1 << (bit & 0x7);
+                        ++bit;
+                }
+        }
+}
+
+/**
+ * gibbon_position_get_position_id:
+ * @self: The #GibbonPosition.
+ *
+ * Encodes the checker distribution of @self as a GNU Backgammon position ID.
+ * See gibbon_position_get_key() for the perspective.
+ *
+ * Returns: The 14 character position ID, free with g_free().
+ */
+gchar *
+gibbon_position_get_position_id (const GibbonPosition *self)
+{
+        guint8 key[10];
+        gchar *id;
+
+        g_return_val_if_fail (self != NULL, NULL);
+
+        gibbon_position_get_key (self, key);
+        id = g_malloc (15);
+        gibbon_position_encode_base64 (key, sizeof key, id);
+
+        return id;
+}
+
+/**
+ * gibbon_position_set_position_id:
+ * @self: The #GibbonPosition.
+ * @id: A GNU Backgammon position ID.
+ *
+ * Sets the checker distribution of @self from @id.  The position ID does not
+ * tell which side is on roll.  It is taken from the @turn field of @self, so
+ * you will usually call gibbon_position_set_match_id() first.
+ *
+ * Returns: %TRUE for success, %FALSE if @id is invalid.  In the latter case
+ *          @self is not modified.
+ */
+gboolean
+gibbon_position_set_position_id (GibbonPosition *self, const gchar *id)
+{
+        guint8 key[10];
+        GibbonPositionSide sides[2];
+        gint points[24];
+        guint bar[2];
+        guint bit = 0;
+        gint i, slot, point;
+        guint n, total;
+
+        g_return_val_if_fail (self != NULL, FALSE);
+        g_return_val_if_fail (id != NULL, FALSE);
+
+        if (!gibbon_position_decode_base64 (id, 14, key))
+                return FALSE;
+
+        sides[1] = gibbon_position_on_roll (self);
+        sides[0] = -sides[1];
+
+        memset (points, 0, sizeof points);
+        memset (bar, 0, sizeof bar);
+
+        for (i = 0; i < 2; ++i) {
+                total = 0;
+                for (slot = 0; slot < 25; ++slot) {
+                        for (n = 0; ; ++n, ++bit) {
+                                if (bit >= 80)
+                                        return FALSE;
+                                if (!(key[bit >> 3] & (1 << (bit & 0x7))))
+                                        break;
+                        }
+                        ++bit;
+                        total += n;
+                        if (total > 15)
+                                return FALSE;
+                        if (!n)
+                                continue;
+
+                        if (slot == 24) {
+                                bar[sides[i] == GIBBON_POSITION_SIDE_WHITE ?
+                                    0 : 1] = n;
+                                continue;
+                        }
+
+                        point = sides[i] == GIBBON_POSITION_SIDE_WHITE ?
+                                slot : 23 - slot;
+                        if (points[point])
+                                return FALSE;
+                        points[point] = sides[i] * (gint) n;
+                }
+        }
+
+        memcpy (self->points, points, sizeof self->points);
+        memcpy (self->bar, bar, sizeof self->bar);
+
+        return TRUE;
+}
+
+static void
+gibbon_position_put_bits (guint8 *bytes, guint *bit, guint64 value,
+                          guint width)
+{
+        for (; width; --width, ++*bit, value >>= 1)
+                if (value & 1)
+                        bytes[*bit >> 3] |= 1 << (*bit & 0x7);
+}
+
+static guint64
+gibbon_position_get_bits (const guint8 *bytes, guint *bit, guint width)
+{
+        guint64 value = 0;
+        guint i;
+
+        for (i = 0; i < width; ++i, ++*bit)
+                if (bytes[*bit >> 3] & (1 << (*bit & 0x7)))
+                        value |= G_GUINT64_CONSTANT (1) << i;
+
+        return value;
+}
+
+/**
+ * gibbon_position_get_match_id:
+ * @self: The #GibbonPosition.
+ *
+ * Encodes the match and cube state of @self as a GNU Backgammon match ID.
+ * White is player 1 and black is player 0 in GNU Backgammon terms.
+ *
+ * The match ID has no room for some of the information in a #GibbonPosition.
+ * Scores and the match length are truncated to 15 bits, and the Crawford
+ * flag is derived from the cube state.
+ *
+ * Returns: The 12 character match ID, free with g_free().
+ */
+gchar *
+gibbon_position_get_match_id (const GibbonPosition *self)
+{
+        guint8 bytes[9];
+        guint bit = 0;
+        guint log2_cube;
+        guint owner;
+        gboolean crawford;
+        guint state;
+        GibbonPositionSide on_roll, turn;
+        guint64 resigned;
+        gchar *id;
+
+        g_return_val_if_fail (self != NULL, NULL);
+
+        memset (bytes, 0, sizeof bytes);
+
+        log2_cube = self->cube ? g_bit_storage (self->cube) - 1 : 0;
+        if (log2_cube > 15)
+                log2_cube = 15;
+
+        if (self->may_double[0] == self->may_double[1])
+                owner = 3;
+        else if (self->may_double[0])
+                owner = 1;
+        else
+                owner = 0;
+
+        crawford = self->match_length > 0
+                   && !self->may_double[0] && !self->may_double[1]
+                   && self->cube == 1;
+
+        if (self->score)
+                state = 2;
+        else if (self->turn == GIBBON_POSITION_SIDE_NONE)
+                state = 0;
+        else
+                state = 1;
+
+        on_roll = gibbon_position_on_roll (self);
+        resigned = self->resigned < 0 ? -self->resigned : self->resigned;
+        if (resigned > 3)
+                resigned = 3;
+
+        /* The side that has to take a decision.  */
+        if (self->resigned)
+                turn = self->resigned > 0 ?
+                        GIBBON_POSITION_SIDE_BLACK : GIBBON_POSITION_SIDE_WHITE;
+        else if (self->cube_turned)
+                turn = -self->cube_turned;
+        else
+                turn = on_roll;
+
+        gibbon_position_put_bits (bytes, &bit, log2_cube, 4);
+        gibbon_position_put_bits (bytes, &bit, owner, 2);
+        gibbon_position_put_bits (bytes, &bit,
+                                  on_roll == GIBBON_POSITION_SIDE_WHITE, 1);
+        gibbon_position_put_bits (bytes, &bit, crawford, 1);
+        gibbon_position_put_bits (bytes, &bit, state, 3);
+        gibbon_position_put_bits (bytes, &bit,
+                                  turn == GIBBON_POSITION_SIDE_WHITE, 1);
+        gibbon_position_put_bits (bytes, &bit, self->cube_turned != 0, 1);
+        gibbon_position_put_bits (bytes, &bit, resigned, 2);
+        gibbon_position_put_bits (bytes, &bit, abs ((gint) self->dice[0]), 3);
+        gibbon_position_put_bits (bytes, &bit, abs ((gint) self->dice[1]), 3);
+        gibbon_position_put_bits (bytes, &bit, self->match_length, 15);
+        gibbon_position_put_bits (bytes, &bit, self->scores[1], 15);
+        gibbon_position_put_bits (bytes, &bit, self->scores[0], 15);
+
+        id = g_malloc (13);
+        gibbon_position_encode_base64 (bytes, sizeof bytes, id);
+
+        return id;
+}
+
+/**
+ * gibbon_position_set_match_id:
+ * @self: The #GibbonPosition.
+ * @id: A GNU Backgammon match ID.
+ *
+ * Sets the match and cube state of @self from @id.  See
+ * gibbon_position_get_match_id() for the mapping.
+ *
+ * Returns: %TRUE for success, %FALSE if @id is invalid.  In the latter case
+ *          @self is not modified.
+ */
+gboolean
+gibbon_position_set_match_id (GibbonPosition *self, const gchar *id)
+{
+        guint8 bytes[9];
+        guint bit = 0;
+        guint log2_cube, owner, state, resigned;
+        gboolean crawford, on_roll, turn, doubled;
+        guint die1, die2;
+        guint64 match_length, scores[2];
+        GibbonPositionSide side;
+
+        g_return_val_if_fail (self != NULL, FALSE);
+        g_return_val_if_fail (id != NULL, FALSE);
+
+        if (!gibbon_position_decode_base64 (id, 12, bytes))
+                return FALSE;
+
+        log2_cube = gibbon_position_get_bits (bytes, &bit, 4);
+        owner = gibbon_position_get_bits (bytes, &bit, 2);
+        on_roll = gibbon_position_get_bits (bytes, &bit, 1);
+        crawford = gibbon_position_get_bits (bytes, &bit, 1);
+        state = gibbon_position_get_bits (bytes, &bit, 3);
+        turn = gibbon_position_get_bits (bytes, &bit, 1);
+        doubled = gibbon_position_get_bits (bytes, &bit, 1);
+        resigned = gibbon_position_get_bits (bytes, &bit, 2);
+        die1 = gibbon_position_get_bits (bytes, &bit, 3);
+        die2 = gibbon_position_get_bits (bytes, &bit, 3);
+        match_length = gibbon_position_get_bits (bytes, &bit, 15);
+        scores[1] = gibbon_position_get_bits (bytes, &bit, 15);
+        scores[0] = gibbon_position_get_bits (bytes, &bit, 15);
+
+        if (owner == 2 || state > 4 || die1 > 6 || die2 > 6)
+                return FALSE;
+        if (!die1 != !die2)
+                return FALSE;
+        if (doubled && resigned)
+                return FALSE;
+
+        self->cube = G_GUINT64_CONSTANT (1) << log2_cube;
+        if (crawford) {
+                self->may_double[0] = self->may_double[1] = FALSE;
+        } else {
+                self->may_double[0] = owner != 0;
+                self->may_double[1] = owner != 1;
+        }
+
+        side = on_roll ? GIBBON_POSITION_SIDE_WHITE
+                       : GIBBON_POSITION_SIDE_BLACK;
+        self->turn = state ? side : GIBBON_POSITION_SIDE_NONE;
+        self->dice[0] = side * (gint) die1;
+        self->dice[1] = side * (gint) die2;
+
+        side = turn ? GIBBON_POSITION_SIDE_WHITE : GIBBON_POSITION_SIDE_BLACK;
+        self->cube_turned = doubled ? -side : GIBBON_POSITION_SIDE_NONE;
+        self->resigned = -side * (gint64) resigned;
+
+        self->match_length = match_length;
+        self->scores[0] = scores[0];
+        self->scores[1] = scores[1];
+
+        return TRUE;
+}
+
 gboolean
 gibbon_position_apply_move (GibbonPosition *self, GibbonMove *move,
                             GibbonPositionSide side, gboolean reverse)
@@ -1124,6 +1894,7 @@ static GRegex *re_dup2 = NULL;
 static GRegex *re_dup3 = NULL;
 static GRegex *re_dup4 = NULL;
 static GRegex *re_prune_intermediate = NULL;
+static gsize regexes_initialized = 0;
 
 gchar *
 gibbon_position_format_move (const GibbonPosition *self,
@@ -1174,41 +1945,18 @@ gibbon_position_format_move (const GibbonPosition *self,
         }
         buf[j - 1] = 0;
 
-        if (!re_adjacent1) {
-                re_adjacent1 = g_regex_new ("([a-z]) \\1",
-                                            0, 0, &error);
-                if (error)
-                        return g_strdup (error->message);
-        }
-        if (!re_adjacent2) {
+        /* Called from the match readers, possibly in several threads.  */
+        if (g_once_init_enter (&regexes_initialized)) {
+                re_adjacent1 = g_regex_new ("([a-z]) \\1", 0, 0, NULL);
                 re_adjacent2 = g_regex_new ("([a-z])/([a-z])(.*) \\2/([a-z])",
-                                            0, 0, &error);
-                if (error)
-                        return g_strdup (error->message);
-        }
-        if (!re_dup4) {
+                                            0, 0, NULL);
                 re_dup4 = g_regex_new ("([a-z]/[a-z]) \\1 \\1 \\1",
-                                       0, 0, &error);
-                if (error)
-                        return g_strdup (error->message);
-        }
-        if (!re_dup3) {
-                re_dup3 = g_regex_new ("([a-z]/[a-z]) \\1 \\1",
-                                       0, 0, &error);
-                if (error)
-                        return g_strdup (error->message);
-        }
-        if (!re_dup2) {
-                re_dup2 = g_regex_new ("([a-z](?:/[a-z])+) \\1",
-                                       0, 0, &error);
-                if (error)
-                        return g_strdup (error->message);
-        }
-        if (!re_prune_intermediate) {
+                                       0, 0, NULL);
+                re_dup3 = g_regex_new ("([a-z]/[a-z]) \\1 \\1", 0, 0, NULL);
+                re_dup2 = g_regex_new ("([a-z](?:/[a-z])+) \\1", 0, 0, NULL);
                 re_prune_intermediate = g_regex_new ("/[1-9][0-9]*/",
-                                                     0, 0, &error);
-                if (error)
-                        return g_strdup (error->message);
+                                                     0, 0, NULL);
+                g_once_init_leave (&regexes_initialized, 1);
         }
 
         /* First compression step.  Condense ab bc into abc, or
@@ -138,6 +138,32 @@ struct _GibbonPosition
         gchar *status;
 };
 
+/**
+ * GibbonPositionPlay:
+ * @board: The resulting position seen from the side on move.  @board[1] to
+ *         @board[24] are the points, the side on move has positive checker
+ *         counts and moves from 24 towards 1, the opponent has negative
+ *         counts.  @board[25] holds the checkers of the side on move on the
+ *         bar, @board[0] those of the opponent.
+ * @number: The number of checkers moved.
+ * @movements: The first @number checker movements.  The bar is 25, and
+ *             checkers borne off go to 0.
+ *
+ * One legal play as produced by gibbon_position_generate_moves().  The
+ * structure is plain old data and can be copied with memcpy().
+ */
+typedef struct _GibbonPositionPlay GibbonPositionPlay;
+struct _GibbonPositionPlay
+{
+        gint8 board[26];
+        guint8 number;
+        struct {
+                guint8 from;
+                guint8 to;
+                guint8 die;
+        } movements[4];
+};
+
 GType gibbon_position_get_type (void) G_GNUC_CONST;
 
 GibbonPosition *gibbon_position_new (void);
@@ -155,8 +181,21 @@ guint gibbon_position_get_borne_off (const GibbonPosition *self,
 struct _GibbonMove *gibbon_position_check_move (const GibbonPosition *before,
                                                 const GibbonPosition *after,
                                                 GibbonPositionSide side);
+void gibbon_position_normalize (const GibbonPosition *self,
+                                GibbonPositionSide side, gint8 board[26]);
+gsize gibbon_position_generate_moves (const GibbonPosition *self,
+                                      GibbonPositionSide side,
+                                      guint die1, guint die2,
+                                      GArray *plays);
 gboolean gibbon_position_equals_technically (const GibbonPosition *self,
                                              const GibbonPosition *other);
+guint64 gibbon_position_hash (const GibbonPosition *self);
+void gibbon_position_get_key (const GibbonPosition *self, guint8 key[10]);
+gchar *gibbon_position_get_position_id (const GibbonPosition *self);
+gboolean gibbon_position_set_position_id (GibbonPosition *self,
+                                          const gchar *id);
+gchar *gibbon_position_get_match_id (const GibbonPosition *self);
+gboolean gibbon_position_set_match_id (GibbonPosition *self, const gchar *id);
 void gibbon_position_dump (const GibbonPosition *self);
 
 /* Apply a move to a position.  The function only does a plausability test,
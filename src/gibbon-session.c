@@ -71,11 +71,42 @@ struct GibbonSessionSavedCountCallbackInfo {
 
 #define GIBBON_SESSION_REPLY_TIMEOUT 2500
 
+/*
+ * Who information is not processed line by line.  It is buffered and
+ * written to the database in one transaction, when the end of the who
+ * information (CLIP 6) is seen, when the buffer is full, when any other
+ * message arrives, or when the timeout (in milliseconds) expires.
+ */
+#define GIBBON_SESSION_WHO_INFO_BATCH_SIZE 500
+#define GIBBON_SESSION_WHO_INFO_TIMEOUT 250
+
+typedef struct _GibbonSessionWhoInfo GibbonSessionWhoInfo;
+struct _GibbonSessionWhoInfo {
+        gchar *who;
+        gchar *opponent;
+        gchar *watching;
+        gboolean ready;
+        gboolean away;
+        gdouble rating;
+        guint64 experience;
+        gchar *hostname;
+        gchar *client;
+        gchar *email;
+};
+
 static gint gibbon_session_clip_welcome (GibbonSession *self, GSList *iter);
 static gint gibbon_session_clip_own_info (GibbonSession *self, GSList *iter);
-static gint gibbon_session_clip_who_info (GibbonSession *self, GSList *iter);
+static gint gibbon_session_clip_who_info (GibbonSession *self,
+                                          const GibbonCLIPWhoInfo *info);
 static gint gibbon_session_clip_who_info_end (GibbonSession *self,
                                               GSList *iter);
+static void gibbon_session_flush_who_infos (GibbonSession *self);
+static gboolean gibbon_session_on_who_info_timeout (GibbonSession *self);
+static void gibbon_session_process_who_info (GibbonSession *self,
+                                             const GibbonSessionWhoInfo *info,
+                                             gdouble reliability,
+                                             guint confidence);
+static void gibbon_session_who_info_free (GibbonSessionWhoInfo *info);
 static gint gibbon_session_clip_login (GibbonSession *self, GSList *iter);
 static gint gibbon_session_clip_logout (GibbonSession *self, GSList *iter);
 static gint gibbon_session_clip_message (GibbonSession *self, GSList *iter);
@@ -83,11 +114,16 @@ static gint gibbon_session_clip_message_delivered (GibbonSession *self,
                                                    GSList *iter);
 static gint gibbon_session_clip_message_saved (GibbonSession *self,
                                                GSList *iter);
-static gint gibbon_session_clip_says (GibbonSession *self, GSList *iter);
-static gint gibbon_session_clip_alerts (GibbonSession *self, GSList *iter);
-static gint gibbon_session_clip_shouts (GibbonSession *self, GSList *iter);
-static gint gibbon_session_clip_whispers (GibbonSession *self, GSList *iter);
-static gint gibbon_session_clip_kibitzes (GibbonSession *self, GSList *iter);
+static gint gibbon_session_clip_says (GibbonSession *self,
+                                      const GibbonCLIPChat *chat);
+static gint gibbon_session_clip_alerts (GibbonSession *self,
+                                        const GibbonCLIPChat *chat);
+static gint gibbon_session_clip_shouts (GibbonSession *self,
+                                        const GibbonCLIPChat *chat);
+static gint gibbon_session_clip_whispers (GibbonSession *self,
+                                          const GibbonCLIPChat *chat);
+static gint gibbon_session_clip_kibitzes (GibbonSession *self,
+                                          const GibbonCLIPChat *chat);
 static gint gibbon_session_clip_you_say (GibbonSession *self, GSList *iter);
 static gint gibbon_session_clip_you_shout (GibbonSession *self, GSList *iter);
 static gint gibbon_session_clip_you_whisper (GibbonSession *self, GSList *iter);
@@ -95,9 +131,12 @@ static gint gibbon_session_clip_you_kibitz (GibbonSession *self, GSList *iter);
 static gint gibbon_session_handle_error (GibbonSession *self, GSList *iter);
 static gint gibbon_session_handle_no_such_user (GibbonSession *self,
                                                 GSList *iter);
-static gint gibbon_session_handle_board (GibbonSession *self, GSList *iter);
-static gint gibbon_session_handle_rolls (GibbonSession *self, GSList *iter);
-static gint gibbon_session_handle_moves (GibbonSession *self, GSList *iter);
+static gint gibbon_session_handle_board (GibbonSession *self,
+                                        const GibbonCLIPBoard *board);
+static gint gibbon_session_handle_rolls (GibbonSession *self,
+                                        const GibbonCLIPRolls *rolls);
+static gint gibbon_session_handle_moves (GibbonSession *self,
+                                        const GibbonCLIPMoves *moves);
 static gint gibbon_session_handle_invitation (GibbonSession *self,
                                               GSList *iter);
 static gint gibbon_session_handle_youre_watching (GibbonSession *self,
@@ -209,6 +248,11 @@ struct _GibbonSessionPrivate {
         gboolean expect_autoboard;
         GSList *expect_who_infos;
         GSList *expect_saved_counts;
+
+        GSList *who_infos;
+        guint num_who_infos;
+        GHashTable *who_info_index;
+        guint who_info_timeout_id;
         gboolean expect_address;
 
         gboolean address_checked;
@@ -265,6 +309,12 @@ gibbon_session_init (GibbonSession *self)
         self->priv->expect_autoboard = FALSE;
         self->priv->expect_who_infos = NULL;
         self->priv->expect_saved_counts = NULL;
+
+        self->priv->who_infos = NULL;
+        self->priv->num_who_infos = 0;
+        self->priv->who_info_index = g_hash_table_new (g_str_hash,
+                                                       g_str_equal);
+        self->priv->who_info_timeout_id = 0;
         self->priv->expect_address = FALSE;
 
         self->priv->address_checked = FALSE;
@@ -337,6 +387,13 @@ gibbon_session_finalize (GObject *object)
         if (self->priv->timeout_id)
                 g_source_remove (self->priv->timeout_id);
 
+        if (self->priv->who_info_timeout_id)
+                g_source_remove (self->priv->who_info_timeout_id);
+        g_slist_free_full (self->priv->who_infos,
+                           (GDestroyNotify) gibbon_session_who_info_free);
+        if (self->priv->who_info_index)
+                g_hash_table_destroy (self->priv->who_info_index);
+
         if (self->priv->watching)
                 g_free (self->priv->watching);
 
@@ -463,6 +520,7 @@ gibbon_session_process_server_line (GibbonSession *self,
                                     const gchar *line)
 {
         gint retval = -1;
+        const GibbonCLIPRecord *record;
         GSList *values, *iter;
         enum GibbonClipCode code;
         GTimeVal timeval;
@@ -495,19 +553,72 @@ gibbon_session_process_server_line (GibbonSession *self,
                 return -1;
         }
 
-        values = gibbon_clip_reader_parse (self->priv->clip_reader, line);
-        if (!values)
+        record = gibbon_clip_reader_scan (self->priv->clip_reader, line);
+        if (!record)
                 return -1;
+        code = record->code;
 
-        iter = values;
-        if (!gibbon_clip_reader_get_int (self->priv->clip_reader, &iter,
-                                         (gint *) &code)) {
-                gibbon_clip_reader_free_result (self->priv->clip_reader,
-                                                values);
-                return -1;
+        /*
+         * Buffered who information must be processed before anything
+         * else happens.
+         */
+        if (code != GIBBON_CLIP_WHO_INFO && self->priv->who_infos)
+                gibbon_session_flush_who_infos (self);
+
+        /*
+         * The frequent messages are handled directly from the typed
+         * record without allocating memory.
+         */
+        switch (code) {
+        case GIBBON_CLIP_WHO_INFO:
+                return gibbon_session_clip_who_info (self,
+                                                     &record->u.who_info);
+        case GIBBON_CLIP_SAYS:
+                return gibbon_session_clip_says (self, &record->u.chat);
+        case GIBBON_CLIP_SHOUTS:
+                return gibbon_session_clip_shouts (self, &record->u.chat);
+        case GIBBON_CLIP_WHISPERS:
+                return gibbon_session_clip_whispers (self, &record->u.chat);
+        case GIBBON_CLIP_KIBITZES:
+                return gibbon_session_clip_kibitzes (self, &record->u.chat);
+        case GIBBON_CLIP_ALERTS:
+                return gibbon_session_clip_alerts (self, &record->u.chat);
+        case GIBBON_CLIP_BOARD:
+                if (self->priv->debug_board_state) {
+                        g_get_current_time (&timeval);
+                        now = localtime ((time_t *) &timeval.tv_sec);
+                        g_printerr ("[%02d:%02d:%02d.%06ld] %s\n",
+                                   now->tm_hour, now->tm_min, now->tm_sec,
+                                   timeval.tv_usec, line);
+                }
+                return gibbon_session_handle_board (self, &record->u.board);
+        case GIBBON_CLIP_ROLLS:
+                return gibbon_session_handle_rolls (self, &record->u.rolls);
+        case GIBBON_CLIP_MOVES:
+                return gibbon_session_handle_moves (self, &record->u.moves);
+        default:
+                break;
         }
 
+        values = gibbon_clip_reader_get_values (self->priv->clip_reader);
+        if (!values)
+                return -1;
+
+        /* Skip the code.  */
+        iter = values->next;
+
         switch (code) {
+        case GIBBON_CLIP_WHO_INFO:
+        case GIBBON_CLIP_SAYS:
+        case GIBBON_CLIP_SHOUTS:
+        case GIBBON_CLIP_WHISPERS:
+        case GIBBON_CLIP_KIBITZES:
+        case GIBBON_CLIP_ALERTS:
+        case GIBBON_CLIP_BOARD:
+        case GIBBON_CLIP_ROLLS:
+        case GIBBON_CLIP_MOVES:
+                /* Handled above.  */
+                break;
         case GIBBON_CLIP_UNHANDLED:
         case GIBBON_CLIP_UNKNOWN_MESSAGE:
                 break;
@@ -523,9 +634,6 @@ gibbon_session_process_server_line (GibbonSession *self,
         case GIBBON_CLIP_MOTD_END:
                 retval = GIBBON_CLIP_MOTD_END;
                 break;
-        case GIBBON_CLIP_WHO_INFO:
-                retval = gibbon_session_clip_who_info (self, iter);
-                break;
         case GIBBON_CLIP_WHO_INFO_END:
                 retval = gibbon_session_clip_who_info_end (self, iter);
                 break;
@@ -544,18 +652,6 @@ gibbon_session_process_server_line (GibbonSession *self,
         case GIBBON_CLIP_MESSAGE_SAVED:
                 retval = gibbon_session_clip_message_saved (self, iter);
                 break;
-        case GIBBON_CLIP_SAYS:
-                retval = gibbon_session_clip_says (self, iter);
-                break;
-        case GIBBON_CLIP_SHOUTS:
-                retval = gibbon_session_clip_shouts (self, iter);
-                break;
-        case GIBBON_CLIP_WHISPERS:
-                retval = gibbon_session_clip_whispers (self, iter);
-                break;
-        case GIBBON_CLIP_KIBITZES:
-                retval = gibbon_session_clip_kibitzes (self, iter);
-                break;
         case GIBBON_CLIP_YOU_SAY:
                 retval = gibbon_session_clip_you_say (self, iter);
                 break;
@@ -568,28 +664,9 @@ gibbon_session_process_server_line (GibbonSession *self,
         case GIBBON_CLIP_YOU_KIBITZ:
                 retval = gibbon_session_clip_you_kibitz (self, iter);
                 break;
-        case GIBBON_CLIP_ALERTS:
-                retval = gibbon_session_clip_alerts (self, iter);
-                break;
         case GIBBON_CLIP_ERROR:
                 retval = gibbon_session_handle_error (self, iter);
                 break;
-        case GIBBON_CLIP_BOARD:
-                if (self->priv->debug_board_state) {
-                        g_get_current_time (&timeval);
-                        now = localtime ((time_t *) &timeval.tv_sec);
-                        g_printerr ("[%02d:%02d:%02d.%06ld] %s\n",
-                                   now->tm_hour, now->tm_min, now->tm_sec,
-                                   timeval.tv_usec, line);
-                }
-                retval = gibbon_session_handle_board (self, iter);
-                break;
-        case GIBBON_CLIP_ROLLS:
-                retval = gibbon_session_handle_rolls (self, iter);
-                break;
-        case GIBBON_CLIP_MOVES:
-                retval = gibbon_session_handle_moves (self, iter);
-                break;
         case GIBBON_CLIP_START_GAME:
                 /* Ignored.  */
                 retval = GIBBON_CLIP_START_GAME;
@@ -872,100 +949,178 @@ gibbon_session_clip_own_info (GibbonSession *self, GSList *iter)
 }
 
 static gint
-gibbon_session_clip_who_info (GibbonSession *self, 
-                              GSList *iter)
+gibbon_session_clip_who_info (GibbonSession *self,
+                              const GibbonCLIPWhoInfo *record)
 {
-        const gchar *who;
-        const gchar *opponent;
-        const gchar *watching;
-        gboolean ready;
-        gboolean available;
-        gboolean away;
-        gdouble rating;
-        guint64 experience;
-        const gchar *raw_client;
-        gchar *client;
-        enum GibbonClientType client_type;
-        GibbonClientIcons *client_icons;
-        GdkPixbuf *client_icon;
-        const gchar *current_email;
-        const gchar *hostname;
-        GibbonCountry *country;
-        GibbonArchive *archive;
-        gdouble reliability;
-        guint confidence;
+        const gchar *who = record->who;
+        const gchar *opponent = record->opponent;
+        const gchar *watching = record->watching;
         const gchar *account;
-        guint port;
-        const gchar *server;
-        gboolean has_saved;
-        GibbonSavedInfo *saved_info;
-        GError *error = NULL;
-        GibbonCLIPReader *clip_reader = self->priv->clip_reader;
-
-        if (!gibbon_clip_reader_get_string (clip_reader, &iter, &who))
-                return -1;
+        GibbonSessionWhoInfo *info;
 
         gibbon_session_unqueue_who_request (self, who);
 
-        if (!gibbon_clip_reader_get_string (clip_reader, &iter, &opponent))
-                return -1;
         if (opponent[0] == '-' && opponent[1] == 0)
                 opponent = "";
-                
-        if (!gibbon_clip_reader_get_string (clip_reader, &iter, &watching))
-                return -1;
         if (watching[0] == '-' && watching[1] == 0)
                 watching = "";
 
-        if (!gibbon_clip_reader_get_boolean (clip_reader, &iter, &ready))
-                return -1;
+        /*
+         * A newer record for the same player replaces the buffered one
+         * in place.
+         */
+        info = g_hash_table_lookup (self->priv->who_info_index, who);
+        if (info) {
+                g_free (info->opponent);
+                g_free (info->watching);
+                g_free (info->hostname);
+                g_free (info->client);
+                g_free (info->email);
+        } else {
+                info = g_malloc (sizeof *info);
+                info->who = g_strdup (who);
+                self->priv->who_infos = g_slist_prepend (self->priv->who_infos,
+                                                         info);
+                ++self->priv->num_who_infos;
+                g_hash_table_insert (self->priv->who_info_index, info->who,
+                                     info);
+        }
+
+        info->opponent = g_strdup (opponent);
+        info->watching = g_strdup (watching);
+        info->ready = record->ready;
+        info->away = record->away;
+        info->rating = record->rating;
+        info->experience = record->experience;
+        info->hostname = g_strdup (record->hostname);
+        info->client = gibbon_session_decode_client (self, record->client);
+        info->email = g_strdup (record->email);
 
-        if (!gibbon_clip_reader_get_boolean (clip_reader, &iter, &away))
-                return -1;
+        /*
+         * Our own record changes the session state.  It is processed
+         * immediately.
+         */
+        account = gibbon_connection_get_login (self->priv->connection);
+        if (!g_strcmp0 (who, account)
+            || self->priv->num_who_infos >= GIBBON_SESSION_WHO_INFO_BATCH_SIZE)
+                gibbon_session_flush_who_infos (self);
+        else if (!self->priv->who_info_timeout_id)
+                self->priv->who_info_timeout_id =
+                        g_timeout_add (GIBBON_SESSION_WHO_INFO_TIMEOUT,
+                                       (GSourceFunc)
+                                       gibbon_session_on_who_info_timeout,
+                                       self);
 
-        if (!gibbon_clip_reader_get_double (clip_reader, &iter, &rating))
-                return -1;
+        return GIBBON_CLIP_WHO_INFO;
+}
 
-        if (!gibbon_clip_reader_get_int64 (clip_reader, &iter,
-                                           (gint64 *) &experience))
-                return -1;
+static gboolean
+gibbon_session_on_who_info_timeout (GibbonSession *self)
+{
+        self->priv->who_info_timeout_id = 0;
 
-        iter = iter->next;
-        iter = iter->next;
-        
-        if (!gibbon_clip_reader_get_string (clip_reader, &iter, &hostname))
-                return -1;
+        gibbon_session_flush_who_infos (self);
 
-        if (!gibbon_clip_reader_get_string (clip_reader, &iter, &raw_client))
-                return -1;
-        client = gibbon_session_decode_client (self, raw_client);
+        return FALSE;
+}
 
-        if (!gibbon_clip_reader_get_string (clip_reader, &iter, &current_email))
-                return -1;
+static void
+gibbon_session_flush_who_infos (GibbonSession *self)
+{
+        GSList *who_infos, *iter;
+        GibbonDatabaseUser *users;
+        GibbonSessionWhoInfo *info;
+        gsize num_users, i;
+        const gchar *server;
+        guint port;
+        GError *error = NULL;
 
-        available = ready && !away && !opponent[0];
+        if (self->priv->who_info_timeout_id) {
+                g_source_remove (self->priv->who_info_timeout_id);
+                self->priv->who_info_timeout_id = 0;
+        }
+
+        if (!self->priv->who_infos)
+                return;
+
+        /* Detach the buffer so that the handlers cannot interfere.  */
+        who_infos = g_slist_reverse (self->priv->who_infos);
+        num_users = self->priv->num_who_infos;
+        self->priv->who_infos = NULL;
+        self->priv->num_who_infos = 0;
+        g_hash_table_remove_all (self->priv->who_info_index);
+
+        users = g_new (GibbonDatabaseUser, num_users);
+        for (i = 0, iter = who_infos; iter; ++i, iter = iter->next) {
+                info = (GibbonSessionWhoInfo *) iter->data;
+                users[i].login = info->who;
+                users[i].rating = info->rating;
+                users[i].experience = info->experience;
+                users[i].reliability = 0;
+                users[i].confidence = 0;
+        }
 
-        account = gibbon_connection_get_login (self->priv->connection);
         server = gibbon_connection_get_hostname (self->priv->connection);
         port = gibbon_connection_get_port (self->priv->connection);
 
-        if (!gibbon_archive_get_reliability (self->priv->archive,
-                                             server, port, who,
-                                             &reliability, &confidence,
-                                             &error)) {
+        if (!gibbon_archive_update_users (self->priv->archive, server, port,
+                                          users, num_users, &error)) {
                 gibbon_app_display_error (self->priv->app, _("Database Error"),
                                           "%s", error->message);
                 g_error_free (error);
-                error = NULL;
-                confidence = 0;
-                reliability = 0;
+                for (i = 0; i < num_users; ++i) {
+                        users[i].reliability = 0;
+                        users[i].confidence = 0;
+                }
         }
 
-        client_type = gibbon_get_client_type (client, who, server, port);
+        gibbon_player_list_begin_update (self->priv->player_list);
+        for (i = 0, iter = who_infos; iter; ++i, iter = iter->next)
+                gibbon_session_process_who_info (self, iter->data,
+                                                 users[i].reliability,
+                                                 users[i].confidence);
+        gibbon_player_list_end_update (self->priv->player_list);
+
+        g_free (users);
+        g_slist_free_full (who_infos,
+                           (GDestroyNotify) gibbon_session_who_info_free);
+}
+
+static void
+gibbon_session_process_who_info (GibbonSession *self,
+                                 const GibbonSessionWhoInfo *info,
+                                 gdouble reliability, guint confidence)
+{
+        const gchar *who = info->who;
+        const gchar *opponent = info->opponent;
+        const gchar *watching = info->watching;
+        gdouble rating = info->rating;
+        guint64 experience = info->experience;
+        gboolean available;
+        enum GibbonClientType client_type;
+        GibbonClientIcons *client_icons;
+        GdkPixbuf *client_icon;
+        GibbonCountry *country;
+        GibbonArchive *archive;
+        const gchar *account;
+        guint port;
+        const gchar *server;
+        gboolean has_saved;
+        GibbonSavedInfo *saved_info;
+        GError *error = NULL;
+
+        available = info->ready && !info->away && !opponent[0];
+
+        account = gibbon_connection_get_login (self->priv->connection);
+        server = gibbon_connection_get_hostname (self->priv->connection);
+        port = gibbon_connection_get_port (self->priv->connection);
+
+        client_type = gibbon_get_client_type (info->client, who, server, port);
         client_icons = gibbon_app_get_client_icons (self->priv->app);
         client_icon = gibbon_client_icons_get_icon (client_icons, client_type);
 
-        country = gibbon_archive_get_country (self->priv->archive, hostname,
+        country = gibbon_archive_get_country (self->priv->archive,
+                                              info->hostname,
                                               (GibbonGeoIPCallback)
                                               gibbon_session_on_geo_ip_resolve,
                                               self);
@@ -977,8 +1132,8 @@ gibbon_session_clip_who_info (GibbonSession *self,
                                 who, has_saved, available, rating, experience,
                                 reliability, confidence,
                                 opponent, watching,
-                                client, client_icon,
-                                hostname, country, current_email);
+                                info->client, client_type,
+                                info->hostname, country, info->email);
 
         if (opponent && *opponent) {
                 gibbon_inviter_list_remove (self->priv->inviter_list, who);
@@ -997,12 +1152,10 @@ gibbon_session_clip_who_info (GibbonSession *self,
                 gibbon_inviter_list_set (self->priv->inviter_list, who,
                                          has_saved, rating, experience,
                                          reliability, confidence,
-                                         client, client_icon,
-                                         hostname, country, current_email);
+                                         info->client, client_icon,
+                                         info->hostname, country, info->email);
         }
 
-        g_free (client);
-
         archive = gibbon_app_get_archive (self->priv->app);
 
         if (!g_strcmp0 (who, account)) {
@@ -1037,15 +1190,24 @@ gibbon_session_clip_who_info (GibbonSession *self,
                                 error = NULL;
                         }
                 }
-        }
 
-        gibbon_archive_update_user (archive, server, port, account,
-                                    rating, experience);
+                gibbon_session_check_address (self, info->email);
+        }
+}
 
-        if (!g_strcmp0 (account, who))
-                gibbon_session_check_address (self, current_email);
+static void
+gibbon_session_who_info_free (GibbonSessionWhoInfo *info)
+{
+        if (!info)
+                return;
 
-        return GIBBON_CLIP_WHO_INFO;
+        g_free (info->who);
+        g_free (info->opponent);
+        g_free (info->watching);
+        g_free (info->hostname);
+        g_free (info->client);
+        g_free (info->email);
+        g_free (info);
 }
 
 static gint
@@ -1214,30 +1376,20 @@ gibbon_session_clip_message_saved (GibbonSession *self, GSList *iter)
 }
 
 static gint
-gibbon_session_clip_says (GibbonSession *self, GSList *iter)
+gibbon_session_clip_says (GibbonSession *self, const GibbonCLIPChat *chat)
 {
         GibbonFIBSMessage *fibs_message;
         GibbonConnection *connection;
-        const gchar *message;
-        const gchar *sender;
         GibbonGameChat *game_chat;
 
         connection = gibbon_app_get_connection (self->priv->app);
         if (!connection)
                 return -1;
 
-        if (!gibbon_clip_reader_get_string (self->priv->clip_reader, &iter,
-                                            &sender))
-                return -1;
-
-        if (!gibbon_clip_reader_get_string (self->priv->clip_reader, &iter,
-                                            &message))
-                return -1;
-
-        fibs_message = gibbon_fibs_message_new (sender, message);
+        fibs_message = gibbon_fibs_message_new (chat->sender, chat->message);
 
         if (self->priv->opponent && !self->priv->watching
-            && 0 == g_strcmp0 (self->priv->opponent, sender)) {
+            && 0 == g_strcmp0 (self->priv->opponent, chat->sender)) {
                 game_chat = gibbon_app_get_game_chat (self->priv->app);
                 if (!game_chat) {
                         gibbon_fibs_message_free (fibs_message);
@@ -1256,30 +1408,20 @@ gibbon_session_clip_says (GibbonSession *self, GSList *iter)
 }
 
 static gint
-gibbon_session_clip_alerts (GibbonSession *self, GSList *iter)
+gibbon_session_clip_alerts (GibbonSession *self, const GibbonCLIPChat *chat)
 {
         GibbonFIBSMessage *fibs_message;
         GibbonConnection *connection;
-        const gchar *message;
-        const gchar *sender;
         gchar *headline;
 
-        if (GIBBON_CLIP_SAYS != gibbon_session_clip_says (self, iter))
+        if (GIBBON_CLIP_SAYS != gibbon_session_clip_says (self, chat))
                 return -1;
 
         connection = gibbon_app_get_connection (self->priv->app);
         if (!connection)
                 return -1;
 
-        if (!gibbon_clip_reader_get_string (self->priv->clip_reader, &iter,
-                                            &sender))
-                return -1;
-
-        if (!gibbon_clip_reader_get_string (self->priv->clip_reader, &iter,
-                                            &message))
-                return -1;
-
-        fibs_message = gibbon_fibs_message_new (sender, message);
+        fibs_message = gibbon_fibs_message_new (chat->sender, chat->message);
 
         headline = g_strdup_printf (_("Message from administrator `%s':"),
                                     fibs_message->sender);
@@ -1294,26 +1436,16 @@ gibbon_session_clip_alerts (GibbonSession *self, GSList *iter)
 }
 
 static gint
-gibbon_session_clip_shouts (GibbonSession *self, GSList *iter)
+gibbon_session_clip_shouts (GibbonSession *self, const GibbonCLIPChat *chat)
 {
         GibbonFIBSMessage *fibs_message;
         GibbonShouts *shouts;
-        const gchar *sender;
-        const gchar *message;
 
         shouts = gibbon_app_get_shouts (self->priv->app);
         if (!shouts)
                 return -1;
 
-        if (!gibbon_clip_reader_get_string (self->priv->clip_reader, &iter,
-                                            &sender))
-                return -1;
-
-        if (!gibbon_clip_reader_get_string (self->priv->clip_reader, &iter,
-                                            &message))
-                return -1;
-
-        fibs_message = gibbon_fibs_message_new (sender, message);
+        fibs_message = gibbon_fibs_message_new (chat->sender, chat->message);
 
         gibbon_shouts_append_message (shouts, fibs_message);
 
@@ -1323,26 +1455,16 @@ gibbon_session_clip_shouts (GibbonSession *self, GSList *iter)
 }
 
 static gint
-gibbon_session_clip_whispers (GibbonSession *self, GSList *iter)
+gibbon_session_clip_whispers (GibbonSession *self, const GibbonCLIPChat *chat)
 {
         GibbonFIBSMessage *fibs_message;
         GibbonGameChat *game_chat;
-        const gchar *sender;
-        const gchar *message;
 
         game_chat = gibbon_app_get_game_chat (self->priv->app);
         if (!game_chat)
                 return -1;
 
-        if (!gibbon_clip_reader_get_string (self->priv->clip_reader, &iter,
-                                            &sender))
-                return -1;
-
-        if (!gibbon_clip_reader_get_string (self->priv->clip_reader, &iter,
-                                            &message))
-                return -1;
-
-        fibs_message = gibbon_fibs_message_new (sender, message);
+        fibs_message = gibbon_fibs_message_new (chat->sender, chat->message);
 
         gibbon_game_chat_append_message (game_chat, fibs_message);
 
@@ -1352,26 +1474,16 @@ gibbon_session_clip_whispers (GibbonSession *self, GSList *iter)
 }
 
 static gint
-gibbon_session_clip_kibitzes (GibbonSession *self, GSList *iter)
+gibbon_session_clip_kibitzes (GibbonSession *self, const GibbonCLIPChat *chat)
 {
         GibbonFIBSMessage *fibs_message;
         GibbonGameChat *game_chat;
-        const gchar *sender;
-        const gchar *message;
 
         game_chat = gibbon_app_get_game_chat (self->priv->app);
         if (!game_chat)
                 return -1;
 
-        if (!gibbon_clip_reader_get_string (self->priv->clip_reader, &iter,
-                                            &sender))
-                return -1;
-
-        if (!gibbon_clip_reader_get_string (self->priv->clip_reader, &iter,
-                                            &message))
-                return -1;
-
-        fibs_message = gibbon_fibs_message_new (sender, message);
+        fibs_message = gibbon_fibs_message_new (chat->sender, chat->message);
 
         gibbon_game_chat_append_message (game_chat, fibs_message);
 
@@ -1528,8 +1640,9 @@ gibbon_session_clip_you_kibitz (GibbonSession *self, GSList *iter)
  * and rather rely on the explicit broken down values given at the end of
  * the board string because they are always positive.
  */
-static gboolean
-gibbon_session_handle_board (GibbonSession *self, GSList *iter)
+static gint
+gibbon_session_handle_board (GibbonSession *self,
+                             const GibbonCLIPBoard *record)
 {
         GibbonPosition *pos;
         GibbonBoard *board;
@@ -1538,9 +1651,8 @@ gibbon_session_handle_board (GibbonSession *self, GSList *iter)
         const gchar *login = NULL;
         const GibbonPosition *current;
 
-        pos = gibbon_position_copy (g_value_get_boxed (iter->data));
-        iter = iter->next;
-        self->priv->direction = g_value_get_boolean (iter->data);
+        pos = gibbon_position_copy (record->position);
+        self->priv->direction = record->direction;
 
         if (!g_strcmp0 ("You", pos->players[0])) {
                 connection = gibbon_app_get_connection (self->priv->app);
@@ -1883,21 +1995,13 @@ gibbon_session_handle_resume_match (GibbonSession *self, GSList *iter)
         return GIBBON_CLIP_RESUME_MATCH;
 }
 
-static gboolean
-gibbon_session_handle_rolls (GibbonSession *self, GSList *iter)
+static gint
+gibbon_session_handle_rolls (GibbonSession *self,
+                             const GibbonCLIPRolls *rolls)
 {
-        const gchar *who;
-        gint64 dice[2];
+        const gchar *who = rolls->who;
+        const gint *dice = rolls->dice;
         GibbonPosition *pos;
-        GibbonCLIPReader *clip_reader = self->priv->clip_reader;
-
-        if (!gibbon_clip_reader_get_string (clip_reader, &iter, &who))
-                return -1;
-
-        if (!gibbon_clip_reader_get_int64 (clip_reader, &iter, &dice[0]))
-                return -1;
-        if (!gibbon_clip_reader_get_int64 (clip_reader, &iter, &dice[1]))
-                return -1;
 
         if (0 == g_strcmp0 ("You", who)) {
                 self->priv->position->dice[0] = dice[0];
@@ -1940,7 +2044,8 @@ g_printerr ("updating tracker from %s:%d\n", __FILE__, __LINE__);
 }
 
 static gint
-gibbon_session_handle_moves (GibbonSession *self, GSList *iter)
+gibbon_session_handle_moves (GibbonSession *self,
+                             const GibbonCLIPMoves *moves)
 {
         GibbonMove *move;
         GibbonMovement *movement;
@@ -1952,12 +2057,9 @@ gibbon_session_handle_moves (GibbonSession *self, GSList *iter)
         guint num_moves;
         GibbonBoard *board;
         GibbonPosition *target_position;
-        GibbonCLIPReader *clip_reader = self->priv->clip_reader;
 
-        if (!gibbon_clip_reader_get_string (clip_reader, &iter, &player))
-                return -1;
-
-        num_moves = g_slist_length (iter) >> 1;
+        player = moves->who;
+        num_moves = moves->num_movements;
 
         if (g_strcmp0 (player, self->priv->opponent))
                 side = GIBBON_POSITION_SIDE_WHITE;
@@ -1968,16 +2070,8 @@ gibbon_session_handle_moves (GibbonSession *self, GSList *iter)
 
         for (i = 0; i < num_moves; ++i) {
                 movement = move->movements + move->number++;
-                if (!gibbon_clip_reader_get_int (clip_reader, &iter,
-                                                 &movement->from)) {
-                        g_object_unref (move);
-                        return -1;
-                }
-                if (!gibbon_clip_reader_get_int (clip_reader, &iter,
-                                                 &movement->to)) {
-                        g_object_unref (move);
-                        return -1;
-                }
+                movement->from = moves->movements[i].from;
+                movement->to = moves->movements[i].to;
         }
 
         pretty_move = gibbon_position_format_move (self->priv->position, move,
@@ -2062,11 +2156,10 @@ gibbon_session_handle_invitation (GibbonSession *self, GSList *iter)
 {
         const gchar *opponent;
         gint length;
-        GtkListStore *store;
         GtkTreeIter tree_iter;
         GibbonPlayerList *pl;
         gdouble rating = 1500.0;
-        guint experience = 0;
+        guint64 experience = 0;
         GibbonReliability *rel = NULL;
         gdouble reliability = 0;
         guint confidence = 0;
@@ -2093,12 +2186,11 @@ gibbon_session_handle_invitation (GibbonSession *self, GSList *iter)
                 return -1;
 
         pl = self->priv->player_list;
-        store = gibbon_player_list_get_store (pl);
 
-        g_return_val_if_fail (store != NULL, -1);
+        g_return_val_if_fail (pl != NULL, -1);
 
         if (gibbon_player_list_get_iter (pl, opponent, &tree_iter)) {
-                gtk_tree_model_get (GTK_TREE_MODEL (store), &tree_iter,
+                gtk_tree_model_get (GTK_TREE_MODEL (pl), &tree_iter,
                                     GIBBON_PLAYER_LIST_COL_RATING, &rating,
                                     GIBBON_PLAYER_LIST_COL_EXPERIENCE,
                                             &experience,
@@ -3681,10 +3773,9 @@ gibbon_session_start_playing (GibbonSession *self,
                               guint length, gboolean resumption)
 {
         gdouble rating;
-        guint experience;
+        guint64 experience;
         GibbonReliability *rel;
         GtkTreeIter tree_iter;
-        GtkListStore *store;
         gchar *rank;
 
         if (self->priv->tracker)
@@ -3692,11 +3783,10 @@ gibbon_session_start_playing (GibbonSession *self,
         self->priv->tracker = gibbon_match_tracker_new (player, opponent,
                                                         length, resumption);
 
-        store = gibbon_player_list_get_store (self->priv->player_list);
-
         if (gibbon_player_list_get_iter (self->priv->player_list, player,
                                          &tree_iter)) {
-                gtk_tree_model_get (GTK_TREE_MODEL (store), &tree_iter,
+                gtk_tree_model_get (GTK_TREE_MODEL (self->priv->player_list),
+                                    &tree_iter,
                                     GIBBON_PLAYER_LIST_COL_RATING, &rating,
                                     GIBBON_PLAYER_LIST_COL_EXPERIENCE,
                                             &experience,
@@ -3705,12 +3795,14 @@ gibbon_session_start_playing (GibbonSession *self,
                                     -1);
 
                 if (rel && rel->confidence) {
-                        rank = g_strdup_printf ("%f %u (FIBS), %f %u (Gibbon)",
-                                                 rating, experience,
+                        rank = g_strdup_printf ("%f %llu (FIBS), %f %u (Gibbon)",
+                                                 rating,
+                                                 (unsigned long long) experience,
                                                  rel->value, rel->confidence);
                 } else {
-                        rank = g_strdup_printf ("%f %u (FIBS)",
-                                                 rating, experience);
+                        rank = g_strdup_printf ("%f %llu (FIBS)",
+                                                 rating,
+                                                 (unsigned long long) experience);
                 }
 
                 gibbon_match_tracker_store_rank (self->priv->tracker, rank,
@@ -3722,7 +3814,8 @@ gibbon_session_start_playing (GibbonSession *self,
 
         if (gibbon_player_list_get_iter (self->priv->player_list, opponent,
                                          &tree_iter)) {
-                gtk_tree_model_get (GTK_TREE_MODEL (store), &tree_iter,
+                gtk_tree_model_get (GTK_TREE_MODEL (self->priv->player_list),
+                                    &tree_iter,
                                     GIBBON_PLAYER_LIST_COL_RATING, &rating,
                                     GIBBON_PLAYER_LIST_COL_EXPERIENCE,
                                             &experience,
@@ -3731,12 +3824,14 @@ gibbon_session_start_playing (GibbonSession *self,
                                     -1);
 
                 if (rel && rel->confidence) {
-                        rank = g_strdup_printf ("%f %u (FIBS), %f %u (Gibbon)",
-                                                 rating, experience,
+                        rank = g_strdup_printf ("%f %llu (FIBS), %f %u (Gibbon)",
+                                                 rating,
+                                                 (unsigned long long) experience,
                                                  rel->value, rel->confidence);
                 } else {
-                        rank = g_strdup_printf ("%f %u (FIBS)",
-                                                 rating, experience);
+                        rank = g_strdup_printf ("%f %llu (FIBS)",
+                                                 rating,
+                                                 (unsigned long long) experience);
                 }
 
                 gibbon_match_tracker_store_rank (self->priv->tracker, rank,
@@ -49,6 +49,8 @@
 #define GIBBON_PREFS_MATCH_AUTO_SWAP "auto-swap"
 #define GIBBON_PREFS_MATCH_LENGTH "length"
 #define GIBBON_PREFS_MATCH_SHOW_EQUITY "show-equity"
+#define GIBBON_PREFS_MATCH_JOURNAL_INTERVAL "journal-interval"
+#define GIBBON_PREFS_MATCH_JOURNAL_SYNC "journal-sync"
 
 #define GIBBON_DATA_SCHEMA GIBBON_SCHEMA ".data"
 
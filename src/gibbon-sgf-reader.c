@@ -60,8 +60,6 @@ struct _GibbonSGFReaderPrivate {
         gint64 timestamp;
 };
 
-GibbonSGFReader *_gibbon_sgf_reader_instance = NULL;
-
 #define GIBBON_SGF_READER_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
         GIBBON_TYPE_SGF_READER, GibbonSGFReaderPrivate))
 
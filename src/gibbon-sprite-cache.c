@@ -0,0 +1,356 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gibbon-sprite-cache
+ * @short_description: Pre-rasterized SVG components.
+ *
+ * Since: 0.2.0
+ *
+ * Rendering a #svg_component walks its complete libsvg render tree.
+ * The sprite cache does that once for every component and scale, and
+ * paints the resulting surface afterwards.
+ *
+ * Components whose appearance depends on a text that is changed before
+ * drawing, like the cube value, must be drawn with a different variant
+ * name for every text.
+ *
+ * The total size of all sprites is limited.  When the limit is exceeded,
+ * the least recently used sprites are discarded.
+ */
+
+#include <math.h>
+
+#include <glib.h>
+
+#include "gibbon-sprite-cache.h"
+
+typedef struct _GibbonSprite GibbonSprite;
+struct _GibbonSprite {
+        const struct svg_component *svg;
+        gchar *variant;
+        gdouble scale;
+        gdouble device_scale;
+
+        cairo_surface_t *surface;
+        gsize size;
+
+        /* Our link in the LRU list.  */
+        GList *link;
+};
+
+struct _GibbonSpriteCache {
+        /* Each sprite is used as its own key.  */
+        GHashTable *sprites;
+
+        /* Most recently used sprites first.  */
+        GQueue *lru;
+
+        gsize size;
+        gsize max_size;
+};
+
+static guint gibbon_sprite_hash (gconstpointer key);
+static gboolean gibbon_sprite_equal (gconstpointer a, gconstpointer b);
+static void gibbon_sprite_free (gpointer data);
+static void gibbon_sprite_cache_setup_key (GibbonSprite *key, cairo_t *cr,
+                                           const struct svg_component *svg,
+                                           const gchar *variant);
+static GibbonSprite *gibbon_sprite_cache_render (GibbonSpriteCache *self,
+                                                 cairo_t *cr,
+                                                 const GibbonSprite *key);
+static void gibbon_sprite_cache_expire (GibbonSpriteCache *self);
+
+/**
+ * gibbon_sprite_cache_new:
+ * @max_size: Maximum total size of all sprites in bytes.
+ *
+ * Creates a new, empty sprite cache.
+ *
+ * Returns: The new #GibbonSpriteCache, free it with
+ *          gibbon_sprite_cache_free().
+ */
+GibbonSpriteCache *
+gibbon_sprite_cache_new (gsize max_size)
+{
+        GibbonSpriteCache *self = g_malloc0 (sizeof *self);
+
+        self->sprites = g_hash_table_new_full (gibbon_sprite_hash,
+                                               gibbon_sprite_equal,
+                                               NULL, gibbon_sprite_free);
+        self->lru = g_queue_new ();
+        self->max_size = max_size;
+
+        return self;
+}
+
+/**
+ * gibbon_sprite_cache_free:
+ * @self: The #GibbonSpriteCache or %NULL.
+ *
+ * Frees all resources associated with @self.
+ */
+void
+gibbon_sprite_cache_free (GibbonSpriteCache *self)
+{
+        if (!self)
+                return;
+
+        g_hash_table_destroy (self->sprites);
+        g_queue_free (self->lru);
+        g_free (self);
+}
+
+/**
+ * gibbon_sprite_cache_clear:
+ * @self: The #GibbonSpriteCache.
+ *
+ * Discards all sprites.  This has to be called, when the components
+ * themselves have changed.
+ */
+void
+gibbon_sprite_cache_clear (GibbonSpriteCache *self)
+{
+        g_return_if_fail (self != NULL);
+
+        g_hash_table_remove_all (self->sprites);
+        g_queue_clear (self->lru);
+        self->size = 0;
+}
+
+/**
+ * gibbon_sprite_cache_get_size:
+ * @self: The #GibbonSpriteCache.
+ *
+ * Returns: The total size of all cached sprites in bytes.
+ */
+gsize
+gibbon_sprite_cache_get_size (const GibbonSpriteCache *self)
+{
+        g_return_val_if_fail (self != NULL, 0);
+
+        return self->size;
+}
+
+/**
+ * gibbon_sprite_cache_contains:
+ * @self: The #GibbonSpriteCache.
+ * @cr: The cairo context that the sprite would be drawn to.
+ * @svg: The component.
+ * @variant: The variant name or %NULL.
+ *
+ * Checks whether drawing @svg to @cr can be done without rendering it.
+ * If not, the caller must prepare @svg for rendering before calling
+ * gibbon_sprite_cache_draw().
+ *
+ * Returns: %TRUE if there is a matching sprite, %FALSE otherwise.
+ */
+gboolean
+gibbon_sprite_cache_contains (GibbonSpriteCache *self, cairo_t *cr,
+                              const struct svg_component *svg,
+                              const gchar *variant)
+{
+        GibbonSprite key;
+
+        g_return_val_if_fail (self != NULL, FALSE);
+        g_return_val_if_fail (cr != NULL, FALSE);
+        g_return_val_if_fail (svg != NULL, FALSE);
+
+        gibbon_sprite_cache_setup_key (&key, cr, svg, variant);
+
+        return g_hash_table_lookup (self->sprites, &key) != NULL;
+}
+
+/**
+ * gibbon_sprite_cache_draw:
+ * @self: The #GibbonSpriteCache.
+ * @cr: The cairo context to draw to.
+ * @svg: The component to draw.
+ * @variant: The variant name or %NULL.
+ * @x: Horizontal position of the center of @svg in user space.
+ * @y: Vertical position of the center of @svg in user space.
+ *
+ * Paints @svg so that its center is at @x and @y, rounded to the
+ * nearest pixel.  The component is rendered into a new sprite only if
+ * there is no matching one yet.
+ */
+void
+gibbon_sprite_cache_draw (GibbonSpriteCache *self, cairo_t *cr,
+                          const struct svg_component *svg,
+                          const gchar *variant,
+                          gdouble x, gdouble y)
+{
+        GibbonSprite key;
+        GibbonSprite *sprite;
+
+        g_return_if_fail (self != NULL);
+        g_return_if_fail (cr != NULL);
+        g_return_if_fail (svg != NULL);
+
+        gibbon_sprite_cache_setup_key (&key, cr, svg, variant);
+
+        sprite = g_hash_table_lookup (self->sprites, &key);
+        if (sprite) {
+                g_queue_unlink (self->lru, sprite->link);
+                g_queue_push_head_link (self->lru, sprite->link);
+        } else {
+                sprite = gibbon_sprite_cache_render (self, cr, &key);
+                gibbon_sprite_cache_expire (self);
+        }
+
+        x -= svg->width / 2;
+        y -= svg->height / 2;
+        cairo_user_to_device (cr, &x, &y);
+
+        /* The sprite has a margin of one pixel for antialiasing.  */
+        cairo_save (cr);
+        cairo_identity_matrix (cr);
+        cairo_set_source_surface (cr, sprite->surface,
+                                  floor (x + 0.5) - 1, floor (y + 0.5) - 1);
+        cairo_paint (cr);
+        cairo_restore (cr);
+}
+
+static void
+gibbon_sprite_cache_setup_key (GibbonSprite *key, cairo_t *cr,
+                               const struct svg_component *svg,
+                               const gchar *variant)
+{
+        cairo_matrix_t matrix;
+        gdouble x_scale = 1, y_scale = 1;
+
+        /* The board is never rotated.  */
+        cairo_get_matrix (cr, &matrix);
+
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE (1, 14, 0)
+        cairo_surface_get_device_scale (cairo_get_target (cr),
+                                        &x_scale, &y_scale);
+#endif
+
+        key->svg = svg;
+        key->variant = (gchar *) variant;
+        key->scale = matrix.xx;
+        key->device_scale = x_scale;
+}
+
+static GibbonSprite *
+gibbon_sprite_cache_render (GibbonSpriteCache *self, cairo_t *cr,
+                            const GibbonSprite *key)
+{
+        GibbonSprite *sprite = g_malloc0 (sizeof *sprite);
+        const struct svg_component *svg = key->svg;
+        gint width, height;
+        gdouble pixels;
+        cairo_t *scr;
+
+        sprite->svg = svg;
+        sprite->variant = g_strdup (key->variant);
+        sprite->scale = key->scale;
+        sprite->device_scale = key->device_scale;
+
+        width = ceil (svg->width * key->scale) + 2;
+        height = ceil (svg->height * key->scale) + 2;
+
+        /*
+         * The surface inherits the device scale of the target, so that
+         * the sprite is rendered at the full resolution of the output.
+         */
+        sprite->surface =
+                cairo_surface_create_similar (cairo_get_target (cr),
+                                              CAIRO_CONTENT_COLOR_ALPHA,
+                                              width, height);
+        pixels = width * key->device_scale * height * key->device_scale;
+        sprite->size = 4 * pixels;
+
+        scr = cairo_create (sprite->surface);
+        cairo_translate (scr, 1, 1);
+        cairo_scale (scr, key->scale, key->scale);
+        cairo_translate (scr, -svg->x, -svg->y);
+        svg_cairo_render (svg->scr, scr);
+        cairo_destroy (scr);
+
+        g_hash_table_insert (self->sprites, sprite, sprite);
+        g_queue_push_head (self->lru, sprite);
+        sprite->link = g_queue_peek_head_link (self->lru);
+        self->size += sprite->size;
+
+        return sprite;
+}
+
+/*
+ * Discard the least recently used sprites until the cache is small enough.
+ * The sprite that has just been used is always retained, even if it is
+ * bigger than the limit.
+ */
+static void
+gibbon_sprite_cache_expire (GibbonSpriteCache *self)
+{
+        GibbonSprite *sprite;
+
+        while (self->size > self->max_size
+               && g_queue_get_length (self->lru) > 1) {
+                sprite = g_queue_pop_tail (self->lru);
+                self->size -= sprite->size;
+                g_hash_table_remove (self->sprites, sprite);
+        }
+}
+
+static guint
+gibbon_sprite_hash (gconstpointer key)
+{
+        const GibbonSprite *sprite = key;
+        guint hash;
+
+        hash = g_direct_hash (sprite->svg);
+        if (sprite->variant)
+                hash = 31 * hash + g_str_hash (sprite->variant);
+        hash = 31 * hash + g_double_hash (&sprite->scale);
+        hash = 31 * hash + g_double_hash (&sprite->device_scale);
+
+        return hash;
+}
+
+static gboolean
+gibbon_sprite_equal (gconstpointer a, gconstpointer b)
+{
+        const GibbonSprite *sa = a;
+        const GibbonSprite *sb = b;
+
+        if (sa->svg != sb->svg)
+                return FALSE;
+        if (sa->scale != sb->scale)
+                return FALSE;
+        if (sa->device_scale != sb->device_scale)
+                return FALSE;
+        if (!sa->variant || !sb->variant)
+                return sa->variant == sb->variant;
+
+        return g_strcmp0 (sa->variant, sb->variant) == 0;
+}
+
+static void
+gibbon_sprite_free (gpointer data)
+{
+        GibbonSprite *sprite = data;
+
+        if (sprite->surface)
+                cairo_surface_destroy (sprite->surface);
+        g_free (sprite->variant);
+        g_free (sprite);
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GIBBON_SPRITE_CACHE_H
+# define _GIBBON_SPRITE_CACHE_H
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+#include <cairo.h>
+
+#include "svg-util.h"
+
+G_BEGIN_DECLS
+
+/**
+ * GibbonSpriteCache:
+ *
+ * Rasterized images of SVG components, keyed by the component, an
+ * optional variant name, and the scale they were rendered at.  All members
+ * are private.
+ */
+typedef struct _GibbonSpriteCache GibbonSpriteCache;
+
+GibbonSpriteCache *gibbon_sprite_cache_new (gsize max_size);
+void gibbon_sprite_cache_free (GibbonSpriteCache *self);
+void gibbon_sprite_cache_clear (GibbonSpriteCache *self);
+gsize gibbon_sprite_cache_get_size (const GibbonSpriteCache *self);
+gboolean gibbon_sprite_cache_contains (GibbonSpriteCache *self, cairo_t *cr,
+                                       const struct svg_component *svg,
+                                       const gchar *variant);
+void gibbon_sprite_cache_draw (GibbonSpriteCache *self, cairo_t *cr,
+                               const struct svg_component *svg,
+                               const gchar *variant,
+                               gdouble x, gdouble y);
+
+G_END_DECLS
+
+#endif
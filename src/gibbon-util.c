@@ -18,6 +18,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <glib-object.h>
 #include <glib/gi18n.h>
@@ -401,6 +402,140 @@ gibbon_slurp_file (const gchar *path, char **buffer, gsize *bytes_read_out,
         return TRUE;
 }
 
+/* 32 bit FNV-1a.  */
+guint32
+gibbon_checksum (gconstpointer data, gsize size)
+{
+        const guchar *ptr = data;
+        const guchar *end = ptr + size;
+        guint32 hash = 2166136261U;
+
+        while (ptr < end) {
+                hash ^= *ptr++;
+                hash *= 16777619U;
+        }
+
+        return hash;
+}
+
+/**
+ * gibbon_save_checked_file:
+ * @path: The output file.
+ * @magic: The eight bytes identifying the file format.
+ * @version: The version of the file format.
+ * @contents: The complete file, starting with a #GibbonFileHeader.
+ * @length: The size of @contents in bytes.
+ * @error: Location to store errors or %NULL.
+ *
+ * Fills in the #GibbonFileHeader at the beginning of @contents and writes
+ * @contents into @path.  The checksum covers everything following the
+ * #GibbonFileHeader.  The file is replaced atomically so that a
+ * concurrently running instance never maps a half-written file.
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_save_checked_file (const gchar *path, const gchar *magic,
+                          guint32 version, gchar *contents, gsize length,
+                          GError **error)
+{
+        GibbonFileHeader *header = (GibbonFileHeader *) contents;
+
+        gibbon_return_val_if_fail (path != NULL, FALSE, error);
+        gibbon_return_val_if_fail (magic != NULL, FALSE, error);
+        gibbon_return_val_if_fail (contents != NULL, FALSE, error);
+        gibbon_return_val_if_fail (length >= sizeof *header, FALSE, error);
+
+        memcpy (header->magic, magic, sizeof header->magic);
+        header->version = GUINT32_TO_LE (version);
+        header->checksum = GUINT32_TO_LE (gibbon_checksum (header + 1,
+                                                           length
+                                                           - sizeof *header));
+
+        return g_file_set_contents (path, contents, length, error);
+}
+
+/**
+ * gibbon_map_checked_file:
+ * @path: The file to map.
+ * @magic: The eight bytes identifying the file format.
+ * @version: The expected version of the file format.
+ * @header_size: The minimum size of the file, normally the size of the
+ *               format specific header that starts with a
+ *               #GibbonFileHeader.
+ * @verify: %TRUE if the checksum should be verified as well.
+ * @error: Location to store errors or %NULL.
+ *
+ * Memory-maps a file written by gibbon_save_checked_file() and checks
+ * the magic, the version and the size.  Verifying the checksum reads the
+ * complete file.  Pass %FALSE for @verify if that should be deferred with
+ * gibbon_verify_checked_file().
+ *
+ * Returns: The #GMappedFile or %NULL in case of failure.
+ */
+GMappedFile *
+gibbon_map_checked_file (const gchar *path, const gchar *magic,
+                         guint32 version, gsize header_size, gboolean verify,
+                         GError **error)
+{
+        GMappedFile *mapped;
+        const GibbonFileHeader *header;
+
+        gibbon_return_val_if_fail (path != NULL, NULL, error);
+        gibbon_return_val_if_fail (magic != NULL, NULL, error);
+        gibbon_return_val_if_fail (header_size >= sizeof *header, NULL,
+                                   error);
+
+        mapped = g_mapped_file_new (path, FALSE, error);
+        if (!mapped)
+                return NULL;
+
+        header = (const GibbonFileHeader *)
+                        g_mapped_file_get_contents (mapped);
+        if (g_mapped_file_get_length (mapped) < header_size
+            || memcmp (header->magic, magic, sizeof header->magic)
+            || GUINT32_FROM_LE (header->version) != version) {
+                g_set_error (error, GIBBON_ERROR, -1,
+                             _("`%s' has an unknown file format!"), path);
+                g_mapped_file_unref (mapped);
+                return NULL;
+        }
+
+        if (verify && !gibbon_verify_checked_file (mapped)) {
+                g_set_error (error, GIBBON_ERROR, -1,
+                             _("File `%s' is corrupted!"), path);
+                g_mapped_file_unref (mapped);
+                return NULL;
+        }
+
+        return mapped;
+}
+
+/**
+ * gibbon_verify_checked_file:
+ * @mapped: A #GMappedFile returned by gibbon_map_checked_file().
+ *
+ * Compares the checksum in the #GibbonFileHeader with the file contents.
+ *
+ * Returns: %TRUE if the file is intact, %FALSE otherwise.
+ */
+gboolean
+gibbon_verify_checked_file (GMappedFile *mapped)
+{
+        const GibbonFileHeader *header;
+        gsize length;
+
+        g_return_val_if_fail (mapped != NULL, FALSE);
+
+        length = g_mapped_file_get_length (mapped);
+        header = (const GibbonFileHeader *)
+                        g_mapped_file_get_contents (mapped);
+        g_return_val_if_fail (length >= sizeof *header, FALSE);
+
+        return GUINT32_FROM_LE (header->checksum)
+                == gibbon_checksum (header + 1, length - sizeof *header);
+}
+
 GQuark
 gibbon_error_quark (void)
 {
@@ -46,6 +46,25 @@ GQuark gibbon_error_quark (void);
              return (val);                                                   \
      };                               }G_STMT_END
 
+/**
+ * GibbonFileHeader:
+ * @magic: Eight bytes identifying the file format.
+ * @version: The version of the file format.
+ * @checksum: 32 bit FNV-1a hash of everything following the header.
+ *
+ * Common header of the binary data files written with
+ * gibbon_save_checked_file().  The format specific header follows
+ * immediately.  The numbers in the common header are stored in
+ * little-endian byte order, the byte order of the rest is up to the
+ * file format.
+ */
+typedef struct _GibbonFileHeader GibbonFileHeader;
+struct _GibbonFileHeader {
+        gchar magic[8];
+        guint32 version;
+        guint32 checksum;
+};
+
 enum GibbonClientType {
         GibbonClientUnknown = 0,
         GibbonClientGibbon = 1,
@@ -87,6 +106,15 @@ gint gibbon_compare_uint_column (GtkTreeModel *model,
                                  gpointer user_data);
 gboolean gibbon_debug (const gchar *realm);
 
+guint32 gibbon_checksum (gconstpointer data, gsize size);
+gboolean gibbon_save_checked_file (const gchar *path, const gchar *magic,
+                                   guint32 version, gchar *contents,
+                                   gsize length, GError **error);
+GMappedFile *gibbon_map_checked_file (const gchar *path, const gchar *magic,
+                                      guint32 version, gsize header_size,
+                                      gboolean verify, GError **error);
+gboolean gibbon_verify_checked_file (GMappedFile *mapped);
+
 G_END_DECLS
 
 #endif
@@ -0,0 +1,252 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <gibbon-bearoff.h>
+
+#define EPSILON 0.0001
+
+static gboolean test_lookup (const GibbonBearoff *bearoff);
+static gboolean test_race (const GibbonBearoff *bearoff);
+static gboolean test_save_and_load (const GibbonBearoff *bearoff);
+static gboolean check_value (const gchar *what, gdouble got, gdouble expect);
+
+int
+main(int argc, char *argv[])
+{
+        int status = 0;
+        GibbonBearoff *bearoff;
+
+        g_type_init ();
+
+        bearoff = gibbon_bearoff_new ();
+
+        if (!test_lookup (bearoff))
+                status = -1;
+        if (!test_race (bearoff))
+                status = -1;
+        if (!test_save_and_load (bearoff))
+                status = -1;
+
+        gibbon_bearoff_free (bearoff);
+
+        return status;
+}
+
+static gboolean
+test_lookup (const GibbonBearoff *bearoff)
+{
+        GibbonPosition *pos = gibbon_position_new ();
+        gdouble dist[GIBBON_BEAROFF_MAX_ROLLS];
+        gboolean retval = TRUE;
+
+        /* The initial position is not a bearoff position.  */
+        if (gibbon_bearoff_get_expected_rolls (bearoff, pos,
+                                               GIBBON_POSITION_SIDE_WHITE)
+            >= 0.0) {
+                g_printerr ("Initial position found in bearoff database.\n");
+                retval = FALSE;
+        }
+
+        memset (pos->points, 0, sizeof pos->points);
+
+        /* Every roll bears off a single checker from the ace point.  */
+        pos->points[0] = 1;
+        if (!check_value ("One checker on the ace point",
+                          gibbon_bearoff_get_expected_rolls (bearoff, pos,
+                                                   GIBBON_POSITION_SIDE_WHITE),
+                          1.0))
+                retval = FALSE;
+
+        /*
+         * A single checker on the six point is off in one roll with a
+         * total of six or more (22 rolls) or with doubles from 2-2 on
+         * (5 rolls).
+         */
+        pos->points[0] = 0;
+        pos->points[5] = 1;
+        if (!gibbon_bearoff_get_distribution (bearoff, pos,
+                                              GIBBON_POSITION_SIDE_WHITE,
+                                              dist)) {
+                g_printerr ("No distribution for one checker on 6.\n");
+                retval = FALSE;
+        } else {
+                if (!check_value ("One checker on 6 in 1 roll", dist[1],
+                                  27.0 / 36.0))
+                        retval = FALSE;
+                if (!check_value ("One checker on 6 in 2 rolls", dist[2],
+                                  9.0 / 36.0))
+                        retval = FALSE;
+        }
+
+        /* The same for black.  */
+        pos->points[5] = 0;
+        pos->points[18] = -1;
+        if (!check_value ("One black checker on 6",
+                          gibbon_bearoff_get_expected_rolls (bearoff, pos,
+                                                   GIBBON_POSITION_SIDE_BLACK),
+                          1.25))
+                retval = FALSE;
+
+        /* Black has borne off all checkers.  */
+        pos->points[18] = 0;
+        if (!check_value ("No black checkers",
+                          gibbon_bearoff_get_expected_rolls (bearoff, pos,
+                                                   GIBBON_POSITION_SIDE_BLACK),
+                          0.0))
+                retval = FALSE;
+
+        pos->bar[1] = 1;
+        if (gibbon_bearoff_get_expected_rolls (bearoff, pos,
+                                               GIBBON_POSITION_SIDE_BLACK)
+            >= 0.0) {
+                g_printerr ("Checker on the bar found in bearoff database.\n");
+                retval = FALSE;
+        }
+
+        gibbon_position_free (pos);
+
+        return retval;
+}
+
+static gboolean
+test_race (const GibbonBearoff *bearoff)
+{
+        GibbonPosition *pos = gibbon_position_new ();
+        gdouble p;
+        gboolean retval = TRUE;
+
+        memset (pos->points, 0, sizeof pos->points);
+        pos->points[5] = 1;
+        pos->points[23] = -1;
+
+        pos->turn = GIBBON_POSITION_SIDE_WHITE;
+        if (!gibbon_bearoff_get_win_probability (bearoff, pos, &p)) {
+                g_printerr ("Race not found in bearoff database.\n");
+                retval = FALSE;
+        } else if (!check_value ("White on roll", p, 27.0 / 36.0)) {
+                retval = FALSE;
+        }
+
+        pos->turn = GIBBON_POSITION_SIDE_BLACK;
+        if (!gibbon_bearoff_get_win_probability (bearoff, pos, &p)) {
+                g_printerr ("Race not found in bearoff database.\n");
+                retval = FALSE;
+        } else if (!check_value ("Black on roll", p, 1.0)) {
+                retval = FALSE;
+        }
+
+        gibbon_position_free (pos);
+
+        return retval;
+}
+
+static gboolean
+test_save_and_load (const GibbonBearoff *bearoff)
+{
+        GibbonBearoff *loaded;
+        GibbonPosition *pos;
+        GError *error = NULL;
+        gchar *path;
+        gint fd;
+        gboolean retval = TRUE;
+
+        fd = g_file_open_tmp ("test-bearoff-XXXXXX", &path, &error);
+        if (fd < 0) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+        close (fd);
+
+        if (!gibbon_bearoff_save (bearoff, path, &error)) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                (void) g_unlink (path);
+                g_free (path);
+                return FALSE;
+        }
+
+        loaded = gibbon_bearoff_load (path, &error);
+        if (!loaded) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                retval = FALSE;
+        } else {
+                if (gibbon_bearoff_get_num_positions (loaded)
+                    != gibbon_bearoff_get_num_positions (bearoff)) {
+                        g_printerr ("Loaded database has wrong size.\n");
+                        retval = FALSE;
+                }
+                pos = gibbon_position_new ();
+                if (!check_value ("Loaded initial bearoff",
+                                  gibbon_bearoff_get_expected_rolls (loaded,
+                                                pos,
+                                                GIBBON_POSITION_SIDE_WHITE),
+                                  -1.0))
+                        retval = FALSE;
+                memset (pos->points, 0, sizeof pos->points);
+                pos->points[0] = 3;
+                pos->points[2] = 4;
+                pos->points[5] = 8;
+                if (!check_value ("Loaded 15 checkers",
+                                  gibbon_bearoff_get_expected_rolls (loaded,
+                                                pos,
+                                                GIBBON_POSITION_SIDE_WHITE),
+                                  gibbon_bearoff_get_expected_rolls (bearoff,
+                                                pos,
+                                                GIBBON_POSITION_SIDE_WHITE)))
+                        retval = FALSE;
+                gibbon_position_free (pos);
+                if (!test_lookup (loaded))
+                        retval = FALSE;
+                if (!gibbon_bearoff_verify (loaded, &error)) {
+                        g_printerr ("%s\n", error->message);
+                        g_error_free (error);
+                        error = NULL;
+                        retval = FALSE;
+                }
+                gibbon_bearoff_free (loaded);
+        }
+
+        (void) g_unlink (path);
+        g_free (path);
+
+        return retval;
+}
+
+static gboolean
+check_value (const gchar *what, gdouble got, gdouble expect)
+{
+        if (got < expect - EPSILON || got > expect + EPSILON) {
+                g_printerr ("%s: expected %f, got %f.\n", what, expect, got);
+                return FALSE;
+        }
+
+        return TRUE;
+}
@@ -310,6 +310,7 @@ check_match (const GibbonMatch *match)
         const gchar *expect;
         gint expect_int, got_int;
         const GibbonPosition *pos;
+        const GibbonGame *game;
 
         pos = gibbon_match_get_current_position (match);
         g_return_val_if_fail (pos != NULL, FALSE);
@@ -348,5 +349,35 @@ check_match (const GibbonMatch *match)
                 retval = FALSE;
         }
 
+        /* Earlier positions are unpacked on demand.  */
+        game = gibbon_match_get_nth_game (match, 0);
+        pos = gibbon_game_get_nth_position (game, 1);
+        g_return_val_if_fail (pos != NULL, FALSE);
+        if (pos->points[4] != 2 || pos->points[5] != 4 || pos->points[7] != 2) {
+                g_printerr ("Wrong checker distribution after 8/5 6/5!\n");
+                retval = FALSE;
+        }
+        got = pos->players[0];
+        expect = "Snow White";
+        if (g_strcmp0 (expect, got)) {
+                g_printerr ("Expected `%s', got `%s'!\n", expect, got);
+                retval = FALSE;
+        }
+
+        game = gibbon_match_get_nth_game (match, 1);
+        pos = gibbon_game_get_nth_position (game, 5);
+        g_return_val_if_fail (pos != NULL, FALSE);
+        if (2 != pos->cube) {
+                g_printerr ("Expected cube value %u after take, got %llu!\n",
+                            2, (unsigned long long) pos->cube);
+                retval = FALSE;
+        }
+        got = pos->status;
+        expect = "Joe Black offers a double.";
+        if (g_strcmp0 (expect, got)) {
+                g_printerr ("Expected status `%s', got `%s'!\n", expect, got);
+                retval = FALSE;
+        }
+
         return retval;
 }
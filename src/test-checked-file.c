@@ -0,0 +1,300 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <gibbon-util.h>
+
+#define TEST_MAGIC "GibbonTT"
+#define TEST_VERSION 3
+
+typedef struct _TestHeader TestHeader;
+struct _TestHeader {
+        GibbonFileHeader file;
+        guint32 num_records;
+};
+
+static gboolean test_checksum (void);
+static gboolean test_save_and_map (const gchar *path);
+static gboolean test_corruption (const gchar *path);
+static gboolean test_rejection (const gchar *path);
+static gboolean write_test_file (const gchar *path);
+static gboolean damage_test_file (const gchar *path, gsize length, gsize bit);
+
+int
+main(int argc, char *argv[])
+{
+        int status = 0;
+        GError *error = NULL;
+        gchar *path;
+        gint fd;
+
+        g_type_init ();
+
+        if (!test_checksum ())
+                status = -1;
+
+        fd = g_file_open_tmp ("test-checked-file-XXXXXX", &path, &error);
+        if (fd < 0) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return -1;
+        }
+        close (fd);
+
+        if (!test_save_and_map (path))
+                status = -1;
+        if (!test_corruption (path))
+                status = -1;
+        if (!test_rejection (path))
+                status = -1;
+
+        (void) g_unlink (path);
+        g_free (path);
+
+        return status;
+}
+
+static gboolean
+test_checksum (void)
+{
+        gboolean retval = TRUE;
+
+        /* Reference values of 32 bit FNV-1a.  */
+        if (gibbon_checksum ("", 0) != 0x811c9dc5U) {
+                g_printerr ("Wrong checksum for empty input.\n");
+                retval = FALSE;
+        }
+        if (gibbon_checksum ("a", 1) != 0xe40c292cU) {
+                g_printerr ("Wrong checksum for `a'.\n");
+                retval = FALSE;
+        }
+        if (gibbon_checksum ("foobar", 6) != 0xbf9cf968U) {
+                g_printerr ("Wrong checksum for `foobar'.\n");
+                retval = FALSE;
+        }
+
+        return retval;
+}
+
+/*
+ * Writes a file with a header and three records.
+ */
+static gboolean
+write_test_file (const gchar *path)
+{
+        TestHeader *header;
+        guint32 *records;
+        gchar *buffer;
+        gsize length;
+        GError *error = NULL;
+        gboolean retval;
+
+        length = sizeof *header + 3 * sizeof *records;
+        buffer = g_malloc0 (length);
+        header = (TestHeader *) buffer;
+        header->num_records = 3;
+        records = (guint32 *) (header + 1);
+        records[0] = 2304;
+        records[1] = 1;
+        records[2] = 42;
+
+        retval = gibbon_save_checked_file (path, TEST_MAGIC, TEST_VERSION,
+                                           buffer, length, &error);
+        g_free (buffer);
+        if (!retval) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+        }
+
+        return retval;
+}
+
+/*
+ * Replaces the file contents with the first length bytes and flips the
+ * given bit.
+ */
+static gboolean
+damage_test_file (const gchar *path, gsize length, gsize bit)
+{
+        gchar *contents;
+        gsize size;
+        GError *error = NULL;
+        gboolean retval;
+
+        if (!g_file_get_contents (path, &contents, &size, &error)) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+
+        if (length > size)
+                length = size;
+        if (bit < 8 * length)
+                contents[bit >> 3] ^= 1 << (bit & 7);
+
+        retval = g_file_set_contents (path, contents, length, &error);
+        g_free (contents);
+        if (!retval) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+        }
+
+        return retval;
+}
+
+static gboolean
+test_save_and_map (const gchar *path)
+{
+        GMappedFile *mapped;
+        const TestHeader *header;
+        GError *error = NULL;
+        gboolean retval = TRUE;
+
+        if (!write_test_file (path))
+                return FALSE;
+
+        mapped = gibbon_map_checked_file (path, TEST_MAGIC, TEST_VERSION,
+                                          sizeof *header, TRUE, &error);
+        if (!mapped) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+
+        header = (const TestHeader *) g_mapped_file_get_contents (mapped);
+        if (g_mapped_file_get_length (mapped)
+            != sizeof *header + 3 * sizeof (guint32)) {
+                g_printerr ("Mapped file has wrong size.\n");
+                retval = FALSE;
+        } else if (header->num_records != 3
+                   || ((const guint32 *) (header + 1))[2] != 42) {
+                g_printerr ("Mapped file has wrong contents.\n");
+                retval = FALSE;
+        }
+
+        if (!gibbon_verify_checked_file (mapped)) {
+                g_printerr ("Intact file not verified.\n");
+                retval = FALSE;
+        }
+
+        g_mapped_file_unref (mapped);
+
+        return retval;
+}
+
+static gboolean
+test_corruption (const gchar *path)
+{
+        GMappedFile *mapped;
+        gsize length = sizeof (TestHeader) + 3 * sizeof (guint32);
+        gboolean retval = TRUE;
+
+        /*
+         * Flip one bit in the last record and one in the format specific
+         * header.  A deferred check has to accept the file, but the
+         * checksum must detect the damage.
+         */
+        if (!write_test_file (path)
+            || !damage_test_file (path, length, 8 * length - 3))
+                return FALSE;
+
+        mapped = gibbon_map_checked_file (path, TEST_MAGIC, TEST_VERSION,
+                                          sizeof (TestHeader), FALSE, NULL);
+        if (!mapped) {
+                g_printerr ("File with valid header rejected.\n");
+                retval = FALSE;
+        } else {
+                if (gibbon_verify_checked_file (mapped)) {
+                        g_printerr ("Corrupted record accepted.\n");
+                        retval = FALSE;
+                }
+                g_mapped_file_unref (mapped);
+        }
+
+        mapped = gibbon_map_checked_file (path, TEST_MAGIC, TEST_VERSION,
+                                          sizeof (TestHeader), TRUE, NULL);
+        if (mapped) {
+                g_printerr ("Corrupted record accepted by verifying map.\n");
+                g_mapped_file_unref (mapped);
+                retval = FALSE;
+        }
+
+        if (!write_test_file (path)
+            || !damage_test_file (path, length,
+                                  8 * sizeof (GibbonFileHeader)))
+                return FALSE;
+
+        mapped = gibbon_map_checked_file (path, TEST_MAGIC, TEST_VERSION,
+                                          sizeof (TestHeader), TRUE, NULL);
+        if (mapped) {
+                g_printerr ("Corrupted header accepted.\n");
+                g_mapped_file_unref (mapped);
+                retval = FALSE;
+        }
+
+        return retval;
+}
+
+static gboolean
+test_rejection (const gchar *path)
+{
+        GMappedFile *mapped;
+        gboolean retval = TRUE;
+
+        if (!write_test_file (path))
+                return FALSE;
+
+        mapped = gibbon_map_checked_file (path, "GibbonXX", TEST_VERSION,
+                                          sizeof (TestHeader), TRUE, NULL);
+        if (mapped) {
+                g_printerr ("File with wrong magic accepted.\n");
+                g_mapped_file_unref (mapped);
+                retval = FALSE;
+        }
+
+        mapped = gibbon_map_checked_file (path, TEST_MAGIC, TEST_VERSION + 1,
+                                          sizeof (TestHeader), TRUE, NULL);
+        if (mapped) {
+                g_printerr ("File with wrong version accepted.\n");
+                g_mapped_file_unref (mapped);
+                retval = FALSE;
+        }
+
+        /* Too short for the format specific header.  */
+        if (!damage_test_file (path, sizeof (TestHeader) - 1, G_MAXSIZE))
+                return FALSE;
+        mapped = gibbon_map_checked_file (path, TEST_MAGIC, TEST_VERSION,
+                                          sizeof (TestHeader), FALSE, NULL);
+        if (mapped) {
+                g_printerr ("Truncated file accepted.\n");
+                g_mapped_file_unref (mapped);
+                retval = FALSE;
+        }
+
+        return retval;
+}
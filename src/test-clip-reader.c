@@ -2085,6 +2085,8 @@ static gboolean test_single_case (GibbonCLIPReader *reader,
 static gboolean check_result (const gchar *line, gsize num,
                               struct token_pair *token_pair,
                               GValue *value);
+static gboolean test_records (GibbonCLIPReader *reader);
+static gboolean test_board_record (GibbonCLIPReader *reader);
 
 int
 main (int argc, char *argv[])
@@ -2102,6 +2104,9 @@ main (int argc, char *argv[])
                         status = -1;
         }
 
+        if (!test_records (reader))
+                status = -1;
+
         return status;
 }
 
@@ -2182,3 +2187,125 @@ check_result (const gchar *line, gsize num,
 
         return retval;
 }
+
+static gboolean
+test_records (GibbonCLIPReader *reader)
+{
+        const GibbonCLIPRecord *record;
+        gboolean retval = TRUE;
+
+        record = gibbon_clip_reader_scan (reader,
+                                          "5 GibbonTestA barrack - 0 1"
+                                          " 1418.61 1914 23 1306926526"
+                                          " 173.223.48.110* Gibbon_0.1.1"
+                                          " president@whitehouse.gov");
+        if (!record || record->code != GIBBON_CLIP_WHO_INFO
+            || g_strcmp0 (record->u.who_info.who, "GibbonTestA")
+            || g_strcmp0 (record->u.who_info.opponent, "barrack")
+            || g_strcmp0 (record->u.who_info.watching, "")
+            || record->u.who_info.ready
+            || !record->u.who_info.away
+            || record->u.who_info.rating != 1418.61
+            || record->u.who_info.experience != 1914
+            || record->u.who_info.idle != 23
+            || record->u.who_info.login != 1306926526
+            || g_strcmp0 (record->u.who_info.hostname, "173.223.48.110")
+            || g_strcmp0 (record->u.who_info.client, "Gibbon_0.1.1")
+            || g_strcmp0 (record->u.who_info.email,
+                          "president@whitehouse.gov")) {
+                g_printerr ("Typed who info record is wrong.\n");
+                retval = FALSE;
+        }
+
+        record = gibbon_clip_reader_scan (reader, "12 gflohr Hello world.");
+        if (!record || record->code != GIBBON_CLIP_SAYS
+            || g_strcmp0 (record->u.chat.sender, "gflohr")
+            || g_strcmp0 (record->u.chat.message, "Hello world.")) {
+                g_printerr ("Typed chat record is wrong.\n");
+                retval = FALSE;
+        }
+
+        record = gibbon_clip_reader_scan (reader, "You roll 6 and 5.");
+        if (!record || record->code != GIBBON_CLIP_ROLLS
+            || g_strcmp0 (record->u.rolls.who, "You")
+            || record->u.rolls.dice[0] != 6
+            || record->u.rolls.dice[1] != 5) {
+                g_printerr ("Typed rolls record is wrong.\n");
+                retval = FALSE;
+        }
+
+        record = gibbon_clip_reader_scan (reader,
+                                          "gflohr moves bar-24 bar-22 .");
+        if (!record || record->code != GIBBON_CLIP_MOVES
+            || g_strcmp0 (record->u.moves.who, "gflohr")
+            || record->u.moves.num_movements != 2
+            || record->u.moves.movements[0].from != 25
+            || record->u.moves.movements[0].to != 24
+            || record->u.moves.movements[1].from != 25
+            || record->u.moves.movements[1].to != 22) {
+                g_printerr ("Typed moves record is wrong.\n");
+                retval = FALSE;
+        }
+
+        if (!test_board_record (reader))
+                retval = FALSE;
+
+        return retval;
+}
+
+static gboolean
+test_board_record (GibbonCLIPReader *reader)
+{
+        const GibbonCLIPRecord *record;
+        const GibbonPosition *pos;
+        static const gint points[24] = {
+                 0,  0, -1,  3,  3,  2,  0,  3,  0,  0,  2,  0,
+                 2,  0,  0,  0, -1, -1, -2, -2, -2, -4, -2,  0
+        };
+        gint i;
+
+        record = gibbon_clip_reader_scan (reader, test_board02.line);
+        if (!record || record->code != GIBBON_CLIP_BOARD) {
+                g_printerr ("Typed board record expected.\n");
+                return FALSE;
+        }
+        if (!record->u.board.direction) {
+                g_printerr ("Board record: wrong direction.\n");
+                return FALSE;
+        }
+
+        pos = record->u.board.position;
+        if (!pos) {
+                g_printerr ("Board record: no position.\n");
+                return FALSE;
+        }
+
+        for (i = 0; i < 24; ++i) {
+                if (pos->points[i] != points[i]) {
+                        g_printerr ("Board record: expected %d checkers"
+                                    " on point %d, got %d.\n",
+                                    points[i], i + 1, pos->points[i]);
+                        return FALSE;
+                }
+        }
+
+        if (g_strcmp0 (pos->players[0], "joe_white")
+            || g_strcmp0 (pos->players[1], "black_jack")
+            || pos->match_length != 2
+            || pos->scores[0] != 1
+            || pos->scores[1] != 1
+            || pos->bar[0] || pos->bar[1]
+            || pos->dice[0] != 5
+            || pos->dice[1] != 1
+            || pos->cube != 2
+            || pos->may_double[0]
+            || !pos->may_double[1]
+            || pos->cube_turned != GIBBON_POSITION_SIDE_NONE
+            || pos->turn != GIBBON_POSITION_SIDE_WHITE
+            || g_strcmp0 (pos->game_info, "Post-Crawford game")) {
+                g_printerr ("Typed board record is wrong.\n");
+                return FALSE;
+        }
+
+        return TRUE;
+}
@@ -0,0 +1,289 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <gibbon-evaluator.h>
+#include <gibbon-analysis-move.h>
+#include <gibbon-util.h>
+
+#define NUM_HIDDEN 11
+#define EPSILON 0.00001
+
+static gfloat hidden_weights[GIBBON_EVALUATOR_INPUTS * NUM_HIDDEN];
+static gfloat hidden_bias[NUM_HIDDEN];
+static gfloat output_weights[GIBBON_EVALUATOR_OUTPUTS * NUM_HIDDEN];
+static gfloat output_bias[GIBBON_EVALUATOR_OUTPUTS];
+
+static GibbonEvaluator *create_evaluator (void);
+static void reference (const gint8 board[26],
+                       gdouble p[GIBBON_EVALUATOR_OUTPUTS]);
+static gboolean test_plays (const GibbonEvaluator *evaluator);
+static gboolean test_game_over (const GibbonEvaluator *evaluator);
+static gboolean test_save_and_load (const GibbonEvaluator *evaluator);
+
+int
+main(int argc, char *argv[])
+{
+        int status = 0;
+        GibbonEvaluator *evaluator;
+
+        g_type_init ();
+
+        evaluator = create_evaluator ();
+
+        if (!test_plays (evaluator))
+                status = -1;
+        if (!test_game_over (evaluator))
+                status = -1;
+        if (!test_save_and_load (evaluator))
+                status = -1;
+
+        gibbon_evaluator_free (evaluator);
+
+        return status;
+}
+
+static GibbonEvaluator *
+create_evaluator (void)
+{
+        GRand *rand = g_rand_new_with_seed (2012);
+        gsize i;
+
+        for (i = 0; i < G_N_ELEMENTS (hidden_weights); ++i)
+                hidden_weights[i] = g_rand_double_range (rand, -1.0, 1.0);
+        for (i = 0; i < G_N_ELEMENTS (hidden_bias); ++i)
+                hidden_bias[i] = g_rand_double_range (rand, -1.0, 1.0);
+        for (i = 0; i < G_N_ELEMENTS (output_weights); ++i)
+                output_weights[i] = g_rand_double_range (rand, -1.0, 1.0);
+        for (i = 0; i < G_N_ELEMENTS (output_bias); ++i)
+                output_bias[i] = g_rand_double_range (rand, -1.0, 1.0);
+
+        g_rand_free (rand);
+
+        return gibbon_evaluator_new (NUM_HIDDEN, hidden_weights, hidden_bias,
+                                     output_weights, output_bias);
+}
+
+/* Straightforward implementation of the network in double precision.  */
+static void
+reference (const gint8 board[26], gdouble p[GIBBON_EVALUATOR_OUTPUTS])
+{
+        gfloat inputs[GIBBON_EVALUATOR_INPUTS];
+        gdouble hidden[NUM_HIDDEN];
+        gdouble sum;
+        gsize i, j;
+
+        gibbon_evaluator_encode (board, inputs);
+
+        for (j = 0; j < NUM_HIDDEN; ++j) {
+                sum = hidden_bias[j];
+                for (i = 0; i < GIBBON_EVALUATOR_INPUTS; ++i)
+                        sum += inputs[i] * hidden_weights[i * NUM_HIDDEN + j];
+                hidden[j] = 1.0 / (1.0 + exp (-sum));
+        }
+
+        for (i = 0; i < GIBBON_EVALUATOR_OUTPUTS; ++i) {
+                sum = output_bias[i];
+                for (j = 0; j < NUM_HIDDEN; ++j)
+                        sum += output_weights[i * NUM_HIDDEN + j] * hidden[j];
+                p[i] = 1.0 / (1.0 + exp (-sum));
+        }
+}
+
+static gboolean
+test_plays (const GibbonEvaluator *evaluator)
+{
+        GibbonPosition *pos = gibbon_position_new ();
+        GArray *plays;
+        const GibbonPositionPlay *play;
+        gdouble (*p)[GIBBON_EVALUATOR_OUTPUTS];
+        gdouble expect[GIBBON_EVALUATOR_OUTPUTS];
+        gdouble single[GIBBON_EVALUATOR_OUTPUTS];
+        gint8 board[26];
+        gsize num_plays, i, best;
+        gint j;
+        gboolean retval = TRUE;
+
+        plays = g_array_new (FALSE, FALSE, sizeof (GibbonPositionPlay));
+        num_plays = gibbon_position_generate_moves (pos,
+                                                    GIBBON_POSITION_SIDE_WHITE,
+                                                    6, 5, plays);
+        p = g_malloc (num_plays * sizeof *p);
+        gibbon_evaluator_evaluate_plays (evaluator,
+                                         (GibbonPositionPlay *) plays->data,
+                                         num_plays, p);
+
+        for (i = 0; i < num_plays; ++i) {
+                play = &g_array_index (plays, GibbonPositionPlay, i);
+
+                /* The opponent is on roll after the play.  */
+                board[0] = play->board[25];
+                board[25] = play->board[0];
+                for (j = 1; j <= 24; ++j)
+                        board[j] = -play->board[25 - j];
+                reference (board, expect);
+
+                if (fabs (p[i][GIBBON_ANALYSIS_MOVE_PWIN]
+                          - (1.0 - expect[GIBBON_ANALYSIS_MOVE_PWIN]))
+                    > EPSILON
+                    || fabs (p[i][GIBBON_ANALYSIS_MOVE_PWIN_GAMMON]
+                             - expect[GIBBON_ANALYSIS_MOVE_PLOSE_GAMMON])
+                    > EPSILON
+                    || fabs (p[i][GIBBON_ANALYSIS_MOVE_PLOSE_BACKGAMMON]
+                             - expect[GIBBON_ANALYSIS_MOVE_PWIN_BACKGAMMON])
+                    > EPSILON) {
+                        g_printerr ("Play #%u: batch evaluation differs from"
+                                    " reference implementation.\n",
+                                    (guint) i);
+                        retval = FALSE;
+                }
+        }
+
+        best = gibbon_evaluator_rank_plays (evaluator,
+                                            (GibbonPositionPlay *) plays->data,
+                                            num_plays, single);
+        for (i = 0; i < num_plays; ++i) {
+                if (gibbon_money_equity (p[i])
+                    > gibbon_money_equity (single) + EPSILON) {
+                        g_printerr ("Play #%u is better than best play"
+                                    " #%u.\n", (guint) i, (guint) best);
+                        retval = FALSE;
+                }
+        }
+
+        /* A single position must give the same result as the reference.  */
+        gibbon_evaluator_evaluate (evaluator, pos, GIBBON_POSITION_SIDE_BLACK,
+                                   single);
+        gibbon_position_normalize (pos, GIBBON_POSITION_SIDE_BLACK, board);
+        reference (board, expect);
+        for (i = 0; i < GIBBON_EVALUATOR_OUTPUTS; ++i) {
+                if (fabs (single[i] - expect[i]) > EPSILON) {
+                        g_printerr ("Output #%u: expected %f, got %f.\n",
+                                    (guint) i, expect[i], single[i]);
+                        retval = FALSE;
+                }
+        }
+
+        g_free (p);
+        g_array_free (plays, TRUE);
+        gibbon_position_free (pos);
+
+        return retval;
+}
+
+static gboolean
+test_game_over (const GibbonEvaluator *evaluator)
+{
+        GibbonPositionPlay play;
+        gdouble p[1][GIBBON_EVALUATOR_OUTPUTS];
+        gboolean retval = TRUE;
+
+        /* All checkers off, the opponent has 15 checkers in our home.  */
+        memset (&play, 0, sizeof play);
+        play.board[1] = -15;
+
+        gibbon_evaluator_evaluate_plays (evaluator, &play, 1, p);
+        if (p[0][GIBBON_ANALYSIS_MOVE_PWIN] != 1.0
+            || p[0][GIBBON_ANALYSIS_MOVE_PWIN_GAMMON] != 1.0
+            || p[0][GIBBON_ANALYSIS_MOVE_PWIN_BACKGAMMON] != 1.0
+            || p[0][GIBBON_ANALYSIS_MOVE_PLOSE_GAMMON] != 0.0
+            || p[0][GIBBON_ANALYSIS_MOVE_PLOSE_BACKGAMMON] != 0.0) {
+                g_printerr ("Backgammon not recognized.\n");
+                retval = FALSE;
+        }
+
+        /* The opponent has borne off one checker.  */
+        play.board[1] = -14;
+        gibbon_evaluator_evaluate_plays (evaluator, &play, 1, p);
+        if (p[0][GIBBON_ANALYSIS_MOVE_PWIN] != 1.0
+            || p[0][GIBBON_ANALYSIS_MOVE_PWIN_GAMMON] != 0.0
+            || p[0][GIBBON_ANALYSIS_MOVE_PWIN_BACKGAMMON] != 0.0) {
+                g_printerr ("Single game not recognized.\n");
+                retval = FALSE;
+        }
+
+        return retval;
+}
+
+static gboolean
+test_save_and_load (const GibbonEvaluator *evaluator)
+{
+        GibbonEvaluator *loaded;
+        GibbonPosition *pos;
+        GError *error = NULL;
+        gdouble p1[GIBBON_EVALUATOR_OUTPUTS];
+        gdouble p2[GIBBON_EVALUATOR_OUTPUTS];
+        gchar *path;
+        gint fd;
+        gboolean retval = TRUE;
+
+        fd = g_file_open_tmp ("test-evaluator-XXXXXX", &path, &error);
+        if (fd < 0) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+        close (fd);
+
+        if (!gibbon_evaluator_save (evaluator, path, &error)) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                (void) g_unlink (path);
+                g_free (path);
+                return FALSE;
+        }
+
+        loaded = gibbon_evaluator_load (path, &error);
+        if (!loaded) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                retval = FALSE;
+        } else {
+                if (gibbon_evaluator_get_num_hidden (loaded) != NUM_HIDDEN) {
+                        g_printerr ("Loaded network has wrong size.\n");
+                        retval = FALSE;
+                }
+                pos = gibbon_position_new ();
+                gibbon_evaluator_evaluate (evaluator, pos,
+                                           GIBBON_POSITION_SIDE_WHITE, p1);
+                gibbon_evaluator_evaluate (loaded, pos,
+                                           GIBBON_POSITION_SIDE_WHITE, p2);
+                if (memcmp (p1, p2, sizeof p1)) {
+                        g_printerr ("Loaded network evaluates differently.\n");
+                        retval = FALSE;
+                }
+                gibbon_position_free (pos);
+                gibbon_evaluator_free (loaded);
+        }
+
+        (void) g_unlink (path);
+        g_free (path);
+
+        return retval;
+}
@@ -264,6 +264,9 @@ static gboolean come_in_from_bar (gint board[28], gint die,
                                   GibbonPositionSide turn);
 
 static void print_moves (gint moves[8], GibbonPositionSide side, guint dice[2]);
+static void check_plays (const GibbonPosition *position, gint board[28],
+                         GibbonPositionSide turn, GArray *plays);
+static gboolean find_play (const GArray *plays, const gint board[28]);
 
 #if (DEBUG_TEST_ENGINE)
 static void print_movement (gint board[28], gint from, gint die,
@@ -353,6 +356,7 @@ test_roll (GibbonPosition *position)
         GibbonMove *move;
         int legal;
         guint free_checkers;
+        GArray *plays;
 
         if (position->dice[0] < 0)
                 turn = GIBBON_POSITION_SIDE_BLACK;
@@ -373,6 +377,9 @@ test_roll (GibbonPosition *position)
         dump_position (position);
 #endif
 
+        plays = g_array_new (FALSE, FALSE, sizeof (GibbonPositionPlay));
+        check_plays (position, board, turn, plays);
+
         while (done_positions++ < total_positions) {
                 /* Swap the dice after every try.  The "reasonable" move
                  * generator always uses the dice in order.  In the
@@ -419,6 +426,13 @@ test_roll (GibbonPosition *position)
                 compare_results (position, post_position, move,
                                  legal, moves, turn);
                 g_object_unref (move);
+                if (legal && !find_play (plays, post_board)) {
+                        g_printerr ("Move generator missed a legal play:\n");
+                        dump_position (position);
+                        g_printerr ("End position:\n");
+                        dump_position (post_position);
+                        exit (1);
+                }
                 if (legal) {
 #if (DEBUG_TEST_ENGINE)
                         print_moves (moves, turn, dice);
@@ -434,9 +448,80 @@ test_roll (GibbonPosition *position)
                 gibbon_position_free (post_position);
         }
 
+        g_array_free (plays, TRUE);
+
         return;
 }
 
+/*
+ * Every play found by the move generator must also be legal according
+ * to Gary's code.
+ */
+static void
+check_plays (const GibbonPosition *position, gint board[28],
+             GibbonPositionSide turn, GArray *plays)
+{
+        const GibbonPositionPlay *play;
+        gint post_board[28];
+        gint moves[8];
+        gint roll[2];
+        guint i, j;
+
+        roll[0] = position->dice[0];
+        roll[1] = position->dice[1];
+
+        (void) gibbon_position_generate_moves (position, turn,
+                                               position->dice[0],
+                                               position->dice[1], plays);
+        if (!plays->len) {
+                g_printerr ("Move generator found no play at all:\n");
+                dump_position (position);
+                exit (1);
+        }
+
+        for (i = 0; i < plays->len; ++i) {
+                play = &g_array_index (plays, GibbonPositionPlay, i);
+                post_board[26] = 15;
+                for (j = 0; j < 26; ++j) {
+                        post_board[j] = play->board[j];
+                        if (j && play->board[j] > 0)
+                                post_board[26] -= play->board[j];
+                }
+                post_board[27] = board[27];
+
+                if (!LegalMove (board, post_board, roll, moves)) {
+                        g_printerr ("Move generator produced an illegal"
+                                    " play:\n");
+                        dump_position (position);
+                        g_printerr ("Play:");
+                        for (j = 0; j < play->number; ++j)
+                                g_printerr (" %u/%u",
+                                            play->movements[j].from,
+                                            play->movements[j].to);
+                        g_printerr ("\n");
+                        exit (1);
+                }
+        }
+}
+
+static gboolean
+find_play (const GArray *plays, const gint board[28])
+{
+        const GibbonPositionPlay *play;
+        guint i, j;
+
+        for (i = 0; i < plays->len; ++i) {
+                play = &g_array_index (plays, GibbonPositionPlay, i);
+                for (j = 0; j < 26; ++j)
+                        if (play->board[j] != board[j])
+                                break;
+                if (j == 26)
+                        return TRUE;
+        }
+
+        return FALSE;
+}
+
 /* This function moves a checker more or less randomly.
  *
  * However, the checkers are not moved completely randomly.  If there is
@@ -0,0 +1,263 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <gibbon-geo-ip-snapshot.h>
+
+static GibbonGeoIPSnapshot *create_snapshot (void);
+static gboolean test_lookup (const GibbonGeoIPSnapshot *snapshot,
+                             guint32 address, const gchar *expect);
+static gboolean test_snapshot (const GibbonGeoIPSnapshot *snapshot);
+static gboolean test_save_and_load (const GibbonGeoIPSnapshot *snapshot);
+static gboolean test_parse_line (void);
+
+int
+main(int argc, char *argv[])
+{
+        int status = 0;
+        GibbonGeoIPSnapshot *snapshot;
+
+        g_type_init ();
+
+        snapshot = create_snapshot ();
+
+        if (!test_snapshot (snapshot))
+                status = -1;
+        if (!test_save_and_load (snapshot))
+                status = -1;
+        if (!test_parse_line ())
+                status = -1;
+
+        gibbon_geo_ip_snapshot_free (snapshot);
+
+        return status;
+}
+
+static GibbonGeoIPSnapshot *
+create_snapshot (void)
+{
+        static const struct {
+                guint32 start;
+                guint32 end;
+                const gchar *alpha2;
+        } rows[] = {
+                { 0x01000000, 0x01ffffff, "au" },
+                { 0x02000000, 0x020000ff, "de" },
+                /* Gap.  */
+                { 0x02000200, 0x02000200, "fr" },
+                { 0x50000000, 0x5fffffff, "nl" },
+                { 0xff000000, 0xffffffff, "us" }
+        };
+        GibbonDatabaseIPRange *ranges;
+        gsize i;
+
+        ranges = g_malloc0 (G_N_ELEMENTS (rows) * sizeof *ranges);
+        for (i = 0; i < G_N_ELEMENTS (rows); ++i) {
+                ranges[i].start = rows[i].start;
+                ranges[i].end = rows[i].end;
+                ranges[i].alpha2[0] = rows[i].alpha2[0];
+                ranges[i].alpha2[1] = rows[i].alpha2[1];
+        }
+
+        return gibbon_geo_ip_snapshot_new (ranges, G_N_ELEMENTS (rows));
+}
+
+static gboolean
+test_lookup (const GibbonGeoIPSnapshot *snapshot, guint32 address,
+             const gchar *expect)
+{
+        gchar alpha2[3];
+        gboolean found;
+
+        found = gibbon_geo_ip_snapshot_lookup (snapshot, address, alpha2);
+        if (!expect && found) {
+                g_printerr ("Address 0x%08x: expected no match, got `%s'.\n",
+                            address, alpha2);
+                return FALSE;
+        } else if (expect && !found) {
+                g_printerr ("Address 0x%08x: expected `%s', got no match.\n",
+                            address, expect);
+                return FALSE;
+        } else if (expect && strcmp (expect, alpha2)) {
+                g_printerr ("Address 0x%08x: expected `%s', got `%s'.\n",
+                            address, expect, alpha2);
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+static gboolean
+test_snapshot (const GibbonGeoIPSnapshot *snapshot)
+{
+        gboolean retval = TRUE;
+
+        if (!test_lookup (snapshot, 0x00000000, NULL))
+                retval = FALSE;
+        if (!test_lookup (snapshot, 0x00ffffff, NULL))
+                retval = FALSE;
+        if (!test_lookup (snapshot, 0x01000000, "au"))
+                retval = FALSE;
+        if (!test_lookup (snapshot, 0x01ffffff, "au"))
+                retval = FALSE;
+        if (!test_lookup (snapshot, 0x02000080, "de"))
+                retval = FALSE;
+        if (!test_lookup (snapshot, 0x02000100, NULL))
+                retval = FALSE;
+        if (!test_lookup (snapshot, 0x02000200, "fr"))
+                retval = FALSE;
+        if (!test_lookup (snapshot, 0x02000201, NULL))
+                retval = FALSE;
+        if (!test_lookup (snapshot, 0x5a5a5a5a, "nl"))
+                retval = FALSE;
+        if (!test_lookup (snapshot, 0xffffffff, "us"))
+                retval = FALSE;
+
+        return retval;
+}
+
+static gboolean
+test_save_and_load (const GibbonGeoIPSnapshot *snapshot)
+{
+        GibbonGeoIPSnapshot *loaded;
+        GError *error = NULL;
+        gchar *path;
+        gchar *contents;
+        gsize length;
+        gint fd;
+        gboolean retval = TRUE;
+
+        fd = g_file_open_tmp ("test-geo-ip-snapshot-XXXXXX", &path, &error);
+        if (fd < 0) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+        close (fd);
+
+        if (!gibbon_geo_ip_snapshot_save (snapshot, path, &error)) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                (void) g_unlink (path);
+                g_free (path);
+                return FALSE;
+        }
+
+        loaded = gibbon_geo_ip_snapshot_load (path, &error);
+        if (!loaded) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                retval = FALSE;
+        } else {
+                if (gibbon_geo_ip_snapshot_get_num_ranges (loaded)
+                    != gibbon_geo_ip_snapshot_get_num_ranges (snapshot)) {
+                        g_printerr ("Loaded snapshot has wrong size.\n");
+                        retval = FALSE;
+                }
+                if (!test_snapshot (loaded))
+                        retval = FALSE;
+                if (!gibbon_geo_ip_snapshot_verify (loaded, NULL)) {
+                        g_printerr ("Intact snapshot not verified.\n");
+                        retval = FALSE;
+                }
+                gibbon_geo_ip_snapshot_free (loaded);
+        }
+
+        /* A truncated file is rejected immediately.  */
+        if (g_file_get_contents (path, &contents, &length, NULL)) {
+                if (g_file_set_contents (path, contents, length - 1, NULL)) {
+                        loaded = gibbon_geo_ip_snapshot_load (path, NULL);
+                        if (loaded) {
+                                g_printerr ("Truncated snapshot accepted.\n");
+                                gibbon_geo_ip_snapshot_free (loaded);
+                                retval = FALSE;
+                        }
+                }
+                g_free (contents);
+        }
+
+        (void) g_unlink (path);
+        g_free (path);
+
+        return retval;
+}
+
+static gboolean
+test_parse_line (void)
+{
+        static const struct {
+                const gchar *line;
+                GibbonGeoIPLine expect;
+        } lines[] = {
+                { "", GIBBON_GEO_IP_LINE_EMPTY },
+                { "# \"1\",\"2\"", GIBBON_GEO_IP_LINE_EMPTY },
+                { " \t\r", GIBBON_GEO_IP_LINE_EMPTY },
+                { "\"16777216\",\"16777471\",\"apnic\",\"1313020800\","
+                  "\"AU\",\"AUS\",\"Australia\"\r",
+                  GIBBON_GEO_IP_LINE_RANGE },
+                { "\"16777216\",\"16777471\",\"apnic\"",
+                  GIBBON_GEO_IP_LINE_ERROR },
+                { "\"16777471\",\"16777216\",\"apnic\",\"1313020800\","
+                  "\"AU\",\"AUS\",\"Australia\"",
+                  GIBBON_GEO_IP_LINE_ERROR },
+                { "\"4294967296\",\"4294967296\",\"apnic\",\"1\","
+                  "\"AU\",\"AUS\",\"Australia\"",
+                  GIBBON_GEO_IP_LINE_ERROR },
+                { "\"1\",\"2\",\"apnic\",\"1\",\"au\",\"AUS\","
+                  "\"Australia\"",
+                  GIBBON_GEO_IP_LINE_ERROR }
+        };
+        GibbonDatabaseIPRange range;
+        const gchar *near;
+        GibbonGeoIPLine got;
+        gboolean retval = TRUE;
+        gsize i;
+
+        for (i = 0; i < G_N_ELEMENTS (lines); ++i) {
+                got = gibbon_geo_ip_snapshot_parse_line (
+                                lines[i].line, strlen (lines[i].line),
+                                &range, &near);
+                if (got != lines[i].expect) {
+                        g_printerr ("Line `%s': expected %d, got %d.\n",
+                                    lines[i].line, lines[i].expect, got);
+                        retval = FALSE;
+                }
+        }
+
+        got = gibbon_geo_ip_snapshot_parse_line (lines[3].line,
+                                                 strlen (lines[3].line),
+                                                 &range, &near);
+        if (got == GIBBON_GEO_IP_LINE_RANGE
+            && (range.start != 16777216 || range.end != 16777471
+                || range.alpha2[0] != 'a' || range.alpha2[1] != 'u')) {
+                g_printerr ("Range parsed incorrectly.\n");
+                retval = FALSE;
+        }
+
+        return retval;
+}
@@ -0,0 +1,275 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "gibbon-journal.h"
+#include "gibbon-gmd-reader.h"
+
+static gboolean test_commit (const gchar *path);
+static gboolean test_group_commit (const gchar *path);
+static gboolean test_recover (const gchar *path);
+static gboolean write_string (GOutputStream *out, const gchar *string);
+static gboolean check_contents (const gchar *path, const gchar *wanted,
+                                const gchar *what);
+static gboolean wait_for_commit (const gchar *path, gdouble timeout);
+
+int
+main(int argc, char *argv[])
+{
+        int status = 0;
+        GError *error = NULL;
+        gchar *path;
+        gint fd;
+
+        g_type_init ();
+
+        fd = g_file_open_tmp ("test-journal-XXXXXX", &path, &error);
+        if (fd < 0) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return -1;
+        }
+        close (fd);
+
+        if (!test_commit (path))
+                status = -1;
+        if (!test_group_commit (path))
+                status = -1;
+        if (!test_recover (path))
+                status = -1;
+
+        (void) g_unlink (path);
+        g_free (path);
+
+        return status;
+}
+
+static gboolean
+test_commit (const gchar *path)
+{
+        GibbonJournal *journal;
+        GOutputStream *out;
+        GError *error = NULL;
+        gboolean retval = TRUE;
+
+        journal = gibbon_journal_new (path, FALSE, 60000,
+                                      GIBBON_JOURNAL_SYNC_COMMIT, &error);
+        if (!journal) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+        out = G_OUTPUT_STREAM (journal);
+
+        if (!write_string (out, "GMD-2 # test\n")
+            || !write_string (out, "Game:\n")
+            || !write_string (out, "Roll:W:")) {
+                g_object_unref (journal);
+                return FALSE;
+        }
+
+        /* Nothing must have been written before the interval elapsed.  */
+        if (!check_contents (path, "", "before commit"))
+                retval = FALSE;
+
+        /* An explicit commit writes everything.  */
+        if (!g_output_stream_flush (out, NULL, &error)) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                g_object_unref (journal);
+                return FALSE;
+        }
+        if (!check_contents (path, "GMD-2 # test\nGame:\nRoll:W:",
+                             "after commit"))
+                retval = FALSE;
+
+        if (!write_string (out, "1350000000: 3 1\n")) {
+                g_object_unref (journal);
+                return FALSE;
+        }
+        if (!g_output_stream_close (out, NULL, &error)) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                retval = FALSE;
+        }
+        g_object_unref (journal);
+
+        if (!check_contents (path,
+                             "GMD-2 # test\nGame:\nRoll:W:1350000000: 3 1\n",
+                             "after close"))
+                retval = FALSE;
+
+        return retval;
+}
+
+static gboolean
+test_group_commit (const gchar *path)
+{
+        GibbonJournal *journal;
+        GOutputStream *out;
+        GError *error = NULL;
+        gboolean retval = TRUE;
+
+        journal = gibbon_journal_new (path, FALSE, 10,
+                                      GIBBON_JOURNAL_SYNC_NEVER, &error);
+        if (!journal) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+        out = G_OUTPUT_STREAM (journal);
+
+        if (!write_string (out, "Game:\nRoll:W:")) {
+                g_object_unref (journal);
+                return FALSE;
+        }
+
+        /* Timed commits must not write incomplete lines.  */
+        if (!wait_for_commit (path, 10.0)) {
+                g_printerr ("No group commit within 10 seconds.\n");
+                retval = FALSE;
+        } else if (!check_contents (path, "Game:\n", "after group commit"))
+                retval = FALSE;
+
+        g_object_unref (journal);
+
+        if (!check_contents (path, "Game:\nRoll:W:", "after dispose"))
+                retval = FALSE;
+
+        /* Appending must keep the existing contents.  */
+        journal = gibbon_journal_new (path, TRUE, 10,
+                                      GIBBON_JOURNAL_SYNC_CLOSE, &error);
+        if (!journal) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+        if (!write_string (G_OUTPUT_STREAM (journal), " 6 5\n"))
+                retval = FALSE;
+        g_object_unref (journal);
+
+        if (!check_contents (path, "Game:\nRoll:W: 6 5\n", "after append"))
+                retval = FALSE;
+
+        return retval;
+}
+
+static gboolean
+test_recover (const gchar *path)
+{
+        GError *error = NULL;
+        const gchar *torn = "GMD-2 # test\nGame:\nMove:W:1350000000: 8/5";
+        const gchar *intact = "GMD-2 # test\nGame:\n";
+
+        if (!g_file_set_contents (path, torn, -1, &error)) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+        if (!gibbon_gmd_reader_recover (path, &error)) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+        if (!check_contents (path, intact, "after recovery"))
+                return FALSE;
+
+        /* A complete file must not be touched.  */
+        if (!gibbon_gmd_reader_recover (path, &error)) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+        if (!check_contents (path, intact, "after second recovery"))
+                return FALSE;
+
+        return TRUE;
+}
+
+static gboolean
+write_string (GOutputStream *out, const gchar *string)
+{
+        GError *error = NULL;
+
+        if (!g_output_stream_write_all (out, string, strlen (string),
+                                        NULL, NULL, &error)) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+static gboolean
+check_contents (const gchar *path, const gchar *wanted, const gchar *what)
+{
+        gchar *got;
+        GError *error = NULL;
+
+        if (!g_file_get_contents (path, &got, NULL, &error)) {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+
+        if (g_strcmp0 (wanted, got)) {
+                g_printerr ("Journal contents %s: wanted \"%s\", got \"%s\".\n",
+                            what, wanted, got);
+                g_free (got);
+                return FALSE;
+        }
+
+        g_free (got);
+
+        return TRUE;
+}
+
+/*
+ * The worker thread commits in the background.  Poll until it has written
+ * something instead of guessing how long that takes on a loaded machine.
+ */
+static gboolean
+wait_for_commit (const gchar *path, gdouble timeout)
+{
+        GTimer *timer = g_timer_new ();
+        GStatBuf buf;
+        gboolean retval = FALSE;
+
+        while (g_timer_elapsed (timer, NULL) < timeout) {
+                if (g_stat (path, &buf) == 0 && buf.st_size > 0) {
+                        retval = TRUE;
+                        break;
+                }
+                g_usleep (10 * 1000);
+        }
+
+        g_timer_destroy (timer);
+
+        return retval;
+}
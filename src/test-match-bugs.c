@@ -25,9 +25,11 @@
 #include <string.h>
 
 #include "gibbon-match.h"
+#include "gibbon-match-play.h"
 #include "gibbon-game.h"
 #include "gibbon-position.h"
 #include "gibbon-roll.h"
+#include "gibbon-drop.h"
 
 gboolean
 test_bug01 ()
@@ -132,6 +134,166 @@ test_bug02 ()
         return TRUE;
 }
 
+/*
+ * White's roll and move and black's double and take are missing.  The
+ * doubled cube in the target position must not lead the search into
+ * assuming that white doubled first.
+ */
+gboolean
+test_bug03 ()
+{
+        GibbonMatch *match;
+        GibbonGame *game;
+        GibbonPosition *from;
+        GibbonPosition *to;
+        GSList *result = NULL;
+        GibbonMatchPlay *play;
+        gboolean retval = TRUE;
+
+        match = gibbon_match_new ("guido", "gnubg_supremo", 7, TRUE);
+        g_return_val_if_fail (gibbon_match_add_game (match, NULL), -1);
+        game = gibbon_match_get_current_game (match);
+        from = gibbon_game_get_initial_position_editable (game);
+
+        from->turn = GIBBON_POSITION_SIDE_WHITE;
+
+        /* White rolled 3-1 and played 8/5 6/5.  */
+        to = gibbon_position_copy (gibbon_match_get_current_position (match));
+        to->turn = GIBBON_POSITION_SIDE_BLACK;
+        to->points[7] = 2;
+        to->points[5] = 4;
+        to->points[4] = 2;
+        to->cube = 2;
+        to->may_double[0] = TRUE;
+        to->may_double[1] = FALSE;
+
+        if (!gibbon_match_get_missing_actions (match, to, &result)) {
+                g_printerr ("Double instead of roll: no actions found.\n");
+                retval = FALSE;
+        } else if (g_slist_length (result) != 4) {
+                g_printerr ("Double instead of roll: expected 4 actions,"
+                            " got %u.\n", g_slist_length (result));
+                retval = FALSE;
+        } else {
+                play = result->data;
+                if (!GIBBON_IS_ROLL (play->action)
+                    || play->side != GIBBON_POSITION_SIDE_WHITE) {
+                        g_printerr ("Double instead of roll: first action"
+                                    " is not white's roll.\n");
+                        retval = FALSE;
+                }
+        }
+
+        g_slist_free_full (result, (GDestroyNotify) gibbon_match_play_free);
+        gibbon_position_free (to);
+        g_object_unref (match);
+
+        return retval;
+}
+
+/*
+ * Black doubled, and white dropped, so that the target position is
+ * already the opening roll of the next game.
+ */
+static GibbonMatch *
+create_dropped_double (GibbonPosition **to)
+{
+        GibbonMatch *match;
+        GibbonGame *game;
+        GibbonPosition *from;
+
+        match = gibbon_match_new ("guido", "gnubg_supremo", 7, TRUE);
+        g_return_val_if_fail (gibbon_match_add_game (match, NULL), NULL);
+        game = gibbon_match_get_current_game (match);
+        from = gibbon_game_get_initial_position_editable (game);
+
+        from->turn = GIBBON_POSITION_SIDE_WHITE;
+        from->cube_turned = GIBBON_POSITION_SIDE_BLACK;
+        from->scores[0] = 2;
+        from->scores[1] = 3;
+
+        *to = gibbon_position_copy (gibbon_match_get_current_position (match));
+        gibbon_position_reset (*to);
+        (*to)->scores[1] = 4;
+        (*to)->turn = GIBBON_POSITION_SIDE_WHITE;
+        (*to)->dice[0] = 4;
+        (*to)->dice[1] = 2;
+
+        return match;
+}
+
+gboolean
+test_bug04 ()
+{
+        GibbonMatch *match;
+        GibbonPosition *to;
+        GSList *result = NULL;
+        GibbonMatchPlay *play;
+        gboolean retval = TRUE;
+
+        match = create_dropped_double (&to);
+        g_return_val_if_fail (match != NULL, FALSE);
+
+        if (!gibbon_match_get_missing_actions (match, to, &result)) {
+                g_printerr ("Take instead of drop: no actions found.\n");
+                retval = FALSE;
+        } else if (g_slist_length (result) != 2) {
+                g_printerr ("Take instead of drop: expected 2 actions,"
+                            " got %u.\n", g_slist_length (result));
+                retval = FALSE;
+        } else {
+                play = result->data;
+                if (!GIBBON_IS_DROP (play->action)
+                    || play->side != GIBBON_POSITION_SIDE_WHITE) {
+                        g_printerr ("Take instead of drop: first action"
+                                    " is not white's drop.\n");
+                        retval = FALSE;
+                }
+        }
+
+        g_slist_free_full (result, (GDestroyNotify) gibbon_match_play_free);
+        gibbon_position_free (to);
+        g_object_unref (match);
+
+        return retval;
+}
+
+gboolean
+test_search_limit ()
+{
+        GibbonMatch *match;
+        GibbonPosition *to;
+        GSList *result = NULL;
+        gboolean retval = TRUE;
+
+        match = create_dropped_double (&to);
+        g_return_val_if_fail (match != NULL, FALSE);
+
+        /* The drop and the roll are two steps.  */
+        gibbon_match_set_search_limits (match, 1, 10.0);
+        if (gibbon_match_get_missing_actions (match, to, &result)) {
+                g_printerr ("Search limit: found actions beyond the maximum"
+                            " depth.\n");
+                g_slist_free_full (result,
+                                   (GDestroyNotify) gibbon_match_play_free);
+                result = NULL;
+                retval = FALSE;
+        }
+
+        gibbon_match_set_search_limits (match, 2, 10.0);
+        if (!gibbon_match_get_missing_actions (match, to, &result)) {
+                g_printerr ("Search limit: no actions found within the"
+                            " maximum depth.\n");
+                retval = FALSE;
+        }
+
+        g_slist_free_full (result, (GDestroyNotify) gibbon_match_play_free);
+        gibbon_position_free (to);
+        g_object_unref (match);
+
+        return retval;
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -141,6 +303,12 @@ main (int argc, char *argv[])
                 return -1;
         if (!test_bug02 ())
                 return -1;
+        if (!test_bug03 ())
+                return -1;
+        if (!test_bug04 ())
+                return -1;
+        if (!test_search_limit ())
+                return -1;
 
         return 0;
 }
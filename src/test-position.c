@@ -33,6 +33,7 @@ static gboolean test_copy_constructor (void);
 static gboolean test_compare (void);
 static gboolean test_apply_move (void);
 static gboolean test_game_over (void);
+static gboolean test_ids (void);
 
 int
 main(int argc, char *argv[])
@@ -51,6 +52,8 @@ main(int argc, char *argv[])
                 status = -1;
         if (!test_game_over ())
                 status = -1;
+        if (!test_ids ())
+                status = -1;
 
         return status;
 }
@@ -553,3 +556,95 @@ test_game_over ()
 
         return retval;
 }
+
+static gboolean
+test_ids (void)
+{
+        gboolean retval = TRUE;
+        GibbonPosition *position = gibbon_position_new ();
+        GibbonPosition *copy;
+        gchar *id;
+
+        position->turn = GIBBON_POSITION_SIDE_WHITE;
+
+        id = gibbon_position_get_position_id (position);
+        if (g_strcmp0 ("4HPwATDgc/ABMA", id)) {
+                g_printerr ("Expected position ID 4HPwATDgc/ABMA, got %s.\n",
+                            id);
+                retval = FALSE;
+        }
+        g_free (id);
+
+        id = gibbon_position_get_match_id (position);
+        if (g_strcmp0 ("cAkAAAAAAAAA", id)) {
+                g_printerr ("Expected match ID cAkAAAAAAAAA, got %s.\n", id);
+                retval = FALSE;
+        }
+        g_free (id);
+
+        /* Example from the GNU Backgammon manual.  */
+        if (!gibbon_position_set_match_id (position, "QYkqASAAIAAA")) {
+                g_printerr ("Valid match ID QYkqASAAIAAA rejected.\n");
+                retval = FALSE;
+        } else if (position->match_length != 9
+                   || position->scores[0] != 4 || position->scores[1] != 2
+                   || position->cube != 2
+                   || position->may_double[0] || !position->may_double[1]
+                   || position->turn != GIBBON_POSITION_SIDE_WHITE
+                   || position->dice[0] != 5 || position->dice[1] != 2) {
+                g_printerr ("Match ID QYkqASAAIAAA decoded incorrectly.\n");
+                retval = FALSE;
+        }
+
+        /* Black has opened with 31.  */
+        if (!gibbon_position_set_position_id (position, "sGfwATDgc/ABMA")) {
+                g_printerr ("Valid position ID sGfwATDgc/ABMA rejected.\n");
+                retval = FALSE;
+        } else if (position->points[16] != -2 || position->points[18] != -4
+                   || position->points[19] != -2) {
+                g_printerr ("Position ID sGfwATDgc/ABMA decoded"
+                            " incorrectly.\n");
+                retval = FALSE;
+        }
+        copy = gibbon_position_copy (position);
+        id = gibbon_position_get_position_id (copy);
+        if (g_strcmp0 ("sGfwATDgc/ABMA", id)) {
+                g_printerr ("Position ID sGfwATDgc/ABMA encoded as %s.\n",
+                            id);
+                retval = FALSE;
+        }
+        g_free (id);
+        memset (copy->points, 0, sizeof copy->points);
+        id = gibbon_position_get_match_id (position);
+        if (!gibbon_position_set_match_id (copy, id)
+            || !gibbon_position_set_position_id (copy, "sGfwATDgc/ABMA")
+            || !gibbon_position_equals_technically (position, copy)) {
+                g_printerr ("Position and match ID do not round-trip.\n");
+                retval = FALSE;
+        }
+        g_free (id);
+
+        if (gibbon_position_hash (position) != gibbon_position_hash (copy)) {
+                g_printerr ("Equal positions have different hashes.\n");
+                retval = FALSE;
+        }
+        copy->points[5] = -copy->points[5];
+        if (gibbon_position_hash (position) == gibbon_position_hash (copy)) {
+                g_printerr ("Different positions have the same hash.\n");
+                retval = FALSE;
+        }
+
+        if (gibbon_position_set_position_id (copy, "4HPwATDgc/AB")) {
+                g_printerr ("Truncated position ID accepted.\n");
+                retval = FALSE;
+        }
+        if (gibbon_position_set_position_id (copy, "////////////AA")) {
+                g_printerr ("Position ID with too many checkers accepted.\n");
+                retval = FALSE;
+        }
+
+        gibbon_position_free (copy);
+        gibbon_position_free (position);
+
+        return retval;
+}
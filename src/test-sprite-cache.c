@@ -0,0 +1,186 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <gibbon-sprite-cache.h>
+
+static const gchar *square =
+        "<?xml version=\"1.0\"?>\n"
+        "<svg xmlns=\"http://www.w3.org/2000/svg\""
+        " width=\"10\" height=\"10\">\n"
+        "  <rect x=\"0\" y=\"0\" width=\"10\" height=\"10\""
+        " fill=\"#ff0000\"/>\n"
+        "</svg>\n";
+
+/* Scaled by two plus the margin of one pixel on each side.  */
+#define SPRITE_SIZE (4 * 22 * 22)
+
+static gboolean test_draw (struct svg_component *svg);
+static gboolean test_expire (struct svg_component *svg);
+
+int
+main(int argc, char *argv[])
+{
+        int status = 0;
+        struct svg_component svg;
+
+        g_type_init ();
+
+        memset (&svg, 0, sizeof svg);
+        if (svg_cairo_create (&svg.scr) != SVG_CAIRO_STATUS_SUCCESS
+            || svg_cairo_parse_buffer (svg.scr, square, strlen (square))
+               != SVG_CAIRO_STATUS_SUCCESS) {
+                g_printerr ("Cannot parse test component.\n");
+                return -1;
+        }
+        svg.width = svg.height = 10;
+
+        if (!test_draw (&svg))
+                status = -1;
+        if (!test_expire (&svg))
+                status = -1;
+
+        svg_cairo_destroy (svg.scr);
+
+        return status;
+}
+
+static gboolean
+test_draw (struct svg_component *svg)
+{
+        GibbonSpriteCache *cache = gibbon_sprite_cache_new (1 << 20);
+        cairo_surface_t *surface;
+        cairo_t *cr;
+        guint32 pixel;
+        gboolean retval = TRUE;
+
+        surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 100, 100);
+        cr = cairo_create (surface);
+        cairo_scale (cr, 2, 2);
+
+        if (gibbon_sprite_cache_contains (cache, cr, svg, NULL)) {
+                g_printerr ("Empty cache contains sprite.\n");
+                retval = FALSE;
+        }
+
+        gibbon_sprite_cache_draw (cache, cr, svg, NULL, 20, 20);
+        if (!gibbon_sprite_cache_contains (cache, cr, svg, NULL)) {
+                g_printerr ("Sprite was not cached.\n");
+                retval = FALSE;
+        }
+        if (gibbon_sprite_cache_contains (cache, cr, svg, "variant")) {
+                g_printerr ("Variant was not distinguished.\n");
+                retval = FALSE;
+        }
+        if (gibbon_sprite_cache_get_size (cache) != SPRITE_SIZE) {
+                g_printerr ("Expected cache size %u, got %u.\n",
+                            SPRITE_SIZE,
+                            (guint) gibbon_sprite_cache_get_size (cache));
+                retval = FALSE;
+        }
+
+        /* The component covers the device pixels 30 to 49.  */
+        cairo_surface_flush (surface);
+        pixel = *(guint32 *) (cairo_image_surface_get_data (surface)
+                              + 40 * cairo_image_surface_get_stride (surface)
+                              + 40 * 4);
+        if (pixel != 0xffff0000) {
+                g_printerr ("Expected red pixel at 40/40, got %08x.\n", pixel);
+                retval = FALSE;
+        }
+        pixel = *(guint32 *) (cairo_image_surface_get_data (surface)
+                              + 60 * cairo_image_surface_get_stride (surface)
+                              + 60 * 4);
+        if (pixel) {
+                g_printerr ("Expected empty pixel at 60/60, got %08x.\n",
+                            pixel);
+                retval = FALSE;
+        }
+
+        cairo_scale (cr, 2, 2);
+        if (gibbon_sprite_cache_contains (cache, cr, svg, NULL)) {
+                g_printerr ("Scale was not distinguished.\n");
+                retval = FALSE;
+        }
+
+        gibbon_sprite_cache_clear (cache);
+        if (gibbon_sprite_cache_get_size (cache)) {
+                g_printerr ("Cache not empty after clearing.\n");
+                retval = FALSE;
+        }
+
+        cairo_destroy (cr);
+        cairo_surface_destroy (surface);
+        gibbon_sprite_cache_free (cache);
+
+        return retval;
+}
+
+static gboolean
+test_expire (struct svg_component *svg)
+{
+        GibbonSpriteCache *cache;
+        cairo_surface_t *surface;
+        cairo_t *cr;
+        gboolean retval = TRUE;
+
+        /* Room for two sprites.  */
+        cache = gibbon_sprite_cache_new (2 * SPRITE_SIZE);
+
+        surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 100, 100);
+        cr = cairo_create (surface);
+        cairo_scale (cr, 2, 2);
+
+        gibbon_sprite_cache_draw (cache, cr, svg, "1", 20, 20);
+        gibbon_sprite_cache_draw (cache, cr, svg, "2", 20, 20);
+        gibbon_sprite_cache_draw (cache, cr, svg, "1", 20, 20);
+        gibbon_sprite_cache_draw (cache, cr, svg, "3", 20, 20);
+
+        if (!gibbon_sprite_cache_contains (cache, cr, svg, "1")) {
+                g_printerr ("Recently used sprite was discarded.\n");
+                retval = FALSE;
+        }
+        if (gibbon_sprite_cache_contains (cache, cr, svg, "2")) {
+                g_printerr ("Least recently used sprite was not discarded.\n");
+                retval = FALSE;
+        }
+        if (!gibbon_sprite_cache_contains (cache, cr, svg, "3")) {
+                g_printerr ("New sprite was discarded.\n");
+                retval = FALSE;
+        }
+        if (gibbon_sprite_cache_get_size (cache) != 2 * SPRITE_SIZE) {
+                g_printerr ("Expected cache size %u, got %u.\n",
+                            2 * SPRITE_SIZE,
+                            (guint) gibbon_sprite_cache_get_size (cache));
+                retval = FALSE;
+        }
+
+        cairo_destroy (cr);
+        cairo_surface_destroy (surface);
+        gibbon_sprite_cache_free (cache);
+
+        return retval;
+}
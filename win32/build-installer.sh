@@ -129,7 +129,7 @@ cp -r "${gibbon_prefix}/share/pixmaps/gibbon" installer/gibbon/share/pixmaps ||e
 # GtkBuilder file and GeoIP database.
 mkdir -p installer/gibbon/share/gibbon || exit 1
 cp "${gibbon_prefix}/share/gibbon/gibbon.ui" installer/gibbon/share/gibbon || exit 1
-cp "${gibbon_prefix}/share/gibbon/ip2country.csv.gz" installer/gibbon/share/gibbon || exit 1
+cp "${gibbon_prefix}/share/gibbon/ip2country.bin" installer/gibbon/share/gibbon || exit 1
 
 echo "Copying executable..."
 mkdir -p installer/gibbon/bin